@@ -1,3 +1,146 @@
 ﻿#include "community.h"
+#include <string.h>
 
+#if defined(__arm__)
+#include "stm32f4xx.h"
+#define COMMUNITY_BARRIER()   __DMB()
+#else
+#define COMMUNITY_BARRIER()   __sync_synchronize()
+#endif
 
+#define COMMUNITY_SLOT_WORDS  ((COMMUNITY_SLOT_SIZE + 3) / 4)
+
+typedef struct {
+    volatile uint32_t seq;                       // 偶数：空闲，奇数：正在写第seq/2+1代
+    uint32_t slot[2][COMMUNITY_SLOT_WORDS];      // 第g代数据位于slot[g & 1]
+} communityTopic_t;
+
+/* 全部清零即为未发布状态，不需要初始化 */
+static communityTopic_t g_topics[COMMUNITY_TOPIC_NUM];
+
+/**
+ * @brief  发布话题数据(覆盖上一次的值)
+ * @param  topic: 话题
+ * @param  data: 数据
+ * @param  size: 字节数，不超过COMMUNITY_SLOT_SIZE
+ * @retval 1: 成功  0: 参数错误
+ */
+uint8_t communityPublish(communityTopic_e topic, const void *data, uint16_t size)
+{
+    communityTopic_t *t;
+    uint32_t seq;
+    
+    if (topic >= COMMUNITY_TOPIC_NUM || size > COMMUNITY_SLOT_SIZE)
+    {
+        return 0;
+    }
+    
+    t = &g_topics[topic];
+    seq = t->seq;
+    
+    /* 标记正在写入，订阅者此时仍可读取上一代所在的槽 */
+    t->seq = seq + 1;
+    COMMUNITY_BARRIER();
+    
+    memcpy(t->slot[((seq >> 1) + 1) & 1], data, size);
+    
+    COMMUNITY_BARRIER();
+    t->seq = seq + 2;
+    
+    return 1;
+}
+
+/**
+ * @brief  读取话题最新数据
+ * @param  topic: 话题
+ * @param  out: 输出
+ * @param  size: 字节数，与发布时一致
+ * @retval 数据的代数，0表示尚未发布(out不变)
+ */
+uint32_t communityRead(communityTopic_e topic, void *out, uint16_t size)
+{
+    communityTopic_t *t;
+    uint32_t gen;
+    
+    if (topic >= COMMUNITY_TOPIC_NUM || size > COMMUNITY_SLOT_SIZE)
+    {
+        return 0;
+    }
+    
+    t = &g_topics[topic];
+    
+    do
+    {
+        gen = t->seq >> 1;
+        if (gen == 0)
+        {
+            return 0;
+        }
+        COMMUNITY_BARRIER();
+        
+        memcpy(out, t->slot[gen & 1], size);
+        
+        COMMUNITY_BARRIER();
+    } while (t->seq - (gen << 1) > 2);
+    
+    return gen;
+}
+
+/**
+ * @brief  获取话题当前代数(已完成的发布次数)
+ * @param  topic: 话题
+ * @retval 代数，0表示尚未发布
+ */
+uint32_t communityGeneration(communityTopic_e topic)
+{
+    if (topic >= COMMUNITY_TOPIC_NUM)
+    {
+        return 0;
+    }
+    
+    return g_topics[topic].seq >> 1;
+}
+
+/**
+ * @brief  零拷贝读取：返回最新数据所在槽的指针
+ *         使用完数据后需调用communityPeekValid确认期间未被覆盖，否则丢弃本次结果
+ * @param  topic: 话题
+ * @param  seq: 输出读取时的序号，传给communityPeekValid
+ * @retval 数据指针，NULL表示尚未发布
+ */
+const void *communityPeek(communityTopic_e topic, uint32_t *seq)
+{
+    uint32_t gen;
+    
+    if (topic >= COMMUNITY_TOPIC_NUM)
+    {
+        return NULL;
+    }
+    
+    gen = g_topics[topic].seq >> 1;
+    *seq = gen << 1;
+    if (gen == 0)
+    {
+        return NULL;
+    }
+    COMMUNITY_BARRIER();
+    
+    return g_topics[topic].slot[gen & 1];
+}
+
+/**
+ * @brief  检查communityPeek返回的数据在使用期间是否被覆盖
+ * @param  topic: 话题
+ * @param  seq: communityPeek输出的序号
+ * @retval 1: 数据完整  0: 已被覆盖，需丢弃
+ */
+uint8_t communityPeekValid(communityTopic_e topic, uint32_t seq)
+{
+    if (topic >= COMMUNITY_TOPIC_NUM)
+    {
+        return 0;
+    }
+    
+    COMMUNITY_BARRIER();
+    return g_topics[topic].seq - seq <= 2;
+}
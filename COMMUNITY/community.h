@@ -1,9 +1,38 @@
 ﻿#ifndef __COMMUNITY_H
 #define __COMMUNITY_H
 
+#include <stdint.h>
 
+/*
+ * 任务间数据中心(发布/订阅)
+ *
+ * 每个话题保存最新一份数据，发布者覆盖写入，订阅者随时读取最新值，不使用互斥量与临界区：
+ * 1.每个话题两个数据槽交替写入，序号seq为偶数时空闲，为奇数时正在写入下一个槽
+ * 2.代数 = seq/2，即已完成的发布次数，订阅者比较代数判断是否有新数据
+ * 3.读取代数g对应的槽，直到发布者开始写第g+2代(seq >= 2g+3)之前都不会被覆盖，
+ *   读完后检查seq即可判断是否读到撕裂的数据，因此订阅者有一个完整的发布周期可用
+ *
+ * 每个话题只能有一个发布者(任务或中断)，订阅者数量不限
+ */
 
-#endif
+#define COMMUNITY_SLOT_SIZE    32      // 单个话题数据的最大字节数
 
+/* 话题 */
+typedef enum {
+    COMMUNITY_TOPIC_ATTITUDE = 0,      // attitude_t，stabilizerTask发布
+    COMMUNITY_TOPIC_SENSOR,            // MPU9250_Data_t，stabilizerTask发布
+    COMMUNITY_TOPIC_CONTROL,           // control_t，stabilizerTask发布
+    COMMUNITY_TOPIC_MOTOR,             // float[4]，各电机输出(0~1)，stabilizerTask发布
+    COMMUNITY_TOPIC_VERTICAL,          // float[2]，{高度(m), 垂直速度(m/s)}，stabilizerTask发布(仅EKF模式)
+    COMMUNITY_TOPIC_SETPOINT,          // setpoint_t，atkpRxTask发布
+    COMMUNITY_TOPIC_LINK,              // radiolinkStatus_t，radioLinkTask发布
+    COMMUNITY_TOPIC_NUM
+} communityTopic_e;
 
+uint8_t communityPublish(communityTopic_e topic, const void *data, uint16_t size);
+uint32_t communityRead(communityTopic_e topic, void *out, uint16_t size);
+uint32_t communityGeneration(communityTopic_e topic);
+const void *communityPeek(communityTopic_e topic, uint32_t *seq);
+uint8_t communityPeekValid(communityTopic_e topic, uint32_t seq);
 
+#endif
@@ -0,0 +1,306 @@
+﻿#include "mempool.h"
+
+#if MEMPOOL_ENABLE
+
+#if defined(__arm__)
+#include "FreeRTOS.h"
+#include "task.h"
+#define MEMPOOL_ENTER()              taskENTER_CRITICAL()
+#define MEMPOOL_EXIT()               taskEXIT_CRITICAL()
+#define MEMPOOL_ENTER_FROM_ISR(s)    ((s) = taskENTER_CRITICAL_FROM_ISR())
+#define MEMPOOL_EXIT_FROM_ISR(s)     taskEXIT_CRITICAL_FROM_ISR(s)
+#else
+#define MEMPOOL_ENTER()
+#define MEMPOOL_EXIT()
+#define MEMPOOL_ENTER_FROM_ISR(s)    ((s) = 0)
+#define MEMPOOL_EXIT_FROM_ISR(s)     ((void)(s))
+#endif
+
+typedef struct mempoolBlock {
+    struct mempoolBlock *next;
+} mempoolBlock_t;
+
+typedef struct {
+    uint8_t *start;                  // 第一个块
+    uint8_t *end;                    // 最后一个块之后
+    mempoolBlock_t *freeList;
+    mempoolStats_t stats;
+} mempool_t;
+
+/* 按8字节对齐，块内可以存放double/uint64_t */
+static uint64_t g_buf32[MEMPOOL_32_COUNT * 32 / 8];
+static uint64_t g_buf64[MEMPOOL_64_COUNT * 64 / 8];
+static uint64_t g_buf256[MEMPOOL_256_COUNT * 256 / 8];
+
+static mempool_t g_pools[MEMPOOL_NUM];
+
+/**
+ * @brief  初始化一个池，把全部块串成空闲链表
+ * @param  pool: 池
+ * @param  buf: 存储空间
+ * @param  blockSize: 块字节数，2的幂且不小于指针大小
+ * @param  count: 块个数
+ * @retval 无
+ */
+static void mempoolInitPool(mempool_t *pool, void *buf, uint16_t blockSize, uint16_t count)
+{
+    uint8_t *block = (uint8_t *)buf;
+    uint16_t i;
+    
+    pool->start = block;
+    pool->end = block + (uint32_t)blockSize * count;
+    pool->freeList = NULL;
+    for (i = count; i > 0; i--)
+    {
+        mempoolBlock_t *b = (mempoolBlock_t *)(block + (uint32_t)blockSize * (i - 1));
+        
+        b->next = pool->freeList;
+        pool->freeList = b;
+    }
+    
+    pool->stats.blockSize = blockSize;
+    pool->stats.count = count;
+    pool->stats.used = 0;
+    pool->stats.peak = 0;
+    pool->stats.failCount = 0;
+}
+
+/**
+ * @brief  内存池初始化，需在第一次分配前调用(pvPortMalloc需在创建任何内核对象前)
+ * @param  无
+ * @retval 无
+ */
+void mempoolInit(void)
+{
+    mempoolInitPool(&g_pools[MEMPOOL_32], g_buf32, 32, MEMPOOL_32_COUNT);
+    mempoolInitPool(&g_pools[MEMPOOL_64], g_buf64, 64, MEMPOOL_64_COUNT);
+    mempoolInitPool(&g_pools[MEMPOOL_256], g_buf256, 256, MEMPOOL_256_COUNT);
+}
+
+/**
+ * @brief  选择能放下size的最小的池
+ * @param  size: 字节数
+ * @retval 池序号，没有足够大的块时为MEMPOOL_NUM
+ */
+static uint8_t mempoolSelect(size_t size)
+{
+    uint8_t id;
+    
+    for (id = 0; id < MEMPOOL_NUM; id++)
+    {
+        if (size <= g_pools[id].stats.blockSize)
+        {
+            break;
+        }
+    }
+    
+    return id;
+}
+
+/**
+ * @brief  从id开始依次尝试各池分配一块，调用者负责临界区
+ * @param  id: 首选的池
+ * @retval 块地址，全部用完时为NULL
+ */
+static void *mempoolTake(uint8_t id)
+{
+    mempool_t *pool;
+    mempoolBlock_t *b;
+    
+    if (id >= MEMPOOL_NUM)
+    {
+        return NULL;
+    }
+    
+    g_pools[id].stats.failCount += (g_pools[id].freeList == NULL);
+    for (; id < MEMPOOL_NUM; id++)
+    {
+        pool = &g_pools[id];
+        b = pool->freeList;
+        if (b != NULL)
+        {
+            pool->freeList = b->next;
+            pool->stats.used++;
+            if (pool->stats.used > pool->stats.peak)
+            {
+                pool->stats.peak = pool->stats.used;
+            }
+            return b;
+        }
+    }
+    
+    return NULL;
+}
+
+/**
+ * @brief  把块放回所属的池，调用者负责临界区
+ * @param  p: 块地址
+ * @retval 1: 成功  0: 不是池中的块
+ */
+static uint8_t mempoolGive(void *p)
+{
+    uint8_t *addr = (uint8_t *)p;
+    mempool_t *pool;
+    mempoolBlock_t *b;
+    uint8_t id;
+    
+    for (id = 0; id < MEMPOOL_NUM; id++)
+    {
+        pool = &g_pools[id];
+        if (addr >= pool->start && addr < pool->end)
+        {
+            if (((uint32_t)(addr - pool->start) & (pool->stats.blockSize - 1)) != 0 || pool->stats.used == 0)
+            {
+                return 0;
+            }
+            
+            b = (mempoolBlock_t *)p;
+            b->next = pool->freeList;
+            pool->freeList = b;
+            pool->stats.used--;
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  分配一块(任务中调用)
+ * @param  size: 字节数，不超过最大的块
+ * @retval 块地址(8字节对齐)，失败时为NULL
+ */
+void *mempoolAlloc(size_t size)
+{
+    uint8_t id = mempoolSelect(size);
+    void *p;
+    
+    MEMPOOL_ENTER();
+    p = mempoolTake(id);
+    MEMPOOL_EXIT();
+    
+    return p;
+}
+
+/**
+ * @brief  释放一块(任务中调用)
+ * @param  p: mempoolAlloc返回的地址
+ * @retval 1: 成功  0: 不是池中的块
+ */
+uint8_t mempoolFree(void *p)
+{
+    uint8_t ret;
+    
+    MEMPOOL_ENTER();
+    ret = mempoolGive(p);
+    MEMPOOL_EXIT();
+    
+    return ret;
+}
+
+/**
+ * @brief  分配一块(中断中调用)
+ * @param  size: 字节数，不超过最大的块
+ * @retval 块地址(8字节对齐)，失败时为NULL
+ */
+void *mempoolAllocFromISR(size_t size)
+{
+    uint8_t id = mempoolSelect(size);
+    uint32_t state;
+    void *p;
+    
+    MEMPOOL_ENTER_FROM_ISR(state);
+    p = mempoolTake(id);
+    MEMPOOL_EXIT_FROM_ISR(state);
+    
+    return p;
+}
+
+/**
+ * @brief  释放一块(中断中调用)
+ * @param  p: mempoolAlloc返回的地址
+ * @retval 1: 成功  0: 不是池中的块
+ */
+uint8_t mempoolFreeFromISR(void *p)
+{
+    uint32_t state;
+    uint8_t ret;
+    
+    MEMPOOL_ENTER_FROM_ISR(state);
+    ret = mempoolGive(p);
+    MEMPOOL_EXIT_FROM_ISR(state);
+    
+    return ret;
+}
+
+/**
+ * @brief  获取各池统计
+ * @param  stats: 输出，长度MEMPOOL_NUM
+ * @retval 无
+ */
+void mempoolGetStats(mempoolStats_t *stats)
+{
+    uint8_t id;
+    
+    MEMPOOL_ENTER();
+    for (id = 0; id < MEMPOOL_NUM; id++)
+    {
+        stats[id] = g_pools[id].stats;
+    }
+    MEMPOOL_EXIT();
+}
+
+/**
+ * @brief  把历史最多已用块数和失败次数复位为当前值
+ * @param  无
+ * @retval 无
+ */
+void mempoolResetPeak(void)
+{
+    uint8_t id;
+    
+    MEMPOOL_ENTER();
+    for (id = 0; id < MEMPOOL_NUM; id++)
+    {
+        g_pools[id].stats.peak = g_pools[id].stats.used;
+        g_pools[id].stats.failCount = 0;
+    }
+    MEMPOOL_EXIT();
+}
+
+#if MEMPOOL_PORT_MALLOC
+/**
+ * @brief  FreeRTOS内存分配接口，从内存池分配
+ * @param  xWantedSize: 字节数
+ * @retval 块地址，失败时为NULL
+ */
+void *pvPortMalloc(size_t xWantedSize)
+{
+    void *p = mempoolAlloc(xWantedSize);
+    
+#if configUSE_MALLOC_FAILED_HOOK
+    if (p == NULL)
+    {
+        extern void vApplicationMallocFailedHook(void);
+        vApplicationMallocFailedHook();
+    }
+#endif
+    
+    return p;
+}
+
+/**
+ * @brief  FreeRTOS内存释放接口
+ * @param  pv: pvPortMalloc返回的地址
+ * @retval 无
+ */
+void vPortFree(void *pv)
+{
+    if (pv != NULL)
+    {
+        mempoolFree(pv);
+    }
+}
+#endif
+
+#endif /* MEMPOOL_ENABLE */
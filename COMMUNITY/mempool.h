@@ -0,0 +1,67 @@
+﻿#ifndef __MEMPOOL_H
+#define __MEMPOOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * 固定块内存池，用于运行时缓冲区(代替heap_4)
+ *
+ * 1.MEMPOOL_NUM个池，块大小为2的幂、从小到大排列，每个池的空闲块串成单链表(链表指针存放在空闲块内)，
+ *   分配取表头、释放插回表头，都是O(1)，临界区内只有几条指令
+ * 2.mempoolAlloc选择能放下size的最小的池，该池用完时依次尝试更大的池(最多MEMPOOL_NUM次)；
+ *   mempoolFree按地址范围找到所属的池，并检查指针是否为块起始地址
+ * 3.任务中用mempoolAlloc/mempoolFree(taskENTER_CRITICAL)，中断中用FromISR版本
+ *   (taskENTER_CRITICAL_FROM_ISR)，中断优先级不能高于configMAX_SYSCALL_INTERRUPT_PRIORITY
+ * 4.每个池统计当前已用、历史最多已用和分配失败次数，用于调整MEMPOOL_xxx_COUNT
+ * 5.MEMPOOL_PORT_MALLOC为1时提供pvPortMalloc/vPortFree，FreeRTOS动态创建的对象也从池中分配；
+ *   此时需打开configSUPPORT_DYNAMIC_ALLOCATION并且不编译heap_x.c，任务栈(栈深度*4字节)
+ *   需要能放进最大的块，否则只用于队列、定时器等小对象
+ * 6.MEMPOOL_ENABLE为0(默认)时不编译内存池，也不占用各池的RAM(约2KB)；固件目前没有模块使用内存池，
+ *   有运行时缓冲区改用内存池时再打开
+ *
+ * 主机上与heap_4的最坏延迟对比见TEST/test_mempool.c(fc_test_mempool)：空闲碎片增多时heap_4的
+ * 分配/释放耗时随之增长，内存池的耗时与碎片、已分配块数无关
+ */
+
+#ifndef MEMPOOL_ENABLE
+#define MEMPOOL_ENABLE       0        // 1: 编译内存池，可在编译选项中指定
+#endif
+
+#define MEMPOOL_32_COUNT     16       // 32字节块个数
+#define MEMPOOL_64_COUNT     8        // 64字节块个数
+#define MEMPOOL_256_COUNT    4        // 256字节块个数
+
+#define MEMPOOL_PORT_MALLOC  0        // 1: 用内存池实现pvPortMalloc/vPortFree
+
+#if MEMPOOL_PORT_MALLOC && !MEMPOOL_ENABLE
+#error "MEMPOOL_PORT_MALLOC requires MEMPOOL_ENABLE"
+#endif
+
+typedef enum {
+    MEMPOOL_32 = 0,
+    MEMPOOL_64,
+    MEMPOOL_256,
+    MEMPOOL_NUM,
+} mempoolId_e;
+
+/* 单个池的统计 */
+typedef struct {
+    uint16_t blockSize;       // 块字节数
+    uint16_t count;           // 块个数
+    uint16_t used;            // 当前已用块数
+    uint16_t peak;            // 历史最多已用块数
+    uint32_t failCount;       // 分配时该池已用完的次数(含向更大的池借用成功的情况)
+} mempoolStats_t;
+
+void mempoolInit(void);
+
+void *mempoolAlloc(size_t size);
+uint8_t mempoolFree(void *p);
+void *mempoolAllocFromISR(size_t size);
+uint8_t mempoolFreeFromISR(void *p);
+
+void mempoolGetStats(mempoolStats_t *stats);
+void mempoolResetPeak(void);
+
+#endif
@@ -0,0 +1,23 @@
+﻿#ifndef __RAMFUNC_H
+#define __RAMFUNC_H
+
+/*
+ * 把函数放到SRAM中执行
+ *
+ * 1.在函数定义前加RAMFUNC，函数放入.ramfunc段；分散加载文件(USER/FlightControl.sct)把该段
+ *   与RW数据一起放在RW_IRAM1，启动时由__main从Flash复制到SRAM，Flash与SRAM之间的调用由链接器插入长跳转
+ * 2.F411的SRAM只有一块，从SRAM取指走S总线，与数据访问竞争同一块SRAM；Flash经ART加速器取指，
+ *   命中时0等待。只有分支多、超出ART 1KB指令缓存的代码放到SRAM才有收益，
+ *   是否有效以ART_Benchmark(DRIVER/ART.h)和stabilizer各阶段耗时为准
+ * 3.RAMFUNC_ENABLE为0时全部函数留在Flash；主机编译时RAMFUNC为空
+ */
+
+#define RAMFUNC_ENABLE   1
+
+#if RAMFUNC_ENABLE && defined(__arm__)
+#define RAMFUNC   __attribute__((section(".ramfunc")))
+#else
+#define RAMFUNC
+#endif
+
+#endif
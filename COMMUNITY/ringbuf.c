@@ -0,0 +1,307 @@
+﻿#include "ringbuf.h"
+#include <string.h>
+
+#if defined(__arm__)
+#include "stm32f4xx.h"
+#define RINGBUF_BARRIER()   __DMB()
+#else
+#define RINGBUF_BARRIER()   __sync_synchronize()
+#endif
+
+/**
+ * @brief  初始化环形缓冲区，需在生产者和消费者开始使用前调用
+ * @param  rb: 缓冲区
+ * @param  buf: 存储空间，至少elemSize*count字节
+ * @param  elemSize: 元素字节数
+ * @param  count: 元素个数，必须为2的幂
+ * @retval 1: 成功  0: count不是2的幂
+ */
+uint8_t ringbufInit(ringbuf_t *rb, void *buf, uint16_t elemSize, uint32_t count)
+{
+    if (!RINGBUF_IS_POW2(count) || elemSize == 0)
+    {
+        return 0;
+    }
+    
+    rb->head = 0;
+    rb->tailCache = 0;
+    rb->tail = 0;
+    rb->headCache = 0;
+    rb->buf = (uint8_t *)buf;
+    rb->mask = count - 1;
+    rb->elemSize = elemSize;
+    
+    return 1;
+}
+
+/**
+ * @brief  把n个元素复制到pos开始的位置，回绕时分两段
+ * @param  rb: 缓冲区
+ * @param  pos: 起始下标(未取余)
+ * @param  src: 数据
+ * @param  n: 元素个数
+ * @retval 无
+ */
+static void ringbufCopyIn(ringbuf_t *rb, uint32_t pos, const uint8_t *src, uint32_t n)
+{
+    uint32_t index = pos & rb->mask;
+    uint32_t first = rb->mask + 1 - index;
+    
+    if (first > n)
+    {
+        first = n;
+    }
+    
+    memcpy(rb->buf + index * rb->elemSize, src, first * rb->elemSize);
+    if (n > first)
+    {
+        memcpy(rb->buf, src + first * rb->elemSize, (n - first) * rb->elemSize);
+    }
+}
+
+/**
+ * @brief  把pos开始的n个元素复制出来，回绕时分两段
+ * @param  rb: 缓冲区
+ * @param  pos: 起始下标(未取余)
+ * @param  dst: 输出
+ * @param  n: 元素个数
+ * @retval 无
+ */
+static void ringbufCopyOut(ringbuf_t *rb, uint32_t pos, uint8_t *dst, uint32_t n)
+{
+    uint32_t index = pos & rb->mask;
+    uint32_t first = rb->mask + 1 - index;
+    
+    if (first > n)
+    {
+        first = n;
+    }
+    
+    memcpy(dst, rb->buf + index * rb->elemSize, first * rb->elemSize);
+    if (n > first)
+    {
+        memcpy(dst + first * rb->elemSize, rb->buf, (n - first) * rb->elemSize);
+    }
+}
+
+/**
+ * @brief  生产者可写入的元素数，快照不足need时重新读取tail
+ * @param  rb: 缓冲区
+ * @param  need: 需要的元素数
+ * @retval 可写入的元素数
+ */
+static uint32_t ringbufFreeCached(ringbuf_t *rb, uint32_t need)
+{
+    uint32_t head = rb->head;
+    uint32_t free = rb->mask + 1 - (head - rb->tailCache);
+    
+    if (free < need)
+    {
+        rb->tailCache = rb->tail;
+        RINGBUF_BARRIER();
+        free = rb->mask + 1 - (head - rb->tailCache);
+    }
+    
+    return free;
+}
+
+/**
+ * @brief  消费者可读取的元素数，快照不足need时重新读取head
+ * @param  rb: 缓冲区
+ * @param  need: 需要的元素数
+ * @retval 可读取的元素数
+ */
+static uint32_t ringbufCountCached(ringbuf_t *rb, uint32_t need)
+{
+    uint32_t tail = rb->tail;
+    uint32_t count = rb->headCache - tail;
+    
+    if (count < need)
+    {
+        rb->headCache = rb->head;
+        RINGBUF_BARRIER();
+        count = rb->headCache - tail;
+    }
+    
+    return count;
+}
+
+/**
+ * @brief  可写入的元素数(生产者端)
+ * @param  rb: 缓冲区
+ * @retval 元素数
+ */
+uint32_t ringbufFree(ringbuf_t *rb)
+{
+    return ringbufFreeCached(rb, rb->mask + 1);
+}
+
+/**
+ * @brief  写入一个元素
+ * @param  rb: 缓冲区
+ * @param  elem: 元素
+ * @retval 1: 成功  0: 已满
+ */
+uint8_t ringbufPush(ringbuf_t *rb, const void *elem)
+{
+    return ringbufPushBulk(rb, elem, 1) == 1;
+}
+
+/**
+ * @brief  批量写入，空间不足时写入能容纳的部分
+ * @param  rb: 缓冲区
+ * @param  elems: 元素数组
+ * @param  n: 元素个数
+ * @retval 实际写入的元素数
+ */
+uint32_t ringbufPushBulk(ringbuf_t *rb, const void *elems, uint32_t n)
+{
+    uint32_t free = ringbufFreeCached(rb, n);
+    uint32_t head = rb->head;
+    
+    if (n > free)
+    {
+        n = free;
+    }
+    if (n == 0)
+    {
+        return 0;
+    }
+    
+    ringbufCopyIn(rb, head, (const uint8_t *)elems, n);
+    
+    /* 数据写完后才对消费者可见 */
+    RINGBUF_BARRIER();
+    rb->head = head + n;
+    
+    return n;
+}
+
+/**
+ * @brief  获取可直接写入的连续空间(到缓冲区末尾为止)
+ * @param  rb: 缓冲区
+ * @param  span: 输出写入位置
+ * @retval 连续可写的元素数，写完后用ringbufCommit提交
+ */
+uint32_t ringbufWriteSpan(ringbuf_t *rb, void **span)
+{
+    uint32_t head = rb->head;
+    uint32_t index = head & rb->mask;
+    uint32_t free = ringbufFreeCached(rb, rb->mask + 1 - index);
+    
+    if (free > rb->mask + 1 - index)
+    {
+        free = rb->mask + 1 - index;
+    }
+    
+    *span = rb->buf + index * rb->elemSize;
+    return free;
+}
+
+/**
+ * @brief  提交ringbufWriteSpan中写入的元素
+ * @param  rb: 缓冲区
+ * @param  n: 元素数，不超过ringbufWriteSpan的返回值
+ * @retval 无
+ */
+void ringbufCommit(ringbuf_t *rb, uint32_t n)
+{
+    RINGBUF_BARRIER();
+    rb->head += n;
+}
+
+/**
+ * @brief  可读取的元素数(消费者端)
+ * @param  rb: 缓冲区
+ * @retval 元素数
+ */
+uint32_t ringbufCount(ringbuf_t *rb)
+{
+    return ringbufCountCached(rb, rb->mask + 1);
+}
+
+/**
+ * @brief  读取一个元素
+ * @param  rb: 缓冲区
+ * @param  elem: 输出
+ * @retval 1: 成功  0: 为空
+ */
+uint8_t ringbufPop(ringbuf_t *rb, void *elem)
+{
+    return ringbufPopBulk(rb, elem, 1) == 1;
+}
+
+/**
+ * @brief  批量读取，数据不足时读取已有的部分
+ * @param  rb: 缓冲区
+ * @param  elems: 输出数组
+ * @param  n: 最多读取的元素数
+ * @retval 实际读取的元素数
+ */
+uint32_t ringbufPopBulk(ringbuf_t *rb, void *elems, uint32_t n)
+{
+    uint32_t count = ringbufCountCached(rb, n);
+    uint32_t tail = rb->tail;
+    
+    if (n > count)
+    {
+        n = count;
+    }
+    if (n == 0)
+    {
+        return 0;
+    }
+    
+    ringbufCopyOut(rb, tail, (uint8_t *)elems, n);
+    
+    /* 数据读完后才把空间还给生产者 */
+    RINGBUF_BARRIER();
+    rb->tail = tail + n;
+    
+    return n;
+}
+
+/**
+ * @brief  获取可直接读取的连续数据(到缓冲区末尾为止)
+ * @param  rb: 缓冲区
+ * @param  span: 输出读取位置
+ * @retval 连续可读的元素数，用完后用ringbufConsume释放
+ */
+uint32_t ringbufReadSpan(ringbuf_t *rb, const void **span)
+{
+    uint32_t tail = rb->tail;
+    uint32_t index = tail & rb->mask;
+    uint32_t count = ringbufCountCached(rb, rb->mask + 1 - index);
+    
+    if (count > rb->mask + 1 - index)
+    {
+        count = rb->mask + 1 - index;
+    }
+    
+    *span = rb->buf + index * rb->elemSize;
+    return count;
+}
+
+/**
+ * @brief  释放ringbufReadSpan中读取的元素
+ * @param  rb: 缓冲区
+ * @param  n: 元素数，不超过ringbufReadSpan的返回值
+ * @retval 无
+ */
+void ringbufConsume(ringbuf_t *rb, uint32_t n)
+{
+    RINGBUF_BARRIER();
+    rb->tail += n;
+}
+
+/**
+ * @brief  丢弃全部已写入的数据(消费者端)
+ * @param  rb: 缓冲区
+ * @retval 无
+ */
+void ringbufFlush(ringbuf_t *rb)
+{
+    rb->headCache = rb->head;
+    RINGBUF_BARRIER();
+    rb->tail = rb->headCache;
+}
@@ -0,0 +1,63 @@
+﻿#ifndef __RINGBUF_H
+#define __RINGBUF_H
+
+#include <stdint.h>
+
+/*
+ * 单生产者/单消费者无锁环形缓冲区
+ *
+ * 1.元素个数为2的幂，下标自由递增、取余用掩码，head-tail即为已用元素数(可用满全部空间)
+ * 2.head只由生产者写，tail只由消费者写，双方各缓存一份对方下标的快照，只在快照显示空间不足/数据不够时
+ *   才重新读取对方的下标；两组字段在主机上按缓存行隔开，避免伪共享(Cortex-M4无数据缓存，不填充)
+ * 3.先写数据、内存屏障后再更新下标，不需要临界区，生产者和消费者可以分别在任务和中断中，
+ *   但同一端只能在一个上下文中调用
+ * 4.批量读写按环形回绕最多分两段memcpy；Span/Commit接口直接在缓冲区内读写，省去一次拷贝
+ *
+ * 生产者端：ringbufFree、ringbufPush、ringbufPushBulk、ringbufWriteSpan、ringbufCommit
+ * 消费者端：ringbufCount、ringbufPop、ringbufPopBulk、ringbufReadSpan、ringbufConsume、ringbufFlush
+ */
+
+#if defined(__arm__)
+#define RINGBUF_CACHE_LINE   8
+#else
+#define RINGBUF_CACHE_LINE   64
+#endif
+
+typedef struct {
+    /* 生产者 */
+    volatile uint32_t head;          // 下一个写入位置
+    uint32_t tailCache;              // 生产者看到的tail
+#if RINGBUF_CACHE_LINE > 8
+    uint8_t pad0[RINGBUF_CACHE_LINE - 8];
+#endif
+    /* 消费者 */
+    volatile uint32_t tail;          // 下一个读取位置
+    uint32_t headCache;              // 消费者看到的head
+#if RINGBUF_CACHE_LINE > 8
+    uint8_t pad1[RINGBUF_CACHE_LINE - 8];
+#endif
+    /* 初始化后只读 */
+    uint8_t *buf;
+    uint32_t mask;                   // 元素个数-1
+    uint16_t elemSize;               // 元素字节数
+} ringbuf_t;
+
+/* 检查缓冲区元素个数是否为2的幂，用于#if */
+#define RINGBUF_IS_POW2(n)   ((n) != 0 && ((n) & ((n) - 1)) == 0)
+
+uint8_t ringbufInit(ringbuf_t *rb, void *buf, uint16_t elemSize, uint32_t count);
+
+uint32_t ringbufFree(ringbuf_t *rb);
+uint8_t ringbufPush(ringbuf_t *rb, const void *elem);
+uint32_t ringbufPushBulk(ringbuf_t *rb, const void *elems, uint32_t n);
+uint32_t ringbufWriteSpan(ringbuf_t *rb, void **span);
+void ringbufCommit(ringbuf_t *rb, uint32_t n);
+
+uint32_t ringbufCount(ringbuf_t *rb);
+uint8_t ringbufPop(ringbuf_t *rb, void *elem);
+uint32_t ringbufPopBulk(ringbuf_t *rb, void *elems, uint32_t n);
+uint32_t ringbufReadSpan(ringbuf_t *rb, const void **span);
+void ringbufConsume(ringbuf_t *rb, uint32_t n);
+void ringbufFlush(ringbuf_t *rb);
+
+#endif
@@ -0,0 +1,154 @@
+﻿/*
+ * ART.c
+ *
+ * Flash ART加速器配置检查实现
+ *
+ * 2026-02-27
+ */
+
+#include "ART.h"
+#include "DWT.h"
+#include "ramfunc.h"
+
+#define ART_ACR_ENABLE_MASK      (FLASH_ACR_PRFTEN | FLASH_ACR_ICEN | FLASH_ACR_DCEN)
+
+#define ART_BENCH_STAGES         8           // 基准测试二阶节级数
+#define ART_BENCH_SAMPLES        256         // 基准测试样本数
+
+static ART_Status_t g_status;
+
+/**
+ * @brief  复位并打开指令/数据缓存与预取，缓存只能在关闭时复位
+ * @param  无
+ * @retval 无
+ */
+static void ART_Enable(void)
+{
+    FLASH->ACR &= ~ART_ACR_ENABLE_MASK;
+    FLASH->ACR |= FLASH_ACR_ICRST | FLASH_ACR_DCRST;
+    FLASH->ACR &= ~(FLASH_ACR_ICRST | FLASH_ACR_DCRST);
+    FLASH->ACR |= ART_ACR_ENABLE_MASK;
+}
+
+/**
+ * @brief  检查并改正FLASH_ACR，需在main开始时调用
+ * @param  无
+ * @retval 1: 配置正确  0: 有配置被改正
+ */
+uint8_t ART_Init(void)
+{
+    uint32_t acr = FLASH->ACR;
+    uint32_t mhz = SystemCoreClock / 1000000;
+    
+    g_status.acrBefore = acr;
+    g_status.requiredLatency = (uint8_t)((mhz - 1) / ART_MHZ_PER_WAIT_STATE);
+    g_status.corrected = 0;
+    
+    /* 先增加等待周期，任何主频下增加都是安全的 */
+    if ((acr & FLASH_ACR_LATENCY) < g_status.requiredLatency)
+    {
+        FLASH->ACR = (acr & ~FLASH_ACR_LATENCY) | g_status.requiredLatency;
+        while ((FLASH->ACR & FLASH_ACR_LATENCY) != g_status.requiredLatency)
+        {
+        }
+        g_status.corrected = 1;
+    }
+    
+    if ((acr & ART_ACR_ENABLE_MASK) != ART_ACR_ENABLE_MASK)
+    {
+        ART_Enable();
+        g_status.corrected = 1;
+    }
+    
+    g_status.acrAfter = FLASH->ACR;
+    
+    return !g_status.corrected;
+}
+
+/**
+ * @brief  获取检查结果
+ * @param  status: 输出
+ * @retval 无
+ */
+void ART_GetStatus(ART_Status_t *status)
+{
+    *status = g_status;
+}
+
+/*
+ * 基准测试计算：ART_BENCH_STAGES级二阶节级联，模拟陀螺仪滤波
+ * 同一段代码分别生成Flash和SRAM两份
+ */
+#define ART_BENCH_KERNEL(name, attr)                                            \
+attr static float name(const float *c, float *s, float x)                        \
+{                                                                              \
+    uint16_t n;                                                                \
+    uint8_t stage;                                                             \
+    float y = 0.0f;                                                            \
+                                                                               \
+    for (n = 0; n < ART_BENCH_SAMPLES; n++)                                    \
+    {                                                                          \
+        y = x;                                                                 \
+        for (stage = 0; stage < ART_BENCH_STAGES; stage++)                     \
+        {                                                                      \
+            float out = c[0] * y + s[stage * 2];                               \
+            s[stage * 2] = c[1] * y + c[3] * out + s[stage * 2 + 1];           \
+            s[stage * 2 + 1] = c[2] * y + c[4] * out;                          \
+            y = out;                                                           \
+        }                                                                      \
+        x = -x;                                                                \
+    }                                                                          \
+                                                                               \
+    return y;                                                                  \
+}
+
+ART_BENCH_KERNEL(ART_BenchFlash, )
+ART_BENCH_KERNEL(ART_BenchSram, RAMFUNC)
+
+/**
+ * @brief  运行一次计算并返回耗时
+ * @param  kernel: 计算函数
+ * @retval 耗时 (周期)
+ */
+static uint32_t ART_BenchRun(float (*kernel)(const float *, float *, float))
+{
+    static const float coeffs[5] = {0.2f, 0.4f, 0.2f, 0.6f, -0.2f};
+    float state[ART_BENCH_STAGES * 2] = {0.0f};
+    volatile float sink;
+    uint32_t start;
+    
+    kernel(coeffs, state, 1.0f);         // 预热缓存
+    start = DWT_GetCycles();
+    sink = kernel(coeffs, state, 1.0f);
+    (void)sink;
+    
+    return DWT_GetCycles() - start;
+}
+
+/**
+ * @brief  比较同一段计算从Flash(ART开/关)与SRAM执行的耗时，需在启动调度器前调用
+ * @param  bench: 输出
+ * @retval 无
+ * @note   RAMFUNC_ENABLE为0时sram一项实际也从Flash执行
+ */
+void ART_Benchmark(ART_Bench_t *bench)
+{
+    uint32_t acr = FLASH->ACR;
+    
+    DWT_Init();
+    
+    bench->flashArt = ART_BenchRun(ART_BenchFlash);
+    
+    FLASH->ACR = acr & ~ART_ACR_ENABLE_MASK;
+    bench->flashNoArt = ART_BenchRun(ART_BenchFlash);
+    if ((acr & ART_ACR_ENABLE_MASK) == ART_ACR_ENABLE_MASK)
+    {
+        ART_Enable();
+    }
+    else
+    {
+        FLASH->ACR = acr;
+    }
+    
+    bench->sram = ART_BenchRun(ART_BenchSram);
+}
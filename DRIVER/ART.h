@@ -0,0 +1,42 @@
+﻿/*
+ * ART.h
+ *
+ * Flash ART加速器配置检查头文件
+ * 启动时检查FLASH_ACR：预取、指令缓存、数据缓存是否打开，等待周期是否满足当前主频，
+ * 不满足时改正并记录改正前的值
+ *
+ * STM32F411(VDD 2.7~3.6V)每30MHz需要1个等待周期，100MHz需要3WS；
+ * 标准库system_stm32f4xx.c在100MHz下只配置了2WS，由ART_Init补为3WS
+ *
+ * 2026-02-27
+ */
+
+#ifndef ART_H
+#define ART_H
+
+#include "stm32f4xx.h"
+
+#define ART_MHZ_PER_WAIT_STATE   30          // VDD 2.7~3.6V时每个等待周期对应的主频 (MHz)
+#define ART_BENCHMARK            0           // 1: 启动时运行ART_Benchmark，结果存于g_artBench
+
+/* 检查结果 */
+typedef struct {
+    uint32_t acrBefore;              // 检查前的FLASH_ACR
+    uint32_t acrAfter;               // 改正后的FLASH_ACR
+    uint8_t requiredLatency;         // 当前主频需要的等待周期
+    uint8_t corrected;               // 1: 有配置被改正
+} ART_Status_t;
+
+/* 同一段计算分别在三种条件下的耗时 (周期) */
+typedef struct {
+    uint32_t flashArt;               // 从Flash执行，ART打开
+    uint32_t flashNoArt;             // 从Flash执行，预取与缓存关闭
+    uint32_t sram;                   // 从SRAM执行(RAMFUNC)
+} ART_Bench_t;
+
+/* 函数声明 */
+uint8_t ART_Init(void);
+void ART_GetStatus(ART_Status_t *status);
+void ART_Benchmark(ART_Bench_t *bench);
+
+#endif /* ART_H */
@@ -7,6 +7,7 @@
  * 2026-02-15
  */
 
+#include <math.h>
 #include "BMP280.h"
 
 /* 全局变量 */
@@ -43,7 +44,7 @@ uint8_t BMP280_Init(void)
     I2C2_WriteByte(BMP280_ADDR, BMP280_CTRL_MEAS_REG, 0x73);  // 温度和气压过采样8次/秒
     
     /* 配置配置寄存器 */
-    I2C2_WriteByte(BMP280_ADDR, BMP280_CONFIG_REG, 0xA0);  //  standby时间=1000ms，滤波器系数=4
+    I2C2_WriteByte(BMP280_ADDR, BMP280_CONFIG_REG, 0x08);  //  standby时间=0.5ms，滤波器系数=4，约35Hz输出供高度融合
     
     return 1;
 }
@@ -95,6 +96,16 @@ void BMP280_ReadCalibData(void)
     g_calibData.dig_P9 = (I2C2_ReadByte(BMP280_ADDR, BMP280_DIG_P9_MSB_REG) << 8) | I2C2_ReadByte(BMP280_ADDR, BMP280_DIG_P9_LSB_REG);
 }
 
+/**
+ * @brief  获取BMP280_ReadCalibData读到的校准数据
+ * @param  calib: 校准数据结构指针
+ * @retval 无
+ */
+void BMP280_GetCalibData(BMP280_CalibData_t *calib)
+{
+    *calib = g_calibData;
+}
+
 /**
  * @brief  读取BMP280原始数据
  * @param  data: 原始数据结构指针
@@ -173,7 +184,7 @@ static float BMP280_CalculateAltitude(float pressure)
     float altitude;
     
     /* 使用气压计算海拔高度 */
-    altitude = 44330.0f * (1.0f - pow(pressure * 100.0f / BMP280_PRESSURE_SEA_LEVEL, 1.0f / 5.255f));
+    altitude = 44330.0f * (1.0f - powf(pressure * 100.0f / BMP280_PRESSURE_SEA_LEVEL, 1.0f / 5.255f));
     
     return altitude;
 }
@@ -190,11 +201,22 @@ void BMP280_ReadData(BMP280_Data_t *data)
     /* 读取原始数据 */
     BMP280_ReadRawData(&rawData);
     
-    /* 计算温度 */
-    data->temp = BMP280_CalculateTemperature(rawData.temp);
+    BMP280_ConvertData(&rawData, data);
+}
+
+/**
+ * @brief  原始数据转换为温度、气压与海拔高度
+ * @param  rawData: 原始数据结构指针
+ * @param  data: 处理后的数据结构指针
+ * @retval 无
+ */
+void BMP280_ConvertData(const BMP280_RawData_t *rawData, BMP280_Data_t *data)
+{
+    /* 计算温度(同时得到气压补偿用的t_fine) */
+    data->temp = BMP280_CalculateTemperature(rawData->temp);
     
     /* 计算气压 */
-    data->press = BMP280_CalculatePressure(rawData.press);
+    data->press = BMP280_CalculatePressure(rawData->press);
     
     /* 计算海拔高度 */
     data->altitude = BMP280_CalculateAltitude(data->press);
@@ -84,7 +84,10 @@ typedef struct {
 /* 函数声明 */
 uint8_t BMP280_Init(void);
 uint8_t BMP280_Check(void);
+void BMP280_ReadCalibData(void);
 void BMP280_ReadRawData(BMP280_RawData_t *data);
 void BMP280_ReadData(BMP280_Data_t *data);
+void BMP280_ConvertData(const BMP280_RawData_t *rawData, BMP280_Data_t *data);
+void BMP280_GetCalibData(BMP280_CalibData_t *calib);
 
 #endif /* BMP280_H */
@@ -0,0 +1,114 @@
+﻿/*
+ * CRC16.c
+ *
+ * CRC-16/CCITT校验实现
+ * 用于ATKP数据包校验
+ *
+ * 说明：STM32F411的硬件CRC单元只支持固定多项式的CRC-32，
+ * 无法计算CRC-16/CCITT，因此这里只提供软件实现
+ *
+ * 2026-02-16
+ */
+
+#include "CRC16.h"
+
+#define CRC16_POLY          0x1021
+
+#if CRC16_IMPL == CRC16_IMPL_NIBBLE
+
+/* 4位查表：g_crcNibble[i] = i * 0x1021 (GF(2)) */
+static const uint16_t g_crcNibble[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+#elif CRC16_IMPL == CRC16_IMPL_SLICE4
+
+/* 切片表：g_crcSlice[k][i]为字节i后跟k个0字节的CRC */
+static uint16_t g_crcSlice[4][256];
+
+#else
+#error "CRC16_IMPL配置错误"
+#endif
+
+/**
+ * @brief  CRC16初始化(SLICE4实现生成查表)
+ * @param  无
+ * @retval 无
+ */
+void CRC16_Init(void)
+{
+#if CRC16_IMPL == CRC16_IMPL_SLICE4
+    uint16_t i;
+    uint16_t crc;
+    uint8_t bit, k;
+    
+    for (i = 0; i < 256; i++)
+    {
+        crc = (uint16_t)(i << 8);
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ CRC16_POLY) : (uint16_t)(crc << 1);
+        }
+        g_crcSlice[0][i] = crc;
+    }
+    
+    for (k = 1; k < 4; k++)
+    {
+        for (i = 0; i < 256; i++)
+        {
+            crc = g_crcSlice[k - 1][i];
+            g_crcSlice[k][i] = (uint16_t)((crc << 8) ^ g_crcSlice[0][crc >> 8]);
+        }
+    }
+#endif
+}
+
+/**
+ * @brief  在已有CRC基础上继续计算
+ * @param  crc: 当前CRC值
+ * @param  data: 数据指针
+ * @param  length: 数据长度
+ * @retval 新的CRC值
+ */
+uint16_t CRC16_Update(uint16_t crc, const uint8_t *data, uint16_t length)
+{
+#if CRC16_IMPL == CRC16_IMPL_NIBBLE
+    while (length--)
+    {
+        crc = (uint16_t)((crc << 4) ^ g_crcNibble[(crc >> 12) ^ (*data >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ g_crcNibble[(crc >> 12) ^ (*data & 0x0F)]);
+        data++;
+    }
+#else
+    /* 每次处理4字节 */
+    while (length >= 4)
+    {
+        crc = g_crcSlice[3][data[0] ^ (crc >> 8)]
+            ^ g_crcSlice[2][data[1] ^ (crc & 0xFF)]
+            ^ g_crcSlice[1][data[2]]
+            ^ g_crcSlice[0][data[3]];
+        data += 4;
+        length -= 4;
+    }
+    
+    /* 剩余字节逐字节处理 */
+    while (length--)
+    {
+        crc = (uint16_t)((crc << 8) ^ g_crcSlice[0][(crc >> 8) ^ *data++]);
+    }
+#endif
+    
+    return crc;
+}
+
+/**
+ * @brief  计算数据块的CRC
+ * @param  data: 数据指针
+ * @param  length: 数据长度
+ * @retval CRC值
+ */
+uint16_t CRC16_Calculate(const uint8_t *data, uint16_t length)
+{
+    return CRC16_Update(CRC16_INIT_VALUE, data, length);
+}
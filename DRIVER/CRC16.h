@@ -0,0 +1,31 @@
+﻿/*
+ * CRC16.h
+ *
+ * CRC-16/CCITT校验头文件
+ * 多项式0x1021，初值0xFFFF，不反转，无输出异或(CRC-16/CCITT-FALSE)
+ * 两种实现的正确性检查与主机吞吐量见TEST/test_crc16.c(fc_test_crc16_nibble/fc_test_crc16_slice4)
+ *
+ * 2026-02-16
+ */
+
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+
+/* 实现选择 */
+#define CRC16_IMPL_NIBBLE   0    // 4位查表，表大小32字节，节省Flash
+#define CRC16_IMPL_SLICE4   1    // 每次处理一个字(4字节)，表大小2KB(运行时生成于RAM)
+
+#ifndef CRC16_IMPL
+#define CRC16_IMPL          CRC16_IMPL_NIBBLE
+#endif
+
+#define CRC16_INIT_VALUE    0xFFFF
+
+/* 函数声明 */
+void CRC16_Init(void);
+uint16_t CRC16_Update(uint16_t crc, const uint8_t *data, uint16_t length);
+uint16_t CRC16_Calculate(const uint8_t *data, uint16_t length);
+
+#endif /* CRC16_H */
@@ -0,0 +1,108 @@
+﻿/*
+ * DWT.c
+ *
+ * DWT周期计数器实现
+ * 用于STM32F411CEU6的高精度时间戳与耗时测量
+ *
+ * 2026-02-17
+ */
+
+#include "DWT.h"
+
+/**
+ * @brief  DWT初始化，使能周期计数器
+ * @param  无
+ * @retval 无
+ * @note   可被多个模块重复调用，已启动时不会清零计数器；主机构建时为空操作
+ */
+void DWT_Init(void)
+{
+#if defined(__arm__)
+    if (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)
+    {
+        return;
+    }
+    
+    /* 使能跟踪模块 */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    
+    /* 清零并启动周期计数器 */
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/**
+ * @brief  周期数换算为微秒
+ * @param  cycles: 周期数
+ * @retval 微秒数
+ */
+uint32_t DWT_CyclesToUs(uint32_t cycles)
+{
+    return cycles / (SystemCoreClock / 1000000);
+}
+
+/**
+ * @brief  耗时统计初始化
+ * @param  stats: 统计数据指针
+ * @param  binWidth: 直方图每个桶的宽度 (周期)
+ * @retval 无
+ */
+void DWT_StatsInit(DWT_Stats_t *stats, uint32_t binWidth)
+{
+    uint8_t i;
+    
+    stats->count = 0;
+    stats->min = 0xFFFFFFFF;
+    stats->max = 0;
+    stats->sum = 0;
+    stats->binWidth = (binWidth > 0) ? binWidth : 1;
+    
+    for (i = 0; i < DWT_STATS_BINS; i++)
+    {
+        stats->bins[i] = 0;
+    }
+}
+
+/**
+ * @brief  加入一个耗时样本
+ * @param  stats: 统计数据指针
+ * @param  cycles: 耗时 (周期)
+ * @retval 无
+ */
+void DWT_StatsAdd(DWT_Stats_t *stats, uint32_t cycles)
+{
+    uint32_t bin = cycles / stats->binWidth;
+    
+    if (bin >= DWT_STATS_BINS)
+    {
+        bin = DWT_STATS_BINS - 1;
+    }
+    stats->bins[bin]++;
+    
+    if (cycles < stats->min)
+    {
+        stats->min = cycles;
+    }
+    if (cycles > stats->max)
+    {
+        stats->max = cycles;
+    }
+    stats->sum += cycles;
+    stats->count++;
+}
+
+/**
+ * @brief  计算平均耗时
+ * @param  stats: 统计数据指针
+ * @retval 平均值 (周期)，无样本时为0
+ */
+uint32_t DWT_StatsMean(const DWT_Stats_t *stats)
+{
+    if (stats->count == 0)
+    {
+        return 0;
+    }
+    
+    return (uint32_t)(stats->sum / stats->count);
+}
@@ -0,0 +1,50 @@
+﻿/*
+ * DWT.h
+ *
+ * DWT周期计数器头文件
+ * 用于STM32F411CEU6的高精度时间戳与耗时测量
+ * 主机构建(SIL仿真/回放)时周期计数由hal_sim的虚拟时钟换算，按SystemCoreClock计数
+ *
+ * 2026-02-17
+ */
+
+#ifndef DWT_H
+#define DWT_H
+
+#if defined(__arm__)
+
+#include "stm32f4xx.h"
+
+/* 读取当前周期计数(100MHz下每10ns加1，约42.9s回绕，差值用uint32_t相减即可) */
+#define DWT_GetCycles()          (DWT->CYCCNT)
+
+#else
+
+#include "hal_sim.h"
+
+extern uint32_t SystemCoreClock;
+
+#define DWT_GetCycles()          ((uint32_t)(halSimNowNs() * (SystemCoreClock / 1000000) / 1000))
+
+#endif
+
+/* 耗时统计 */
+#define DWT_STATS_BINS           16          // 直方图桶数，最后一个桶收集超出范围的样本
+
+typedef struct {
+    uint32_t count;                  // 样本数
+    uint32_t min;                    // 最小值 (周期)
+    uint32_t max;                    // 最大值 (周期)
+    uint64_t sum;                    // 累加和 (周期)，均值 = sum / count
+    uint32_t binWidth;               // 每个桶的宽度 (周期)
+    uint32_t bins[DWT_STATS_BINS];   // 直方图
+} DWT_Stats_t;
+
+/* 函数声明 */
+void DWT_Init(void);
+uint32_t DWT_CyclesToUs(uint32_t cycles);
+void DWT_StatsInit(DWT_Stats_t *stats, uint32_t binWidth);
+void DWT_StatsAdd(DWT_Stats_t *stats, uint32_t cycles);
+uint32_t DWT_StatsMean(const DWT_Stats_t *stats);
+
+#endif /* DWT_H */
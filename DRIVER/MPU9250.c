@@ -8,6 +8,9 @@
  */
 
 #include "MPU9250.h"
+#include "hal.h"
+#include "latency.h"
+#include "ramfunc.h"
 
 /* 全局变量 */
 static MPU9250_CalibData_t g_calibData = {
@@ -19,11 +22,16 @@ static MPU9250_CalibData_t g_calibData = {
     .gyroBiasZ = 0.0f
 };
 
+static MPU9250_DataReadyCallback_t g_dataReadyCallback = 0;
+static float g_magAdjust[3] = {1.0f, 1.0f, 1.0f};  // AK8963灵敏度调整系数
+static uint8_t g_magAsa[3] = {128, 128, 128};       // AK8963出厂灵敏度调整寄存器值
+
 /* 灵敏度定义 */
 #define ACCEL_SENSITIVITY_2G     16384.0f  // 2g加速度灵敏度
 #define GYRO_SENSITIVITY_250DPS   131.0f    // 250dps陀螺仪灵敏度
 #define TEMP_SENSITIVITY         333.87f    // 温度灵敏度
 #define TEMP_OFFSET             21.0f      // 温度偏移
+#define MAG_SENSITIVITY_16BIT    0.15f     // 16位输出时磁力计灵敏度 (uT/LSB)
 
 /**
  * @brief  MPU9250初始化
@@ -45,7 +53,7 @@ uint8_t MPU9250_Init(void)
     I2C1_WriteByte(MPU9250_ADDR, MPU9250_SMPLRT_DIV_REG, 0x07);  // 采样率 = 1kHz / (7+1) = 125Hz
     
     /* 配置配置寄存器 */
-    I2C1_WriteByte(MPU9250_ADDR, MPU9250_CONFIG_REG, 0x06);  // 陀螺仪低通滤波器截止频率 = 5Hz
+    I2C1_WriteByte(MPU9250_ADDR, MPU9250_CONFIG_REG, 0x01);  // 陀螺仪低通滤波器截止频率 = 184Hz(延迟2.9ms)，其余滤波由软件完成
     
     /* 配置陀螺仪配置寄存器 */
     I2C1_WriteByte(MPU9250_ADDR, MPU9250_GYRO_CONFIG_REG, 0x00);  // 陀螺仪满量程 = ±250dps
@@ -114,13 +122,24 @@ void MPU9250_ReadData(MPU9250_Data_t *data)
     MPU9250_ReadRawData(&rawData);
     
     /* 计算处理后的数据 */
-    data->accelX = ((float)rawData.accelX / ACCEL_SENSITIVITY_2G) - g_calibData.accelBiasX;
-    data->accelY = ((float)rawData.accelY / ACCEL_SENSITIVITY_2G) - g_calibData.accelBiasY;
-    data->accelZ = ((float)rawData.accelZ / ACCEL_SENSITIVITY_2G) - g_calibData.accelBiasZ;
-    data->gyroX = ((float)rawData.gyroX / GYRO_SENSITIVITY_250DPS) - g_calibData.gyroBiasX;
-    data->gyroY = ((float)rawData.gyroY / GYRO_SENSITIVITY_250DPS) - g_calibData.gyroBiasY;
-    data->gyroZ = ((float)rawData.gyroZ / GYRO_SENSITIVITY_250DPS) - g_calibData.gyroBiasZ;
-    data->temp = ((float)rawData.temp / TEMP_SENSITIVITY) + TEMP_OFFSET;
+    MPU9250_ConvertData(&rawData, data);
+}
+
+/**
+ * @brief  原始数据转换为物理量(减去校准偏移)
+ * @param  rawData: 原始数据结构指针
+ * @param  data: 处理后的数据结构指针
+ * @retval 无
+ */
+void MPU9250_ConvertData(const MPU9250_RawData_t *rawData, MPU9250_Data_t *data)
+{
+    data->accelX = ((float)rawData->accelX / ACCEL_SENSITIVITY_2G) - g_calibData.accelBiasX;
+    data->accelY = ((float)rawData->accelY / ACCEL_SENSITIVITY_2G) - g_calibData.accelBiasY;
+    data->accelZ = ((float)rawData->accelZ / ACCEL_SENSITIVITY_2G) - g_calibData.accelBiasZ;
+    data->gyroX = ((float)rawData->gyroX / GYRO_SENSITIVITY_250DPS) - g_calibData.gyroBiasX;
+    data->gyroY = ((float)rawData->gyroY / GYRO_SENSITIVITY_250DPS) - g_calibData.gyroBiasY;
+    data->gyroZ = ((float)rawData->gyroZ / GYRO_SENSITIVITY_250DPS) - g_calibData.gyroBiasZ;
+    data->temp = ((float)rawData->temp / TEMP_SENSITIVITY) + TEMP_OFFSET;
 }
 
 /**
@@ -173,3 +192,169 @@ void MPU9250_Calibrate(MPU9250_CalibData_t *calibData)
     /* 更新全局校准数据 */
     g_calibData = *calibData;
 }
+
+/**
+ * @brief  设置采样率
+ * @param  rateHz: 采样率 (Hz)，数字低通滤波器开启时内部采样率为1kHz，最高1000Hz
+ * @retval 无
+ */
+void MPU9250_SetSampleRate(uint16_t rateHz)
+{
+    uint16_t div;
+    
+    if (rateHz == 0 || rateHz > 1000)
+    {
+        rateHz = 1000;
+    }
+    
+    /* 采样率 = 1kHz / (SMPLRT_DIV + 1) */
+    div = 1000 / rateHz - 1;
+    if (div > 0xFF)
+    {
+        div = 0xFF;
+    }
+    
+    I2C1_WriteByte(MPU9250_ADDR, MPU9250_SMPLRT_DIV_REG, (uint8_t)div);
+}
+
+/**
+ * @brief  AK8963磁力计初始化
+ * @param  无
+ * @retval 初始化结果1-成功0-失败
+ */
+uint8_t MPU9250_MagInit(void)
+{
+    uint8_t asa[3];
+    uint8_t i;
+    
+    /* 打开旁路，I2C1可直接访问AK8963 */
+    I2C1_WriteByte(MPU9250_ADDR, MPU9250_INT_PIN_CFG_REG, 0x02);
+    
+    if (I2C1_ReadByte(AK8963_ADDR, AK8963_WIA_REG) != AK8963_WIA_VAL)
+    {
+        return 0;
+    }
+    
+    /* 读取出厂灵敏度调整值 */
+    I2C1_WriteByte(AK8963_ADDR, AK8963_CNTL1_REG, 0x0F);  // Fuse ROM访问模式
+    for (volatile uint32_t j = 0; j < 10000; j++);
+    I2C1_ReadBytes(AK8963_ADDR, AK8963_ASAX_REG, asa, 3);
+    for (i = 0; i < 3; i++)
+    {
+        g_magAsa[i] = asa[i];
+        g_magAdjust[i] = ((float)asa[i] - 128.0f) / 256.0f + 1.0f;
+    }
+    
+    I2C1_WriteByte(AK8963_ADDR, AK8963_CNTL1_REG, 0x00);  // 掉电
+    for (volatile uint32_t j = 0; j < 10000; j++);
+    I2C1_WriteByte(AK8963_ADDR, AK8963_CNTL1_REG, 0x16);  // 16位输出，连续测量模式2(100Hz)
+    
+    return 1;
+}
+
+/**
+ * @brief  读取磁力计数据
+ * @param  data: 磁力计数据结构指针
+ * @retval 1-读到新数据，0-无新数据或磁场溢出
+ */
+uint8_t MPU9250_ReadMag(MPU9250_MagData_t *data)
+{
+    MPU9250_MagRawData_t rawData;
+    
+    MPU9250_ReadMagRaw(&rawData);
+    
+    return MPU9250_ConvertMag(&rawData, data);
+}
+
+/**
+ * @brief  读取磁力计原始数据(无论是否有新数据都读出ST1~ST2)
+ * @param  data: 磁力计原始数据结构指针
+ * @retval 无
+ */
+void MPU9250_ReadMagRaw(MPU9250_MagRawData_t *data)
+{
+    uint8_t buffer[8];
+    
+    /* ST1、6字节数据与ST2一次读出，读ST2后AK8963才会更新下一组数据 */
+    I2C1_ReadBytes(AK8963_ADDR, AK8963_ST1_REG, buffer, 8);
+    
+    /* AK8963为小端 */
+    data->st1 = buffer[0];
+    data->magX = (int16_t)((buffer[2] << 8) | buffer[1]);
+    data->magY = (int16_t)((buffer[4] << 8) | buffer[3]);
+    data->magZ = (int16_t)((buffer[6] << 8) | buffer[5]);
+    data->st2 = buffer[7];
+}
+
+/**
+ * @brief  磁力计原始数据转换为物理量
+ * @param  rawData: 磁力计原始数据结构指针
+ * @param  data: 磁力计数据结构指针
+ * @retval 1-有效的新数据，0-无新数据或磁场溢出(data不变)
+ */
+uint8_t MPU9250_ConvertMag(const MPU9250_MagRawData_t *rawData, MPU9250_MagData_t *data)
+{
+    if (!(rawData->st1 & 0x01) || (rawData->st2 & 0x08))
+    {
+        return 0;
+    }
+    
+    /* AK8963的X/Y与加速度计互换，Z轴相反 */
+    data->magX = (float)rawData->magY * g_magAdjust[1] * MAG_SENSITIVITY_16BIT;
+    data->magY = (float)rawData->magX * g_magAdjust[0] * MAG_SENSITIVITY_16BIT;
+    data->magZ = -(float)rawData->magZ * g_magAdjust[2] * MAG_SENSITIVITY_16BIT;
+    
+    return 1;
+}
+
+/**
+ * @brief  读取AK8963出厂灵敏度调整寄存器值(MPU9250_MagInit之后有效)
+ * @param  asa: 输出3字节，依次为ASAX、ASAY、ASAZ
+ * @retval 无
+ */
+void MPU9250_GetMagAsa(uint8_t *asa)
+{
+    asa[0] = g_magAsa[0];
+    asa[1] = g_magAsa[1];
+    asa[2] = g_magAsa[2];
+}
+
+/**
+ * @brief  使能数据就绪中断
+ * @param  callback: 数据就绪时在中断中调用的函数
+ * @retval 无
+ */
+void MPU9250_EnableDataReady(MPU9250_DataReadyCallback_t callback)
+{
+    g_dataReadyCallback = callback;
+    
+    /* 配置INT引脚上升沿触发外部中断 */
+    halExtiInit(HAL_EXTI_MPU_INT, MPU9250_INT_PRIORITY);
+    
+    /* INT高电平有效、推挽、50us脉冲，任意读操作清除中断状态，保留旁路以访问AK8963 */
+    I2C1_WriteByte(MPU9250_ADDR, MPU9250_INT_PIN_CFG_REG, 0x12);
+    
+    /* 使能原始数据就绪中断 */
+    I2C1_WriteByte(MPU9250_ADDR, MPU9250_INT_ENABLE_REG, 0x01);
+}
+
+/**
+ * @brief  MPU9250数据就绪中断处理函数
+ * @param  无
+ * @retval 无
+ */
+RAMFUNC void MPU9250_INT_IRQHandler(void)
+{
+    LATENCY_ISR_ENTRY(LATENCY_SRC_MPU_DRDY);
+    
+    if (halExtiPending(HAL_EXTI_MPU_INT))
+    {
+        halExtiClear(HAL_EXTI_MPU_INT);
+        
+        if (g_dataReadyCallback)
+        {
+            LATENCY_ISR_SIGNAL(LATENCY_SRC_MPU_DRDY);
+            g_dataReadyCallback();
+        }
+    }
+}
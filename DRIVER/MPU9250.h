@@ -36,9 +36,25 @@
 #define MPU9250_GYRO_YOUT_L_REG   0x46        // 陀螺仪Y轴低位
 #define MPU9250_GYRO_ZOUT_H_REG   0x47        // 陀螺仪Z轴高位
 #define MPU9250_GYRO_ZOUT_L_REG   0x48        // 陀螺仪Z轴低位
+#define MPU9250_INT_PIN_CFG_REG   0x37        // 中断引脚配置(bit1=BYPASS_EN，旁路访问AK8963)
+#define MPU9250_INT_ENABLE_REG    0x38        // 中断使能
 #define MPU9250_PWR_MGMT_1_REG    0x6B        // 电源管理1
 #define MPU9250_PWR_MGMT_2_REG    0x6C        // 电源管理2
 
+/* AK8963磁力计(通过MPU9250旁路挂在I2C1上) */
+#define AK8963_ADDR               0x18        // AK8963 I2C地址
+#define AK8963_WIA_REG            0x00        // WHO_AM_I寄存器地址
+#define AK8963_WIA_VAL            0x48        // WHO_AM_I值
+#define AK8963_ST1_REG            0x02        // 状态1(bit0=DRDY)
+#define AK8963_HXL_REG            0x03        // 磁场X轴低位
+#define AK8963_ST2_REG            0x09        // 状态2(bit3=HOFL溢出)
+#define AK8963_CNTL1_REG          0x0A        // 控制1
+#define AK8963_ASAX_REG           0x10        // X轴灵敏度调整值
+
+/* 数据就绪中断(MPU9250 INT)，引脚分配见hal_stm32.c中的HAL_EXTI_MPU_INT */
+#define MPU9250_INT_PRIORITY      5           // 中断抢占优先级，需不高于configMAX_SYSCALL_INTERRUPT_PRIORITY
+#define MPU9250_INT_IRQHandler    EXTI4_IRQHandler
+
 /* 数据结构 */
 typedef struct {
     int16_t accelX;  // 加速度X轴原始值
@@ -60,6 +76,20 @@ typedef struct {
     float temp;    // 温度 (°C)
 } MPU9250_Data_t;
 
+typedef struct {
+    float magX;    // 磁场X轴 (uT，已转换到加速度计/陀螺仪坐标系)
+    float magY;    // 磁场Y轴 (uT)
+    float magZ;    // 磁场Z轴 (uT)
+} MPU9250_MagData_t;
+
+typedef struct {
+    uint8_t st1;     // 状态1(bit0=DRDY)
+    int16_t magX;    // 磁场X轴原始值(AK8963坐标系)
+    int16_t magY;    // 磁场Y轴原始值
+    int16_t magZ;    // 磁场Z轴原始值
+    uint8_t st2;     // 状态2(bit3=HOFL溢出)
+} MPU9250_MagRawData_t;
+
 typedef struct {
     float accelBiasX;  // 加速度X轴偏移
     float accelBiasY;  // 加速度Y轴偏移
@@ -69,11 +99,22 @@ typedef struct {
     float gyroBiasZ;   // 陀螺仪Z轴偏移
 } MPU9250_CalibData_t;
 
+/* 数据就绪回调(在中断中调用) */
+typedef void (*MPU9250_DataReadyCallback_t)(void);
+
 /* 函数声明 */
 uint8_t MPU9250_Init(void);
 uint8_t MPU9250_Check(void);
 void MPU9250_ReadRawData(MPU9250_RawData_t *data);
 void MPU9250_ReadData(MPU9250_Data_t *data);
+void MPU9250_ConvertData(const MPU9250_RawData_t *rawData, MPU9250_Data_t *data);
 void MPU9250_Calibrate(MPU9250_CalibData_t *calibData);
+void MPU9250_SetSampleRate(uint16_t rateHz);
+uint8_t MPU9250_MagInit(void);
+uint8_t MPU9250_ReadMag(MPU9250_MagData_t *data);
+void MPU9250_ReadMagRaw(MPU9250_MagRawData_t *data);
+uint8_t MPU9250_ConvertMag(const MPU9250_MagRawData_t *rawData, MPU9250_MagData_t *data);
+void MPU9250_GetMagAsa(uint8_t *asa);
+void MPU9250_EnableDataReady(MPU9250_DataReadyCallback_t callback);
 
 #endif /* MPU9250_H */
@@ -3,6 +3,7 @@
  *
  * PWM驱动头文件
  * 用于STM32F411CEU6的PWM电机控制
+ * 定时器通道与引脚分配见hal_stm32.c
  *
  * 2026-02-15
  */
@@ -10,7 +11,7 @@
 #ifndef PWM_H
 #define PWM_H
 
-#include "stm32f4xx.h"
+#include <stdint.h>
 
 /* 电机定义 */
 #define MOTOR1  0
@@ -27,6 +28,7 @@
 /* 函数声明 */
 void PWM_Init(void);
 void PWM_SetDuty(uint8_t motor, uint16_t duty);
+void PWM_SetAllDuty(const uint16_t *duty);
 void PWM_Start(void);
 void PWM_Stop(void);
 
@@ -8,155 +8,106 @@
  */
 
 #include "UART2.h"
+#include "hal.h"
+#include "ringbuf.h"
+#include "latency.h"
+#include "ramfunc.h"
+#include <string.h>
 
-/* 全局变量 */
-static uint8_t g_txBuffer[UART2_TX_BUFFER_SIZE];
-static uint8_t g_rxBuffer[UART2_RX_BUFFER_SIZE];
-static volatile uint16_t g_txIndex = 0;
-static volatile uint16_t g_rxIndex = 0;
-static volatile uint8_t g_rxFlag = 0;
+#if !RINGBUF_IS_POW2(UART2_TX_BUFFER_SIZE) || !RINGBUF_IS_POW2(UART2_RX_BUFFER_SIZE)
+#error "UART2收发缓冲区大小必须为2的幂"
+#endif
 
-/* 函数原型 */
-static void UART2_GPIO_Config(void);
-static void UART2_Config(void);
-static void UART2_NVIC_Config(void);
-static uint8_t CalculateChecksum(uint8_t *data, uint16_t length);
+#define UART2_FRAME_SIZE       (UART2_MAX_DATA_SIZE + 5)   // 帧头3字节 + 数据 + CRC2字节
+#define UART2_TX_WAKE_FREE     UART2_FRAME_SIZE            // 发送等待时，空闲空间达到一帧后唤醒
 
-/**
- * @brief  UART2初始化
- * @param  无
- * @retval 无
- */
-void UART2_Init(void)
-{
-    UART2_GPIO_Config();
-    UART2_Config();
-    UART2_NVIC_Config();
-}
+#if UART2_TX_WAKE_FREE > UART2_TX_BUFFER_SIZE
+#error "UART2发送缓冲区必须能放下一个完整的帧"
+#endif
 
-/**
- * @brief  GPIO配置
- * @param  无
- * @retval 无
- */
-static void UART2_GPIO_Config(void)
-{
-    GPIO_InitTypeDef GPIO_InitStructure;
-    
-    /* 使能GPIOA和USART2的时钟 */
-    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOA, ENABLE);
-    RCC_APB1PeriphClockCmd(RCC_APB1Periph_USART2, ENABLE);
-    
-    /* 配置PA2为USART2_TX */
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_2;
-    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF;
-    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
-    GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
-    GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP;
-    GPIO_Init(GPIOA, &GPIO_InitStructure);
-    
-    /* 配置PA3为USART2_RX */
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_3;
-    GPIO_Init(GPIOA, &GPIO_InitStructure);
-    
-    /* 将PA2和PA3复用为USART2 */
-    GPIO_PinAFConfig(GPIOA, GPIO_PinSource2, GPIO_AF_USART2);
-    GPIO_PinAFConfig(GPIOA, GPIO_PinSource3, GPIO_AF_USART2);
-}
+/* 接收状态机 */
+typedef enum {
+    RX_WAIT_START,
+    RX_WAIT_TYPE,
+    RX_WAIT_LENGTH,
+    RX_WAIT_DATA,
+    RX_WAIT_CRC1,
+    RX_WAIT_CRC2
+} RxState_t;
 
-/**
- * @brief  USART2配置
- * @param  无
- * @retval 无
+/* 全局变量
+ * 发送：任务写入g_txRing，TXE中断逐字节取出发送
+ * 接收：中断在g_rxFrame中拼帧，完整的帧整帧写入g_rxRing，任务按帧取出并校验CRC
  */
-static void UART2_Config(void)
-{
-    USART_InitTypeDef USART_InitStructure;
-    
-    /* 配置USART2参数 */
-    USART_InitStructure.USART_BaudRate = UART2_BAUDRATE;
-    USART_InitStructure.USART_WordLength = USART_WordLength_8b;
-    USART_InitStructure.USART_StopBits = USART_StopBits_1;
-    USART_InitStructure.USART_Parity = USART_Parity_No;
-    USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
-    USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
-    
-    /* 初始化USART2 */
-    USART_Init(USART2, &USART_InitStructure);
-    
-    /* 使能USART2接收中断 */
-    USART_ITConfig(USART2, USART_IT_RXNE, ENABLE);
-    
-    /* 使能USART2 */
-    USART_Cmd(USART2, ENABLE);
-}
+static uint8_t g_txBuffer[UART2_TX_BUFFER_SIZE];
+static uint8_t g_rxBuffer[UART2_RX_BUFFER_SIZE];
+static ringbuf_t g_txRing;
+static ringbuf_t g_rxRing;
+static uint8_t g_rxFrame[UART2_FRAME_SIZE];
+static uint16_t g_rxIndex = 0;
+static RxState_t g_rxState = RX_WAIT_START;
+static uint8_t g_rxDiscarding = 0;
+static volatile UART2_RxStats_t g_rxStats;
+static UART2_RxCallback_t g_rxCallback = 0;
+static UART2_TxWait_t g_txWait = 0;
+static UART2_TxWake_t g_txWake = 0;
+static volatile uint8_t g_txWaiting = 0;    // 发送任务在g_txWait中等待空间
 
 /**
- * @brief  NVIC配置
+ * @brief  UART2初始化
  * @param  无
  * @retval 无
  */
-static void UART2_NVIC_Config(void)
+void UART2_Init(void)
 {
-    NVIC_InitTypeDef NVIC_InitStructure;
-    
-    /* 配置USART2中断 */
-    NVIC_InitStructure.NVIC_IRQChannel = USART2_IRQn;
-    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 6;  // 高优先级
-    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
-    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
-    NVIC_Init(&NVIC_InitStructure);
+    CRC16_Init();
+    ringbufInit(&g_txRing, g_txBuffer, 1, UART2_TX_BUFFER_SIZE);
+    ringbufInit(&g_rxRing, g_rxBuffer, 1, UART2_RX_BUFFER_SIZE);
+    halUsartInit(HAL_USART_2, UART2_BAUDRATE, UART2_IRQ_PRIORITY);
 }
 
 /**
- * @brief  发送单个字节
+ * @brief  发送单个字节(写入发送缓冲区)
  * @param  byte: 要发送的字节
  * @retval 无
  */
 void UART2_SendByte(uint8_t byte)
 {
-    /* 等待发送缓冲区为空 */
-    while (USART_GetFlagStatus(USART2, USART_FLAG_TXE) == RESET);
-    
-    /* 发送字节 */
-    USART_SendData(USART2, byte);
+    UART2_SendData(&byte, 1);
 }
 
 /**
- * @brief  发送数据块
+ * @brief  发送数据块(写入发送缓冲区，由TXE中断发送)
+ *         缓冲区满时调用UART2_SetTxWait设置的等待函数，阻塞到中断腾出一帧的空间；
+ *         未设置时忙等(启动调度器前)；只能在一个任务中调用
  * @param  data: 数据指针
  * @param  length: 数据长度
  * @retval 无
  */
 void UART2_SendData(uint8_t *data, uint16_t length)
 {
-    uint16_t i;
+    uint32_t n;
     
-    /* 发送数据 */
-    for (i = 0; i < length; i++)
+    while (length > 0)
     {
-        UART2_SendByte(data[i]);
-    }
-}
-
-/**
- * @brief  计算校验和
- * @param  data: 数据指针
- * @param  length: 数据长度
- * @retval 校验和
- */
-static uint8_t CalculateChecksum(uint8_t *data, uint16_t length)
-{
-    uint8_t checksum = 0;
-    uint16_t i;
-    
-    /* 计算校验和 */
-    for (i = 0; i < length; i++)
-    {
-        checksum ^= data[i];
+        n = ringbufPushBulk(&g_txRing, data, length);
+        data += n;
+        length -= n;
+        
+        /* 中断发送完缓冲区后会关闭TXE中断，写入新数据后重新打开 */
+        halUsartTxIrqEnable(HAL_USART_2, 1);
+        
+        /* 先置等待标志再检查空间：中断在两者之间腾出空间时唤醒已发出，等待函数立即返回 */
+        if (length > 0 && g_txWait)
+        {
+            g_txWaiting = 1;
+            if (ringbufFree(&g_txRing) < UART2_TX_WAKE_FREE)
+            {
+                g_txWait();
+            }
+            g_txWaiting = 0;
+        }
     }
-    
-    return checksum;
 }
 
 /**
@@ -166,11 +117,16 @@ static uint8_t CalculateChecksum(uint8_t *data, uint16_t length)
  */
 void UART2_SendPacket(Packet_t *packet)
 {
-    /* 计算校验和 */
-    packet->checksum = CalculateChecksum(&packet->type, packet->length + 2);
+    uint8_t frame[UART2_FRAME_SIZE];
     
-    /* 发送数据包 */
-    UART2_SendData((uint8_t *)packet, packet->length + 4);
+    /* 计算CRC */
+    packet->crc = CRC16_Calculate(&packet->type, packet->length + 2);
+    
+    /* 帧头与数据内容，CRC高字节在前，整帧一次写入发送缓冲区 */
+    memcpy(frame, packet, packet->length + 3);
+    frame[packet->length + 3] = (uint8_t)(packet->crc >> 8);
+    frame[packet->length + 4] = (uint8_t)(packet->crc & 0xFF);
+    UART2_SendData(frame, packet->length + 5);
 }
 
 /**
@@ -181,10 +137,10 @@ void UART2_SendPacket(Packet_t *packet)
 uint8_t UART2_ReceiveByte(void)
 {
     /* 等待接收数据 */
-    while (USART_GetFlagStatus(USART2, USART_FLAG_RXNE) == RESET);
+    while (!halUsartRxReady(HAL_USART_2));
     
     /* 读取接收的数据 */
-    return (uint8_t)USART_ReceiveData(USART2);
+    return halUsartReadByte(HAL_USART_2);
 }
 
 /**
@@ -207,44 +163,35 @@ uint16_t UART2_ReceiveData(uint8_t *buffer, uint16_t maxLength)
 }
 
 /**
- * @brief  接收数据包
+ * @brief  接收数据包(从接收缓冲区取出一帧)
  * @param  packet: 数据包指针
- * @retval 成功标志：1-成功，0-失败
+ * @retval 成功标志：1-成功，0-无数据包或CRC错误
  */
 uint8_t UART2_ReceivePacket(Packet_t *packet)
 {
-    uint8_t i;
-    uint8_t checksum;
+    uint8_t crcBytes[2];
+    uint16_t crc;
     
-    /* 等待数据包 */
-    if (!g_rxFlag)
+    /* 中断整帧写入，有数据即有完整的一帧 */
+    if (ringbufPopBulk(&g_rxRing, packet, 3) != 3)
     {
         return 0;
     }
     
-    /* 复制数据到数据包结构 */
-    packet->start = g_rxBuffer[0];
-    packet->type = g_rxBuffer[1];
-    packet->length = g_rxBuffer[2];
+    ringbufPopBulk(&g_rxRing, packet->data, packet->length);
+    ringbufPopBulk(&g_rxRing, crcBytes, 2);
+    packet->crc = (uint16_t)((crcBytes[0] << 8) | crcBytes[1]);
     
-    /* 复制数据内容 */
-    for (i = 0; i < packet->length; i++)
-    {
-        packet->data[i] = g_rxBuffer[3 + i];
-    }
+    /* 验证CRC(在任务中计算，不占用中断时间) */
+    crc = CRC16_Calculate(&packet->type, packet->length + 2);
     
-    packet->checksum = g_rxBuffer[3 + packet->length];
-    
-    /* 验证校验和 */
-    checksum = CalculateChecksum(&packet->type, packet->length + 2);
-    if (checksum != packet->checksum)
+    if (crc != packet->crc)
     {
-        g_rxFlag = 0;
+        g_rxStats.crcErrors++;
         return 0;
     }
     
-    /* 清除接收标志 */
-    g_rxFlag = 0;
+    g_rxStats.packets++;
     
     return 1;
 }
@@ -256,7 +203,39 @@ uint8_t UART2_ReceivePacket(Packet_t *packet)
  */
 uint8_t UART2_IsDataAvailable(void)
 {
-    return USART_GetFlagStatus(USART2, USART_FLAG_RXNE) == SET;
+    return halUsartRxReady(HAL_USART_2);
+}
+
+/**
+ * @brief  获取接收错误统计
+ * @param  stats: 统计数据输出指针
+ * @retval 无
+ */
+void UART2_GetRxStats(UART2_RxStats_t *stats)
+{
+    *stats = *(UART2_RxStats_t *)&g_rxStats;
+}
+
+/**
+ * @brief  设置接收完成回调
+ * @param  callback: 回调函数，在中断中收到完整数据包后调用，传0取消
+ * @retval 无
+ */
+void UART2_SetRxCallback(UART2_RxCallback_t callback)
+{
+    g_rxCallback = callback;
+}
+
+/**
+ * @brief  设置发送缓冲区满时的等待方式
+ * @param  wait: 等待函数，在发送任务中调用，收到wake的唤醒后返回(可带超时)，传0恢复忙等
+ * @param  wake: 唤醒回调，在中断中空闲空间达到一帧时调用
+ * @retval 无
+ */
+void UART2_SetTxWait(UART2_TxWait_t wait, UART2_TxWake_t wake)
+{
+    g_txWake = wake;
+    g_txWait = wait;
 }
 
 /**
@@ -264,36 +243,117 @@ uint8_t UART2_IsDataAvailable(void)
  * @param  无
  * @retval 无
  */
-void USART2_IRQHandler(void)
+RAMFUNC void USART2_IRQHandler(void)
 {
     uint8_t byte;
     
-    /* 检查是否是接收中断 */
-    if (USART_GetITStatus(USART2, USART_IT_RXNE) != RESET)
+    LATENCY_ISR_ENTRY(LATENCY_SRC_UART2_RX);
+    
+    /* 发送缓冲区空，取下一个字节，全部发完后关闭TXE中断 */
+    if (halUsartTxIrqPending(HAL_USART_2))
     {
-        /* 读取接收的数据 */
-        byte = USART_ReceiveData(USART2);
-        
-        /* 处理数据包接收 */
-        if (byte == 0xAA)  // 起始字节
+        if (ringbufPop(&g_txRing, &byte))
         {
-            g_rxIndex = 0;
+            halUsartWriteByte(HAL_USART_2, byte);
+            if (g_txWaiting && ringbufCount(&g_txRing) <= UART2_TX_BUFFER_SIZE - UART2_TX_WAKE_FREE)
+            {
+                g_txWaiting = 0;
+                if (g_txWake)
+                {
+                    g_txWake();
+                }
+            }
         }
-        
-        /* 存储数据到接收缓冲区 */
-        if (g_rxIndex < UART2_RX_BUFFER_SIZE)
+        else
         {
-            g_rxBuffer[g_rxIndex++] = byte;
+            halUsartTxIrqEnable(HAL_USART_2, 0);
         }
-        
-        /* 检查数据包是否完整 */
-        if (g_rxIndex >= 4 && g_rxBuffer[2] + 4 == g_rxIndex)
+    }
+    
+    /* 检查是否是接收中断 */
+    if (halUsartRxReady(HAL_USART_2))
+    {
+        /* 硬件溢出，读取数据寄存器后自动清除 */
+        if (halUsartRxOverrun(HAL_USART_2))
         {
-            g_rxFlag = 1;  // 数据包接收完成
+            g_rxStats.hwOverruns++;
         }
         
-        /* 清除中断标志 */
-        USART_ClearITPendingBit(USART2, USART_IT_RXNE);
+        /* 读取接收的数据 */
+        byte = halUsartReadByte(HAL_USART_2);
+        g_rxStats.bytes++;
+        
+        /* 按帧格式逐字节解析，长度字段决定帧边界 */
+        switch (g_rxState)
+        {
+            case RX_WAIT_START:
+                if (byte != UART2_PACKET_START)
+                {
+                    g_rxStats.discarded++;
+                    g_rxDiscarding = 1;
+                    break;
+                }
+                
+                if (g_rxDiscarding)
+                {
+                    g_rxStats.resyncs++;
+                    g_rxDiscarding = 0;
+                }
+                
+                g_rxFrame[0] = byte;
+                g_rxIndex = 1;
+                g_rxState = RX_WAIT_TYPE;
+                break;
+            case RX_WAIT_TYPE:
+                g_rxFrame[g_rxIndex++] = byte;
+                g_rxState = RX_WAIT_LENGTH;
+                break;
+            case RX_WAIT_LENGTH:
+                if (byte > UART2_MAX_DATA_SIZE)
+                {
+                    g_rxStats.lengthErrors++;
+                    g_rxState = RX_WAIT_START;
+                }
+                else
+                {
+                    g_rxFrame[g_rxIndex++] = byte;
+                    g_rxState = (byte == 0) ? RX_WAIT_CRC1 : RX_WAIT_DATA;
+                }
+                break;
+            case RX_WAIT_DATA:
+                g_rxFrame[g_rxIndex++] = byte;
+                if (g_rxIndex == 3 + g_rxFrame[2])
+                {
+                    g_rxState = RX_WAIT_CRC1;
+                }
+                break;
+            case RX_WAIT_CRC1:
+                g_rxFrame[g_rxIndex++] = byte;
+                g_rxState = RX_WAIT_CRC2;
+                break;
+            case RX_WAIT_CRC2:
+                g_rxFrame[g_rxIndex++] = byte;
+                g_rxState = RX_WAIT_START;
+                
+                /* 数据包接收完成，整帧写入接收缓冲区，CRC在UART2_ReceivePacket中校验 */
+                if (ringbufFree(&g_rxRing) < g_rxIndex)
+                {
+                    /* 任务来不及取走，丢弃本包 */
+                    g_rxStats.overruns++;
+                }
+                else
+                {
+                    ringbufPushBulk(&g_rxRing, g_rxFrame, g_rxIndex);
+                    if (g_rxCallback)
+                    {
+                        LATENCY_ISR_SIGNAL(LATENCY_SRC_UART2_RX);
+                        g_rxCallback();
+                    }
+                }
+                break;
+            default:
+                g_rxState = RX_WAIT_START;
+                break;
+        }
     }
 }
-
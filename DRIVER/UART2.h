@@ -10,22 +10,48 @@
 #ifndef UART2_H
 #define UART2_H
 
-#include "stm32f4xx.h"
+#include <stdint.h>
+#include "CRC16.h"
 
 /* 配置参数 */
 #define UART2_BAUDRATE         115200      // 波特率
-#define UART2_TX_BUFFER_SIZE   256         // 发送缓冲区大小
-#define UART2_RX_BUFFER_SIZE   256         // 接收缓冲区大小
+#define UART2_TX_BUFFER_SIZE   256         // 发送缓冲区大小(2的幂)
+#define UART2_RX_BUFFER_SIZE   256         // 接收缓冲区大小(2的幂，可缓存多个数据包)
+#define UART2_PACKET_START     0xAA        // 起始字节
+#define UART2_MAX_DATA_SIZE    64          // 数据包最大数据长度
+#define UART2_IRQ_PRIORITY     6           // 中断抢占优先级
 
-/* 数据包结构 */
+/* 数据包结构
+ * 帧格式：0xAA | type | length | data[length] | CRC高字节 | CRC低字节
+ * CRC-16/CCITT覆盖type、length与data
+ */
 typedef struct {
-    uint8_t start;     // 起始字节 (0xAA)
-    uint8_t type;      // 数据包类型
-    uint8_t length;    // 数据长度
-    uint8_t data[64];  // 数据内容
-    uint8_t checksum;  // 校验和
+    uint8_t start;                        // 起始字节 (0xAA)
+    uint8_t type;                         // 数据包类型
+    uint8_t length;                       // 数据长度
+    uint8_t data[UART2_MAX_DATA_SIZE];    // 数据内容
+    uint16_t crc;                         // CRC-16/CCITT
 } Packet_t;
 
+/* 接收错误统计 */
+typedef struct {
+    uint32_t bytes;         // 接收的字节数
+    uint32_t packets;       // 校验通过的数据包数
+    uint32_t crcErrors;     // CRC错误的数据包数
+    uint32_t lengthErrors;  // 长度字段超出UART2_MAX_DATA_SIZE的数据包数
+    uint32_t overruns;      // 接收缓冲区满而被丢弃的数据包数
+    uint32_t hwOverruns;    // USART硬件溢出(ORE)次数，每次丢失字节(所在数据包通常还会计入CRC或长度错误)
+    uint32_t discarded;     // 帧外被丢弃的字节数
+    uint32_t resyncs;       // 丢弃若干字节后重新找到起始字节的次数
+} UART2_RxStats_t;
+
+/* 接收完成回调(在中断中调用) */
+typedef void (*UART2_RxCallback_t)(void);
+
+/* 发送缓冲区满时的等待函数(在发送任务中调用)，阻塞到唤醒回调(在中断中调用)后返回 */
+typedef void (*UART2_TxWait_t)(void);
+typedef void (*UART2_TxWake_t)(void);
+
 /* 函数声明 */
 void UART2_Init(void);
 void UART2_SendByte(uint8_t byte);
@@ -35,5 +61,8 @@ uint8_t UART2_ReceiveByte(void);
 uint16_t UART2_ReceiveData(uint8_t *buffer, uint16_t maxLength);
 uint8_t UART2_ReceivePacket(Packet_t *packet);
 uint8_t UART2_IsDataAvailable(void);
+void UART2_GetRxStats(UART2_RxStats_t *stats);
+void UART2_SetRxCallback(UART2_RxCallback_t callback);
+void UART2_SetTxWait(UART2_TxWait_t wait, UART2_TxWake_t wake);
 
 #endif /* UART2_H */
@@ -0,0 +1,216 @@
+﻿/*
+ * W25Q.c
+ *
+ * W25Q系列SPI NOR Flash驱动实现
+ * 每条命令为一次片选内的若干次SPI传输：命令字节(与地址) + 数据
+ *
+ * 2026-03-01
+ */
+
+#include "W25Q.h"
+#include "hal.h"
+
+/* 一次SPI传输的最大长度(halSpiTransfer的length为16位) */
+#define W25Q_TRANSFER_MAX        0x8000
+
+static uint32_t g_capacity;          // 容量 (字节)，0-未检测到芯片
+
+/**
+ * @brief  执行一条命令：片选 -> 命令与地址 -> 发送或接收数据 -> 释放片选
+ * @param  cmd: 命令与地址字节
+ * @param  cmdLen: 命令与地址字节数
+ * @param  tx: 发送数据，可为0
+ * @param  rx: 接收缓冲区，可为0(tx与rx都为0时没有数据阶段)
+ * @param  length: 数据字节数
+ * @retval 1-成功，0-SPI超时
+ */
+static uint8_t W25Q_Command(const uint8_t *cmd, uint8_t cmdLen, const uint8_t *tx, uint8_t *rx, uint32_t length)
+{
+    uint16_t n;
+    uint8_t ok;
+    
+    halSpiSelect(HAL_SPI_2, 1);
+    ok = halSpiTransfer(HAL_SPI_2, cmd, 0, cmdLen);
+    while (ok && length > 0)
+    {
+        n = length > W25Q_TRANSFER_MAX ? W25Q_TRANSFER_MAX : (uint16_t)length;
+        ok = halSpiTransfer(HAL_SPI_2, tx, rx, n);
+        tx = tx ? tx + n : 0;
+        rx = rx ? rx + n : 0;
+        length -= n;
+    }
+    halSpiSelect(HAL_SPI_2, 0);
+    
+    return ok;
+}
+
+/**
+ * @brief  生成带3字节地址的命令
+ * @param  cmd: 输出，4字节
+ * @param  op: 命令字
+ * @param  addr: 地址
+ * @retval 无
+ */
+static void W25Q_AddressCommand(uint8_t *cmd, uint8_t op, uint32_t addr)
+{
+    cmd[0] = op;
+    cmd[1] = (uint8_t)(addr >> 16);
+    cmd[2] = (uint8_t)(addr >> 8);
+    cmd[3] = (uint8_t)addr;
+}
+
+/**
+ * @brief  写使能(每次编程/擦除前需要，完成后芯片自动清除WEL)
+ * @param  无
+ * @retval 1-成功，0-SPI超时
+ */
+static uint8_t W25Q_WriteEnable(void)
+{
+    uint8_t cmd = W25Q_CMD_WRITE_ENABLE;
+    
+    return W25Q_Command(&cmd, 1, 0, 0, 0);
+}
+
+/**
+ * @brief  W25Q初始化，读取JEDEC ID确定容量
+ * @param  无
+ * @retval 初始化结果1-成功0-失败(无应答或不支持的容量)
+ */
+uint8_t W25Q_Init(void)
+{
+    uint8_t id[3];
+    
+    halSpiInit(HAL_SPI_2, W25Q_SPI_CLOCK_HZ);
+    g_capacity = 0;
+    
+    if (!W25Q_ReadJedecId(id))
+    {
+        return 0;
+    }
+    
+    /* 没有芯片时MISO上拉读到0xFF；id[2]为容量的2的对数，超过16MB需要4字节地址 */
+    if (id[0] == 0x00 || id[0] == 0xFF || id[2] < 16 || (1UL << id[2]) > W25Q_MAX_CAPACITY)
+    {
+        return 0;
+    }
+    
+    g_capacity = 1UL << id[2];
+    return 1;
+}
+
+/**
+ * @brief  获取容量
+ * @param  无
+ * @retval 容量 (字节)，0-未检测到芯片
+ */
+uint32_t W25Q_GetCapacity(void)
+{
+    return g_capacity;
+}
+
+/**
+ * @brief  读取JEDEC ID
+ * @param  id: 输出制造商ID、存储类型、容量(3字节)
+ * @retval 1-成功，0-SPI超时
+ */
+uint8_t W25Q_ReadJedecId(uint8_t *id)
+{
+    uint8_t cmd = W25Q_CMD_JEDEC_ID;
+    
+    return W25Q_Command(&cmd, 1, 0, id, 3);
+}
+
+/**
+ * @brief  查询编程/擦除是否在进行中
+ * @param  无
+ * @retval 1-忙(或SPI超时)，0-空闲
+ */
+uint8_t W25Q_IsBusy(void)
+{
+    uint8_t cmd = W25Q_CMD_READ_STATUS1;
+    uint8_t status;
+    
+    if (!W25Q_Command(&cmd, 1, 0, &status, 1))
+    {
+        return 1;
+    }
+    
+    return (status & W25Q_STATUS_BUSY) != 0;
+}
+
+/**
+ * @brief  读取数据，地址自动递增，可跨页/扇区连续读取
+ * @param  addr: 起始地址
+ * @param  buffer: 输出缓冲区
+ * @param  length: 字节数
+ * @retval 1-成功，0-芯片忙、超出容量或SPI超时
+ */
+uint8_t W25Q_Read(uint32_t addr, uint8_t *buffer, uint32_t length)
+{
+    uint8_t cmd[4];
+    
+    if (addr + length > g_capacity || addr + length < addr || W25Q_IsBusy())
+    {
+        return 0;
+    }
+    
+    W25Q_AddressCommand(cmd, W25Q_CMD_READ_DATA, addr);
+    return W25Q_Command(cmd, 4, 0, buffer, length);
+}
+
+/**
+ * @brief  页编程，只发出命令不等待完成
+ * @param  addr: 起始地址
+ * @param  data: 数据
+ * @param  length: 字节数(1~256，不能跨页，超出页尾的部分会回绕到页首)
+ * @retval 1-已开始编程，0-芯片忙、跨页、超出容量或SPI超时
+ * @note   只能把1编程为0，目标区域需已擦除
+ */
+uint8_t W25Q_PageProgram(uint32_t addr, const uint8_t *data, uint16_t length)
+{
+    uint8_t cmd[4];
+    
+    if (length == 0 || (addr % W25Q_PAGE_SIZE) + length > W25Q_PAGE_SIZE || addr + length > g_capacity ||
+        W25Q_IsBusy() || !W25Q_WriteEnable())
+    {
+        return 0;
+    }
+    
+    W25Q_AddressCommand(cmd, W25Q_CMD_PAGE_PROGRAM, addr);
+    return W25Q_Command(cmd, 4, data, 0, length);
+}
+
+/**
+ * @brief  擦除4KB扇区，只发出命令不等待完成
+ * @param  addr: 扇区内任意地址
+ * @retval 1-已开始擦除，0-芯片忙、超出容量或SPI超时
+ */
+uint8_t W25Q_EraseSector(uint32_t addr)
+{
+    uint8_t cmd[4];
+    
+    if (addr >= g_capacity || W25Q_IsBusy() || !W25Q_WriteEnable())
+    {
+        return 0;
+    }
+    
+    W25Q_AddressCommand(cmd, W25Q_CMD_SECTOR_ERASE, addr - addr % W25Q_SECTOR_SIZE);
+    return W25Q_Command(cmd, 4, 0, 0, 0);
+}
+
+/**
+ * @brief  整片擦除，只发出命令不等待完成
+ * @param  无
+ * @retval 1-已开始擦除，0-未检测到芯片、芯片忙或SPI超时
+ */
+uint8_t W25Q_EraseChip(void)
+{
+    uint8_t cmd = W25Q_CMD_CHIP_ERASE;
+    
+    if (g_capacity == 0 || W25Q_IsBusy() || !W25Q_WriteEnable())
+    {
+        return 0;
+    }
+    
+    return W25Q_Command(&cmd, 1, 0, 0, 0);
+}
@@ -0,0 +1,53 @@
+﻿/*
+ * W25Q.h
+ *
+ * W25Q系列SPI NOR Flash驱动头文件
+ * 用于黑匣子存储，经硬件抽象层访问SPI2(引脚分配见hal_stm32.c)
+ *
+ * 只使用3字节地址的基本命令(容量不超过16MB，W25Q16~W25Q128)：
+ * 编程与擦除只发出命令、不等待完成，调用者用W25Q_IsBusy查询，
+ * 控制任务之外的低优先级任务可以在芯片忙时先去做其他事情
+ *
+ * 典型时间(W25Q128JV)：页编程0.7ms(最长3ms)，扇区擦除45ms(最长400ms)，整片擦除40s(最长200s)
+ *
+ * 2026-03-01
+ */
+
+#ifndef W25Q_H
+#define W25Q_H
+
+#include <stdint.h>
+
+#define W25Q_SPI_CLOCK_HZ        25000000    // SPI时钟 (Hz)，APB1 50MHz二分频
+
+/* 命令 */
+#define W25Q_CMD_WRITE_ENABLE    0x06
+#define W25Q_CMD_READ_STATUS1    0x05
+#define W25Q_CMD_READ_DATA       0x03
+#define W25Q_CMD_PAGE_PROGRAM    0x02
+#define W25Q_CMD_SECTOR_ERASE    0x20        // 4KB
+#define W25Q_CMD_CHIP_ERASE      0xC7
+#define W25Q_CMD_JEDEC_ID        0x9F
+
+/* 状态寄存器1 */
+#define W25Q_STATUS_BUSY         0x01        // 编程/擦除进行中
+#define W25Q_STATUS_WEL          0x02        // 写使能锁存
+
+/* 组织结构 */
+#define W25Q_PAGE_SIZE           256         // 编程页，一次编程不能跨页
+#define W25Q_SECTOR_SIZE         4096        // 最小擦除单位
+#define W25Q_MAX_CAPACITY        (16UL * 1024 * 1024)
+
+/* 函数声明
+ * 返回1-成功，0-芯片忙、参数错误或SPI超时
+ */
+uint8_t W25Q_Init(void);
+uint32_t W25Q_GetCapacity(void);
+uint8_t W25Q_ReadJedecId(uint8_t *id);
+uint8_t W25Q_IsBusy(void);
+uint8_t W25Q_Read(uint32_t addr, uint8_t *buffer, uint32_t length);
+uint8_t W25Q_PageProgram(uint32_t addr, const uint8_t *data, uint16_t length);
+uint8_t W25Q_EraseSector(uint32_t addr);
+uint8_t W25Q_EraseChip(void);
+
+#endif /* W25Q_H */
@@ -0,0 +1,85 @@
+﻿/*
+ * hal.h
+ *
+ * 硬件抽象层头文件
+ * 驱动通过本层访问I2C、SPI、USART、TIM(PWM)与GPIO/EXTI，不直接调用标准外设库，
+ * 引脚与外设分配集中在实现文件中：
+ *   hal_stm32.c  目标板实现(STM32F4标准外设库)
+ *   hal_sim.c    主机实现，模拟外设寄存器行为、总线时序与故障(测试接口见hal_sim.h)
+ * 两个实现二选一参与链接，驱动代码在目标板与主机上完全相同
+ *
+ * I2C按事务划分(一次完整的寄存器读/写)，每一步等待都有超时，失败时发送停止信号并返回0；
+ * SPI为查询方式的全双工字节交换，片选由驱动控制，一条命令由多次传输组成；
+ * USART/EXTI为中断服务函数中用到的标志与数据寄存器访问，中断服务函数仍在各驱动中，
+ * 目标板由向量表调用，主机由hal_sim在模拟的中断时刻调用
+ *
+ * 2026-03-01
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+
+/* I2C */
+#define HAL_I2C_TIMEOUT_US       1000        // 每一步等待的超时时间 (us)
+
+typedef enum {
+    HAL_I2C_1 = 0,               // I2C1(PB6/PB7)：MPU9250、AK8963
+    HAL_I2C_2,                   // I2C2(PB10/PB11)：BMP280
+    HAL_I2C_NUM,
+} halI2c_e;
+
+/* SPI */
+#define HAL_SPI_TIMEOUT_US       100         // 每个字节等待的超时时间 (us)
+
+typedef enum {
+    HAL_SPI_2 = 0,               // SPI2(PB13/PB14/PB15，片选PB12)：W25Q SPI NOR Flash(黑匣子)
+    HAL_SPI_NUM,
+} halSpi_e;
+
+/* USART */
+typedef enum {
+    HAL_USART_2 = 0,             // USART2(PA2/PA3)：NRF51822，中断服务函数USART2_IRQHandler
+    HAL_USART_NUM,
+} halUsart_e;
+
+/* PWM：通道i对应电机i(MOTOR1~MOTOR4) */
+#define HAL_PWM_CHANNEL_NUM      4
+
+/* 外部中断 */
+typedef enum {
+    HAL_EXTI_MPU_INT = 0,        // MPU9250 INT(PA4，上升沿)，中断服务函数EXTI4_IRQHandler
+    HAL_EXTI_NUM,
+} halExti_e;
+
+/* I2C主机 */
+void halI2cInit(halI2c_e bus, uint32_t clockHz);
+uint8_t halI2cRead(halI2c_e bus, uint8_t devAddr, uint8_t regAddr, uint8_t *buffer, uint16_t length);
+uint8_t halI2cWrite(halI2c_e bus, uint8_t devAddr, uint8_t regAddr, const uint8_t *data, uint16_t length);
+
+/* SPI主机(模式0，8位，高位在前，软件片选) */
+void halSpiInit(halSpi_e bus, uint32_t clockHz);
+void halSpiSelect(halSpi_e bus, uint8_t select);
+uint8_t halSpiTransfer(halSpi_e bus, const uint8_t *tx, uint8_t *rx, uint16_t length);
+
+/* USART(8N1，使能接收中断) */
+void halUsartInit(halUsart_e port, uint32_t baudrate, uint8_t irqPriority);
+uint8_t halUsartRxReady(halUsart_e port);
+uint8_t halUsartRxOverrun(halUsart_e port);
+uint8_t halUsartReadByte(halUsart_e port);
+uint8_t halUsartTxIrqPending(halUsart_e port);
+void halUsartWriteByte(halUsart_e port, uint8_t byte);
+void halUsartTxIrqEnable(halUsart_e port, uint8_t enable);
+
+/* PWM(比较寄存器预装载，新值在下一个PWM周期生效) */
+void halPwmInit(uint32_t freqHz, uint16_t resolution);
+void halPwmSetCompare(uint8_t channel, uint16_t compare);
+void halPwmEnable(uint8_t enable);
+
+/* 外部中断 */
+void halExtiInit(halExti_e line, uint8_t irqPriority);
+uint8_t halExtiPending(halExti_e line);
+void halExtiClear(halExti_e line);
+
+#endif /* HAL_H */
@@ -0,0 +1,802 @@
+﻿/*
+ * hal_sim.c
+ *
+ * 硬件抽象层主机实现
+ * 模拟外设寄存器行为、总线时序与故障，用于在Linux上运行与测试驱动，说明见hal_sim.h
+ * 中断按电平触发处理：中断条件(RXNE、TXE中断使能、EXTI挂起)存在时反复调用中断服务函数，
+ * 直到服务函数清除该条件，与NVIC的行为一致
+ *
+ * 2026-03-01
+ */
+
+#include "hal_sim.h"
+#include "ringbuf.h"
+#include <string.h>
+
+#if !RINGBUF_IS_POW2(HAL_SIM_USART_BUFFER)
+#error "HAL_SIM_USART_BUFFER必须为2的幂"
+#endif
+
+/* 驱动中的中断服务函数(与目标板向量表同名)，未链接对应驱动时为空 */
+extern void USART2_IRQHandler(void) __attribute__((weak));
+extern void EXTI4_IRQHandler(void) __attribute__((weak));
+
+typedef struct {
+    uint32_t clockHz;            // 0表示未初始化，访问时超时
+    halSimI2cDevice_t *devices[HAL_SIM_I2C_DEVICE_MAX];
+    uint8_t deviceNum;
+    halSimFault_e fault;
+    uint32_t faultCount;
+    halSimI2cStats_t stats;
+} halSimI2cBus_t;
+
+typedef struct {
+    uint32_t clockHz;            // 0表示未初始化，传输超时
+    halSimSpiDevice_t *device;
+    uint8_t selected;
+    halSimSpiStats_t stats;
+} halSimSpiBus_t;
+
+typedef struct {
+    uint8_t ready;               // 已初始化
+    uint64_t byteNs;             // 一个字节(10位)的传输时间
+    uint8_t dr;                  // 接收数据寄存器
+    uint8_t rxne;
+    uint8_t ore;
+    uint8_t rxIrq;
+    uint8_t txIrq;
+    uint64_t rxNextNs;           // 下一个注入字节到达的时刻
+    halSimFault_e fault;
+    uint32_t faultCount;
+    ringbuf_t rxRing;            // 注入、尚未到达的字节
+    ringbuf_t txRing;            // 已发送、尚未被取走的字节
+    uint8_t rxBuffer[HAL_SIM_USART_BUFFER];
+    uint8_t txBuffer[HAL_SIM_USART_BUFFER];
+} halSimUsart_t;
+
+typedef struct {
+    uint8_t enabled;
+    uint8_t pending;
+    uint64_t periodNs;           // 周期触发，0为不触发
+    uint64_t nextNs;
+} halSimExti_t;
+
+/* 目标板系统时钟(system_stm32f4xx.c)，主机上DWT周期计数按该频率由虚拟时钟换算 */
+uint32_t SystemCoreClock = 100000000;
+
+static void (*const g_usartIrq[HAL_USART_NUM])(void) = {USART2_IRQHandler};
+static void (*const g_extiIrq[HAL_EXTI_NUM])(void) = {EXTI4_IRQHandler};
+
+static uint64_t g_nowNs;
+static uint8_t g_inIsr;
+static halSimI2cBus_t g_i2c[HAL_I2C_NUM];
+static halSimSpiBus_t g_spi[HAL_SPI_NUM];
+static halSimUsart_t g_usart[HAL_USART_NUM];
+static halSimExti_t g_exti[HAL_EXTI_NUM];
+static uint16_t g_pwmCompare[HAL_PWM_CHANNEL_NUM];
+static uint8_t g_pwmEnabled;
+
+/**
+ * @brief  复位全部模拟状态(时钟归零、卸下I2C/SPI设备、清除故障)
+ * @param  无
+ * @retval 无
+ */
+void halSimReset(void)
+{
+    g_nowNs = 0;
+    g_inIsr = 0;
+    memset(g_i2c, 0, sizeof(g_i2c));
+    memset(g_spi, 0, sizeof(g_spi));
+    memset(g_usart, 0, sizeof(g_usart));
+    memset(g_exti, 0, sizeof(g_exti));
+    memset(g_pwmCompare, 0, sizeof(g_pwmCompare));
+    g_pwmEnabled = 0;
+}
+
+/**
+ * @brief  读取虚拟时钟
+ * @param  无
+ * @retval 当前时刻 (ns)
+ */
+uint64_t halSimNowNs(void)
+{
+    return g_nowNs;
+}
+
+/**
+ * @brief  取出一次待注入的故障
+ * @param  fault: 故障类型
+ * @param  count: 剩余次数
+ * @retval 本次的故障，无故障时为HAL_SIM_FAULT_NONE
+ */
+static halSimFault_e halSimTakeFault(halSimFault_e fault, uint32_t *count)
+{
+    if (*count == 0)
+    {
+        return HAL_SIM_FAULT_NONE;
+    }
+    
+    (*count)--;
+    return fault;
+}
+
+/**
+ * @brief  调用中断条件成立的中断服务函数，直到全部条件清除；已在中断中时由外层处理
+ * @param  无
+ * @retval 无
+ */
+static void halSimService(void)
+{
+    uint8_t active;
+    uint8_t i;
+    
+    if (g_inIsr)
+    {
+        return;
+    }
+    
+    g_inIsr = 1;
+    do
+    {
+        active = 0;
+        for (i = 0; i < HAL_USART_NUM; i++)
+        {
+            if (g_usartIrq[i] && ((g_usart[i].rxIrq && g_usart[i].rxne) || g_usart[i].txIrq))
+            {
+                g_usartIrq[i]();
+                active = 1;
+            }
+        }
+        for (i = 0; i < HAL_EXTI_NUM; i++)
+        {
+            if (g_extiIrq[i] && g_exti[i].enabled && g_exti[i].pending)
+            {
+                g_extiIrq[i]();
+                active = 1;
+            }
+        }
+    } while (active);
+    g_inIsr = 0;
+}
+
+/**
+ * @brief  下一个注入字节到达接收数据寄存器
+ * @param  u: USART
+ * @retval 无
+ */
+static void halSimUsartDeliver(halSimUsart_t *u)
+{
+    uint8_t byte;
+    halSimFault_e fault;
+    
+    ringbufPop(&u->rxRing, &byte);
+    fault = halSimTakeFault(u->fault, &u->faultCount);
+    
+    if (fault == HAL_SIM_FAULT_CORRUPT)
+    {
+        byte ^= 0x80;
+    }
+    
+    /* 上一个字节未读走时新字节丢失 */
+    if (fault == HAL_SIM_FAULT_OVERRUN || u->rxne)
+    {
+        u->ore = 1;
+    }
+    else
+    {
+        u->dr = byte;
+        u->rxne = 1;
+    }
+    
+    u->rxNextNs += u->byteNs;
+}
+
+/**
+ * @brief  虚拟时钟前进，按时间顺序处理期间的USART接收与周期外部中断
+ * @param  ns: 前进的时间 (ns)
+ * @retval 无
+ */
+void halSimAdvanceNs(uint64_t ns)
+{
+    uint64_t end = g_nowNs + ns;
+    uint64_t next;
+    halSimUsart_t *u;
+    int8_t usart, exti;
+    uint8_t i;
+    
+    for (;;)
+    {
+        /* 找出最早的事件 */
+        next = end;
+        usart = -1;
+        exti = -1;
+        for (i = 0; i < HAL_USART_NUM; i++)
+        {
+            u = &g_usart[i];
+            if (u->ready && ringbufCount(&u->rxRing) > 0 && u->rxNextNs <= next)
+            {
+                next = u->rxNextNs;
+                usart = i;
+            }
+        }
+        for (i = 0; i < HAL_EXTI_NUM; i++)
+        {
+            if (g_exti[i].periodNs > 0 && g_exti[i].nextNs <= next)
+            {
+                next = g_exti[i].nextNs;
+                usart = -1;
+                exti = i;
+            }
+        }
+        
+        if (usart < 0 && exti < 0)
+        {
+            break;
+        }
+        
+        /* 中断中的I2C事务可能已让时钟越过该事件，时钟不回退 */
+        if (next > g_nowNs)
+        {
+            g_nowNs = next;
+        }
+        if (exti >= 0)
+        {
+            g_exti[exti].pending = 1;
+            g_exti[exti].nextNs += g_exti[exti].periodNs;
+        }
+        else
+        {
+            halSimUsartDeliver(&g_usart[usart]);
+        }
+        halSimService();
+    }
+    
+    if (end > g_nowNs)
+    {
+        g_nowNs = end;
+    }
+}
+
+/**
+ * @brief  I2C总线占用指定位数的时间
+ * @param  b: 总线
+ * @param  bits: 位数
+ * @retval 无
+ */
+static void halSimI2cBusy(halSimI2cBus_t *b, uint32_t bits)
+{
+    uint64_t ns = (uint64_t)bits * 1000000000ULL / b->clockHz;
+    
+    b->stats.busyNs += ns;
+    halSimAdvanceNs(ns);
+}
+
+/**
+ * @brief  I2C起始信号与地址阶段
+ * @param  b: 总线
+ * @param  devAddr: 设备地址
+ * @param  corrupt: 输出，本次事务是否注入数据错误
+ * @retval 应答的设备，无应答或超时为0
+ */
+static halSimI2cDevice_t *halSimI2cStart(halSimI2cBus_t *b, uint8_t devAddr, uint8_t *corrupt)
+{
+    halSimFault_e fault = halSimTakeFault(b->fault, &b->faultCount);
+    halSimI2cDevice_t *dev = 0;
+    uint8_t i;
+    
+    /* 未初始化的I2C不会产生起始信号，等待超时 */
+    if (b->clockHz == 0 || fault == HAL_SIM_FAULT_TIMEOUT)
+    {
+        b->stats.timeouts++;
+        halSimAdvanceNs(HAL_I2C_TIMEOUT_US * 1000ULL);
+        return 0;
+    }
+    
+    for (i = 0; i < b->deviceNum; i++)
+    {
+        if (b->devices[i]->addr == (devAddr & 0xFE))
+        {
+            dev = b->devices[i];
+        }
+    }
+    
+    /* 起始信号与地址，无应答时主机发送停止信号 */
+    if (dev == 0 || fault == HAL_SIM_FAULT_NACK)
+    {
+        b->stats.nacks++;
+        halSimI2cBusy(b, 1 + 9 + 1);
+        return 0;
+    }
+    
+    *corrupt = (fault == HAL_SIM_FAULT_CORRUPT);
+    return dev;
+}
+
+/**
+ * @brief  I2C初始化
+ * @param  bus: I2C总线
+ * @param  clockHz: SCL时钟频率 (Hz)
+ * @retval 无
+ */
+void halI2cInit(halI2c_e bus, uint32_t clockHz)
+{
+    g_i2c[bus].clockHz = clockHz;
+}
+
+/**
+ * @brief  I2C读取连续寄存器，寄存器地址自动递增
+ * @param  bus: I2C总线
+ * @param  devAddr: 设备地址
+ * @param  regAddr: 起始寄存器地址
+ * @param  buffer: 数据缓冲区
+ * @param  length: 数据长度
+ * @retval 1-成功，0-超时或无应答
+ */
+uint8_t halI2cRead(halI2c_e bus, uint8_t devAddr, uint8_t regAddr, uint8_t *buffer, uint16_t length)
+{
+    halSimI2cBus_t *b = &g_i2c[bus];
+    halSimI2cDevice_t *dev;
+    uint8_t corrupt = 0;
+    uint8_t reg;
+    uint16_t i;
+    
+    dev = halSimI2cStart(b, devAddr, &corrupt);
+    if (dev == 0)
+    {
+        return 0;
+    }
+    
+    for (i = 0; i < length; i++)
+    {
+        reg = (uint8_t)(regAddr + i);
+        if (dev->onRead)
+        {
+            dev->onRead(dev, reg);
+        }
+        buffer[i] = dev->regs[reg];
+    }
+    if (corrupt && length > 0)
+    {
+        buffer[0] ^= 0x80;
+    }
+    
+    /* 起始、地址、寄存器地址、重复起始、地址、数据、停止 */
+    halSimI2cBusy(b, 1 + 9 + 9 + 1 + 9 + 9 * (uint32_t)length + 1);
+    b->stats.reads++;
+    b->stats.bytes += length;
+    
+    return 1;
+}
+
+/**
+ * @brief  I2C写入连续寄存器，寄存器地址自动递增
+ * @param  bus: I2C总线
+ * @param  devAddr: 设备地址
+ * @param  regAddr: 起始寄存器地址
+ * @param  data: 要写入的数据
+ * @param  length: 数据长度
+ * @retval 1-成功，0-超时或无应答
+ */
+uint8_t halI2cWrite(halI2c_e bus, uint8_t devAddr, uint8_t regAddr, const uint8_t *data, uint16_t length)
+{
+    halSimI2cBus_t *b = &g_i2c[bus];
+    halSimI2cDevice_t *dev;
+    uint8_t corrupt = 0;
+    uint8_t reg;
+    uint16_t i;
+    
+    dev = halSimI2cStart(b, devAddr, &corrupt);
+    if (dev == 0)
+    {
+        return 0;
+    }
+    
+    /* 起始、地址、寄存器地址、数据、停止 */
+    halSimI2cBusy(b, 1 + 9 + 9 + 9 * (uint32_t)length + 1);
+    
+    for (i = 0; i < length; i++)
+    {
+        reg = (uint8_t)(regAddr + i);
+        dev->regs[reg] = (corrupt && i == 0) ? (data[i] ^ 0x80) : data[i];
+        if (dev->onWrite)
+        {
+            dev->onWrite(dev, reg, dev->regs[reg]);
+        }
+    }
+    b->stats.writes++;
+    b->stats.bytes += length;
+    
+    return 1;
+}
+
+/**
+ * @brief  在总线上挂接设备
+ * @param  bus: I2C总线
+ * @param  dev: 设备模型，地址与寄存器初值由调用者填好
+ * @retval 无
+ */
+void halSimI2cAttach(halI2c_e bus, halSimI2cDevice_t *dev)
+{
+    halSimI2cBus_t *b = &g_i2c[bus];
+    
+    if (b->deviceNum < HAL_SIM_I2C_DEVICE_MAX)
+    {
+        b->devices[b->deviceNum++] = dev;
+    }
+}
+
+/**
+ * @brief  注入I2C故障
+ * @param  bus: I2C总线
+ * @param  fault: HAL_SIM_FAULT_NACK、HAL_SIM_FAULT_TIMEOUT或HAL_SIM_FAULT_CORRUPT
+ * @param  count: 之后连续count次事务出现该故障，0为清除
+ * @retval 无
+ */
+void halSimI2cFault(halI2c_e bus, halSimFault_e fault, uint32_t count)
+{
+    g_i2c[bus].fault = fault;
+    g_i2c[bus].faultCount = count;
+}
+
+/**
+ * @brief  获取I2C总线统计
+ * @param  bus: I2C总线
+ * @param  stats: 统计数据输出指针
+ * @retval 无
+ */
+void halSimI2cGetStats(halI2c_e bus, halSimI2cStats_t *stats)
+{
+    *stats = g_i2c[bus].stats;
+}
+
+/**
+ * @brief  SPI初始化
+ * @param  bus: SPI总线
+ * @param  clockHz: SCK时钟频率 (Hz)
+ * @retval 无
+ */
+void halSpiInit(halSpi_e bus, uint32_t clockHz)
+{
+    g_spi[bus].clockHz = clockHz;
+}
+
+/**
+ * @brief  SPI片选，状态变化时通知设备
+ * @param  bus: SPI总线
+ * @param  select: 1-选中，0-释放
+ * @retval 无
+ */
+void halSpiSelect(halSpi_e bus, uint8_t select)
+{
+    halSimSpiBus_t *b = &g_spi[bus];
+    
+    select = select ? 1 : 0;
+    if (select == b->selected)
+    {
+        return;
+    }
+    b->selected = select;
+    if (b->device && b->device->onSelect)
+    {
+        b->device->onSelect(b->device, select);
+    }
+}
+
+/**
+ * @brief  SPI全双工传输
+ * @param  bus: SPI总线
+ * @param  tx: 发送数据，为0时发送0xFF
+ * @param  rx: 接收缓冲区，可为0
+ * @param  length: 字节数
+ * @retval 1-成功，0-超时(未初始化)
+ */
+uint8_t halSpiTransfer(halSpi_e bus, const uint8_t *tx, uint8_t *rx, uint16_t length)
+{
+    halSimSpiBus_t *b = &g_spi[bus];
+    uint64_t ns;
+    uint8_t byte;
+    uint16_t i;
+    
+    if (b->clockHz == 0)
+    {
+        b->stats.timeouts++;
+        halSimAdvanceNs(HAL_SPI_TIMEOUT_US * 1000ULL);
+        return 0;
+    }
+    
+    for (i = 0; i < length; i++)
+    {
+        byte = tx ? tx[i] : 0xFF;
+        byte = (b->device && b->selected) ? b->device->onByte(b->device, byte) : 0xFF;
+        if (rx)
+        {
+            rx[i] = byte;
+        }
+    }
+    
+    ns = (uint64_t)length * 8 * 1000000000ULL / b->clockHz;
+    b->stats.busyNs += ns;
+    b->stats.transfers++;
+    b->stats.bytes += length;
+    halSimAdvanceNs(ns);
+    
+    return 1;
+}
+
+/**
+ * @brief  在总线上挂接设备(替换原有设备)
+ * @param  bus: SPI总线
+ * @param  dev: 设备模型
+ * @retval 无
+ */
+void halSimSpiAttach(halSpi_e bus, halSimSpiDevice_t *dev)
+{
+    g_spi[bus].device = dev;
+}
+
+/**
+ * @brief  获取SPI总线统计
+ * @param  bus: SPI总线
+ * @param  stats: 统计数据输出指针
+ * @retval 无
+ */
+void halSimSpiGetStats(halSpi_e bus, halSimSpiStats_t *stats)
+{
+    *stats = g_spi[bus].stats;
+}
+
+/**
+ * @brief  USART初始化
+ * @param  port: USART端口
+ * @param  baudrate: 波特率
+ * @param  irqPriority: 中断抢占优先级(主机不使用)
+ * @retval 无
+ */
+void halUsartInit(halUsart_e port, uint32_t baudrate, uint8_t irqPriority)
+{
+    halSimUsart_t *u = &g_usart[port];
+    
+    memset(u, 0, sizeof(*u));
+    ringbufInit(&u->rxRing, u->rxBuffer, 1, HAL_SIM_USART_BUFFER);
+    ringbufInit(&u->txRing, u->txBuffer, 1, HAL_SIM_USART_BUFFER);
+    u->byteNs = 10ULL * 1000000000ULL / baudrate;
+    u->rxIrq = 1;
+    u->ready = 1;
+}
+
+/**
+ * @brief  接收数据寄存器非空(RXNE)
+ * @param  port: USART端口
+ * @retval 1-有数据，0-无数据
+ */
+uint8_t halUsartRxReady(halUsart_e port)
+{
+    return g_usart[port].rxne;
+}
+
+/**
+ * @brief  接收溢出(ORE)
+ * @param  port: USART端口
+ * @retval 1-发生溢出，0-无溢出
+ */
+uint8_t halUsartRxOverrun(halUsart_e port)
+{
+    return g_usart[port].ore;
+}
+
+/**
+ * @brief  读取接收数据寄存器，清除RXNE与ORE
+ * @param  port: USART端口
+ * @retval 接收到的字节
+ */
+uint8_t halUsartReadByte(halUsart_e port)
+{
+    halSimUsart_t *u = &g_usart[port];
+    
+    u->rxne = 0;
+    u->ore = 0;
+    
+    return u->dr;
+}
+
+/**
+ * @brief  发送中断待处理，发送数据寄存器总是空，等同于TXE中断已使能
+ * @param  port: USART端口
+ * @retval 1-待处理，0-无
+ */
+uint8_t halUsartTxIrqPending(halUsart_e port)
+{
+    return g_usart[port].txIrq;
+}
+
+/**
+ * @brief  写发送数据寄存器，字节进入发送捕获缓冲区(满时丢弃)
+ * @param  port: USART端口
+ * @param  byte: 要发送的字节
+ * @retval 无
+ */
+void halUsartWriteByte(halUsart_e port, uint8_t byte)
+{
+    ringbufPush(&g_usart[port].txRing, &byte);
+}
+
+/**
+ * @brief  使能/关闭发送(TXE)中断，使能后立即进入中断
+ * @param  port: USART端口
+ * @param  enable: 1-使能，0-关闭
+ * @retval 无
+ */
+void halUsartTxIrqEnable(halUsart_e port, uint8_t enable)
+{
+    g_usart[port].txIrq = enable;
+    
+    if (enable)
+    {
+        halSimService();
+    }
+}
+
+/**
+ * @brief  注入接收字节，从当前时刻起按波特率逐个到达
+ * @param  port: USART端口
+ * @param  data: 数据
+ * @param  length: 数据长度
+ * @retval 实际注入的字节数(USART未初始化时为0)
+ */
+uint16_t halSimUsartInject(halUsart_e port, const uint8_t *data, uint16_t length)
+{
+    halSimUsart_t *u = &g_usart[port];
+    
+    if (!u->ready)
+    {
+        return 0;
+    }
+    
+    if (ringbufCount(&u->rxRing) == 0)
+    {
+        u->rxNextNs = g_nowNs + u->byteNs;
+    }
+    
+    return (uint16_t)ringbufPushBulk(&u->rxRing, data, length);
+}
+
+/**
+ * @brief  取出已发送的字节
+ * @param  port: USART端口
+ * @param  buffer: 输出缓冲区
+ * @param  maxLength: 最大长度
+ * @retval 取出的字节数
+ */
+uint16_t halSimUsartTake(halUsart_e port, uint8_t *buffer, uint16_t maxLength)
+{
+    if (!g_usart[port].ready)
+    {
+        return 0;
+    }
+    
+    return (uint16_t)ringbufPopBulk(&g_usart[port].txRing, buffer, maxLength);
+}
+
+/**
+ * @brief  注入USART接收故障
+ * @param  port: USART端口
+ * @param  fault: HAL_SIM_FAULT_CORRUPT或HAL_SIM_FAULT_OVERRUN
+ * @param  count: 之后到达的count个字节出现该故障，0为清除
+ * @retval 无
+ */
+void halSimUsartFault(halUsart_e port, halSimFault_e fault, uint32_t count)
+{
+    g_usart[port].fault = fault;
+    g_usart[port].faultCount = count;
+}
+
+/**
+ * @brief  PWM初始化，比较值清零，定时器停止
+ * @param  freqHz: PWM频率 (Hz)
+ * @param  resolution: 每个周期的计数值
+ * @retval 无
+ */
+void halPwmInit(uint32_t freqHz, uint16_t resolution)
+{
+    memset(g_pwmCompare, 0, sizeof(g_pwmCompare));
+    g_pwmEnabled = 0;
+}
+
+/**
+ * @brief  设置PWM比较值
+ * @param  channel: 通道(电机编号)
+ * @param  compare: 比较值
+ * @retval 无
+ */
+void halPwmSetCompare(uint8_t channel, uint16_t compare)
+{
+    if (channel < HAL_PWM_CHANNEL_NUM)
+    {
+        g_pwmCompare[channel] = compare;
+    }
+}
+
+/**
+ * @brief  启动/停止PWM定时器
+ * @param  enable: 1-启动，0-停止
+ * @retval 无
+ */
+void halPwmEnable(uint8_t enable)
+{
+    g_pwmEnabled = enable;
+}
+
+/**
+ * @brief  读取PWM比较值
+ * @param  channel: 通道(电机编号)
+ * @retval 比较值
+ */
+uint16_t halSimPwmGetCompare(uint8_t channel)
+{
+    return (channel < HAL_PWM_CHANNEL_NUM) ? g_pwmCompare[channel] : 0;
+}
+
+/**
+ * @brief  PWM定时器是否运行
+ * @param  无
+ * @retval 1-运行，0-停止
+ */
+uint8_t halSimPwmIsEnabled(void)
+{
+    return g_pwmEnabled;
+}
+
+/**
+ * @brief  外部中断初始化
+ * @param  line: 外部中断
+ * @param  irqPriority: 中断抢占优先级(主机不使用)
+ * @retval 无
+ */
+void halExtiInit(halExti_e line, uint8_t irqPriority)
+{
+    g_exti[line].enabled = 1;
+    g_exti[line].pending = 0;
+}
+
+/**
+ * @brief  外部中断挂起
+ * @param  line: 外部中断
+ * @retval 1-挂起，0-无
+ */
+uint8_t halExtiPending(halExti_e line)
+{
+    return g_exti[line].pending;
+}
+
+/**
+ * @brief  清除外部中断挂起标志
+ * @param  line: 外部中断
+ * @retval 无
+ */
+void halExtiClear(halExti_e line)
+{
+    g_exti[line].pending = 0;
+}
+
+/**
+ * @brief  在当前时刻产生一次外部中断上升沿
+ * @param  line: 外部中断
+ * @retval 无
+ */
+void halSimExtiTrigger(halExti_e line)
+{
+    g_exti[line].pending = 1;
+    halSimService();
+}
+
+/**
+ * @brief  设置外部中断周期触发(如传感器数据就绪)
+ * @param  line: 外部中断
+ * @param  periodNs: 周期 (ns)，0为停止；第一次在一个周期后触发
+ * @retval 无
+ */
+void halSimExtiSetPeriod(halExti_e line, uint64_t periodNs)
+{
+    g_exti[line].periodNs = periodNs;
+    g_exti[line].nextNs = g_nowNs + periodNs;
+}
@@ -0,0 +1,110 @@
+﻿/*
+ * hal_sim.h
+ *
+ * 硬件抽象层主机实现(hal_sim.c)的测试接口
+ * 在Linux上运行驱动代码：虚拟时钟、I2C设备寄存器模型、USART收发、PWM比较值与外部中断，
+ * 并可注入总线故障
+ *
+ * 1.时间：虚拟时钟只在halSimAdvanceNs和I2C事务中前进(I2C按总线时钟计算传输时间，与目标板忙等一致)，
+ *   时钟前进时按时间顺序产生USART接收与周期外部中断事件并调用对应的中断服务函数
+ * 2.I2C：每条总线最多挂HAL_SIM_I2C_DEVICE_MAX个设备，每个设备为256字节寄存器，
+ *   连续读写时寄存器地址自动递增；读前/写后的回调用于实现数据寄存器更新、读清零等寄存器行为。
+ *   未挂接的地址无应答
+ * 3.SPI：每条总线挂一个设备(接在片选上)，片选变化与每个交换的字节调用设备回调，
+ *   按总线时钟推进虚拟时钟；未挂接设备或未选中时读到0xFF
+ * 4.USART：halSimUsartInject注入的字节按波特率逐个到达接收数据寄存器，上一个字节未读走时
+ *   置溢出标志并丢弃新字节(与硬件相同)；发送不模拟线路时间，写入数据寄存器后立即完成，
+ *   字节由halSimUsartTake取出
+ * 5.中断：按目标板向量表中的名字(USART2_IRQHandler、EXTI4_IRQHandler)调用驱动中的中断服务函数，
+ *   未链接该驱动时忽略。中断服务函数执行时不会再嵌套进入
+ * 6.故障：halSimI2cFault/halSimUsartFault使之后count次事务(I2C)或字节(USART)出现指定故障
+ *
+ * 使用前调用halSimReset
+ *
+ * 2026-03-01
+ */
+
+#ifndef HAL_SIM_H
+#define HAL_SIM_H
+
+#include <stdint.h>
+#include "hal.h"
+
+#define HAL_SIM_I2C_DEVICE_MAX   4           // 每条总线最多挂接的设备数
+#define HAL_SIM_USART_BUFFER     1024        // 接收注入与发送捕获缓冲区大小(2的幂)
+
+/* 故障类型 */
+typedef enum {
+    HAL_SIM_FAULT_NONE = 0,
+    HAL_SIM_FAULT_NACK,          // I2C：地址无应答
+    HAL_SIM_FAULT_TIMEOUT,       // I2C：总线卡死，等待HAL_I2C_TIMEOUT_US后失败
+    HAL_SIM_FAULT_CORRUPT,       // I2C：读出的第一个字节最高位翻转；USART：接收字节最高位翻转
+    HAL_SIM_FAULT_OVERRUN,       // USART：接收字节丢失并置溢出标志
+} halSimFault_e;
+
+/* I2C设备寄存器模型 */
+typedef struct halSimI2cDevice_s halSimI2cDevice_t;
+
+struct halSimI2cDevice_s {
+    uint8_t addr;                // 设备地址(8位格式，与驱动中的xxx_ADDR相同)
+    uint8_t regs[256];           // 寄存器
+    void (*onRead)(halSimI2cDevice_t *dev, uint8_t reg);                 // 读寄存器前调用，可为0
+    void (*onWrite)(halSimI2cDevice_t *dev, uint8_t reg, uint8_t value); // 写寄存器后调用，可为0
+    void *user;                  // 模型私有数据
+};
+
+/* I2C总线统计 */
+typedef struct {
+    uint32_t reads;              // 成功的读事务数
+    uint32_t writes;             // 成功的写事务数
+    uint32_t bytes;              // 成功传输的数据字节数
+    uint32_t nacks;              // 无应答次数
+    uint32_t timeouts;           // 超时次数
+    uint64_t busyNs;             // 总线占用时间 (ns)
+} halSimI2cStats_t;
+
+/* SPI设备模型 */
+typedef struct halSimSpiDevice_s halSimSpiDevice_t;
+
+struct halSimSpiDevice_s {
+    void (*onSelect)(halSimSpiDevice_t *dev, uint8_t select);   // 片选变化时调用，可为0
+    uint8_t (*onByte)(halSimSpiDevice_t *dev, uint8_t tx);      // 交换一个字节，返回设备输出
+    void *user;                  // 模型私有数据
+};
+
+/* SPI总线统计 */
+typedef struct {
+    uint32_t transfers;          // 成功的传输次数
+    uint32_t bytes;              // 交换的字节数
+    uint32_t timeouts;           // 超时次数
+    uint64_t busyNs;             // 总线占用时间 (ns)
+} halSimSpiStats_t;
+
+/* 虚拟时钟 */
+void halSimReset(void);
+uint64_t halSimNowNs(void);
+void halSimAdvanceNs(uint64_t ns);
+
+/* I2C */
+void halSimI2cAttach(halI2c_e bus, halSimI2cDevice_t *dev);
+void halSimI2cFault(halI2c_e bus, halSimFault_e fault, uint32_t count);
+void halSimI2cGetStats(halI2c_e bus, halSimI2cStats_t *stats);
+
+/* SPI */
+void halSimSpiAttach(halSpi_e bus, halSimSpiDevice_t *dev);
+void halSimSpiGetStats(halSpi_e bus, halSimSpiStats_t *stats);
+
+/* USART */
+uint16_t halSimUsartInject(halUsart_e port, const uint8_t *data, uint16_t length);
+uint16_t halSimUsartTake(halUsart_e port, uint8_t *buffer, uint16_t maxLength);
+void halSimUsartFault(halUsart_e port, halSimFault_e fault, uint32_t count);
+
+/* PWM */
+uint16_t halSimPwmGetCompare(uint8_t channel);
+uint8_t halSimPwmIsEnabled(void);
+
+/* 外部中断 */
+void halSimExtiTrigger(halExti_e line);
+void halSimExtiSetPeriod(halExti_e line, uint64_t periodNs);
+
+#endif /* HAL_SIM_H */
@@ -0,0 +1,726 @@
+﻿/*
+ * hal_stm32.c
+ *
+ * 硬件抽象层目标板实现
+ * 基于STM32F4标准外设库，引脚与外设分配见各外设的配置表
+ * I2C超时由DWT周期计数判断，DWT未初始化时计数不变，等待退化为无超时
+ *
+ * 2026-03-01
+ */
+
+#include "hal.h"
+#include "stm32f4xx.h"
+#include "DWT.h"
+#include "ramfunc.h"
+
+/* I2C配置(SCL与SDA在同一端口) */
+typedef struct {
+    I2C_TypeDef *i2c;
+    uint32_t clock;              // APB1时钟使能位
+    GPIO_TypeDef *port;
+    uint16_t sclPin;
+    uint16_t sdaPin;
+    uint8_t sclSource;
+    uint8_t sdaSource;
+    uint8_t af;
+} halI2cHw_t;
+
+static const halI2cHw_t g_i2cHw[HAL_I2C_NUM] = {
+    {I2C1, RCC_APB1Periph_I2C1, GPIOB, GPIO_Pin_6, GPIO_Pin_7, GPIO_PinSource6, GPIO_PinSource7, GPIO_AF_I2C1},
+    {I2C2, RCC_APB1Periph_I2C2, GPIOB, GPIO_Pin_10, GPIO_Pin_11, GPIO_PinSource10, GPIO_PinSource11, GPIO_AF_I2C2},
+};
+
+/* SPI配置(SCK、MISO、MOSI与片选在同一端口，片选为普通输出) */
+typedef struct {
+    SPI_TypeDef *spi;
+    uint32_t clock;              // APB1时钟使能位
+    GPIO_TypeDef *port;
+    uint32_t portClock;
+    uint16_t sckPin;
+    uint16_t misoPin;
+    uint16_t mosiPin;
+    uint16_t csPin;
+    uint8_t sckSource;
+    uint8_t misoSource;
+    uint8_t mosiSource;
+    uint8_t af;
+} halSpiHw_t;
+
+static const halSpiHw_t g_spiHw[HAL_SPI_NUM] = {
+    {SPI2, RCC_APB1Periph_SPI2, GPIOB, RCC_AHB1Periph_GPIOB, GPIO_Pin_13, GPIO_Pin_14, GPIO_Pin_15, GPIO_Pin_12,
+     GPIO_PinSource13, GPIO_PinSource14, GPIO_PinSource15, GPIO_AF_SPI2},
+};
+
+/* USART配置(TX与RX在同一端口) */
+typedef struct {
+    USART_TypeDef *usart;
+    uint32_t clock;              // APB1时钟使能位
+    GPIO_TypeDef *port;
+    uint32_t portClock;
+    uint16_t txPin;
+    uint16_t rxPin;
+    uint8_t txSource;
+    uint8_t rxSource;
+    uint8_t af;
+    IRQn_Type irq;
+} halUsartHw_t;
+
+static const halUsartHw_t g_usartHw[HAL_USART_NUM] = {
+    {USART2, RCC_APB1Periph_USART2, GPIOA, RCC_AHB1Periph_GPIOA, GPIO_Pin_2, GPIO_Pin_3,
+     GPIO_PinSource2, GPIO_PinSource3, GPIO_AF_USART2, USART2_IRQn},
+};
+
+/* PWM通道配置，按电机顺序 */
+typedef struct {
+    TIM_TypeDef *tim;
+    uint8_t channel;             // 定时器通道1~4
+    GPIO_TypeDef *port;
+    uint16_t pin;
+    uint8_t source;
+    uint8_t af;
+} halPwmHw_t;
+
+static const halPwmHw_t g_pwmHw[HAL_PWM_CHANNEL_NUM] = {
+    {TIM4, 2, GPIOB, GPIO_Pin_7, GPIO_PinSource7, GPIO_AF_TIM4},     // MOTOR1
+    {TIM4, 1, GPIOB, GPIO_Pin_6, GPIO_PinSource6, GPIO_AF_TIM4},     // MOTOR2
+    {TIM2, 3, GPIOB, GPIO_Pin_10, GPIO_PinSource10, GPIO_AF_TIM2},   // MOTOR3
+    {TIM2, 1, GPIOA, GPIO_Pin_5, GPIO_PinSource5, GPIO_AF_TIM2},     // MOTOR4
+};
+
+/* 外部中断配置 */
+typedef struct {
+    GPIO_TypeDef *port;
+    uint32_t portClock;
+    uint16_t pin;
+    uint8_t portSource;
+    uint8_t pinSource;
+    uint32_t line;
+    IRQn_Type irq;
+} halExtiHw_t;
+
+static const halExtiHw_t g_extiHw[HAL_EXTI_NUM] = {
+    {GPIOA, RCC_AHB1Periph_GPIOA, GPIO_Pin_4, EXTI_PortSourceGPIOA, EXTI_PinSource4, EXTI_Line4, EXTI4_IRQn},
+};
+
+/**
+ * @brief  配置NVIC中断通道
+ * @param  irq: 中断号
+ * @param  priority: 抢占优先级，需不高于configMAX_SYSCALL_INTERRUPT_PRIORITY
+ * @retval 无
+ */
+static void halNvicEnable(IRQn_Type irq, uint8_t priority)
+{
+    NVIC_InitTypeDef NVIC_InitStructure;
+    
+    NVIC_InitStructure.NVIC_IRQChannel = irq;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = priority;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+}
+
+/**
+ * @brief  I2C初始化(GPIO复用开漏上拉，7位地址主机模式)
+ * @param  bus: I2C总线
+ * @param  clockHz: SCL时钟频率 (Hz)
+ * @retval 无
+ */
+void halI2cInit(halI2c_e bus, uint32_t clockHz)
+{
+    const halI2cHw_t *hw = &g_i2cHw[bus];
+    GPIO_InitTypeDef GPIO_InitStructure;
+    I2C_InitTypeDef I2C_InitStructure;
+    
+    /* 使能GPIOB和I2C时钟 */
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOB, ENABLE);
+    RCC_APB1PeriphClockCmd(hw->clock, ENABLE);
+    
+    /* 配置SCL和SDA引脚 */
+    GPIO_InitStructure.GPIO_Pin = hw->sclPin | hw->sdaPin;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_InitStructure.GPIO_OType = GPIO_OType_OD;
+    GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP;
+    GPIO_Init(hw->port, &GPIO_InitStructure);
+    GPIO_PinAFConfig(hw->port, hw->sclSource, hw->af);
+    GPIO_PinAFConfig(hw->port, hw->sdaSource, hw->af);
+    
+    /* 复位并配置I2C */
+    I2C_DeInit(hw->i2c);
+    I2C_InitStructure.I2C_Mode = I2C_Mode_I2C;
+    I2C_InitStructure.I2C_DutyCycle = I2C_DutyCycle_2;
+    I2C_InitStructure.I2C_OwnAddress1 = 0x00;
+    I2C_InitStructure.I2C_Ack = I2C_Ack_Enable;
+    I2C_InitStructure.I2C_AcknowledgedAddress = I2C_AcknowledgedAddress_7bit;
+    I2C_InitStructure.I2C_ClockSpeed = clockHz;
+    I2C_Init(hw->i2c, &I2C_InitStructure);
+    
+    I2C_Cmd(hw->i2c, ENABLE);
+}
+
+/**
+ * @brief  等待I2C事件
+ * @param  I2Cx: I2C外设
+ * @param  event: I2C_EVENT_xxx
+ * @retval 1-事件发生，0-超时
+ */
+static uint8_t halI2cWaitEvent(I2C_TypeDef *I2Cx, uint32_t event)
+{
+    uint32_t start = DWT_GetCycles();
+    
+    while (!I2C_CheckEvent(I2Cx, event))
+    {
+        if (DWT_GetCycles() - start > (SystemCoreClock / 1000000) * HAL_I2C_TIMEOUT_US)
+        {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief  等待I2C标志清除
+ * @param  I2Cx: I2C外设
+ * @param  flag: I2C_FLAG_xxx
+ * @retval 1-已清除，0-超时
+ */
+static uint8_t halI2cWaitFlagReset(I2C_TypeDef *I2Cx, uint32_t flag)
+{
+    uint32_t start = DWT_GetCycles();
+    
+    while (I2C_GetFlagStatus(I2Cx, flag))
+    {
+        if (DWT_GetCycles() - start > (SystemCoreClock / 1000000) * HAL_I2C_TIMEOUT_US)
+        {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief  发送起始(或重复起始)信号和设备地址
+ * @param  I2Cx: I2C外设
+ * @param  devAddr: 设备地址
+ * @param  direction: I2C_Direction_Transmitter或I2C_Direction_Receiver
+ * @retval 1-地址已应答，0-超时(含地址无应答)
+ */
+static uint8_t halI2cStart(I2C_TypeDef *I2Cx, uint8_t devAddr, uint8_t direction)
+{
+    I2C_GenerateSTART(I2Cx, ENABLE);
+    if (!halI2cWaitEvent(I2Cx, I2C_EVENT_MASTER_MODE_SELECT))
+    {
+        return 0;
+    }
+    
+    I2C_Send7bitAddress(I2Cx, devAddr, direction);
+    if (direction == I2C_Direction_Transmitter)
+    {
+        return halI2cWaitEvent(I2Cx, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED);
+    }
+    
+    return halI2cWaitEvent(I2Cx, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED);
+}
+
+/**
+ * @brief  发送停止信号并恢复应答
+ * @param  I2Cx: I2C外设
+ * @param  ok: 事务结果，原样返回
+ * @retval ok
+ */
+static uint8_t halI2cStop(I2C_TypeDef *I2Cx, uint8_t ok)
+{
+    I2C_GenerateSTOP(I2Cx, ENABLE);
+    halI2cWaitFlagReset(I2Cx, I2C_FLAG_STOPF);
+    
+    /* 事务中途失败时清除应答失败标志 */
+    I2C_ClearFlag(I2Cx, I2C_FLAG_AF);
+    I2C_AcknowledgeConfig(I2Cx, ENABLE);
+    
+    return ok;
+}
+
+/**
+ * @brief  I2C读取连续寄存器
+ * @param  bus: I2C总线
+ * @param  devAddr: 设备地址
+ * @param  regAddr: 起始寄存器地址
+ * @param  buffer: 数据缓冲区
+ * @param  length: 数据长度
+ * @retval 1-成功，0-超时或无应答
+ */
+uint8_t halI2cRead(halI2c_e bus, uint8_t devAddr, uint8_t regAddr, uint8_t *buffer, uint16_t length)
+{
+    I2C_TypeDef *I2Cx = g_i2cHw[bus].i2c;
+    uint16_t i;
+    
+    /* 等待总线空闲 */
+    if (!halI2cWaitFlagReset(I2Cx, I2C_FLAG_BUSY))
+    {
+        return halI2cStop(I2Cx, 0);
+    }
+    
+    /* 写模式发送寄存器地址 */
+    if (!halI2cStart(I2Cx, devAddr, I2C_Direction_Transmitter))
+    {
+        return halI2cStop(I2Cx, 0);
+    }
+    I2C_SendData(I2Cx, regAddr);
+    if (!halI2cWaitEvent(I2Cx, I2C_EVENT_MASTER_BYTE_TRANSMITTED))
+    {
+        return halI2cStop(I2Cx, 0);
+    }
+    
+    /* 重复起始，读模式 */
+    if (!halI2cStart(I2Cx, devAddr, I2C_Direction_Receiver))
+    {
+        return halI2cStop(I2Cx, 0);
+    }
+    
+    for (i = 0; i < length; i++)
+    {
+        if (i == (length - 1))
+        {
+            /* 最后一个字节禁用应答 */
+            I2C_AcknowledgeConfig(I2Cx, DISABLE);
+        }
+        
+        if (!halI2cWaitEvent(I2Cx, I2C_EVENT_MASTER_BYTE_RECEIVED))
+        {
+            return halI2cStop(I2Cx, 0);
+        }
+        buffer[i] = I2C_ReceiveData(I2Cx);
+    }
+    
+    return halI2cStop(I2Cx, 1);
+}
+
+/**
+ * @brief  I2C写入连续寄存器
+ * @param  bus: I2C总线
+ * @param  devAddr: 设备地址
+ * @param  regAddr: 起始寄存器地址
+ * @param  data: 要写入的数据
+ * @param  length: 数据长度
+ * @retval 1-成功，0-超时或无应答
+ */
+uint8_t halI2cWrite(halI2c_e bus, uint8_t devAddr, uint8_t regAddr, const uint8_t *data, uint16_t length)
+{
+    I2C_TypeDef *I2Cx = g_i2cHw[bus].i2c;
+    uint16_t i;
+    
+    /* 等待总线空闲 */
+    if (!halI2cWaitFlagReset(I2Cx, I2C_FLAG_BUSY))
+    {
+        return halI2cStop(I2Cx, 0);
+    }
+    
+    if (!halI2cStart(I2Cx, devAddr, I2C_Direction_Transmitter))
+    {
+        return halI2cStop(I2Cx, 0);
+    }
+    
+    /* 寄存器地址与数据 */
+    I2C_SendData(I2Cx, regAddr);
+    if (!halI2cWaitEvent(I2Cx, I2C_EVENT_MASTER_BYTE_TRANSMITTED))
+    {
+        return halI2cStop(I2Cx, 0);
+    }
+    for (i = 0; i < length; i++)
+    {
+        I2C_SendData(I2Cx, data[i]);
+        if (!halI2cWaitEvent(I2Cx, I2C_EVENT_MASTER_BYTE_TRANSMITTED))
+        {
+            return halI2cStop(I2Cx, 0);
+        }
+    }
+    
+    return halI2cStop(I2Cx, 1);
+}
+
+/**
+ * @brief  SPI初始化(主机，模式0，8位，高位在前，软件片选)
+ * @param  bus: SPI总线
+ * @param  clockHz: SCK时钟上限 (Hz)，取APB1时钟2~256分频中不超过该值的最高频率
+ * @retval 无
+ */
+void halSpiInit(halSpi_e bus, uint32_t clockHz)
+{
+    const halSpiHw_t *hw = &g_spiHw[bus];
+    GPIO_InitTypeDef GPIO_InitStructure;
+    SPI_InitTypeDef SPI_InitStructure;
+    uint32_t pclk = SystemCoreClock / 2;
+    uint32_t div = 2;
+    uint16_t prescaler = SPI_BaudRatePrescaler_2;
+    
+    RCC_AHB1PeriphClockCmd(hw->portClock, ENABLE);
+    RCC_APB1PeriphClockCmd(hw->clock, ENABLE);
+    
+    /* 片选先置高(不选中)再配置为输出 */
+    GPIO_SetBits(hw->port, hw->csPin);
+    GPIO_InitStructure.GPIO_Pin = hw->csPin;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_OUT;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
+    GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP;
+    GPIO_Init(hw->port, &GPIO_InitStructure);
+    
+    GPIO_InitStructure.GPIO_Pin = hw->sckPin | hw->misoPin | hw->mosiPin;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF;
+    GPIO_Init(hw->port, &GPIO_InitStructure);
+    GPIO_PinAFConfig(hw->port, hw->sckSource, hw->af);
+    GPIO_PinAFConfig(hw->port, hw->misoSource, hw->af);
+    GPIO_PinAFConfig(hw->port, hw->mosiSource, hw->af);
+    
+    /* BR[2:0]每加1分频系数加倍 */
+    while (div < 256 && pclk / div > clockHz)
+    {
+        div <<= 1;
+        prescaler = (uint16_t)(prescaler + SPI_BaudRatePrescaler_4);
+    }
+    
+    SPI_I2S_DeInit(hw->spi);
+    SPI_InitStructure.SPI_Direction = SPI_Direction_2Lines_FullDuplex;
+    SPI_InitStructure.SPI_Mode = SPI_Mode_Master;
+    SPI_InitStructure.SPI_DataSize = SPI_DataSize_8b;
+    SPI_InitStructure.SPI_CPOL = SPI_CPOL_Low;
+    SPI_InitStructure.SPI_CPHA = SPI_CPHA_1Edge;
+    SPI_InitStructure.SPI_NSS = SPI_NSS_Soft;
+    SPI_InitStructure.SPI_BaudRatePrescaler = prescaler;
+    SPI_InitStructure.SPI_FirstBit = SPI_FirstBit_MSB;
+    SPI_InitStructure.SPI_CRCPolynomial = 7;
+    SPI_Init(hw->spi, &SPI_InitStructure);
+    
+    SPI_Cmd(hw->spi, ENABLE);
+}
+
+/**
+ * @brief  SPI片选
+ * @param  bus: SPI总线
+ * @param  select: 1-选中(片选拉低)，0-释放
+ * @retval 无
+ */
+void halSpiSelect(halSpi_e bus, uint8_t select)
+{
+    const halSpiHw_t *hw = &g_spiHw[bus];
+    
+    if (select)
+    {
+        GPIO_ResetBits(hw->port, hw->csPin);
+    }
+    else
+    {
+        GPIO_SetBits(hw->port, hw->csPin);
+    }
+}
+
+/**
+ * @brief  等待SPI标志置位
+ * @param  SPIx: SPI外设
+ * @param  flag: SPI_I2S_FLAG_xxx
+ * @retval 1-已置位，0-超时
+ */
+static uint8_t halSpiWaitFlag(SPI_TypeDef *SPIx, uint16_t flag)
+{
+    uint32_t start = DWT_GetCycles();
+    
+    while (!SPI_I2S_GetFlagStatus(SPIx, flag))
+    {
+        if (DWT_GetCycles() - start > (SystemCoreClock / 1000000) * HAL_SPI_TIMEOUT_US)
+        {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief  SPI全双工传输(片选由调用者控制)
+ * @param  bus: SPI总线
+ * @param  tx: 发送数据，为0时发送0xFF
+ * @param  rx: 接收缓冲区，为0时丢弃接收数据
+ * @param  length: 字节数
+ * @retval 1-成功，0-超时
+ */
+uint8_t halSpiTransfer(halSpi_e bus, const uint8_t *tx, uint8_t *rx, uint16_t length)
+{
+    SPI_TypeDef *spi = g_spiHw[bus].spi;
+    uint8_t byte;
+    uint16_t i;
+    
+    for (i = 0; i < length; i++)
+    {
+        if (!halSpiWaitFlag(spi, SPI_I2S_FLAG_TXE))
+        {
+            return 0;
+        }
+        SPI_I2S_SendData(spi, tx ? tx[i] : 0xFF);
+        
+        if (!halSpiWaitFlag(spi, SPI_I2S_FLAG_RXNE))
+        {
+            return 0;
+        }
+        byte = (uint8_t)SPI_I2S_ReceiveData(spi);
+        if (rx)
+        {
+            rx[i] = byte;
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief  USART初始化(8N1，无流控，使能接收中断)
+ * @param  port: USART端口
+ * @param  baudrate: 波特率
+ * @param  irqPriority: 中断抢占优先级
+ * @retval 无
+ */
+void halUsartInit(halUsart_e port, uint32_t baudrate, uint8_t irqPriority)
+{
+    const halUsartHw_t *hw = &g_usartHw[port];
+    GPIO_InitTypeDef GPIO_InitStructure;
+    USART_InitTypeDef USART_InitStructure;
+    
+    /* 使能GPIO和USART时钟 */
+    RCC_AHB1PeriphClockCmd(hw->portClock, ENABLE);
+    RCC_APB1PeriphClockCmd(hw->clock, ENABLE);
+    
+    /* 配置TX和RX引脚 */
+    GPIO_InitStructure.GPIO_Pin = hw->txPin | hw->rxPin;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
+    GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP;
+    GPIO_Init(hw->port, &GPIO_InitStructure);
+    GPIO_PinAFConfig(hw->port, hw->txSource, hw->af);
+    GPIO_PinAFConfig(hw->port, hw->rxSource, hw->af);
+    
+    /* 配置USART参数 */
+    USART_InitStructure.USART_BaudRate = baudrate;
+    USART_InitStructure.USART_WordLength = USART_WordLength_8b;
+    USART_InitStructure.USART_StopBits = USART_StopBits_1;
+    USART_InitStructure.USART_Parity = USART_Parity_No;
+    USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+    USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
+    USART_Init(hw->usart, &USART_InitStructure);
+    
+    /* 使能接收中断 */
+    USART_ITConfig(hw->usart, USART_IT_RXNE, ENABLE);
+    USART_Cmd(hw->usart, ENABLE);
+    
+    halNvicEnable(hw->irq, irqPriority);
+}
+
+/**
+ * @brief  接收数据寄存器非空(RXNE)
+ * @param  port: USART端口
+ * @retval 1-有数据，0-无数据
+ */
+RAMFUNC uint8_t halUsartRxReady(halUsart_e port)
+{
+    return USART_GetFlagStatus(g_usartHw[port].usart, USART_FLAG_RXNE) == SET;
+}
+
+/**
+ * @brief  接收溢出(ORE)，读取数据寄存器后自动清除
+ * @param  port: USART端口
+ * @retval 1-发生溢出，0-无溢出
+ */
+RAMFUNC uint8_t halUsartRxOverrun(halUsart_e port)
+{
+    return USART_GetFlagStatus(g_usartHw[port].usart, USART_FLAG_ORE) == SET;
+}
+
+/**
+ * @brief  读取接收数据寄存器(同时清除RXNE)
+ * @param  port: USART端口
+ * @retval 接收到的字节
+ */
+RAMFUNC uint8_t halUsartReadByte(halUsart_e port)
+{
+    return (uint8_t)USART_ReceiveData(g_usartHw[port].usart);
+}
+
+/**
+ * @brief  发送中断待处理(TXE中断已使能且发送数据寄存器空)
+ * @param  port: USART端口
+ * @retval 1-待处理，0-无
+ */
+RAMFUNC uint8_t halUsartTxIrqPending(halUsart_e port)
+{
+    return USART_GetITStatus(g_usartHw[port].usart, USART_IT_TXE) != RESET;
+}
+
+/**
+ * @brief  写发送数据寄存器
+ * @param  port: USART端口
+ * @param  byte: 要发送的字节
+ * @retval 无
+ */
+RAMFUNC void halUsartWriteByte(halUsart_e port, uint8_t byte)
+{
+    USART_SendData(g_usartHw[port].usart, byte);
+}
+
+/**
+ * @brief  使能/关闭发送(TXE)中断
+ * @param  port: USART端口
+ * @param  enable: 1-使能，0-关闭
+ * @retval 无
+ */
+RAMFUNC void halUsartTxIrqEnable(halUsart_e port, uint8_t enable)
+{
+    USART_ITConfig(g_usartHw[port].usart, USART_IT_TXE, enable ? ENABLE : DISABLE);
+}
+
+/**
+ * @brief  PWM初始化(边沿对齐PWM1模式，比较寄存器与自动重载预装载)，初始占空比为0，定时器未启动
+ * @param  freqHz: PWM频率 (Hz)
+ * @param  resolution: 每个周期的计数值
+ * @retval 无
+ */
+void halPwmInit(uint32_t freqHz, uint16_t resolution)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+    TIM_OCInitTypeDef TIM_OCInitStructure;
+    const halPwmHw_t *hw;
+    uint8_t i;
+    
+    /* 使能GPIO与定时器时钟 */
+    RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOA | RCC_AHB1Periph_GPIOB, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2 | RCC_APB1Periph_TIM4, ENABLE);
+    
+    /* TIM2与TIM4时基相同，定时器时钟为SystemCoreClock / 2 */
+    TIM_TimeBaseStructure.TIM_Period = resolution - 1;
+    TIM_TimeBaseStructure.TIM_Prescaler = (SystemCoreClock / 2) / (freqHz * resolution) - 1;
+    TIM_TimeBaseStructure.TIM_ClockDivision = 0;
+    TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit(TIM2, &TIM_TimeBaseStructure);
+    TIM_TimeBaseInit(TIM4, &TIM_TimeBaseStructure);
+    
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_100MHz;
+    GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
+    GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_UP;
+    
+    TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_PWM1;
+    TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Enable;
+    TIM_OCInitStructure.TIM_Pulse = 0;
+    TIM_OCInitStructure.TIM_OCPolarity = TIM_OCPolarity_High;
+    
+    for (i = 0; i < HAL_PWM_CHANNEL_NUM; i++)
+    {
+        hw = &g_pwmHw[i];
+        
+        GPIO_InitStructure.GPIO_Pin = hw->pin;
+        GPIO_Init(hw->port, &GPIO_InitStructure);
+        GPIO_PinAFConfig(hw->port, hw->source, hw->af);
+        
+        switch (hw->channel)
+        {
+            case 1:
+                TIM_OC1Init(hw->tim, &TIM_OCInitStructure);
+                TIM_OC1PreloadConfig(hw->tim, TIM_OCPreload_Enable);
+                break;
+            case 2:
+                TIM_OC2Init(hw->tim, &TIM_OCInitStructure);
+                TIM_OC2PreloadConfig(hw->tim, TIM_OCPreload_Enable);
+                break;
+            case 3:
+                TIM_OC3Init(hw->tim, &TIM_OCInitStructure);
+                TIM_OC3PreloadConfig(hw->tim, TIM_OCPreload_Enable);
+                break;
+            default:
+                TIM_OC4Init(hw->tim, &TIM_OCInitStructure);
+                TIM_OC4PreloadConfig(hw->tim, TIM_OCPreload_Enable);
+                break;
+        }
+    }
+    
+    TIM_ARRPreloadConfig(TIM2, ENABLE);
+    TIM_ARRPreloadConfig(TIM4, ENABLE);
+}
+
+/**
+ * @brief  设置PWM比较值
+ * @param  channel: 通道(电机编号)
+ * @param  compare: 比较值 (0~resolution)
+ * @retval 无
+ */
+RAMFUNC void halPwmSetCompare(uint8_t channel, uint16_t compare)
+{
+    const halPwmHw_t *hw = &g_pwmHw[channel];
+    
+    /* CCR1~CCR4在TIM_TypeDef中依次相隔4字节 */
+    (&hw->tim->CCR1)[hw->channel - 1] = compare;
+}
+
+/**
+ * @brief  启动/停止PWM定时器
+ * @param  enable: 1-启动，0-停止
+ * @retval 无
+ */
+void halPwmEnable(uint8_t enable)
+{
+    TIM_Cmd(TIM2, enable ? ENABLE : DISABLE);
+    TIM_Cmd(TIM4, enable ? ENABLE : DISABLE);
+}
+
+/**
+ * @brief  外部中断初始化(输入下拉，上升沿触发)
+ * @param  line: 外部中断
+ * @param  irqPriority: 中断抢占优先级
+ * @retval 无
+ */
+void halExtiInit(halExti_e line, uint8_t irqPriority)
+{
+    const halExtiHw_t *hw = &g_extiHw[line];
+    GPIO_InitTypeDef GPIO_InitStructure;
+    EXTI_InitTypeDef EXTI_InitStructure;
+    
+    /* 配置引脚为输入 */
+    RCC_AHB1PeriphClockCmd(hw->portClock, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE);
+    
+    GPIO_InitStructure.GPIO_Pin = hw->pin;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_DOWN;
+    GPIO_Init(hw->port, &GPIO_InitStructure);
+    
+    /* 配置EXTI上升沿触发 */
+    SYSCFG_EXTILineConfig(hw->portSource, hw->pinSource);
+    EXTI_InitStructure.EXTI_Line = hw->line;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising;
+    EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&EXTI_InitStructure);
+    
+    halNvicEnable(hw->irq, irqPriority);
+}
+
+/**
+ * @brief  外部中断挂起
+ * @param  line: 外部中断
+ * @retval 1-挂起，0-无
+ */
+RAMFUNC uint8_t halExtiPending(halExti_e line)
+{
+    return EXTI_GetITStatus(g_extiHw[line].line) != RESET;
+}
+
+/**
+ * @brief  清除外部中断挂起标志
+ * @param  line: 外部中断
+ * @retval 无
+ */
+RAMFUNC void halExtiClear(halExti_e line)
+{
+    EXTI_ClearITPendingBit(g_extiHw[line].line);
+}
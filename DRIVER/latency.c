@@ -0,0 +1,100 @@
+﻿/*
+ * latency.c
+ *
+ * 中断到任务延迟测量实现
+ * 待测样本由中断写、任务读，pending为1期间中断不再改写signal；任务读取样本后清除pending，
+ * 其间到来的通知会被漏测一次，不影响统计的正确性
+ *
+ * 2026-02-26
+ */
+
+#include "latency.h"
+
+#if LATENCY_ENABLE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+volatile uint32_t g_latencyEntry[LATENCY_SRC_NUM];     // 最近一次中断入口时刻
+
+static volatile uint32_t g_signal[LATENCY_SRC_NUM];    // 待测样本的中断入口时刻
+static volatile uint8_t g_pending[LATENCY_SRC_NUM];
+static DWT_Stats_t g_stats[LATENCY_SRC_NUM];
+
+/**
+ * @brief  延迟测量初始化，需在使能相关中断前调用
+ * @param  无
+ * @retval 无
+ */
+void latencyInit(void)
+{
+    DWT_Init();
+    latencyReset();
+}
+
+/**
+ * @brief  中断中通知任务时调用，记录待测样本
+ * @param  src: 测量源
+ * @retval 无
+ */
+void latencyIsrSignal(latencySource_e src)
+{
+    if (!g_pending[src])
+    {
+        g_signal[src] = g_latencyEntry[src];
+        g_pending[src] = 1;
+    }
+}
+
+/**
+ * @brief  任务被唤醒后调用，计入一个样本
+ * @param  src: 测量源
+ * @retval 无
+ */
+void latencyTaskWake(latencySource_e src)
+{
+    uint32_t now = DWT_GetCycles();
+    
+    if (!g_pending[src])
+    {
+        return;
+    }
+    
+    taskENTER_CRITICAL();
+    DWT_StatsAdd(&g_stats[src], now - g_signal[src]);
+    g_pending[src] = 0;
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief  获取统计结果
+ * @param  src: 测量源
+ * @param  stats: 输出
+ * @retval 无
+ */
+void latencyGetStats(latencySource_e src, DWT_Stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = g_stats[src];
+    taskEXIT_CRITICAL();
+}
+
+/**
+ * @brief  清零全部统计
+ * @param  无
+ * @retval 无
+ */
+void latencyReset(void)
+{
+    uint8_t i;
+    
+    taskENTER_CRITICAL();
+    for (i = 0; i < LATENCY_SRC_NUM; i++)
+    {
+        DWT_StatsInit(&g_stats[i], LATENCY_BIN_US * (SystemCoreClock / 1000000));
+        g_pending[i] = 0;
+    }
+    taskEXIT_CRITICAL();
+}
+
+#endif /* LATENCY_ENABLE */
@@ -0,0 +1,61 @@
+﻿/*
+ * latency.h
+ *
+ * 中断到任务延迟测量头文件
+ * 中断入口用DWT周期计数打时间戳，消费该中断的任务被唤醒后再打一次，差值即为中断到任务的延迟
+ * (含中断响应、中断处理、任务切换以及被更高优先级任务/中断抢占的时间)
+ *
+ * 用法(每个源三处)：
+ *   中断入口          LATENCY_ISR_ENTRY(src)    记录入口时刻
+ *   中断中通知任务处  LATENCY_ISR_SIGNAL(src)   该次入口时刻成为待测样本(已有待测样本时保留较早的)
+ *   任务唤醒后        LATENCY_TASK_WAKE(src)    有待测样本时计入统计
+ * 一次中断不一定通知任务(如UART2每个字节都进中断、收完一帧才通知)，因此入口与通知分开记录
+ *
+ * LATENCY_ENABLE为0时以上宏为空，latency.c不编译任何代码，正式版本没有任何开销
+ *
+ * 2026-02-26
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+#ifndef LATENCY_ENABLE
+#define LATENCY_ENABLE           0           // 1: 编译延迟测量(调试版本)，可在编译选项中指定
+#endif
+#define LATENCY_BIN_US           2           // 直方图桶宽度 (us)，DWT_STATS_BINS个桶
+
+/* 测量源 */
+typedef enum {
+    LATENCY_SRC_MPU_DRDY = 0,    // MPU9250数据就绪(EXTI4) -> stabilizerTask，需STABILIZER_SYNC_IMU_DRDY
+    LATENCY_SRC_UART2_RX,        // USART2收完一帧 -> radioLinkTask
+    LATENCY_SRC_NUM,
+} latencySource_e;
+
+#if LATENCY_ENABLE
+
+#include "DWT.h"
+
+extern volatile uint32_t g_latencyEntry[LATENCY_SRC_NUM];
+
+#define LATENCY_ISR_ENTRY(src)   (g_latencyEntry[(src)] = DWT_GetCycles())
+#define LATENCY_ISR_SIGNAL(src)  latencyIsrSignal(src)
+#define LATENCY_TASK_WAKE(src)   latencyTaskWake(src)
+
+/* 函数声明 */
+void latencyInit(void);
+void latencyIsrSignal(latencySource_e src);
+void latencyTaskWake(latencySource_e src);
+void latencyGetStats(latencySource_e src, DWT_Stats_t *stats);
+void latencyReset(void);
+
+#else
+
+#define LATENCY_ISR_ENTRY(src)   ((void)0)
+#define LATENCY_ISR_SIGNAL(src)  ((void)0)
+#define LATENCY_TASK_WAKE(src)   ((void)0)
+
+#endif /* LATENCY_ENABLE */
+
+#endif /* LATENCY_H */
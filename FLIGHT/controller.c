@@ -0,0 +1,166 @@
+﻿/*
+ * controller.c
+ *
+ * 串级姿态控制器实现
+ *
+ * 2026-02-21
+ */
+
+#include "controller.h"
+#include "maths.h"
+#include "ramfunc.h"
+
+static pidBank_t g_anglePid;
+static pidBank_t g_ratePid;
+static filterBank_t g_dtermFilter;   // 角速度环微分项滤波
+static float g_rateSp[PID_AXIS_NUM]; // 最近一次的角速度设定值
+static float g_dt;
+
+static const pidGains_t g_defaultAngleGains[PID_AXIS_NUM] = {
+    {CONTROLLER_ANGLE_KP, CONTROLLER_ANGLE_KI, 0.0f, CONTROLLER_ANGLE_I_LIMIT, CONTROLLER_MAX_RATE},
+    {CONTROLLER_ANGLE_KP, CONTROLLER_ANGLE_KI, 0.0f, CONTROLLER_ANGLE_I_LIMIT, CONTROLLER_MAX_RATE},
+    {0.0f, 0.0f, 0.0f, 0.0f, 0.0f}    // 偏航不使用角度环
+};
+static const pidGains_t g_defaultRateGains[PID_AXIS_NUM] = {
+    {CONTROLLER_RATE_RP_KP, CONTROLLER_RATE_RP_KI, CONTROLLER_RATE_RP_KD, CONTROLLER_RATE_I_LIMIT, CONTROLLER_RATE_OUT_LIMIT},
+    {CONTROLLER_RATE_RP_KP, CONTROLLER_RATE_RP_KI, CONTROLLER_RATE_RP_KD, CONTROLLER_RATE_I_LIMIT, CONTROLLER_RATE_OUT_LIMIT},
+    {CONTROLLER_RATE_YAW_KP, CONTROLLER_RATE_YAW_KI, CONTROLLER_RATE_YAW_KD, CONTROLLER_RATE_I_LIMIT, CONTROLLER_RATE_OUT_LIMIT}
+};
+
+/**
+ * @brief  控制器初始化，使用controller.h中的默认参数
+ * @param  dt: 控制周期 (s)
+ * @retval 无
+ */
+void controllerInit(float dt)
+{
+    g_dt = dt;
+    
+    /* 微分项对噪声最敏感：一阶低通 + 二阶巴特沃斯低通 */
+    filterBankInit(&g_dtermFilter);
+    filterBankAddPt1(&g_dtermFilter, CONTROLLER_RATE_D_CUTOFF_HZ, 1.0f / dt);
+    filterBankAddLowpass(&g_dtermFilter, CONTROLLER_RATE_D_LPF_HZ, FILTER_BUTTERWORTH_Q, 1.0f / dt);
+    
+    controllerSetGains(g_defaultAngleGains, g_defaultRateGains);
+}
+
+/**
+ * @brief  读取默认PID参数
+ * @param  angleGains: 输出角度环参数(PID_AXIS_NUM个)，可为0
+ * @param  rateGains: 输出角速度环参数(PID_AXIS_NUM个)，可为0
+ * @retval 无
+ */
+void controllerGetDefaultGains(pidGains_t *angleGains, pidGains_t *rateGains)
+{
+    uint8_t i;
+    
+    for (i = 0; i < PID_AXIS_NUM; i++)
+    {
+        if (angleGains)
+        {
+            angleGains[i] = g_defaultAngleGains[i];
+        }
+        if (rateGains)
+        {
+            rateGains[i] = g_defaultRateGains[i];
+        }
+    }
+}
+
+/**
+ * @brief  设置PID参数并清零状态(用于调参与SIL参数扫描)
+ * @param  angleGains: 角度环参数(PID_AXIS_NUM个)
+ * @param  rateGains: 角速度环参数(PID_AXIS_NUM个)
+ * @retval 无
+ * @note   需在controllerInit之后、控制循环之外调用
+ */
+void controllerSetGains(const pidGains_t *angleGains, const pidGains_t *rateGains)
+{
+    pidBankInit(&g_anglePid, angleGains, 0.0f, g_dt);
+    pidBankInit(&g_ratePid, rateGains, 0.0f, g_dt);
+    pidBankSetDtermFilter(&g_ratePid, &g_dtermFilter);
+}
+
+/**
+ * @brief  清零积分与微分状态
+ * @param  无
+ * @retval 无
+ */
+void controllerReset(void)
+{
+    pidBankReset(&g_anglePid);
+    pidBankReset(&g_ratePid);
+}
+
+/**
+ * @brief  计算油门PID衰减系数
+ * @param  thrust: 油门 (0~1)
+ * @retval P/D缩放系数
+ */
+static float controllerTpa(float thrust)
+{
+    if (thrust <= CONTROLLER_TPA_BREAKPOINT)
+    {
+        return 1.0f;
+    }
+    
+    return 1.0f - CONTROLLER_TPA_RATE * (thrust - CONTROLLER_TPA_BREAKPOINT) / (1.0f - CONTROLLER_TPA_BREAKPOINT);
+}
+
+/**
+ * @brief  控制器更新
+ * @param  sp: 设定值
+ * @param  angle: 姿态角[roll, pitch, yaw] (deg)
+ * @param  gyro: 角速度[x, y, z] (deg/s)
+ * @param  out: 控制输出
+ * @retval 无
+ */
+RAMFUNC void controllerUpdate(const setpoint_t *sp, const float *angle, const float *gyro, control_t *out)
+{
+    float angleSp[PID_AXIS_NUM];
+    float *rateSp = g_rateSp;
+    float torque[PID_AXIS_NUM];
+    float thrust = constrainf(sp->thrust, 0.0f, 1.0f);
+    uint8_t flying = thrust >= CONTROLLER_MIN_THRUST;
+    
+    /* 未起飞时积分清零，避免地面上累积 */
+    if (!flying)
+    {
+        controllerReset();
+    }
+    
+    /* 外环：角度误差 -> 角速度设定值 */
+    angleSp[PID_ROLL] = constrainf(sp->roll, -CONTROLLER_MAX_ANGLE, CONTROLLER_MAX_ANGLE);
+    angleSp[PID_PITCH] = constrainf(sp->pitch, -CONTROLLER_MAX_ANGLE, CONTROLLER_MAX_ANGLE);
+    angleSp[PID_YAW] = angle[PID_YAW];
+    pidBankUpdate(&g_anglePid, angleSp, angle, 1.0f, flying, rateSp);
+    
+    /* 偏航直接使用遥控给出的角速度 */
+    rateSp[PID_YAW] = constrainf(sp->yawRate, -CONTROLLER_MAX_YAW_RATE, CONTROLLER_MAX_YAW_RATE);
+    
+    /* 内环：角速度误差 -> 力矩 */
+    pidBankUpdate(&g_ratePid, rateSp, gyro, controllerTpa(thrust), flying, torque);
+    
+    out->roll = torque[PID_ROLL];
+    out->pitch = torque[PID_PITCH];
+    out->yaw = torque[PID_YAW];
+    out->thrust = thrust;
+}
+
+/**
+ * @brief  读取最近一次更新的角速度环设定值与P/I/D各项
+ * @param  terms: 输出
+ * @retval 无
+ */
+RAMFUNC void controllerGetRateTerms(controllerRateTerms_t *terms)
+{
+    uint8_t i;
+    
+    for (i = 0; i < PID_AXIS_NUM; i++)
+    {
+        terms->rateSp[i] = g_rateSp[i];
+        terms->p[i] = g_ratePid.pTerm[i];
+        terms->i[i] = g_ratePid.integ[i];
+        terms->d[i] = g_ratePid.dTerm[i];
+    }
+}
@@ -0,0 +1,78 @@
+﻿/*
+ * controller.h
+ *
+ * 串级姿态控制器头文件
+ * 外环角度P(横滚/俯仰) -> 内环角速度PID(三轴)，偏航只有角速度环
+ * 输出为归一化的三轴力矩与油门，由电机混控转换为各电机占空比
+ *
+ * 2026-02-21
+ */
+
+#ifndef CONTROLLER_H
+#define CONTROLLER_H
+
+#include <stdint.h>
+#include "pid.h"
+
+/* 设定值限幅 */
+#define CONTROLLER_MAX_ANGLE           30.0f     // 最大倾角 (deg)
+#define CONTROLLER_MAX_RATE            300.0f    // 角度环输出的最大角速度 (deg/s)
+#define CONTROLLER_MAX_YAW_RATE        200.0f    // 最大偏航角速度 (deg/s)
+
+/* 角度环(P) */
+#define CONTROLLER_ANGLE_KP            6.0f      // (deg/s)/deg
+#define CONTROLLER_ANGLE_KI            0.0f
+#define CONTROLLER_ANGLE_I_LIMIT       0.0f
+
+/* 角速度环，输入deg/s，输出为归一化力矩 */
+#define CONTROLLER_RATE_RP_KP          0.0025f
+#define CONTROLLER_RATE_RP_KI          0.02f
+#define CONTROLLER_RATE_RP_KD          0.00004f
+#define CONTROLLER_RATE_YAW_KP         0.004f
+#define CONTROLLER_RATE_YAW_KI         0.02f
+#define CONTROLLER_RATE_YAW_KD         0.0f
+#define CONTROLLER_RATE_I_LIMIT        0.15f
+#define CONTROLLER_RATE_OUT_LIMIT      0.5f
+#define CONTROLLER_RATE_D_CUTOFF_HZ    80.0f     // 微分项一阶低通截止频率
+#define CONTROLLER_RATE_D_LPF_HZ       120.0f    // 微分项二阶低通截止频率
+
+/* 油门PID衰减(TPA)：油门超过拐点后P/D线性衰减，满油门时衰减CONTROLLER_TPA_RATE */
+#define CONTROLLER_TPA_BREAKPOINT      0.5f
+#define CONTROLLER_TPA_RATE            0.3f
+
+/* 油门低于该值视为未起飞，积分清零 */
+#define CONTROLLER_MIN_THRUST          0.1f
+
+/* 设定值(来自遥控) */
+typedef struct {
+    float roll;        // 横滚角 (deg)
+    float pitch;       // 俯仰角 (deg)
+    float yawRate;     // 偏航角速度 (deg/s)
+    float thrust;      // 油门 (0~1)
+} setpoint_t;
+
+/* 控制输出 */
+typedef struct {
+    float roll;        // 横滚力矩 (-0.5~0.5)
+    float pitch;       // 俯仰力矩 (-0.5~0.5)
+    float yaw;         // 偏航力矩 (-0.5~0.5)
+    float thrust;      // 油门 (0~1)
+} control_t;
+
+/* 角速度环各项(最近一次更新)，供黑匣子记录 */
+typedef struct {
+    float rateSp[PID_AXIS_NUM];    // 角速度设定值 (deg/s)
+    float p[PID_AXIS_NUM];         // P项
+    float i[PID_AXIS_NUM];         // I项
+    float d[PID_AXIS_NUM];         // D项
+} controllerRateTerms_t;
+
+/* 函数声明 */
+void controllerInit(float dt);
+void controllerGetDefaultGains(pidGains_t *angleGains, pidGains_t *rateGains);
+void controllerSetGains(const pidGains_t *angleGains, const pidGains_t *rateGains);
+void controllerReset(void);
+void controllerUpdate(const setpoint_t *sp, const float *angle, const float *gyro, control_t *out);
+void controllerGetRateTerms(controllerRateTerms_t *terms);
+
+#endif /* CONTROLLER_H */
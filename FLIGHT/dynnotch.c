@@ -0,0 +1,372 @@
+﻿/*
+ * dynnotch.c
+ *
+ * 动态陷波实现
+ * 基2按时间抽取FFT，蝶形运算按线性序号逐个推进，可在任意位置暂停；
+ * 峰值位置用相邻三个频点的抛物线插值细化到小于一个频点
+ *
+ * 2026-02-23
+ */
+
+#include "dynnotch.h"
+#include "filter.h"
+#include "maths.h"
+#include "ramfunc.h"
+
+#define DYN_NOTCH_FFT_MASK         (DYN_NOTCH_FFT_SIZE - 1)
+#define DYN_NOTCH_BUTTERFLIES      (DYN_NOTCH_FFT_SIZE / 2 * DYN_NOTCH_FFT_BITS)
+
+/* 分析步骤 */
+#define DYN_NOTCH_STEP_WINDOW      0
+#define DYN_NOTCH_STEP_FFT         1
+#define DYN_NOTCH_STEP_PEAKS       2
+#define DYN_NOTCH_STEP_UPDATE      3
+
+static float g_sampleHz;
+static float g_binHz;
+static uint8_t g_minBin;
+static uint8_t g_maxBin;
+
+/* 采样环形缓冲区(三轴共用写位置) */
+static float g_ring[DYN_NOTCH_AXIS_NUM][DYN_NOTCH_FFT_SIZE];
+static uint8_t g_ringPos;
+
+/* FFT工作区与常量表 */
+static float g_re[DYN_NOTCH_FFT_SIZE];
+static float g_im[DYN_NOTCH_FFT_SIZE];
+static float g_window[DYN_NOTCH_FFT_SIZE];
+static float g_cos[DYN_NOTCH_FFT_SIZE / 2];
+static float g_sin[DYN_NOTCH_FFT_SIZE / 2];
+static uint8_t g_bitrev[DYN_NOTCH_FFT_SIZE];
+
+/* 分析状态 */
+static uint8_t g_step;
+static uint8_t g_axis;
+static uint16_t g_butterfly;
+static float g_peakHz[DYN_NOTCH_COUNT];
+static uint8_t g_peakCount;
+
+/* 陷波(各轴系数独立)，中心频率为0表示尚未找到峰值，该级直通 */
+static float g_center[DYN_NOTCH_AXIS_NUM][DYN_NOTCH_COUNT];
+static float g_coeffs[DYN_NOTCH_AXIS_NUM][DYN_NOTCH_COUNT * FILTER_COEFFS_PER_STAGE];
+static float g_state[DYN_NOTCH_AXIS_NUM][DYN_NOTCH_COUNT * FILTER_STATE_PER_STAGE];
+
+/**
+ * @brief  动态陷波初始化
+ * @param  sampleHz: 陀螺仪采样频率(控制频率) (Hz)
+ * @retval 无
+ */
+void dynNotchInit(float sampleHz)
+{
+    uint16_t i;
+    uint8_t b, r, axis, k;
+    float maxBin;
+    
+    g_sampleHz = sampleHz;
+    g_binHz = sampleHz / DYN_NOTCH_FFT_SIZE;
+    
+    /* 搜索范围两侧各留一个频点用于插值 */
+    g_minBin = (uint8_t)(DYN_NOTCH_MIN_HZ / g_binHz);
+    if (g_minBin < 2)
+    {
+        g_minBin = 2;
+    }
+    maxBin = DYN_NOTCH_MAX_HZ / g_binHz;
+    g_maxBin = maxBin > DYN_NOTCH_FFT_SIZE / 2 - 2 ? DYN_NOTCH_FFT_SIZE / 2 - 2 : (uint8_t)maxBin;
+    
+    for (i = 0; i < DYN_NOTCH_FFT_SIZE; i++)
+    {
+        /* 汉宁窗 */
+        g_window[i] = 0.5f - 0.5f * cosf(2.0f * M_PI_F * i / DYN_NOTCH_FFT_SIZE);
+        
+        r = 0;
+        for (b = 0; b < DYN_NOTCH_FFT_BITS; b++)
+        {
+            r |= ((i >> b) & 1) << (DYN_NOTCH_FFT_BITS - 1 - b);
+        }
+        g_bitrev[i] = r;
+    }
+    for (i = 0; i < DYN_NOTCH_FFT_SIZE / 2; i++)
+    {
+        g_cos[i] = cosf(2.0f * M_PI_F * i / DYN_NOTCH_FFT_SIZE);
+        g_sin[i] = sinf(2.0f * M_PI_F * i / DYN_NOTCH_FFT_SIZE);
+    }
+    
+    for (axis = 0; axis < DYN_NOTCH_AXIS_NUM; axis++)
+    {
+        for (i = 0; i < DYN_NOTCH_FFT_SIZE; i++)
+        {
+            g_ring[axis][i] = 0.0f;
+        }
+        for (k = 0; k < DYN_NOTCH_COUNT; k++)
+        {
+            g_center[axis][k] = 0.0f;
+            filterBypassCoeffs(&g_coeffs[axis][k * FILTER_COEFFS_PER_STAGE]);
+        }
+        for (i = 0; i < DYN_NOTCH_COUNT * FILTER_STATE_PER_STAGE; i++)
+        {
+            g_state[axis][i] = 0.0f;
+        }
+    }
+    
+    g_ringPos = 0;
+    g_step = DYN_NOTCH_STEP_WINDOW;
+    g_axis = 0;
+    g_butterfly = 0;
+}
+
+/**
+ * @brief  取出当前轴最近FFT_SIZE个样本，加窗后按位反转顺序放入工作区
+ * @param  无
+ * @retval 无
+ */
+static void dynNotchWindow(void)
+{
+    const float *src = g_ring[g_axis];
+    uint16_t i;
+    
+    /* g_ringPos指向最旧的样本 */
+    for (i = 0; i < DYN_NOTCH_FFT_SIZE; i++)
+    {
+        g_re[g_bitrev[i]] = src[(g_ringPos + i) & DYN_NOTCH_FFT_MASK] * g_window[i];
+        g_im[g_bitrev[i]] = 0.0f;
+    }
+}
+
+/**
+ * @brief  执行若干个蝶形运算
+ * @param  count: 本次执行的个数
+ * @retval 1-FFT已完成，0-未完成
+ */
+RAMFUNC static uint8_t dynNotchButterflies(uint16_t count)
+{
+    uint16_t b, k, i, j, half, tw;
+    uint8_t stage;
+    float wr, wi, tr, ti;
+    
+    while (count-- && g_butterfly < DYN_NOTCH_BUTTERFLIES)
+    {
+        /* 线性序号 -> (级, 组, 组内位置) */
+        b = g_butterfly++;
+        stage = (uint8_t)(b / (DYN_NOTCH_FFT_SIZE / 2));
+        k = b % (DYN_NOTCH_FFT_SIZE / 2);
+        half = (uint16_t)1 << stage;
+        j = k & (half - 1);
+        i = (uint16_t)(((k >> stage) << (stage + 1)) + j);
+        tw = (uint16_t)(j << (DYN_NOTCH_FFT_BITS - 1 - stage));
+        
+        wr = g_cos[tw];
+        wi = -g_sin[tw];
+        tr = wr * g_re[i + half] - wi * g_im[i + half];
+        ti = wr * g_im[i + half] + wi * g_re[i + half];
+        g_re[i + half] = g_re[i] - tr;
+        g_im[i + half] = g_im[i] - ti;
+        g_re[i] += tr;
+        g_im[i] += ti;
+    }
+    
+    return g_butterfly >= DYN_NOTCH_BUTTERFLIES;
+}
+
+/**
+ * @brief  在搜索范围内找最强的DYN_NOTCH_COUNT个峰，结果按频率升序
+ * @param  无
+ * @retval 无
+ */
+static void dynNotchFindPeaks(void)
+{
+    float *mag = g_re;   // 功率谱原地写回实部
+    float peakMag[DYN_NOTCH_COUNT];
+    float sum = 0.0f;
+    float threshold, denom, delta, tmp;
+    uint8_t b, k, n;
+    
+    for (b = g_minBin - 1; b <= g_maxBin + 1; b++)
+    {
+        mag[b] = g_re[b] * g_re[b] + g_im[b] * g_im[b];
+    }
+    for (b = g_minBin; b <= g_maxBin; b++)
+    {
+        sum += mag[b];
+    }
+    threshold = DYN_NOTCH_THRESHOLD * sum / (g_maxBin - g_minBin + 1);
+    
+    /* 局部极大值按幅值插入排序 */
+    g_peakCount = 0;
+    for (b = g_minBin; b <= g_maxBin; b++)
+    {
+        if (mag[b] <= threshold || mag[b] <= mag[b - 1] || mag[b] < mag[b + 1])
+        {
+            continue;
+        }
+        
+        if (g_peakCount < DYN_NOTCH_COUNT)
+        {
+            n = g_peakCount++;
+        }
+        else if (mag[b] > peakMag[DYN_NOTCH_COUNT - 1])
+        {
+            n = DYN_NOTCH_COUNT - 1;
+        }
+        else
+        {
+            continue;
+        }
+        while (n > 0 && peakMag[n - 1] < mag[b])
+        {
+            peakMag[n] = peakMag[n - 1];
+            g_peakHz[n] = g_peakHz[n - 1];
+            n--;
+        }
+        
+        denom = mag[b - 1] - 2.0f * mag[b] + mag[b + 1];
+        delta = denom != 0.0f ? 0.5f * (mag[b - 1] - mag[b + 1]) / denom : 0.0f;
+        peakMag[n] = mag[b];
+        g_peakHz[n] = ((float)b + delta) * g_binHz;
+    }
+    
+    /* 按频率升序，便于与已有陷波一一对应 */
+    for (k = 1; k < g_peakCount; k++)
+    {
+        for (n = k; n > 0 && g_peakHz[n - 1] > g_peakHz[n]; n--)
+        {
+            tmp = g_peakHz[n];
+            g_peakHz[n] = g_peakHz[n - 1];
+            g_peakHz[n - 1] = tmp;
+        }
+    }
+}
+
+/**
+ * @brief  用找到的峰更新当前轴的陷波，没有找到峰的陷波保持原频率
+ * @param  无
+ * @retval 无
+ */
+static void dynNotchRetune(void)
+{
+    float *center = g_center[g_axis];
+    float dist, best;
+    uint8_t used[DYN_NOTCH_COUNT] = {0};
+    uint8_t p, k, slot;
+    
+    for (p = 0; p < g_peakCount; p++)
+    {
+        /* 对应到中心频率最接近的陷波，未启用的陷波优先级最低 */
+        slot = DYN_NOTCH_COUNT;
+        best = 0.0f;
+        for (k = 0; k < DYN_NOTCH_COUNT; k++)
+        {
+            if (used[k])
+            {
+                continue;
+            }
+            dist = center[k] > 0.0f ? fabsf(center[k] - g_peakHz[p]) : g_sampleHz;
+            if (slot == DYN_NOTCH_COUNT || dist < best)
+            {
+                slot = k;
+                best = dist;
+            }
+        }
+        
+        used[slot] = 1;
+        if (center[slot] > 0.0f)
+        {
+            center[slot] += DYN_NOTCH_SMOOTH * (g_peakHz[p] - center[slot]);
+        }
+        else
+        {
+            center[slot] = g_peakHz[p];
+        }
+        filterNotchCoeffs(&g_coeffs[g_axis][slot * FILTER_COEFFS_PER_STAGE], center[slot], DYN_NOTCH_Q, g_sampleHz);
+    }
+}
+
+/**
+ * @brief  每次控制循环调用一次：记录陀螺仪样本并推进一步分析
+ * @param  gyro: 低通之前的三轴角速度
+ * @retval 无
+ */
+void dynNotchUpdate(const float *gyro)
+{
+    uint8_t axis;
+    
+    for (axis = 0; axis < DYN_NOTCH_AXIS_NUM; axis++)
+    {
+        g_ring[axis][g_ringPos] = gyro[axis];
+    }
+    g_ringPos = (g_ringPos + 1) & DYN_NOTCH_FFT_MASK;
+    
+    switch (g_step)
+    {
+        case DYN_NOTCH_STEP_WINDOW:
+            dynNotchWindow();
+            g_butterfly = 0;
+            g_step = DYN_NOTCH_STEP_FFT;
+            break;
+        case DYN_NOTCH_STEP_FFT:
+            if (dynNotchButterflies(DYN_NOTCH_BUTTERFLIES_PER_STEP))
+            {
+                g_step = DYN_NOTCH_STEP_PEAKS;
+            }
+            break;
+        case DYN_NOTCH_STEP_PEAKS:
+            dynNotchFindPeaks();
+            g_step = DYN_NOTCH_STEP_UPDATE;
+            break;
+        default:
+            dynNotchRetune();
+            g_axis = (g_axis + 1) % DYN_NOTCH_AXIS_NUM;
+            g_step = DYN_NOTCH_STEP_WINDOW;
+            break;
+    }
+}
+
+/**
+ * @brief  三轴动态陷波滤波
+ * @param  xyz: 三轴输入，原地输出
+ * @retval 无
+ */
+RAMFUNC void dynNotchApply(float *xyz)
+{
+    uint8_t axis;
+    
+    for (axis = 0; axis < DYN_NOTCH_AXIS_NUM; axis++)
+    {
+        xyz[axis] = filterCascadeApply(g_coeffs[axis], g_state[axis], DYN_NOTCH_COUNT, xyz[axis]);
+    }
+}
+
+/**
+ * @brief  获取陷波中心频率
+ * @param  axis: 轴
+ * @param  notch: 陷波序号
+ * @retval 中心频率 (Hz)，0表示尚未启用
+ */
+float dynNotchGetCenter(uint8_t axis, uint8_t notch)
+{
+    return g_center[axis][notch];
+}
+
+/**
+ * @brief  读取最近一次找峰使用的功率谱(调试与主机测试用)
+ * @param  power: 输出DYN_NOTCH_FFT_SIZE / 2个频点的功率，搜索范围(含两侧插值频点)之外为0
+ * @param  axis: 输出所属的轴
+ * @retval 1-成功，0-当前不在找峰之后(功率谱只在找峰与更新系数之间的一次迭代内有效)
+ */
+uint8_t dynNotchGetSpectrum(float *power, uint8_t *axis)
+{
+    uint8_t b;
+    
+    if (g_step != DYN_NOTCH_STEP_UPDATE)
+    {
+        return 0;
+    }
+    
+    for (b = 0; b < DYN_NOTCH_FFT_SIZE / 2; b++)
+    {
+        power[b] = (b >= g_minBin - 1 && b <= g_maxBin + 1) ? g_re[b] : 0.0f;
+    }
+    *axis = g_axis;
+    
+    return 1;
+}
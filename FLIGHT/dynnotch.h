@@ -0,0 +1,38 @@
+﻿/*
+ * dynnotch.h
+ *
+ * 动态陷波头文件
+ * 对未经低通的陀螺仪做滑动窗口FFT，跟踪各轴最强的几个共振峰并实时调整陷波中心频率
+ *
+ * FFT计算拆分到多次控制循环中完成，每次dynNotchUpdate只做一小步：
+ * 加窗(1步) -> 蝶形运算(每步DYN_NOTCH_BUTTERFLIES_PER_STEP个) -> 找峰(1步) -> 更新系数(1步)，
+ * 三个轴轮流分析
+ *
+ * 2026-02-23
+ */
+
+#ifndef DYNNOTCH_H
+#define DYNNOTCH_H
+
+#include <stdint.h>
+
+#define DYN_NOTCH_AXIS_NUM         3
+#define DYN_NOTCH_FFT_BITS         7
+#define DYN_NOTCH_FFT_SIZE         (1 << DYN_NOTCH_FFT_BITS)   // 128点，1kHz采样时分辨率7.8Hz
+#define DYN_NOTCH_BUTTERFLIES_PER_STEP 32                      // 每次迭代的蝶形运算数(约3us@100MHz)
+
+#define DYN_NOTCH_COUNT            2         // 每轴陷波个数(跟踪的峰数)
+#define DYN_NOTCH_MIN_HZ           80.0f     // 峰值搜索下限
+#define DYN_NOTCH_MAX_HZ           400.0f    // 峰值搜索上限
+#define DYN_NOTCH_Q                3.0f      // 陷波品质因数
+#define DYN_NOTCH_THRESHOLD        8.0f      // 峰值需超过搜索范围内平均能量的倍数(白噪声误检概率约0.03%/频点)
+#define DYN_NOTCH_SMOOTH           0.3f      // 中心频率平滑系数(每次分析)
+
+/* 函数声明 */
+void dynNotchInit(float sampleHz);
+void dynNotchUpdate(const float *gyro);
+void dynNotchApply(float *xyz);
+float dynNotchGetCenter(uint8_t axis, uint8_t notch);
+uint8_t dynNotchGetSpectrum(float *power, uint8_t *axis);
+
+#endif /* DYNNOTCH_H */
@@ -0,0 +1,558 @@
+﻿/*
+ * ekf.c
+ *
+ * 乘性扩展卡尔曼滤波(MEKF)实现
+ * 名义四元数负责积分，滤波器只估计小角度误差，每组观测更新后把误差注入名义状态并清零；
+ * 观测拆为标量后逐个更新(S为标量，只需一次除法)，协方差按上三角压缩存储
+ *
+ * 全部使用单精度运算，不依赖任何硬件，可与主机程序一起编译用于离线回放
+ *
+ * 2026-02-20
+ */
+
+#include "ekf.h"
+#include "maths.h"
+
+/* 协方差对角元下限，防止舍入误差使其失去正定性 */
+#define EKF_P_MIN                  1.0e-12f
+
+/* 压缩存储下标(要求i <= j) */
+#define EKF_P_IDX(i, j)            (g_rowStart[i] + (j) - (i))
+
+/* 状态转移矩阵F的稀疏行(每行最多4个非零元) */
+typedef struct {
+    uint8_t n;
+    uint8_t col[4];
+    float val[4];
+} ekfRow_t;
+
+/* 上三角第i行在压缩数组中的起始位置 */
+static const uint8_t g_rowStart[EKF_STATE_NUM] = {0, 9, 17, 24, 30, 35, 39, 42, 44};
+
+/* 名义状态 */
+static float q0 = 1.0f;
+static float q1 = 0.0f;
+static float q2 = 0.0f;
+static float q3 = 0.0f;
+static float g_gyroBias[3];     // 陀螺仪零偏 (rad/s)
+static float g_height;          // 相对起飞点高度 (m，向上为正)
+static float g_velocity;        // 垂直速度 (m/s)
+static float g_accBias;         // 垂直加速度零偏 (m/s^2)
+
+/* 误差状态与协方差 */
+static float g_dx[EKF_STATE_NUM];
+static float g_P[EKF_COV_SIZE];
+static float g_work[EKF_STATE_NUM][EKF_STATE_NUM];  // 协方差传播中间结果F*P
+
+static uint8_t g_attAligned;    // 已用加速度计初始化横滚/俯仰
+static uint8_t g_magAligned;    // 已用磁力计初始化偏航
+static uint8_t g_baroRefSet;    // 已记录起飞点气压高度
+static float g_baroRef;
+
+static ekfStats_t g_stats;
+
+/**
+ * @brief  读取协方差元素
+ * @param  i,j: 行列下标
+ * @retval P(i,j)
+ */
+static __inline float ekfGetP(uint8_t i, uint8_t j)
+{
+    return i <= j ? g_P[EKF_P_IDX(i, j)] : g_P[EKF_P_IDX(j, i)];
+}
+
+/**
+ * @brief  名义四元数右乘小旋转(机体系)并归一化
+ * @param  dx,dy,dz: 半角向量 (rad)
+ * @retval 无
+ */
+static void ekfRotateBody(float dx, float dy, float dz)
+{
+    float n0 = q0 - q1 * dx - q2 * dy - q3 * dz;
+    float n1 = q1 + q0 * dx + q2 * dz - q3 * dy;
+    float n2 = q2 + q0 * dy - q1 * dz + q3 * dx;
+    float n3 = q3 + q0 * dz + q1 * dy - q2 * dx;
+    float recipNorm = invSqrt(n0 * n0 + n1 * n1 + n2 * n2 + n3 * n3);
+    
+    q0 = n0 * recipNorm;
+    q1 = n1 * recipNorm;
+    q2 = n2 * recipNorm;
+    q3 = n3 * recipNorm;
+}
+
+/**
+ * @brief  名义四元数绕地理系Z轴左乘旋转并归一化
+ * @param  angle: 旋转角 (rad)
+ * @retval 无
+ */
+static void ekfRotateYaw(float angle)
+{
+    float a0 = cosf(0.5f * angle);
+    float a3 = sinf(0.5f * angle);
+    float n0 = a0 * q0 - a3 * q3;
+    float n1 = a0 * q1 - a3 * q2;
+    float n2 = a0 * q2 + a3 * q1;
+    float n3 = a0 * q3 + a3 * q0;
+    float recipNorm = invSqrt(n0 * n0 + n1 * n1 + n2 * n2 + n3 * n3);
+    
+    q0 = n0 * recipNorm;
+    q1 = n1 * recipNorm;
+    q2 = n2 * recipNorm;
+    q3 = n3 * recipNorm;
+}
+
+/**
+ * @brief  计算旋转矩阵(机体系到地理系)第3行，即地理系Z轴在机体系中的表示
+ * @param  r: 输出[R20, R21, R22]
+ * @retval 无
+ */
+static void ekfGravityRow(float *r)
+{
+    r[0] = 2.0f * (q1 * q3 - q0 * q2);
+    r[1] = 2.0f * (q2 * q3 + q0 * q1);
+    r[2] = 1.0f - 2.0f * (q1 * q1 + q2 * q2);
+}
+
+/**
+ * @brief  协方差传播 P = (I + F*dt) P (I + F*dt)' + Q*dt
+ * @param  F: 稀疏行形式的F*dt
+ * @param  qDiag: 过程噪声Q*dt对角元
+ * @retval 无
+ */
+static void ekfPredictCovariance(const ekfRow_t *F, const float *qDiag)
+{
+    uint8_t i, j, k;
+    float t;
+    float *p;
+    
+    /* g_work = (I + F*dt) * P */
+    for (i = 0; i < EKF_STATE_NUM; i++)
+    {
+        for (j = 0; j < EKF_STATE_NUM; j++)
+        {
+            t = ekfGetP(i, j);
+            for (k = 0; k < F[i].n; k++)
+            {
+                t += F[i].val[k] * ekfGetP(F[i].col[k], j);
+            }
+            g_work[i][j] = t;
+        }
+    }
+    
+    /* P = g_work * (I + F*dt)' + Q*dt，结果对称，只算上三角 */
+    p = g_P;
+    for (i = 0; i < EKF_STATE_NUM; i++)
+    {
+        for (j = i; j < EKF_STATE_NUM; j++)
+        {
+            t = g_work[i][j];
+            for (k = 0; k < F[j].n; k++)
+            {
+                t += F[j].val[k] * g_work[i][F[j].col[k]];
+            }
+            if (i == j)
+            {
+                t += qDiag[i];
+            }
+            *p++ = t;
+        }
+    }
+}
+
+/**
+ * @brief  标量观测更新(结果累加到误差状态g_dx，调用者负责注入)
+ * @param  col: 观测矩阵H非零元所在列
+ * @param  h: 观测矩阵H非零元
+ * @param  n: 非零元个数
+ * @param  residual: 观测值 - 名义状态预测值
+ * @param  variance: 观测噪声方差
+ * @retval 1-已更新，0-新息超出门限被拒绝
+ */
+static uint8_t ekfScalarUpdate(const uint8_t *col, const float *h, uint8_t n,
+                               float residual, float variance)
+{
+    float pht[EKF_STATE_NUM];
+    float s = variance;
+    float innov = residual;
+    float recipS, gain;
+    float *p;
+    uint8_t i, j, k;
+    
+    /* P*H' */
+    for (i = 0; i < EKF_STATE_NUM; i++)
+    {
+        pht[i] = 0.0f;
+        for (k = 0; k < n; k++)
+        {
+            pht[i] += ekfGetP(i, col[k]) * h[k];
+        }
+    }
+    
+    /* S = H*P*H' + R，新息扣除本组之前观测已累积的误差状态 */
+    for (k = 0; k < n; k++)
+    {
+        s += h[k] * pht[col[k]];
+        innov -= h[k] * g_dx[col[k]];
+    }
+    
+    if (innov * innov > EKF_INNOVATION_GATE * EKF_INNOVATION_GATE * s)
+    {
+        g_stats.rejected++;
+        return 0;
+    }
+    
+    /* K = P*H'/S，dx += K*innov，P -= K*(P*H')' */
+    recipS = 1.0f / s;
+    p = g_P;
+    for (i = 0; i < EKF_STATE_NUM; i++)
+    {
+        gain = pht[i] * recipS;
+        g_dx[i] += gain * innov;
+        for (j = i; j < EKF_STATE_NUM; j++)
+        {
+            *p++ -= gain * pht[j];
+        }
+    }
+    
+    for (i = 0; i < EKF_STATE_NUM; i++)
+    {
+        if (g_P[EKF_P_IDX(i, i)] < EKF_P_MIN)
+        {
+            g_P[EKF_P_IDX(i, i)] = EKF_P_MIN;
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief  误差状态注入名义状态并清零
+ * @param  无
+ * @retval 无
+ */
+static void ekfInject(void)
+{
+    uint8_t i;
+    
+    ekfRotateBody(0.5f * g_dx[EKF_ATT_X], 0.5f * g_dx[EKF_ATT_Y], 0.5f * g_dx[EKF_ATT_Z]);
+    g_gyroBias[0] += g_dx[EKF_BIAS_X];
+    g_gyroBias[1] += g_dx[EKF_BIAS_Y];
+    g_gyroBias[2] += g_dx[EKF_BIAS_Z];
+    g_height += g_dx[EKF_POS_Z];
+    g_velocity += g_dx[EKF_VEL_Z];
+    g_accBias += g_dx[EKF_ACC_BIAS_Z];
+    
+    for (i = 0; i < EKF_STATE_NUM; i++)
+    {
+        g_dx[i] = 0.0f;
+    }
+}
+
+/**
+ * @brief  EKF初始化
+ * @param  无
+ * @retval 无
+ */
+void ekfInit(void)
+{
+    static const float initStd[EKF_STATE_NUM] = {
+        EKF_INIT_ATT_STD, EKF_INIT_ATT_STD, EKF_INIT_ATT_STD,
+        EKF_INIT_BIAS_STD, EKF_INIT_BIAS_STD, EKF_INIT_BIAS_STD,
+        EKF_INIT_POS_STD, EKF_INIT_VEL_STD, EKF_INIT_ACC_BIAS_STD
+    };
+    uint8_t i;
+    
+    q0 = 1.0f;
+    q1 = 0.0f;
+    q2 = 0.0f;
+    q3 = 0.0f;
+    g_gyroBias[0] = 0.0f;
+    g_gyroBias[1] = 0.0f;
+    g_gyroBias[2] = 0.0f;
+    g_height = 0.0f;
+    g_velocity = 0.0f;
+    g_accBias = 0.0f;
+    
+    for (i = 0; i < EKF_COV_SIZE; i++)
+    {
+        g_P[i] = 0.0f;
+    }
+    for (i = 0; i < EKF_STATE_NUM; i++)
+    {
+        g_dx[i] = 0.0f;
+        g_P[EKF_P_IDX(i, i)] = initStd[i] * initStd[i];
+    }
+    
+    g_attAligned = 0;
+    g_magAligned = 0;
+    g_baroRefSet = 0;
+    g_baroRef = 0.0f;
+    
+    g_stats.accUpdates = 0;
+    g_stats.magUpdates = 0;
+    g_stats.baroUpdates = 0;
+    g_stats.rejected = 0;
+}
+
+/**
+ * @brief  时间更新：名义状态积分与协方差传播
+ * @param  gx,gy,gz: 角速度 (deg/s)
+ * @param  ax,ay,az: 加速度 (g)
+ * @param  dt: 时间间隔 (s)
+ * @retval 无
+ */
+void ekfPredict(float gx, float gy, float gz, float ax, float ay, float az, float dt)
+{
+    ekfRow_t F[EKF_STATE_NUM];
+    float qDiag[EKF_STATE_NUM];
+    float r[3];
+    float wx, wy, wz, accZ, g;
+    uint8_t i;
+    
+    wx = gx * DEG2RAD - g_gyroBias[0];
+    wy = gy * DEG2RAD - g_gyroBias[1];
+    wz = gz * DEG2RAD - g_gyroBias[2];
+    
+    /* 垂直通道：比力转到地理系后扣除重力 */
+    ekfGravityRow(r);
+    accZ = (r[0] * ax + r[1] * ay + r[2] * az) * EKF_GRAVITY - EKF_GRAVITY - g_accBias;
+    g_height += (g_velocity + 0.5f * accZ * dt) * dt;
+    g_velocity += accZ * dt;
+    
+    /*
+     * F*dt的非零元：
+     * d(dtheta)/dt = -[w]x * dtheta - dbias
+     * d(dz)/dt     = dvz
+     * d(dvz)/dt    = -g * (r x a) * dtheta - dbaz，r为R第3行
+     */
+    F[0].n = 3; F[0].col[0] = 1; F[0].val[0] =  wz * dt; F[0].col[1] = 2; F[0].val[1] = -wy * dt; F[0].col[2] = 3; F[0].val[2] = -dt;
+    F[1].n = 3; F[1].col[0] = 0; F[1].val[0] = -wz * dt; F[1].col[1] = 2; F[1].val[1] =  wx * dt; F[1].col[2] = 4; F[1].val[2] = -dt;
+    F[2].n = 3; F[2].col[0] = 0; F[2].val[0] =  wy * dt; F[2].col[1] = 1; F[2].val[1] = -wx * dt; F[2].col[2] = 5; F[2].val[2] = -dt;
+    F[3].n = 0;
+    F[4].n = 0;
+    F[5].n = 0;
+    F[6].n = 1; F[6].col[0] = EKF_VEL_Z; F[6].val[0] = dt;
+    g = -EKF_GRAVITY * dt;
+    F[7].n = 4;
+    F[7].col[0] = 0; F[7].val[0] = g * (r[1] * az - r[2] * ay);
+    F[7].col[1] = 1; F[7].val[1] = g * (r[2] * ax - r[0] * az);
+    F[7].col[2] = 2; F[7].val[2] = g * (r[0] * ay - r[1] * ax);
+    F[7].col[3] = EKF_ACC_BIAS_Z; F[7].val[3] = -dt;
+    F[8].n = 0;
+    
+    for (i = 0; i < 3; i++)
+    {
+        qDiag[EKF_ATT_X + i] = EKF_GYRO_NOISE * EKF_GYRO_NOISE * dt;
+        qDiag[EKF_BIAS_X + i] = EKF_GYRO_BIAS_WALK * EKF_GYRO_BIAS_WALK * dt;
+    }
+    qDiag[EKF_POS_Z] = 0.0f;
+    qDiag[EKF_VEL_Z] = EKF_ACC_NOISE * EKF_ACC_NOISE * dt;
+    qDiag[EKF_ACC_BIAS_Z] = EKF_ACC_BIAS_WALK * EKF_ACC_BIAS_WALK * dt;
+    
+    ekfPredictCovariance(F, qDiag);
+    
+    /* 四元数积分(协方差传播使用积分前的姿态) */
+    ekfRotateBody(0.5f * wx * dt, 0.5f * wy * dt, 0.5f * wz * dt);
+}
+
+/**
+ * @brief  重力方向观测，首次调用时直接用加速度初始化横滚/俯仰
+ * @param  ax,ay,az: 加速度 (g)
+ * @retval 无
+ */
+void ekfUpdateAccel(float ax, float ay, float az)
+{
+    static const uint8_t col[3][2] = {{1, 2}, {0, 2}, {0, 1}};
+    float normSq = ax * ax + ay * ay + az * az;
+    float recipNorm, halfRoll, halfPitch;
+    float v[3], h[2];
+    uint8_t accepted = 0;
+    
+    if (normSq < EKF_ACC_MIN_G * EKF_ACC_MIN_G || normSq > EKF_ACC_MAX_G * EKF_ACC_MAX_G)
+    {
+        g_stats.rejected++;
+        return;
+    }
+    
+    recipNorm = invSqrt(normSq);
+    ax *= recipNorm;
+    ay *= recipNorm;
+    az *= recipNorm;
+    
+    if (!g_attAligned)
+    {
+        halfRoll = 0.5f * atan2f(ay, az);
+        halfPitch = 0.5f * atan2f(-ax, fastSqrtf(ay * ay + az * az));
+        q0 = cosf(halfRoll) * cosf(halfPitch);
+        q1 = sinf(halfRoll) * cosf(halfPitch);
+        q2 = cosf(halfRoll) * sinf(halfPitch);
+        q3 = -sinf(halfRoll) * sinf(halfPitch);
+        g_attAligned = 1;
+        return;
+    }
+    
+    /* 预测值v = R'*[0 0 1]'，H = [v]x(对姿态误差) */
+    ekfGravityRow(v);
+    
+    h[0] = -v[2]; h[1] =  v[1];
+    accepted |= ekfScalarUpdate(col[0], h, 2, ax - v[0], EKF_ACC_MEAS_STD * EKF_ACC_MEAS_STD);
+    h[0] =  v[2]; h[1] = -v[0];
+    accepted |= ekfScalarUpdate(col[1], h, 2, ay - v[1], EKF_ACC_MEAS_STD * EKF_ACC_MEAS_STD);
+    h[0] = -v[1]; h[1] =  v[0];
+    accepted |= ekfScalarUpdate(col[2], h, 2, az - v[2], EKF_ACC_MEAS_STD * EKF_ACC_MEAS_STD);
+    
+    ekfInject();
+    
+    if (accepted)
+    {
+        g_stats.accUpdates++;
+    }
+}
+
+/**
+ * @brief  磁航向观测，只修正偏航，首次调用时直接对齐磁北
+ * @param  mx,my,mz: 磁场(机体系，单位任意)
+ * @retval 无
+ */
+void ekfUpdateMag(float mx, float my, float mz)
+{
+    static const uint8_t col[3] = {EKF_ATT_X, EKF_ATT_Y, EKF_ATT_Z};
+    float hx, hy, err;
+    float r[3];
+    
+    if (!g_attAligned)
+    {
+        return;
+    }
+    
+    /* 磁场转到地理系，水平分量的方向即航向误差(地理系X轴定义为磁北) */
+    hx = (1.0f - 2.0f * (q2 * q2 + q3 * q3)) * mx + 2.0f * (q1 * q2 - q0 * q3) * my + 2.0f * (q1 * q3 + q0 * q2) * mz;
+    hy = 2.0f * (q1 * q2 + q0 * q3) * mx + (1.0f - 2.0f * (q1 * q1 + q3 * q3)) * my + 2.0f * (q2 * q3 - q0 * q1) * mz;
+    
+    /* 水平分量过小(接近磁极或受干扰)时航向不可靠 */
+    if (hx * hx + hy * hy < 0.01f * (mx * mx + my * my + mz * mz))
+    {
+        g_stats.rejected++;
+        return;
+    }
+    
+    err = atan2f(hy, hx);
+    
+    if (!g_magAligned)
+    {
+        ekfRotateYaw(-err);
+        g_magAligned = 1;
+        return;
+    }
+    
+    /* 机体系误差绕地理系Z轴的分量为R第3行与dtheta的点积 */
+    ekfGravityRow(r);
+    if (ekfScalarUpdate(col, r, 3, -err, EKF_MAG_HEADING_STD * EKF_MAG_HEADING_STD))
+    {
+        g_stats.magUpdates++;
+    }
+    ekfInject();
+}
+
+/**
+ * @brief  气压高度观测，首次调用时记录起飞点高度
+ * @param  altitude: 气压海拔高度 (m)
+ * @retval 无
+ */
+void ekfUpdateBaro(float altitude)
+{
+    static const uint8_t col[1] = {EKF_POS_Z};
+    static const float h[1] = {1.0f};
+    
+    if (!g_baroRefSet)
+    {
+        g_baroRef = altitude;
+        g_baroRefSet = 1;
+        return;
+    }
+    
+    if (ekfScalarUpdate(col, h, 1, altitude - g_baroRef - g_height, EKF_BARO_STD * EKF_BARO_STD))
+    {
+        g_stats.baroUpdates++;
+    }
+    ekfInject();
+}
+
+/**
+ * @brief  获取欧拉角
+ * @param  roll,pitch,yaw: 输出角度 (deg)
+ * @retval 无
+ */
+void ekfGetEuler(float *roll, float *pitch, float *yaw)
+{
+    float sinp = constrainf(2.0f * (q0 * q2 - q3 * q1), -1.0f, 1.0f);
+    
+    *roll = atan2f(2.0f * (q0 * q1 + q2 * q3), 1.0f - 2.0f * (q1 * q1 + q2 * q2)) * RAD2DEG;
+    *pitch = asinf(sinp) * RAD2DEG;
+    *yaw = atan2f(2.0f * (q0 * q3 + q1 * q2), 1.0f - 2.0f * (q2 * q2 + q3 * q3)) * RAD2DEG;
+}
+
+/**
+ * @brief  获取姿态四元数
+ * @param  q: 输出四元数[w, x, y, z]
+ * @retval 无
+ */
+void ekfGetQuaternion(float *q)
+{
+    q[0] = q0;
+    q[1] = q1;
+    q[2] = q2;
+    q[3] = q3;
+}
+
+/**
+ * @brief  获取陀螺仪零偏估计
+ * @param  bias: 输出零偏[x, y, z] (deg/s)
+ * @retval 无
+ */
+void ekfGetGyroBias(float *bias)
+{
+    bias[0] = g_gyroBias[0] * RAD2DEG;
+    bias[1] = g_gyroBias[1] * RAD2DEG;
+    bias[2] = g_gyroBias[2] * RAD2DEG;
+}
+
+/**
+ * @brief  获取垂直通道估计
+ * @param  height: 相对起飞点高度 (m)
+ * @param  velocity: 垂直速度 (m/s，向上为正)
+ * @retval 无
+ */
+void ekfGetVertical(float *height, float *velocity)
+{
+    *height = g_height;
+    *velocity = g_velocity;
+}
+
+/**
+ * @brief  获取观测统计
+ * @param  stats: 输出统计
+ * @retval 无
+ */
+void ekfGetStats(ekfStats_t *stats)
+{
+    *stats = g_stats;
+}
+
+/**
+ * @brief  获取误差状态协方差(由上三角展开为完整矩阵)
+ * @param  P: 输出EKF_STATE_NUM x EKF_STATE_NUM矩阵，按行存放
+ * @retval 无
+ */
+void ekfGetCovariance(float *P)
+{
+    uint8_t i, j;
+    
+    for (i = 0; i < EKF_STATE_NUM; i++)
+    {
+        for (j = 0; j < EKF_STATE_NUM; j++)
+        {
+            P[i * EKF_STATE_NUM + j] = ekfGetP(i, j);
+        }
+    }
+}
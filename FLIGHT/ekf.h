@@ -0,0 +1,91 @@
+﻿/*
+ * ekf.h
+ *
+ * 乘性扩展卡尔曼滤波(MEKF)头文件
+ * 名义状态：姿态四元数、陀螺仪零偏、高度、垂直速度、垂直加速度零偏
+ * 误差状态：3维姿态误差(机体系小角度) + 3维陀螺仪零偏 + 高度 + 垂直速度 + 垂直加速度零偏
+ *
+ * 协方差为9x9对称阵，只存上三角(45个float)；
+ * 加速度计/磁力计/气压计均拆成标量观测逐个更新，不需要矩阵求逆
+ *
+ * 2026-02-20
+ */
+
+#ifndef EKF_H
+#define EKF_H
+
+#include <stdint.h>
+
+/* 误差状态索引 */
+#define EKF_ATT_X                  0
+#define EKF_ATT_Y                  1
+#define EKF_ATT_Z                  2
+#define EKF_BIAS_X                 3
+#define EKF_BIAS_Y                 4
+#define EKF_BIAS_Z                 5
+#define EKF_POS_Z                  6
+#define EKF_VEL_Z                  7
+#define EKF_ACC_BIAS_Z             8
+#define EKF_STATE_NUM              9
+#define EKF_COV_SIZE               (EKF_STATE_NUM * (EKF_STATE_NUM + 1) / 2)
+
+/* 过程噪声(连续时间谱密度) */
+#define EKF_GYRO_NOISE             1.0e-3f   // 陀螺仪噪声 (rad/s/sqrt(Hz))，含机架振动余量
+#define EKF_GYRO_BIAS_WALK         2.0e-5f   // 陀螺仪零偏随机游走 (rad/s^2/sqrt(Hz))
+#define EKF_ACC_NOISE              0.35f     // 垂直加速度噪声 (m/s^2/sqrt(Hz))
+#define EKF_ACC_BIAS_WALK          2.0e-3f   // 垂直加速度零偏随机游走 (m/s^3/sqrt(Hz))
+
+/* 观测噪声(标准差) */
+#define EKF_ACC_MEAS_STD           0.05f     // 归一化重力方向
+#define EKF_MAG_HEADING_STD        0.1f      // 磁航向 (rad)
+#define EKF_BARO_STD               0.5f      // 气压高度 (m)
+
+/* 新息超过该倍数的标准差时拒绝观测 */
+#define EKF_INNOVATION_GATE        5.0f
+
+/* 加速度模长在该范围外时(机动、冲击)不做重力方向观测 */
+#define EKF_ACC_MIN_G              0.7f
+#define EKF_ACC_MAX_G              1.3f
+
+/* 初始标准差 */
+#define EKF_INIT_ATT_STD           0.2f      // rad
+#define EKF_INIT_BIAS_STD          0.05f     // rad/s
+#define EKF_INIT_POS_STD           1.0f      // m
+#define EKF_INIT_VEL_STD           0.5f      // m/s
+#define EKF_INIT_ACC_BIAS_STD      0.2f      // m/s^2
+
+#define EKF_GRAVITY                9.80665f  // m/s^2
+
+/* 观测统计 */
+typedef struct {
+    uint32_t accUpdates;       // 接受的重力方向观测(每次3个标量)
+    uint32_t magUpdates;       // 接受的磁航向观测
+    uint32_t baroUpdates;      // 接受的气压高度观测
+    uint32_t rejected;         // 因新息门限或模长检查被拒绝的观测
+} ekfStats_t;
+
+/*
+ * 计算量(单精度乘加次数，Cortex-M4F上每次约1~2个周期，另有少量除法/开方/atan2f)：
+ * ekfPredict:       协方差传播利用F的稀疏性(每行最多4个非零元)，约9*9*4 + 45*4 = 504次，
+ *                   加四元数积分，约30us@100MHz
+ * 每个标量观测:      P*H'约30次(H最多3个非零元)，P更新45次，1次除法
+ * ekfUpdateAccel:   3个标量
+ * ekfUpdateMag:     1个标量 + 1次atan2f
+ * ekfUpdateBaro:    1个标量
+ * 实际耗时由stabilizer时序统计的姿态解算阶段给出(stabilizerGetTiming)
+ */
+
+/* 函数声明 */
+void ekfInit(void);
+void ekfPredict(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+void ekfUpdateAccel(float ax, float ay, float az);
+void ekfUpdateMag(float mx, float my, float mz);
+void ekfUpdateBaro(float altitude);
+void ekfGetEuler(float *roll, float *pitch, float *yaw);
+void ekfGetQuaternion(float *q);
+void ekfGetGyroBias(float *bias);
+void ekfGetVertical(float *height, float *velocity);
+void ekfGetStats(ekfStats_t *stats);
+void ekfGetCovariance(float *P);
+
+#endif /* EKF_H */
@@ -0,0 +1,272 @@
+﻿/*
+ * filter.c
+ *
+ * 三轴滤波器组实现
+ * 二阶节系数按RBJ Audio EQ Cookbook计算，每级每轴5次乘加，
+ * 三轴x4级在Cortex-M4F上约100个周期
+ *
+ * 2026-02-22
+ */
+
+#include "filter.h"
+#include "maths.h"
+#include "ramfunc.h"
+
+/**
+ * @brief  添加一级并返回其序号
+ * @param  bank: 滤波器组
+ * @retval 级序号，FILTER_NO_STAGE-已满
+ */
+static uint8_t filterBankAddStage(filterBank_t *bank)
+{
+    uint8_t stage = bank->numStages;
+#if FILTER_USE_CMSIS_DSP
+    uint8_t axis;
+#endif
+    
+    if (stage >= FILTER_MAX_STAGES)
+    {
+        return FILTER_NO_STAGE;
+    }
+    
+    bank->numStages++;
+    
+#if FILTER_USE_CMSIS_DSP
+    /* 级数变化后重新绑定实例，init会清零状态 */
+    for (axis = 0; axis < FILTER_AXIS_NUM; axis++)
+    {
+        arm_biquad_cascade_df2T_init_f32(&bank->inst[axis], bank->numStages, bank->coeffs, bank->state[axis]);
+    }
+#endif
+    
+    return stage;
+}
+
+/**
+ * @brief  写入一级系数(按a0归一化，a1/a2取反)
+ * @param  c: 该级系数(FILTER_COEFFS_PER_STAGE个)
+ * @param  b0,b1,b2,a0,a1,a2: 标准形式系数
+ * @retval 无
+ */
+static void filterSetCoeffs(float *c, float b0, float b1, float b2, float a0, float a1, float a2)
+{
+    float recipA0 = 1.0f / a0;
+    
+    c[0] = b0 * recipA0;
+    c[1] = b1 * recipA0;
+    c[2] = b2 * recipA0;
+    c[3] = -a1 * recipA0;
+    c[4] = -a2 * recipA0;
+}
+
+/**
+ * @brief  滤波器组初始化(清空所有级)
+ * @param  bank: 滤波器组
+ * @retval 无
+ */
+void filterBankInit(filterBank_t *bank)
+{
+    uint8_t i;
+    
+    bank->numStages = 0;
+    for (i = 0; i < FILTER_MAX_STAGES * FILTER_COEFFS_PER_STAGE; i++)
+    {
+        bank->coeffs[i] = 0.0f;
+    }
+    filterBankReset(bank);
+}
+
+/**
+ * @brief  清零滤波器状态，保留系数
+ * @param  bank: 滤波器组
+ * @retval 无
+ */
+void filterBankReset(filterBank_t *bank)
+{
+    uint8_t i, axis;
+    
+    for (axis = 0; axis < FILTER_AXIS_NUM; axis++)
+    {
+        for (i = 0; i < FILTER_MAX_STAGES * FILTER_STATE_PER_STAGE; i++)
+        {
+            bank->state[axis][i] = 0.0f;
+        }
+    }
+}
+
+/**
+ * @brief  添加一阶低通(PT1)：y = y1 + k*(x - y1)
+ * @param  bank: 滤波器组
+ * @param  cutoffHz: 截止频率 (Hz)
+ * @param  sampleHz: 采样频率 (Hz)
+ * @retval 级序号，FILTER_NO_STAGE-已满
+ */
+uint8_t filterBankAddPt1(filterBank_t *bank, float cutoffHz, float sampleHz)
+{
+    uint8_t stage = filterBankAddStage(bank);
+    float dt = 1.0f / sampleHz;
+    float rc = 1.0f / (2.0f * M_PI_F * cutoffHz);
+    float k = dt / (rc + dt);
+    
+    if (stage != FILTER_NO_STAGE)
+    {
+        filterSetCoeffs(&bank->coeffs[stage * FILTER_COEFFS_PER_STAGE], k, 0.0f, 0.0f, 1.0f, k - 1.0f, 0.0f);
+    }
+    
+    return stage;
+}
+
+/**
+ * @brief  添加二阶低通
+ * @param  bank: 滤波器组
+ * @param  cutoffHz: 截止频率 (Hz)
+ * @param  q: 品质因数，FILTER_BUTTERWORTH_Q为巴特沃斯
+ * @param  sampleHz: 采样频率 (Hz)
+ * @retval 级序号，FILTER_NO_STAGE-已满
+ */
+uint8_t filterBankAddLowpass(filterBank_t *bank, float cutoffHz, float q, float sampleHz)
+{
+    uint8_t stage = filterBankAddStage(bank);
+    float omega = 2.0f * M_PI_F * cutoffHz / sampleHz;
+    float cs = cosf(omega);
+    float alpha = sinf(omega) / (2.0f * q);
+    
+    if (stage != FILTER_NO_STAGE)
+    {
+        filterSetCoeffs(&bank->coeffs[stage * FILTER_COEFFS_PER_STAGE], 0.5f * (1.0f - cs), 1.0f - cs, 0.5f * (1.0f - cs),
+                        1.0f + alpha, -2.0f * cs, 1.0f - alpha);
+    }
+    
+    return stage;
+}
+
+/**
+ * @brief  添加陷波
+ * @param  bank: 滤波器组
+ * @param  centerHz: 中心频率 (Hz)
+ * @param  q: 品质因数(中心频率/带宽)
+ * @param  sampleHz: 采样频率 (Hz)
+ * @retval 级序号，FILTER_NO_STAGE-已满
+ */
+uint8_t filterBankAddNotch(filterBank_t *bank, float centerHz, float q, float sampleHz)
+{
+    uint8_t stage = filterBankAddStage(bank);
+    
+    if (stage != FILTER_NO_STAGE)
+    {
+        filterBankSetNotch(bank, stage, centerHz, q, sampleHz);
+    }
+    
+    return stage;
+}
+
+/**
+ * @brief  修改陷波中心频率(动态陷波)，保留状态避免切换时的跳变
+ * @param  bank: 滤波器组
+ * @param  stage: 级序号
+ * @param  centerHz: 中心频率 (Hz)
+ * @param  q: 品质因数
+ * @param  sampleHz: 采样频率 (Hz)
+ * @retval 无
+ */
+void filterBankSetNotch(filterBank_t *bank, uint8_t stage, float centerHz, float q, float sampleHz)
+{
+    filterNotchCoeffs(&bank->coeffs[stage * FILTER_COEFFS_PER_STAGE], centerHz, q, sampleHz);
+}
+
+/**
+ * @brief  将某级设为直通(禁用但保留位置，便于之后重新设置)
+ * @param  bank: 滤波器组
+ * @param  stage: 级序号
+ * @retval 无
+ */
+void filterBankSetBypass(filterBank_t *bank, uint8_t stage)
+{
+    filterBypassCoeffs(&bank->coeffs[stage * FILTER_COEFFS_PER_STAGE]);
+}
+
+/**
+ * @brief  三轴各滤波一个样本
+ * @param  bank: 滤波器组
+ * @param  xyz: 三轴输入，原地输出
+ * @retval 无
+ */
+RAMFUNC void filterBankApply(filterBank_t *bank, float *xyz)
+{
+    uint8_t axis;
+#if FILTER_USE_CMSIS_DSP
+    for (axis = 0; axis < FILTER_AXIS_NUM; axis++)
+    {
+        arm_biquad_cascade_df2T_f32(&bank->inst[axis], &xyz[axis], &xyz[axis], 1);
+    }
+#else
+    for (axis = 0; axis < FILTER_AXIS_NUM; axis++)
+    {
+        xyz[axis] = filterCascadeApply(bank->coeffs, bank->state[axis], bank->numStages, xyz[axis]);
+    }
+#endif
+}
+
+/**
+ * @brief  计算陷波系数
+ * @param  c: 输出系数(FILTER_COEFFS_PER_STAGE个)
+ * @param  centerHz: 中心频率 (Hz)
+ * @param  q: 品质因数
+ * @param  sampleHz: 采样频率 (Hz)
+ * @retval 无
+ */
+void filterNotchCoeffs(float *c, float centerHz, float q, float sampleHz)
+{
+    float omega = 2.0f * M_PI_F * centerHz / sampleHz;
+    float cs = cosf(omega);
+    float alpha = sinf(omega) / (2.0f * q);
+    
+    filterSetCoeffs(c, 1.0f, -2.0f * cs, 1.0f, 1.0f + alpha, -2.0f * cs, 1.0f - alpha);
+}
+
+/**
+ * @brief  计算直通系数
+ * @param  c: 输出系数(FILTER_COEFFS_PER_STAGE个)
+ * @retval 无
+ */
+void filterBypassCoeffs(float *c)
+{
+    filterSetCoeffs(c, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+}
+
+/**
+ * @brief  单通道DF2T级联滤波一个样本(与arm_biquad_cascade_df2T_f32算法相同)
+ * @param  coeffs: 各级系数
+ * @param  state: 各级状态(FILTER_STATE_PER_STAGE个/级)
+ * @param  numStages: 级数
+ * @param  x: 输入
+ * @retval 输出
+ */
+RAMFUNC float filterCascadeApply(const float *coeffs, float *state, uint8_t numStages, float x)
+{
+    float y;
+    uint8_t stage;
+    
+    for (stage = 0; stage < numStages; stage++)
+    {
+        y = coeffs[0] * x + state[0];
+        state[0] = coeffs[1] * x + coeffs[3] * y + state[1];
+        state[1] = coeffs[2] * x + coeffs[4] * y;
+        x = y;
+        coeffs += FILTER_COEFFS_PER_STAGE;
+        state += FILTER_STATE_PER_STAGE;
+    }
+    
+    return x;
+}
+
+/**
+ * @brief  由中心频率与-3dB下边沿计算陷波品质因数
+ * @param  centerHz: 中心频率 (Hz)
+ * @param  cutoffHz: 下边沿频率 (Hz，小于centerHz)
+ * @retval 品质因数
+ */
+float filterNotchQ(float centerHz, float cutoffHz)
+{
+    return centerHz * cutoffHz / (centerHz * centerHz - cutoffHz * cutoffHz);
+}
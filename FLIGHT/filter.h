@@ -0,0 +1,64 @@
+﻿/*
+ * filter.h
+ *
+ * 三轴滤波器组头文件
+ * PT1、二阶低通与陷波统一表示为二阶节(biquad)，三个轴共用系数、各自保存状态，
+ * 按转置直接II型(DF2T)级联，系数布局与arm_biquad_cascade_df2T_f32一致：
+ * 每级{b0, b1, b2, a1, a2}，a1/a2已取反(y = b0*x + b1*x1 + b2*x2 + a1*y1 + a2*y2)
+ *
+ * 2026-02-22
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+
+/*
+ * 1-调用CMSIS-DSP的arm_biquad_cascade_df2T_f32，需在工程中加入arm_cortexM4lf_math.lib
+ *   并定义ARM_MATH_CM4(仓库只带arm_math.h，未带库文件)
+ * 0-使用本文件内联的同算法实现，结果与CMSIS-DSP一致
+ */
+#ifndef FILTER_USE_CMSIS_DSP
+#define FILTER_USE_CMSIS_DSP       0
+#endif
+
+#if FILTER_USE_CMSIS_DSP
+#include "arm_math.h"
+#endif
+
+#define FILTER_AXIS_NUM            3
+#define FILTER_MAX_STAGES          4         // 每个滤波器组最多4级
+#define FILTER_COEFFS_PER_STAGE    5
+#define FILTER_STATE_PER_STAGE     2
+#define FILTER_NO_STAGE            0xFF
+
+#define FILTER_BUTTERWORTH_Q       0.70710678f
+
+/* 三轴滤波器组 */
+typedef struct {
+    uint8_t numStages;
+    float coeffs[FILTER_MAX_STAGES * FILTER_COEFFS_PER_STAGE];                   // 三轴共用
+    float state[FILTER_AXIS_NUM][FILTER_MAX_STAGES * FILTER_STATE_PER_STAGE];    // 各轴状态
+#if FILTER_USE_CMSIS_DSP
+    arm_biquad_cascade_df2T_instance_f32 inst[FILTER_AXIS_NUM];
+#endif
+} filterBank_t;
+
+/* 函数声明 */
+void filterBankInit(filterBank_t *bank);
+void filterBankReset(filterBank_t *bank);
+uint8_t filterBankAddPt1(filterBank_t *bank, float cutoffHz, float sampleHz);
+uint8_t filterBankAddLowpass(filterBank_t *bank, float cutoffHz, float q, float sampleHz);
+uint8_t filterBankAddNotch(filterBank_t *bank, float centerHz, float q, float sampleHz);
+void filterBankSetNotch(filterBank_t *bank, uint8_t stage, float centerHz, float q, float sampleHz);
+void filterBankSetBypass(filterBank_t *bank, uint8_t stage);
+void filterBankApply(filterBank_t *bank, float *xyz);
+float filterNotchQ(float centerHz, float cutoffHz);
+
+/* 单通道系数计算与滤波，供各轴系数不同的动态陷波使用 */
+void filterNotchCoeffs(float *c, float centerHz, float q, float sampleHz);
+void filterBypassCoeffs(float *c);
+float filterCascadeApply(const float *coeffs, float *state, uint8_t numStages, float x);
+
+#endif /* FILTER_H */
@@ -0,0 +1,78 @@
+﻿/*
+ * maths.h
+ *
+ * 飞控算法通用数学函数
+ * 只使用单精度运算，Cortex-M4F上开方直接映射为vsqrt.f32指令
+ *
+ * 2026-02-18
+ */
+
+#ifndef MATHS_H
+#define MATHS_H
+
+#include <stdint.h>
+#include <math.h>
+
+#define M_PI_F              3.14159265358979f
+#define DEG2RAD             (M_PI_F / 180.0f)
+#define RAD2DEG             (180.0f / M_PI_F)
+
+/**
+ * @brief  单精度开方
+ * @param  x: 被开方数(非负)
+ * @retval 平方根
+ */
+static __inline float fastSqrtf(float x)
+{
+#if defined(__CC_ARM)
+    return __sqrtf(x);
+#elif defined(__GNUC__) && defined(__ARM_FP)
+    float r;
+    __asm("vsqrt.f32 %0, %1" : "=t"(r) : "t"(x));
+    return r;
+#else
+    return sqrtf(x);
+#endif
+}
+
+/**
+ * @brief  快速平方根倒数(位运算初值 + 一次牛顿迭代，相对误差<0.2%)
+ * @param  x: 输入(正数)
+ * @retval 1/sqrt(x)
+ */
+static __inline float invSqrt(float x)
+{
+    union {
+        float f;
+        int32_t i;
+    } conv;
+    float halfx = 0.5f * x;
+    
+    conv.f = x;
+    conv.i = 0x5f3759df - (conv.i >> 1);
+    conv.f = conv.f * (1.5f - (halfx * conv.f * conv.f));
+    
+    return conv.f;
+}
+
+/**
+ * @brief  限幅
+ * @param  value: 输入
+ * @param  min: 下限
+ * @param  max: 上限
+ * @retval 限幅后的值
+ */
+static __inline float constrainf(float value, float min, float max)
+{
+    if (value < min)
+    {
+        return min;
+    }
+    if (value > max)
+    {
+        return max;
+    }
+    return value;
+}
+
+#endif /* MATHS_H */
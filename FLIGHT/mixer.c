@@ -0,0 +1,131 @@
+﻿/*
+ * mixer.c
+ *
+ * 电机混控实现
+ * 处理顺序：矩阵乘法 -> 饱和重分配 -> 推力线性化 -> 怠速映射
+ *
+ * 饱和重分配：姿态部分的跨度(最大-最小)超过输出范围时按比例缩小姿态力矩，
+ * 再移动油门使所有电机落在0~1内；关闭空中模式时油门只向下让出余量，低油门端直接截断
+ *
+ * 2026-02-25
+ */
+
+#include "mixer.h"
+#include "maths.h"
+#include "ramfunc.h"
+
+const mixerRule_t mixerQuadX[MIXER_MOTOR_NUM] = {
+    /* 油门   横滚    俯仰    偏航 */
+    { 1.0f, -1.0f, -1.0f, -1.0f },   // M1 右前 逆时针
+    { 1.0f, -1.0f,  1.0f,  1.0f },   // M2 右后 顺时针
+    { 1.0f,  1.0f,  1.0f, -1.0f },   // M3 左后 逆时针
+    { 1.0f,  1.0f, -1.0f,  1.0f },   // M4 左前 顺时针
+};
+
+const mixerRule_t mixerQuadPlus[MIXER_MOTOR_NUM] = {
+    /* 油门   横滚    俯仰    偏航 */
+    { 1.0f,  0.0f, -1.0f, -1.0f },   // M1 前 逆时针
+    { 1.0f, -1.0f,  0.0f,  1.0f },   // M2 右 顺时针
+    { 1.0f,  0.0f,  1.0f, -1.0f },   // M3 后 逆时针
+    { 1.0f,  1.0f,  0.0f,  1.0f },   // M4 左 顺时针
+};
+
+static const mixerRule_t *g_table = mixerQuadX;
+
+/**
+ * @brief  选择混控表
+ * @param  table: 混控表(MIXER_MOTOR_NUM行)，可传入自定义表，需为静态存储
+ * @retval 无
+ */
+void mixerInit(const mixerRule_t *table)
+{
+    g_table = table;
+}
+
+/**
+ * @brief  推力线性化：由期望推力求输出，即解 (1-k)*u + k*u^2 = t
+ * @param  t: 期望推力 (0~1)
+ * @retval 电机输出 (0~1)
+ */
+static float mixerLinearize(float t)
+{
+    const float k = MIXER_THRUST_LINEAR;
+    
+    if (k <= 0.0f)
+    {
+        return t;
+    }
+    
+    return (fastSqrtf((1.0f - k) * (1.0f - k) + 4.0f * k * t) - (1.0f - k)) / (2.0f * k);
+}
+
+/**
+ * @brief  电机混控
+ * @param  control: 控制输出(油门0~1，三轴力矩)
+ * @param  armed: 是否解锁，未解锁时所有电机输出0
+ * @param  motor: 输出各电机油门 (0~1)，长度MIXER_MOTOR_NUM
+ * @retval 1: 姿态力矩超出输出范围被缩小  0: 未饱和
+ */
+RAMFUNC uint8_t mixerUpdate(const control_t *control, uint8_t armed, float *motor)
+{
+    float attitude[MIXER_MOTOR_NUM];
+    float minAtt = 0.0f, maxAtt = 0.0f;
+    float range, scale = 1.0f, thrust;
+    uint8_t saturated = 0;
+    uint8_t i;
+    
+    if (!armed)
+    {
+        for (i = 0; i < MIXER_MOTOR_NUM; i++)
+        {
+            motor[i] = 0.0f;
+        }
+        return 0;
+    }
+    
+    /* 姿态部分 */
+    for (i = 0; i < MIXER_MOTOR_NUM; i++)
+    {
+        attitude[i] = g_table[i].roll  * control->roll
+                    + g_table[i].pitch * control->pitch
+                    + g_table[i].yaw   * control->yaw;
+        
+        if (i == 0 || attitude[i] < minAtt)
+        {
+            minAtt = attitude[i];
+        }
+        if (i == 0 || attitude[i] > maxAtt)
+        {
+            maxAtt = attitude[i];
+        }
+    }
+    
+    /* 姿态跨度超出输出范围时按比例缩小 */
+    range = maxAtt - minAtt;
+    if (range > 1.0f)
+    {
+        scale = 1.0f / range;
+        minAtt *= scale;
+        maxAtt *= scale;
+        saturated = 1;
+    }
+    
+    /* 移动油门让出余量 */
+    thrust = constrainf(control->thrust, 0.0f, 1.0f);
+#if MIXER_AIRMODE
+    thrust = constrainf(thrust, -minAtt, 1.0f - maxAtt);
+#else
+    if (thrust > 1.0f - maxAtt)
+    {
+        thrust = 1.0f - maxAtt;
+    }
+#endif
+    
+    for (i = 0; i < MIXER_MOTOR_NUM; i++)
+    {
+        motor[i] = constrainf(g_table[i].thrust * thrust + scale * attitude[i], 0.0f, 1.0f);
+        motor[i] = MIXER_IDLE + (1.0f - MIXER_IDLE) * mixerLinearize(motor[i]);
+    }
+    
+    return saturated;
+}
@@ -0,0 +1,53 @@
+﻿/*
+ * mixer.h
+ *
+ * 电机混控头文件
+ * 混控表每行对应一个电机，按{油门, 横滚, 俯仰, 偏航}系数把控制输出映射为各电机推力，
+ * 一次4x4矩阵乘法得到全部电机输出，机型只由混控表决定(四轴X、四轴+或自定义)
+ *
+ * 机体坐标系：x向前、y向左、z向上
+ * 横滚为正时左侧电机加速，俯仰为正(机头向下)时后侧电机加速，
+ * 偏航为正(俯视逆时针)时顺时针旋转的桨加速
+ *
+ *          四轴X                     四轴+
+ *        M4     M1                    M1
+ *          \   /                      |
+ *           ( )                  M4 --+-- M2
+ *          /   \                      |
+ *        M3     M2                    M3
+ *
+ * M1、M3逆时针旋转，M2、M4顺时针旋转
+ *
+ * 2026-02-25
+ */
+
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdint.h>
+#include "controller.h"
+
+#define MIXER_MOTOR_NUM          4
+
+#ifndef MIXER_AIRMODE
+#define MIXER_AIRMODE            1         // 低油门时抬高油门保证姿态控制余量
+#endif
+#define MIXER_IDLE               0.05f     // 解锁后电机怠速输出 (0~1)
+#define MIXER_THRUST_LINEAR      0.3f      // 推力线性化系数(推力 = (1-k)*输出 + k*输出^2，0为不补偿)
+
+/* 混控表的一行：各控制量对一个电机的系数 */
+typedef struct {
+    float thrust;
+    float roll;
+    float pitch;
+    float yaw;
+} mixerRule_t;
+
+extern const mixerRule_t mixerQuadX[MIXER_MOTOR_NUM];
+extern const mixerRule_t mixerQuadPlus[MIXER_MOTOR_NUM];
+
+/* 函数声明 */
+void mixerInit(const mixerRule_t *table);
+uint8_t mixerUpdate(const control_t *control, uint8_t armed, float *motor);
+
+#endif /* MIXER_H */
@@ -0,0 +1,153 @@
+﻿/*
+ * pid.c
+ *
+ * 三轴PID实现
+ * ki/kd在初始化时预乘/预除dt，每轴每次更新只剩乘加与限幅
+ *
+ * 2026-02-21
+ */
+
+#include "pid.h"
+#include "maths.h"
+#include "ramfunc.h"
+
+/**
+ * @brief  三轴PID初始化
+ * @param  pid: PID
+ * @param  gains: 各轴参数(PID_AXIS_NUM个)
+ * @param  dCutoffHz: 微分项低通截止频率 (Hz)，0为不滤波
+ * @param  dt: 控制周期 (s)
+ * @retval 无
+ */
+void pidBankInit(pidBank_t *pid, const pidGains_t *gains, float dCutoffHz, float dt)
+{
+    uint8_t i;
+    float rc;
+    
+    for (i = 0; i < PID_AXIS_NUM; i++)
+    {
+        pid->kp[i] = gains[i].kp;
+        pid->ki[i] = gains[i].ki * dt;
+        pid->kd[i] = gains[i].kd / dt;
+        pid->iLimit[i] = gains[i].iLimit;
+        pid->outLimit[i] = gains[i].outLimit;
+    }
+    
+    if (dCutoffHz > 0.0f)
+    {
+        rc = 1.0f / (2.0f * M_PI_F * dCutoffHz);
+        pid->dAlpha = dt / (rc + dt);
+    }
+    else
+    {
+        pid->dAlpha = 1.0f;
+    }
+    
+    pid->dFilter = 0;
+    pidBankReset(pid);
+}
+
+/**
+ * @brief  设置微分项滤波器组(如二阶低通+陷波)
+ * @param  pid: PID
+ * @param  bank: 已配置好的滤波器组，0为恢复一阶低通
+ * @retval 无
+ */
+void pidBankSetDtermFilter(pidBank_t *pid, filterBank_t *bank)
+{
+    pid->dFilter = bank;
+    pidBankReset(pid);
+}
+
+/**
+ * @brief  清零积分与微分状态(解锁、起飞前调用)
+ * @param  pid: PID
+ * @retval 无
+ */
+void pidBankReset(pidBank_t *pid)
+{
+    uint8_t i;
+    
+    for (i = 0; i < PID_AXIS_NUM; i++)
+    {
+        pid->integ[i] = 0.0f;
+        pid->lastMeas[i] = 0.0f;
+        pid->dFilt[i] = 0.0f;
+        pid->pTerm[i] = 0.0f;
+        pid->dTerm[i] = 0.0f;
+    }
+    if (pid->dFilter)
+    {
+        filterBankReset(pid->dFilter);
+    }
+    pid->primed = 0;
+}
+
+/**
+ * @brief  三轴PID更新
+ * @param  pid: PID
+ * @param  setpoint: 各轴设定值
+ * @param  measurement: 各轴测量值
+ * @param  pdScale: P/D项缩放(油门PID衰减)，积分项不缩放
+ * @param  integrate: 1-积分，0-保持积分项不变(如油门过低时)
+ * @param  out: 各轴输出
+ * @retval 无
+ */
+RAMFUNC void pidBankUpdate(pidBank_t *pid, const float *setpoint, const float *measurement,
+                   float pdScale, uint8_t integrate, float *out)
+{
+    uint8_t i;
+    float error, integ, p, d;
+    float deriv[PID_AXIS_NUM];
+    
+    /* 首次更新没有上一次测量值，微分项从0开始 */
+    if (!pid->primed)
+    {
+        for (i = 0; i < PID_AXIS_NUM; i++)
+        {
+            pid->lastMeas[i] = measurement[i];
+        }
+        pid->primed = 1;
+    }
+    
+    /* 微分作用于测量值 */
+    for (i = 0; i < PID_AXIS_NUM; i++)
+    {
+        deriv[i] = pid->lastMeas[i] - measurement[i];
+        pid->lastMeas[i] = measurement[i];
+    }
+    
+    if (pid->dFilter)
+    {
+        filterBankApply(pid->dFilter, deriv);
+        for (i = 0; i < PID_AXIS_NUM; i++)
+        {
+            pid->dFilt[i] = deriv[i];
+        }
+    }
+    else
+    {
+        for (i = 0; i < PID_AXIS_NUM; i++)
+        {
+            pid->dFilt[i] += pid->dAlpha * (deriv[i] - pid->dFilt[i]);
+        }
+    }
+    
+    for (i = 0; i < PID_AXIS_NUM; i++)
+    {
+        error = setpoint[i] - measurement[i];
+        
+        integ = pid->integ[i];
+        if (integrate)
+        {
+            integ = constrainf(integ + pid->ki[i] * error, -pid->iLimit[i], pid->iLimit[i]);
+            pid->integ[i] = integ;
+        }
+        
+        p = pid->kp[i] * error;
+        d = pid->kd[i] * pid->dFilt[i];
+        pid->pTerm[i] = pdScale * p;
+        pid->dTerm[i] = pdScale * d;
+        out[i] = constrainf(pdScale * (p + d) + integ, -pid->outLimit[i], pid->outLimit[i]);
+    }
+}
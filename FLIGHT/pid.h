@@ -0,0 +1,56 @@
+﻿/*
+ * pid.h
+ *
+ * 三轴PID头文件
+ * 按结构数组(SoA)组织，同一参数的三个轴连续存放，一次循环处理三个轴
+ * 微分作用于测量值(设定值突变不产生微分冲击)，微分项一阶低通或外接滤波器组，积分限幅
+ *
+ * 2026-02-21
+ */
+
+#ifndef PID_H
+#define PID_H
+
+#include <stdint.h>
+#include "filter.h"
+
+/* 轴定义 */
+#define PID_ROLL                   0
+#define PID_PITCH                  1
+#define PID_YAW                    2
+#define PID_AXIS_NUM               3
+
+/* 单轴参数(仅用于初始化) */
+typedef struct {
+    float kp;
+    float ki;
+    float kd;
+    float iLimit;      // 积分项限幅(输出单位)
+    float outLimit;    // 输出限幅
+} pidGains_t;
+
+/* 三轴PID */
+typedef struct {
+    float kp[PID_AXIS_NUM];
+    float ki[PID_AXIS_NUM];         // 已乘dt
+    float kd[PID_AXIS_NUM];         // 已除dt
+    float iLimit[PID_AXIS_NUM];
+    float outLimit[PID_AXIS_NUM];
+    float integ[PID_AXIS_NUM];      // 积分项
+    float lastMeas[PID_AXIS_NUM];   // 上一次测量值
+    float dFilt[PID_AXIS_NUM];      // 低通后的微分项
+    float pTerm[PID_AXIS_NUM];      // 最近一次更新的P项(已乘pdScale，未限幅)，供黑匣子记录
+    float dTerm[PID_AXIS_NUM];      // 最近一次更新的D项(同上)，I项即integ
+    float dAlpha;                   // 微分低通系数，1为不滤波
+    filterBank_t *dFilter;          // 微分项滤波器组，非空时代替一阶低通
+    uint8_t primed;                 // 已有上一次测量值
+} pidBank_t;
+
+/* 函数声明 */
+void pidBankInit(pidBank_t *pid, const pidGains_t *gains, float dCutoffHz, float dt);
+void pidBankReset(pidBank_t *pid);
+void pidBankSetDtermFilter(pidBank_t *pid, filterBank_t *bank);
+void pidBankUpdate(pidBank_t *pid, const float *setpoint, const float *measurement,
+                   float pdScale, uint8_t integrate, float *out);
+
+#endif /* PID_H */
@@ -0,0 +1,128 @@
+﻿/*
+ * rpmfilter.c
+ *
+ * 电机转速谐波陷波实现
+ * 过渡区的减弱直接折算进系数：H' = w*H + (1-w)，即分子b' = w*b + (1-w)*a，
+ * 滤波时不需要额外的混合运算
+ *
+ * 2026-02-24
+ */
+
+#include "rpmfilter.h"
+#include "filter.h"
+#include "maths.h"
+#include "ramfunc.h"
+
+static float g_sampleHz;
+static float g_motorHz[RPM_FILTER_MOTOR_NUM];
+static uint8_t g_motor;          // 下一次更新系数的电机
+
+/* 第m个电机第h次谐波位于第m*RPM_FILTER_HARMONICS+h级 */
+static float g_coeffs[RPM_FILTER_NOTCH_NUM * FILTER_COEFFS_PER_STAGE];
+static float g_state[RPM_FILTER_AXIS_NUM][RPM_FILTER_NOTCH_NUM * FILTER_STATE_PER_STAGE];
+
+/**
+ * @brief  转速陷波初始化，所有陷波直通
+ * @param  sampleHz: 陀螺仪采样频率(控制频率) (Hz)
+ * @retval 无
+ */
+void rpmFilterInit(float sampleHz)
+{
+    uint8_t i, axis;
+    
+    g_sampleHz = sampleHz;
+    g_motor = 0;
+    
+    for (i = 0; i < RPM_FILTER_MOTOR_NUM; i++)
+    {
+        g_motorHz[i] = 0.0f;
+    }
+    for (i = 0; i < RPM_FILTER_NOTCH_NUM; i++)
+    {
+        filterBypassCoeffs(&g_coeffs[i * FILTER_COEFFS_PER_STAGE]);
+    }
+    for (axis = 0; axis < RPM_FILTER_AXIS_NUM; axis++)
+    {
+        for (i = 0; i < RPM_FILTER_NOTCH_NUM * FILTER_STATE_PER_STAGE; i++)
+        {
+            g_state[axis][i] = 0.0f;
+        }
+    }
+}
+
+/**
+ * @brief  设置电机转速(只记录，系数在rpmFilterUpdate中更新)
+ * @param  motor: 电机序号
+ * @param  hz: 转速基频 (Hz，即RPM/60)
+ * @retval 无
+ */
+void rpmFilterSetMotorHz(uint8_t motor, float hz)
+{
+    if (motor < RPM_FILTER_MOTOR_NUM)
+    {
+        g_motorHz[motor] = hz;
+    }
+}
+
+/**
+ * @brief  计算一级陷波系数，低频/高频端按权重减弱
+ * @param  c: 输出系数
+ * @param  hz: 陷波频率 (Hz)
+ * @retval 无
+ */
+static void rpmFilterSetNotch(float *c, float hz)
+{
+    float maxHz = RPM_FILTER_MAX_RATIO * g_sampleHz;
+    float weight;
+    
+    if (hz <= RPM_FILTER_MIN_HZ || hz >= maxHz)
+    {
+        filterBypassCoeffs(c);
+        return;
+    }
+    
+    weight = constrainf((hz - RPM_FILTER_MIN_HZ) / RPM_FILTER_FADE_HZ, 0.0f, 1.0f);
+    filterNotchCoeffs(c, hz, RPM_FILTER_Q, g_sampleHz);
+    
+    if (weight < 1.0f)
+    {
+        /* 分母系数已取反存放：a1 = -c[3]，a2 = -c[4] */
+        c[0] = weight * c[0] + (1.0f - weight);
+        c[1] = weight * c[1] - (1.0f - weight) * c[3];
+        c[2] = weight * c[2] - (1.0f - weight) * c[4];
+    }
+}
+
+/**
+ * @brief  更新一个电机的各次谐波陷波系数，每次控制循环调用一次
+ * @param  无
+ * @retval 无
+ */
+void rpmFilterUpdate(void)
+{
+    float *c = &g_coeffs[g_motor * RPM_FILTER_HARMONICS * FILTER_COEFFS_PER_STAGE];
+    uint8_t h;
+    
+    for (h = 0; h < RPM_FILTER_HARMONICS; h++)
+    {
+        rpmFilterSetNotch(c, g_motorHz[g_motor] * (h + 1));
+        c += FILTER_COEFFS_PER_STAGE;
+    }
+    
+    g_motor = (g_motor + 1) % RPM_FILTER_MOTOR_NUM;
+}
+
+/**
+ * @brief  三轴转速陷波滤波
+ * @param  xyz: 三轴输入，原地输出
+ * @retval 无
+ */
+RAMFUNC void rpmFilterApply(float *xyz)
+{
+    uint8_t axis;
+    
+    for (axis = 0; axis < RPM_FILTER_AXIS_NUM; axis++)
+    {
+        xyz[axis] = filterCascadeApply(g_coeffs, g_state[axis], RPM_FILTER_NOTCH_NUM, xyz[axis]);
+    }
+}
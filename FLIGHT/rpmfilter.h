@@ -0,0 +1,41 @@
+﻿/*
+ * rpmfilter.h
+ *
+ * 电机转速谐波陷波头文件
+ * 每个电机的基频及其2、3次谐波各一个陷波(4电机 x 3谐波 = 12级)，三轴共用系数、各自保存状态
+ *
+ * 系数更新分摊：每次rpmFilterUpdate只重算一个电机的3级系数，4次迭代轮完一遍
+ * 频率低于RPM_FILTER_MIN_HZ(或接近奈奎斯特频率)的陷波在RPM_FILTER_FADE_HZ范围内
+ * 逐渐减弱为直通，避免电机怠速附近陷波突然开关引起的跳变
+ *
+ * 计算量(Cortex-M4F @100MHz)：
+ * rpmFilterApply:  3轴 x 12级 x 5次乘加，约2.5us
+ * rpmFilterUpdate: 3级系数(各1次cosf/sinf/除法)，约4us
+ * 控制频率1kHz(周期1000us)时合计约0.65%；本模块也适用于2kHz采样(周期500us，约1.3%)，
+ * 由fc_test_rpmfilter在2kHz下验证，目标板上的实际耗时见stabilizerTiming_t.rpmFilter
+ *
+ * 2026-02-24
+ */
+
+#ifndef RPMFILTER_H
+#define RPMFILTER_H
+
+#include <stdint.h>
+
+#define RPM_FILTER_AXIS_NUM        3
+#define RPM_FILTER_MOTOR_NUM       4
+#define RPM_FILTER_HARMONICS       3
+#define RPM_FILTER_NOTCH_NUM       (RPM_FILTER_MOTOR_NUM * RPM_FILTER_HARMONICS)
+
+#define RPM_FILTER_Q               5.0f      // 陷波品质因数
+#define RPM_FILTER_MIN_HZ          80.0f     // 低于该频率的陷波直通
+#define RPM_FILTER_FADE_HZ         30.0f     // 从直通过渡到完整陷波的频率范围
+#define RPM_FILTER_MAX_RATIO       0.45f     // 陷波频率上限(相对采样频率)
+
+/* 函数声明 */
+void rpmFilterInit(float sampleHz);
+void rpmFilterSetMotorHz(uint8_t motor, float hz);
+void rpmFilterUpdate(void);
+void rpmFilterApply(float *xyz);
+
+#endif /* RPMFILTER_H */
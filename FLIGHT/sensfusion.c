@@ -0,0 +1,256 @@
+﻿/*
+ * sensfusion.c
+ *
+ * 四元数姿态解算实现
+ * 全部使用单精度运算(常量带f后缀，数学函数使用xxxf版本)，避免提升为double
+ *
+ * 2026-02-18
+ */
+
+#include "sensfusion.h"
+#include "maths.h"
+#include "ramfunc.h"
+
+/* 姿态四元数(机体系到地理系) */
+static float q0 = 1.0f;
+static float q1 = 0.0f;
+static float q2 = 0.0f;
+static float q3 = 0.0f;
+
+/* 陀螺仪零偏估计 (rad/s) */
+static float g_biasX = 0.0f;
+static float g_biasY = 0.0f;
+static float g_biasZ = 0.0f;
+
+/**
+ * @brief  姿态解算初始化
+ * @param  无
+ * @retval 无
+ */
+void sensfusionInit(void)
+{
+    q0 = 1.0f;
+    q1 = 0.0f;
+    q2 = 0.0f;
+    q3 = 0.0f;
+    g_biasX = 0.0f;
+    g_biasY = 0.0f;
+    g_biasZ = 0.0f;
+}
+
+/**
+ * @brief  归一化加速度，模长不在合理范围内时返回0
+ * @param  ax,ay,az: 加速度 (g)，输出归一化结果
+ * @retval 1-可用于修正，0-不可用
+ */
+static uint8_t sensfusionNormalizeAcc(float *ax, float *ay, float *az)
+{
+    float normSq = (*ax) * (*ax) + (*ay) * (*ay) + (*az) * (*az);
+    float recipNorm;
+    
+    if (normSq < SENSFUSION_ACC_MIN_G * SENSFUSION_ACC_MIN_G ||
+        normSq > SENSFUSION_ACC_MAX_G * SENSFUSION_ACC_MAX_G)
+    {
+        return 0;
+    }
+    
+    recipNorm = invSqrt(normSq);
+    *ax *= recipNorm;
+    *ay *= recipNorm;
+    *az *= recipNorm;
+    
+    return 1;
+}
+
+/**
+ * @brief  四元数积分并归一化
+ * @param  gx,gy,gz: 角速度 (rad/s)
+ * @param  sx,sy,sz,sw: 附加的四元数导数修正项(Madgwick使用，Mahony为0)
+ * @param  dt: 时间间隔 (s)
+ * @retval 无
+ */
+static void sensfusionIntegrate(float gx, float gy, float gz,
+                                float s0, float s1, float s2, float s3, float dt)
+{
+    float qDot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz) - s0;
+    float qDot1 = 0.5f * ( q0 * gx + q2 * gz - q3 * gy) - s1;
+    float qDot2 = 0.5f * ( q0 * gy - q1 * gz + q3 * gx) - s2;
+    float qDot3 = 0.5f * ( q0 * gz + q1 * gy - q2 * gx) - s3;
+    float recipNorm;
+    
+    q0 += qDot0 * dt;
+    q1 += qDot1 * dt;
+    q2 += qDot2 * dt;
+    q3 += qDot3 * dt;
+    
+    recipNorm = invSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q0 *= recipNorm;
+    q1 *= recipNorm;
+    q2 *= recipNorm;
+    q3 *= recipNorm;
+}
+
+#if SENSFUSION_ALGORITHM == SENSFUSION_MAHONY
+
+/**
+ * @brief  Mahony互补滤波
+ * @param  gx,gy,gz: 角速度 (rad/s)
+ * @param  ax,ay,az: 加速度 (g)
+ * @param  dt: 时间间隔 (s)
+ * @retval 无
+ */
+RAMFUNC static void sensfusionUpdateMahony(float gx, float gy, float gz, float ax, float ay, float az, float dt)
+{
+    float halfvx, halfvy, halfvz;
+    float halfex, halfey, halfez;
+    
+    if (sensfusionNormalizeAcc(&ax, &ay, &az))
+    {
+        /* 估计的重力方向(四元数旋转矩阵第三行的一半) */
+        halfvx = q1 * q3 - q0 * q2;
+        halfvy = q0 * q1 + q2 * q3;
+        halfvz = q0 * q0 - 0.5f + q3 * q3;
+        
+        /* 误差为测量重力方向与估计重力方向的叉积 */
+        halfex = ay * halfvz - az * halfvy;
+        halfey = az * halfvx - ax * halfvz;
+        halfez = ax * halfvy - ay * halfvx;
+        
+        /* 积分项跟踪陀螺仪零偏 */
+        g_biasX -= 2.0f * SENSFUSION_MAHONY_KI * halfex * dt;
+        g_biasY -= 2.0f * SENSFUSION_MAHONY_KI * halfey * dt;
+        g_biasZ -= 2.0f * SENSFUSION_MAHONY_KI * halfez * dt;
+        
+        /* 比例项 */
+        gx += 2.0f * SENSFUSION_MAHONY_KP * halfex;
+        gy += 2.0f * SENSFUSION_MAHONY_KP * halfey;
+        gz += 2.0f * SENSFUSION_MAHONY_KP * halfez;
+    }
+    
+    sensfusionIntegrate(gx - g_biasX, gy - g_biasY, gz - g_biasZ, 0.0f, 0.0f, 0.0f, 0.0f, dt);
+}
+
+#elif SENSFUSION_ALGORITHM == SENSFUSION_MADGWICK
+
+/**
+ * @brief  Madgwick梯度下降
+ * @param  gx,gy,gz: 角速度 (rad/s)
+ * @param  ax,ay,az: 加速度 (g)
+ * @param  dt: 时间间隔 (s)
+ * @retval 无
+ */
+static void sensfusionUpdateMadgwick(float gx, float gy, float gz, float ax, float ay, float az, float dt)
+{
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    float _2q0, _2q1, _2q2, _2q3, _4q0, _4q1, _4q2, _8q1, _8q2;
+    float q0q0, q1q1, q2q2, q3q3;
+    float recipNorm;
+    
+    if (sensfusionNormalizeAcc(&ax, &ay, &az))
+    {
+        _2q0 = 2.0f * q0;
+        _2q1 = 2.0f * q1;
+        _2q2 = 2.0f * q2;
+        _2q3 = 2.0f * q3;
+        _4q0 = 4.0f * q0;
+        _4q1 = 4.0f * q1;
+        _4q2 = 4.0f * q2;
+        _8q1 = 8.0f * q1;
+        _8q2 = 8.0f * q2;
+        q0q0 = q0 * q0;
+        q1q1 = q1 * q1;
+        q2q2 = q2 * q2;
+        q3q3 = q3 * q3;
+        
+        /* 目标函数梯度 */
+        s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+        
+        recipNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        if (recipNorm > 0.0f)
+        {
+            recipNorm = invSqrt(recipNorm);
+            s0 *= recipNorm;
+            s1 *= recipNorm;
+            s2 *= recipNorm;
+            s3 *= recipNorm;
+            
+            /* 梯度对应的角速度误差 2*q^-1⊗s，积分跟踪陀螺仪零偏 */
+            g_biasX += 2.0f * (q0 * s1 - q1 * s0 - q2 * s3 + q3 * s2) * SENSFUSION_MADGWICK_ZETA * dt;
+            g_biasY += 2.0f * (q0 * s2 + q1 * s3 - q2 * s0 - q3 * s1) * SENSFUSION_MADGWICK_ZETA * dt;
+            g_biasZ += 2.0f * (q0 * s3 - q1 * s2 + q2 * s1 - q3 * s0) * SENSFUSION_MADGWICK_ZETA * dt;
+            
+            s0 *= SENSFUSION_MADGWICK_BETA;
+            s1 *= SENSFUSION_MADGWICK_BETA;
+            s2 *= SENSFUSION_MADGWICK_BETA;
+            s3 *= SENSFUSION_MADGWICK_BETA;
+        }
+    }
+    
+    sensfusionIntegrate(gx - g_biasX, gy - g_biasY, gz - g_biasZ, s0, s1, s2, s3, dt);
+}
+
+#else
+#error "SENSFUSION_ALGORITHM配置错误"
+#endif
+
+/**
+ * @brief  姿态更新
+ * @param  gx,gy,gz: 角速度 (deg/s)
+ * @param  ax,ay,az: 加速度 (g)
+ * @param  dt: 时间间隔 (s)
+ * @retval 无
+ */
+void sensfusionUpdate(float gx, float gy, float gz, float ax, float ay, float az, float dt)
+{
+    gx *= DEG2RAD;
+    gy *= DEG2RAD;
+    gz *= DEG2RAD;
+    
+#if SENSFUSION_ALGORITHM == SENSFUSION_MAHONY
+    sensfusionUpdateMahony(gx, gy, gz, ax, ay, az, dt);
+#else
+    sensfusionUpdateMadgwick(gx, gy, gz, ax, ay, az, dt);
+#endif
+}
+
+/**
+ * @brief  获取欧拉角
+ * @param  roll,pitch,yaw: 输出欧拉角 (deg)
+ * @retval 无
+ */
+void sensfusionGetEuler(float *roll, float *pitch, float *yaw)
+{
+    float sinp = constrainf(2.0f * (q0 * q2 - q3 * q1), -1.0f, 1.0f);
+    
+    *roll = atan2f(2.0f * (q0 * q1 + q2 * q3), 1.0f - 2.0f * (q1 * q1 + q2 * q2)) * RAD2DEG;
+    *pitch = asinf(sinp) * RAD2DEG;
+    *yaw = atan2f(2.0f * (q0 * q3 + q1 * q2), 1.0f - 2.0f * (q2 * q2 + q3 * q3)) * RAD2DEG;
+}
+
+/**
+ * @brief  获取姿态四元数
+ * @param  q: 输出四元数[w, x, y, z]
+ * @retval 无
+ */
+void sensfusionGetQuaternion(float *q)
+{
+    q[0] = q0;
+    q[1] = q1;
+    q[2] = q2;
+    q[3] = q3;
+}
+
+/**
+ * @brief  获取陀螺仪零偏估计
+ * @param  bias: 输出零偏[x, y, z] (deg/s)
+ * @retval 无
+ */
+void sensfusionGetGyroBias(float *bias)
+{
+    bias[0] = g_biasX * RAD2DEG;
+    bias[1] = g_biasY * RAD2DEG;
+    bias[2] = g_biasZ * RAD2DEG;
+}
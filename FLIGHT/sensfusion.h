@@ -0,0 +1,42 @@
+﻿/*
+ * sensfusion.h
+ *
+ * 四元数姿态解算头文件
+ * 陀螺仪+加速度计融合，可选Mahony互补滤波或Madgwick梯度下降
+ *
+ * 2026-02-18
+ */
+
+#ifndef SENSFUSION_H
+#define SENSFUSION_H
+
+#include <stdint.h>
+
+/* 算法选择 */
+#define SENSFUSION_MAHONY          0
+#define SENSFUSION_MADGWICK        1
+
+#ifndef SENSFUSION_ALGORITHM
+#define SENSFUSION_ALGORITHM       SENSFUSION_MAHONY
+#endif
+
+/* Mahony参数 */
+#define SENSFUSION_MAHONY_KP       0.4f      // 比例增益
+#define SENSFUSION_MAHONY_KI       0.005f    // 积分增益(陀螺仪零偏跟踪)
+
+/* Madgwick参数 */
+#define SENSFUSION_MADGWICK_BETA   0.1f      // 梯度下降步长
+#define SENSFUSION_MADGWICK_ZETA   0.003f    // 陀螺仪零偏跟踪增益
+
+/* 加速度模长在该范围外时(机动、冲击)不做加速度修正 */
+#define SENSFUSION_ACC_MIN_G       0.5f
+#define SENSFUSION_ACC_MAX_G       1.5f
+
+/* 函数声明 */
+void sensfusionInit(void);
+void sensfusionUpdate(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+void sensfusionGetEuler(float *roll, float *pitch, float *yaw);
+void sensfusionGetQuaternion(float *q);
+void sensfusionGetGyroBias(float *bias);
+
+#endif /* SENSFUSION_H */
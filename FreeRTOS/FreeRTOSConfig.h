@@ -43,19 +43,26 @@
 #define configUSE_TICKLESS_IDLE                 0                        /* 不使用无tick空闲模式，实时性要求高 */
 
 /* 内存配置 */
-#define configTOTAL_HEAP_SIZE                   ( ( size_t ) ( 16 * 1024 ) ) /* 16KB堆大小，适合STM32F411CEU6 */
-#define configAPPLICATION_ALLOCATED_HEAP        0                          /* 不使用应用程序分配的堆 */
+/* 任务、队列等全部使用静态数组创建，不链接heap_x.c，运行时没有动态分配，RAM占用在链接时确定 */
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        0
+#define configKERNEL_PROVIDED_STATIC_MEMORY     1                          /* 空闲任务与定时器任务的栈由内核静态提供 */
 
 /* 钩子函数配置 */
-#define configUSE_IDLE_HOOK                     0
+#define configUSE_IDLE_HOOK                     1                        /* cpuload.c统计空闲时间 */
 #define configUSE_TICK_HOOK                     0
 #define configUSE_MALLOC_FAILED_HOOK            0
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
+#define configCHECK_FOR_STACK_OVERFLOW          2                        /* 切换任务时检查栈顶标记，溢出时调用stackmon.c的钩子 */
 
 /* 运行时统计信息 */
-#define configGENERATE_RUN_TIME_STATS           0
-#define configUSE_TRACE_FACILITY                0
+/* 以DWT周期计数为运行时统计时钟(100MHz，10ns分辨率)，32位计数约42.9s回绕，按窗口取差值不受影响 */
+#define configGENERATE_RUN_TIME_STATS           1
+#define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
+extern void DWT_Init( void );
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    DWT_Init()
+#define portGET_RUN_TIME_COUNTER_VALUE()            ( *( volatile uint32_t * ) 0xE0001004 )   /* DWT->CYCCNT */
 
 /* 协程配置 */
 #define configUSE_CO_ROUTINES                   0
@@ -86,14 +93,10 @@
 #define configUSE_EVENT_GROUPS                  1
 
 /* 任务优先级相关 */
-/* 四轴飞控任务优先级分配建议：
+/* 应用任务的优先级不手工指定，由main.c任务表按截止时间单调分配(截止时间越短优先级越高)：
  * 0: 空闲任务（系统默认）
- * 1: 低优先级任务（日志、状态更新等）
- * 2: 中优先级任务（通信任务、参数管理等）
- * 3: 较高优先级任务（传感器数据处理）
- * 4: 高优先级任务（姿态解算）
- * 5: 最高优先级任务（电机控制）
- * 6: 系统任务（定时器任务等）
+ * 1 ~ configMAX_PRIORITIES-2: 应用任务
+ * configMAX_PRIORITIES-1: 定时器任务
  */
 
 /* 与STM32相关的配置 */
@@ -109,6 +112,8 @@
 #define INCLUDE_xTaskAbortDelay                1
 #define INCLUDE_xTaskGetHandle                 1
 #define INCLUDE_xTaskGetCurrentTaskHandle      1
+#define INCLUDE_uxTaskGetStackHighWaterMark    1
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle 1
 #define INCLUDE_pxTaskGetStackStart            1
 #define INCLUDE_eTaskGetState                  1
 #define INCLUDE_xEventGroupSetBitsFromISR      1
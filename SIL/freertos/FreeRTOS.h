@@ -0,0 +1,70 @@
+﻿/*
+ * FreeRTOS.h
+ *
+ * SIL仿真用的FreeRTOS替身(主机构建)
+ * 只提供stabilizer.c、atkpRx.c与FreeRTOS/port/heap_4.c(主机测试中与内存池对比)用到的类型与接口，
+ * 实现见SIL/sil_rtos.c：
+ * 1.没有调度器，仿真主循环直接调用stabilizerStep、atkpRxPoll，任务函数本身不运行
+ * 2.系统节拍由hal_sim的虚拟时钟换算(configTICK_RATE_HZ)，vTaskDelayUntil推进虚拟时钟
+ * 3.队列为静态分配的非阻塞FIFO，等待时间被忽略
+ * 4.单线程运行，临界区与任务切换为空操作
+ *
+ * 2026-03-01
+ */
+
+#ifndef SIL_FREERTOS_H
+#define SIL_FREERTOS_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define configTICK_RATE_HZ       1000
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                  ((BaseType_t)0)
+#define pdTRUE                   ((BaseType_t)1)
+#define pdPASS                   pdTRUE
+#define pdFAIL                   pdFALSE
+#define portMAX_DELAY            ((TickType_t)0xFFFFFFFF)
+#define pdMS_TO_TICKS(ms)        ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
+
+/* heap_4.c的配置，堆大小可在编译选项中指定 */
+#define configSUPPORT_DYNAMIC_ALLOCATION  1
+#ifndef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE    ((size_t)(16 * 1024))
+#endif
+#define configASSERT(x)          assert(x)
+#define portBYTE_ALIGNMENT       8
+#define portBYTE_ALIGNMENT_MASK  (portBYTE_ALIGNMENT - 1)
+#define portPOINTER_SIZE_TYPE    uintptr_t
+#define PRIVILEGED_DATA
+#define PRIVILEGED_FUNCTION
+#define mtCOVERAGE_TEST_MARKER()
+#define traceMALLOC(p, size)
+#define traceFREE(p, size)
+
+/* 堆统计，vPortGetHeapStats填写 */
+typedef struct xHeapStats {
+    size_t xAvailableHeapSpaceInBytes;        // 空闲字节数
+    size_t xSizeOfLargestFreeBlockInBytes;    // 最大空闲块
+    size_t xSizeOfSmallestFreeBlockInBytes;   // 最小空闲块
+    size_t xNumberOfFreeBlocks;               // 空闲块个数
+    size_t xMinimumEverFreeBytesRemaining;    // 历史最少空闲字节数
+    size_t xNumberOfSuccessfulAllocations;    // 成功分配次数
+    size_t xNumberOfSuccessfulFrees;          // 成功释放次数
+} HeapStats_t;
+
+void *pvPortMalloc(size_t xWantedSize);
+void vPortFree(void *pv);
+size_t xPortGetFreeHeapSize(void);
+void vPortGetHeapStats(HeapStats_t *pxHeapStats);
+
+#endif /* SIL_FREERTOS_H */
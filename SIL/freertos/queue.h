@@ -0,0 +1,33 @@
+﻿/*
+ * queue.h
+ *
+ * SIL仿真用的FreeRTOS队列接口替身，见FreeRTOS.h
+ * 队列满时发送立即失败，队列空时接收立即失败，不等待
+ *
+ * 2026-03-01
+ */
+
+#ifndef SIL_QUEUE_H
+#define SIL_QUEUE_H
+
+#include "FreeRTOS.h"
+
+/* 队列控制块，由调用者静态分配 */
+typedef struct {
+    uint8_t *storage;
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t head;            // 下一个读出的位置
+    UBaseType_t count;           // 队列中的元素数
+} StaticQueue_t;
+
+typedef StaticQueue_t *QueueHandle_t;
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t itemSize,
+                                 uint8_t *storage, StaticQueue_t *queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait);
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t ticksToWait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticksToWait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#endif /* SIL_QUEUE_H */
@@ -0,0 +1,24 @@
+﻿/*
+ * task.h
+ *
+ * SIL仿真用的FreeRTOS任务接口替身，见FreeRTOS.h
+ *
+ * 2026-03-01
+ */
+
+#ifndef SIL_TASK_H
+#define SIL_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef struct silTask_s *TaskHandle_t;
+
+TickType_t xTaskGetTickCount(void);
+void vTaskDelayUntil(TickType_t *previousWakeTime, TickType_t increment);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+
+#endif /* SIL_TASK_H */
@@ -0,0 +1,262 @@
+﻿/*
+ * sil_bbdecode.c
+ *
+ * 黑匣子记录解码：把fc_sil --blackbox/--blackbox-flash(或从目标板Flash读出)的数据解码为CSV，
+ * 并统计记录次数、帧数、平均每帧字节数、丢帧与无法解码的字节
+ *
+ * 用法：
+ *   fc_blackbox_decode LOG [--out FILE] [--raw]
+ *   --out FILE    每帧一行：session,iteration,time_us,各字段(列名见blackboxFields)
+ *   --raw         输出量化后的整数(默认为物理量)
+ *
+ * 2026-03-01
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "blackboxCodec.h"
+
+/* 解码统计 */
+typedef struct {
+    uint32_t sessions;           // 文件头数
+    uint32_t ended;              // 正常结束(有结束标记)的记录数
+    uint32_t frames;             // 帧数
+    uint32_t keyFrames;          // 关键帧数
+    uint32_t frameBytes;         // 帧的字节数
+    uint32_t gaps;               // 迭代序号不连续的次数
+    uint32_t missing;            // 缺失的迭代数
+    uint32_t dropped;            // 结束标记中记录的丢弃帧数
+    uint32_t skipped;            // 跳过的字节数(含Flash中未写入的0xFF)
+    uint32_t truncated;          // 末尾不完整的字节数
+    uint64_t durationUs;         // 各次记录的时长之和 (us)
+} bbdecodeResult_t;
+
+/**
+ * @brief  读取整个文件
+ * @param  path: 文件名
+ * @param  len: 输出字节数
+ * @retval 文件内容(malloc)，失败时为0(已打印错误信息)
+ */
+static uint8_t *bbdecodeLoad(const char *path, uint32_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *data = 0;
+    long size;
+    
+    if (!f)
+    {
+        perror(path);
+        return 0;
+    }
+    if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) >= 0 && size <= 0x7FFFFFFF &&
+        fseek(f, 0, SEEK_SET) == 0)
+    {
+        data = (uint8_t *)malloc(size ? (size_t)size : 1);
+        if (data && fread(data, 1, (size_t)size, f) == (size_t)size)
+        {
+            *len = (uint32_t)size;
+        }
+        else
+        {
+            free(data);
+            data = 0;
+        }
+    }
+    if (!data)
+    {
+        fprintf(stderr, "%s: read failed\n", path);
+    }
+    fclose(f);
+    
+    return data;
+}
+
+/**
+ * @brief  解码全部数据
+ * @param  data: 数据
+ * @param  len: 字节数
+ * @param  out: CSV输出，可为0
+ * @param  raw: 1-输出量化值
+ * @param  res: 输出统计
+ * @retval 无
+ */
+static void bbdecodeRun(const uint8_t *data, uint32_t len, FILE *out, uint8_t raw, bbdecodeResult_t *res)
+{
+    static blackboxCodec_t dec;
+    blackboxDecoded_t item;
+    uint32_t pos = 0, n, firstUs = 0, lastIteration = 0, lastUs = 0;
+    uint8_t inSession = 0, haveFrame = 0, i;
+    
+    memset(res, 0, sizeof(*res));
+    blackboxDecoderInit(&dec);
+    
+    if (out)
+    {
+        fprintf(out, "session,iteration,time_us");
+        for (i = 0; i < BLACKBOX_FIELD_NUM; i++)
+        {
+            fprintf(out, ",%s", blackboxFields[i].name);
+        }
+        fprintf(out, "\n");
+    }
+    
+    while ((n = blackboxDecode(&dec, &data[pos], len - pos, &item)) > 0)
+    {
+        pos += n;
+        
+        switch (item.type)
+        {
+            case BLACKBOX_DECODED_HEADER:
+                if (haveFrame)
+                {
+                    res->durationUs += lastUs - firstUs;
+                }
+                res->sessions++;
+                inSession = 1;
+                haveFrame = 0;
+                break;
+            
+            case BLACKBOX_DECODED_FRAME:
+                if (!haveFrame)
+                {
+                    firstUs = item.timeUs;
+                    haveFrame = 1;
+                }
+                else if (item.iteration != lastIteration + 1)
+                {
+                    res->gaps++;
+                    res->missing += item.iteration - lastIteration - 1;
+                }
+                lastIteration = item.iteration;
+                lastUs = item.timeUs;
+                res->frames++;
+                res->keyFrames += item.key;
+                res->frameBytes += n;
+                
+                if (out)
+                {
+                    fprintf(out, "%u,%u,%u", (unsigned)res->sessions, (unsigned)item.iteration, (unsigned)item.timeUs);
+                    for (i = 0; i < BLACKBOX_FIELD_NUM; i++)
+                    {
+                        if (raw)
+                        {
+                            fprintf(out, ",%d", (int)item.values[i]);
+                        }
+                        else
+                        {
+                            fprintf(out, ",%.7g", (double)blackboxDequantize(i, item.values[i]));
+                        }
+                    }
+                    fprintf(out, "\n");
+                }
+                break;
+            
+            case BLACKBOX_DECODED_END:
+                res->ended++;
+                res->dropped += item.dropped;
+                inSession = 0;
+                break;
+            
+            default:
+                res->skipped += n;
+                break;
+        }
+    }
+    
+    if (haveFrame)
+    {
+        res->durationUs += lastUs - firstUs;
+    }
+    (void)inSession;
+    res->truncated = len - pos;
+}
+
+/**
+ * @brief  打印用法
+ */
+static void bbdecodeUsage(const char *prog)
+{
+    printf("usage: %s LOG [options]\n"
+           "  --out FILE                 write one CSV line per frame\n"
+           "  --raw                      write quantized integers instead of physical values\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *logPath = 0, *outPath = 0;
+    bbdecodeResult_t res;
+    uint8_t *data;
+    uint32_t len = 0;
+    uint8_t raw = 0;
+    FILE *out = 0;
+    int a;
+    
+    for (a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "--help") == 0 || strcmp(argv[a], "-h") == 0)
+        {
+            bbdecodeUsage(argv[0]);
+            return 0;
+        }
+        if (argv[a][0] != '-')
+        {
+            logPath = argv[a];
+        }
+        else if (strcmp(argv[a], "--raw") == 0)
+        {
+            raw = 1;
+        }
+        else if (strcmp(argv[a], "--out") == 0 && a + 1 < argc)
+        {
+            outPath = argv[++a];
+        }
+        else
+        {
+            bbdecodeUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (!logPath)
+    {
+        bbdecodeUsage(argv[0]);
+        return 2;
+    }
+    
+    data = bbdecodeLoad(logPath, &len);
+    if (!data)
+    {
+        return 1;
+    }
+    if (outPath)
+    {
+        out = fopen(outPath, "w");
+        if (!out)
+        {
+            perror(outPath);
+            free(data);
+            return 1;
+        }
+    }
+    
+    bbdecodeRun(data, len, out, raw, &res);
+    if (out)
+    {
+        fclose(out);
+    }
+    free(data);
+    
+    printf("sessions               %u (%u ended)\n", (unsigned)res.sessions, (unsigned)res.ended);
+    printf("frames                 %u (%u key frames)\n", (unsigned)res.frames, (unsigned)res.keyFrames);
+    printf("bytes_per_frame        %.2f\n", res.frames ? (double)res.frameBytes / res.frames : 0.0);
+    printf("duration               %.3f s\n", (double)res.durationUs * 1e-6);
+    printf("gaps                   %u (%u iterations missing, %u dropped)\n", (unsigned)res.gaps,
+           (unsigned)res.missing, (unsigned)res.dropped);
+    printf("skipped                %u bytes\n", (unsigned)res.skipped);
+    if (res.truncated)
+    {
+        printf("truncated              %u bytes\n", (unsigned)res.truncated);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,217 @@
+﻿/*
+ * sil_flash.c
+ *
+ * SIL仿真SPI NOR Flash模型实现
+ *
+ * 2026-03-01
+ */
+
+#include "sil_flash.h"
+#include "hal_sim.h"
+#include "W25Q.h"
+#include <string.h>
+
+static const uint8_t g_jedecId[3] = {0xEF, 0x40, SIL_FLASH_CAPACITY_LOG2};   // Winbond W25Q128JV
+
+static uint8_t g_memory[SIL_FLASH_CAPACITY];
+static uint8_t g_page[W25Q_PAGE_SIZE];       // 页编程数据(片选释放时写入)
+static uint8_t g_pageMask[W25Q_PAGE_SIZE];   // 页内已接收数据的位置
+static uint32_t g_index;                     // 本次片选内收到的字节数
+static uint8_t g_cmd;
+static uint32_t g_addr;
+static uint8_t g_wel;                        // 写使能锁存
+static uint8_t g_ignored;                    // 本条命令因忙被忽略
+static uint64_t g_busyUntilNs;
+static silFlashStats_t g_stats;
+static halSimSpiDevice_t g_dev;
+
+/**
+ * @brief  编程/擦除是否在进行中
+ */
+static uint8_t silFlashBusy(void)
+{
+    return halSimNowNs() < g_busyUntilNs;
+}
+
+/**
+ * @brief  开始一次编程/擦除：BUSY持续给定时间，完成后清除WEL
+ */
+static void silFlashStartBusy(uint64_t ns)
+{
+    g_busyUntilNs = halSimNowNs() + ns;
+    g_stats.busyNs += ns;
+    g_wel = 0;
+}
+
+/**
+ * @brief  片选释放时执行编程/擦除与写使能
+ */
+static void silFlashExecute(void)
+{
+    uint32_t base, i;
+    uint8_t bits;
+    
+    if (g_ignored || g_index == 0)
+    {
+        return;
+    }
+    
+    if (g_cmd == W25Q_CMD_WRITE_ENABLE)
+    {
+        g_wel = 1;
+        return;
+    }
+    if (g_cmd != W25Q_CMD_PAGE_PROGRAM && g_cmd != W25Q_CMD_SECTOR_ERASE && g_cmd != W25Q_CMD_CHIP_ERASE)
+    {
+        return;
+    }
+    
+    /* 地址不完整的命令芯片不执行 */
+    if (!g_wel || (g_cmd != W25Q_CMD_CHIP_ERASE && g_index < 4))
+    {
+        g_stats.rejected++;
+        return;
+    }
+    
+    switch (g_cmd)
+    {
+        case W25Q_CMD_PAGE_PROGRAM:
+            base = g_addr & ~(uint32_t)(W25Q_PAGE_SIZE - 1);
+            for (i = 0; i < W25Q_PAGE_SIZE; i++)
+            {
+                if (g_pageMask[i])
+                {
+                    bits = (uint8_t)(g_page[i] & ~g_memory[base + i]);
+                    while (bits)
+                    {
+                        g_stats.badBits += bits & 1;
+                        bits >>= 1;
+                    }
+                    g_memory[base + i] &= g_page[i];
+                    g_stats.bytesProgrammed++;
+                }
+            }
+            g_stats.pagePrograms++;
+            silFlashStartBusy(SIL_FLASH_PAGE_NS);
+            break;
+        
+        case W25Q_CMD_SECTOR_ERASE:
+            memset(&g_memory[g_addr & ~(uint32_t)(W25Q_SECTOR_SIZE - 1)], 0xFF, W25Q_SECTOR_SIZE);
+            g_stats.sectorErases++;
+            silFlashStartBusy(SIL_FLASH_SECTOR_NS);
+            break;
+        
+        default:
+            memset(g_memory, 0xFF, sizeof(g_memory));
+            g_stats.chipErases++;
+            silFlashStartBusy(SIL_FLASH_CHIP_NS);
+            break;
+    }
+}
+
+/**
+ * @brief  片选变化：选中时开始新命令，释放时执行
+ */
+static void silFlashOnSelect(halSimSpiDevice_t *dev, uint8_t select)
+{
+    if (select)
+    {
+        g_index = 0;
+        g_ignored = 0;
+        memset(g_pageMask, 0, sizeof(g_pageMask));
+    }
+    else
+    {
+        silFlashExecute();
+    }
+}
+
+/**
+ * @brief  交换一个字节
+ */
+static uint8_t silFlashOnByte(halSimSpiDevice_t *dev, uint8_t tx)
+{
+    uint32_t i = g_index++;
+    uint32_t offset;
+    
+    if (i == 0)
+    {
+        g_cmd = tx;
+        g_addr = 0;
+        /* 忙时只响应读状态寄存器 */
+        if (silFlashBusy() && tx != W25Q_CMD_READ_STATUS1)
+        {
+            g_ignored = 1;
+            g_stats.rejected++;
+        }
+        return 0xFF;
+    }
+    if (g_ignored)
+    {
+        return 0xFF;
+    }
+    
+    switch (g_cmd)
+    {
+        case W25Q_CMD_JEDEC_ID:
+            return i <= 3 ? g_jedecId[i - 1] : 0xFF;
+        
+        case W25Q_CMD_READ_STATUS1:
+            return (uint8_t)((silFlashBusy() ? W25Q_STATUS_BUSY : 0) | (g_wel ? W25Q_STATUS_WEL : 0));
+        
+        default:
+            break;
+    }
+    
+    /* 3字节地址 */
+    if (i <= 3)
+    {
+        g_addr = (g_addr << 8) | tx;
+        return 0xFF;
+    }
+    
+    if (g_cmd == W25Q_CMD_READ_DATA)
+    {
+        offset = (g_addr + (i - 4)) & (SIL_FLASH_CAPACITY - 1);
+        return g_memory[offset];
+    }
+    if (g_cmd == W25Q_CMD_PAGE_PROGRAM)
+    {
+        /* 超出页尾的数据回绕到页首 */
+        offset = (g_addr + (i - 4)) & (W25Q_PAGE_SIZE - 1);
+        g_page[offset] = tx;
+        g_pageMask[offset] = 1;
+    }
+    
+    return 0xFF;
+}
+
+/**
+ * @brief  Flash模型初始化：全部擦除并挂接到SPI2，需在halSimReset之后调用
+ * @param  无
+ * @retval 无
+ */
+void silFlashInit(void)
+{
+    memset(g_memory, 0xFF, sizeof(g_memory));
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_index = 0;
+    g_wel = 0;
+    g_ignored = 0;
+    g_busyUntilNs = 0;
+    
+    g_dev.onSelect = silFlashOnSelect;
+    g_dev.onByte = silFlashOnByte;
+    g_dev.user = 0;
+    halSimSpiAttach(HAL_SPI_2, &g_dev);
+}
+
+/**
+ * @brief  获取统计
+ * @param  stats: 输出统计
+ * @retval 无
+ */
+void silFlashGetStats(silFlashStats_t *stats)
+{
+    *stats = g_stats;
+}
@@ -0,0 +1,41 @@
+﻿/*
+ * sil_flash.h
+ *
+ * SIL仿真SPI NOR Flash模型头文件
+ * 在hal_sim的SPI2上挂接W25Q128(16MB)模型，按命令字节序列实现W25Q驱动用到的命令：
+ * 1.JEDEC ID、读状态寄存器1、写使能、读数据(地址自动递增)
+ * 2.页编程：数据在页内回绕，片选释放时生效，只能把1编程为0(与原有内容按位与)
+ * 3.扇区/整片擦除：全部置为0xFF
+ * 编程与擦除需要先写使能，执行期间BUSY置位并持续典型时间(按虚拟时钟)，
+ * 忙时收到的读/编程/擦除命令被忽略(与芯片相同)并计数
+ *
+ * 2026-03-01
+ */
+
+#ifndef SIL_FLASH_H
+#define SIL_FLASH_H
+
+#include <stdint.h>
+
+#define SIL_FLASH_CAPACITY_LOG2  24                 // 16MB
+#define SIL_FLASH_CAPACITY       (1UL << SIL_FLASH_CAPACITY_LOG2)
+#define SIL_FLASH_PAGE_NS        700000ULL          // 页编程 0.7ms
+#define SIL_FLASH_SECTOR_NS      45000000ULL        // 扇区擦除 45ms
+#define SIL_FLASH_CHIP_NS        40000000000ULL     // 整片擦除 40s
+
+/* 统计 */
+typedef struct {
+    uint32_t pagePrograms;       // 页编程次数
+    uint32_t bytesProgrammed;    // 编程的字节数
+    uint32_t sectorErases;       // 扇区擦除次数
+    uint32_t chipErases;         // 整片擦除次数
+    uint32_t rejected;           // 忙或未写使能时被忽略的命令数
+    uint32_t badBits;            // 编程时要求把0变为1的位数(目标区域未擦除)
+    uint64_t busyNs;             // 编程/擦除的忙时间 (ns)
+} silFlashStats_t;
+
+/* 函数声明 */
+void silFlashInit(void);
+void silFlashGetStats(silFlashStats_t *stats);
+
+#endif /* SIL_FLASH_H */
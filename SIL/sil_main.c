@@ -0,0 +1,788 @@
+﻿/*
+ * sil_main.c
+ *
+ * 软件在环(SIL)仿真：在主机上运行真实的stabilizer迭代(传感器驱动、陀螺仪滤波、姿态解算、
+ * 串级PID、混控)与atkpRx遥控数据处理，传感器经hal_sim的I2C寄存器模型读取6自由度机体模型的状态，
+ * 混控输出(COMMUNITY_TOPIC_MOTOR)驱动机体模型的电机，遥控设定值由脚本按50Hz打包成DOWN_RCDATA送入atkpRx
+ *
+ * 时间全部为虚拟时间：每次迭代在周期起点开始，I2C事务按总线时钟推进虚拟时钟，
+ * 因此stabilizerGetTiming得到的各阶段耗时为仿真时间(只含I2C传输时间，不含CPU计算时间)，
+ * 计算耗时需在目标板上用DWT测量。仿真不等待真实时间，运行速度远快于实时
+ *
+ * 用法：
+ *   fc_sil [--script FILE] [--duration S] [--seed N] [--set NAME=VALUE]... [--csv FILE [--csv-div N]]
+ *   fc_sil --sweep NAME=START:STOP:STEP [...]      每个取值运行一次，每行输出一组结果
+ *   fc_sil --list-params                            列出可设置的参数
+ *   fc_sil --record FILE                            同时保存原始传感器记录(sensorlog)，用fc_replay回放
+ *   fc_sil --blackbox FILE                          黑匣子直接写入文件
+ *   fc_sil --blackbox-flash FILE                    黑匣子写入SPI NOR Flash模型，结束后读出到文件
+ * 黑匣子文件用fc_blackbox_decode解码为CSV
+ *
+ * 2026-03-01
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hal_sim.h"
+#include "stabilizer.h"
+#include "atkpRx.h"
+#include "atkpTx.h"
+#include "cpuload.h"
+#include "community.h"
+#include "radioLink.h"
+#include "mixer.h"
+#include "sensorlog.h"
+#include "blackbox.h"
+#include "blackboxFlash.h"
+#include "W25Q.h"
+#include "sil_flash.h"
+#include "sil_quad.h"
+#include "sil_sensors.h"
+#include "sil_rc.h"
+
+#define SIL_PERIOD_NS            (1000000000ULL / STABILIZER_RATE_HZ)
+#define SIL_RC_PERIOD_NS         (ATKPRX_PERIOD_MS * 1000000ULL)
+#define SIL_SWEEP_MAX            1000
+#define SIL_BLACKBOX_DIV         (STABILIZER_RATE_HZ * BLACKBOX_PERIOD_MS / 1000)
+#define SIL_BLACKBOX_CLOSE_MS    60000       // 结束时等待黑匣子写完的最长仿真时间
+
+/* 一次仿真的全部可调参数 */
+typedef struct {
+    silQuadParams_t quad;
+    silSensorsParams_t sensors;
+    pidGains_t angleGains[PID_AXIS_NUM];
+    pidGains_t rateGains[PID_AXIS_NUM];
+} silConfig_t;
+
+/* 可由--set/--sweep设置的参数：从offset开始的count个值，间隔stride字节 */
+typedef struct {
+    const char *name;
+    size_t offset;
+    uint8_t isFloat;             // 1-float，0-double
+    uint8_t count;
+    size_t stride;
+    const char *help;
+} silParam_t;
+
+/* double参数；float参数；横滚与俯仰共用的PID参数 */
+#define SIL_PARAM_D(name, field, help)        {name, offsetof(silConfig_t, field), 0, 1, 0, help}
+#define SIL_PARAM_F(name, field, help)        {name, offsetof(silConfig_t, field), 1, 1, 0, help}
+#define SIL_PARAM_RP(name, gains, field, help) {name, offsetof(silConfig_t, gains[0].field), 1, 2, sizeof(pidGains_t), help}
+
+static const silParam_t g_params[] = {
+    SIL_PARAM_D("quad.mass",        quad.mass,             "mass (kg)"),
+    SIL_PARAM_D("quad.arm",         quad.arm,              "motor to center distance (m)"),
+    SIL_PARAM_D("quad.ixx",         quad.inertia[0],       "roll inertia (kg*m^2)"),
+    SIL_PARAM_D("quad.iyy",         quad.inertia[1],       "pitch inertia (kg*m^2)"),
+    SIL_PARAM_D("quad.izz",         quad.inertia[2],       "yaw inertia (kg*m^2)"),
+    SIL_PARAM_D("quad.max_thrust",  quad.maxThrust,        "max thrust per motor (N)"),
+    SIL_PARAM_D("quad.torque_ratio", quad.torqueRatio,     "yaw reaction torque / thrust (m)"),
+    SIL_PARAM_D("quad.motor_tau",   quad.motorTau,         "motor speed time constant (s)"),
+    SIL_PARAM_D("quad.thrust_curve", quad.thrustCurve,     "thrust curve quadratic term k"),
+    SIL_PARAM_D("quad.rotor_hz",    quad.rotorHz,          "rotor frequency at full speed (Hz)"),
+    SIL_PARAM_D("quad.drag",        quad.drag,             "linear drag (N/(m/s))"),
+    SIL_PARAM_D("quad.angular_drag", quad.angularDrag,     "angular drag (N*m/(rad/s))"),
+    SIL_PARAM_D("imu.gyro_noise",   sensors.gyroNoise,     "gyro white noise (deg/s rms)"),
+    SIL_PARAM_D("imu.gyro_bias",    sensors.gyroBias,      "gyro bias sigma (deg/s)"),
+    SIL_PARAM_D("imu.accel_noise",  sensors.accelNoise,    "accel white noise (g rms)"),
+    SIL_PARAM_D("imu.vib_accel",    sensors.vibAccel,      "accel vibration at full speed (g)"),
+    SIL_PARAM_D("imu.vib_gyro",     sensors.vibGyro,       "gyro vibration at full speed (deg/s)"),
+    SIL_PARAM_D("imu.dlpf_hz",      sensors.dlpfHz,        "on-chip low pass cutoff (Hz), 0 = off"),
+    SIL_PARAM_D("mag.field_x",      sensors.magField[0],   "earth field, north (uT)"),
+    SIL_PARAM_D("mag.field_y",      sensors.magField[1],   "earth field, west (uT)"),
+    SIL_PARAM_D("mag.field_z",      sensors.magField[2],   "earth field, up (uT)"),
+    SIL_PARAM_D("mag.noise",        sensors.magNoise,      "magnetometer white noise (uT rms)"),
+    SIL_PARAM_D("baro.noise",       sensors.baroNoise,     "barometer white noise (Pa rms)"),
+    SIL_PARAM_RP("angle.kp",        angleGains, kp,        "angle loop P, roll and pitch"),
+    SIL_PARAM_RP("rate.rp.kp",      rateGains, kp,         "rate loop P, roll and pitch"),
+    SIL_PARAM_RP("rate.rp.ki",      rateGains, ki,         "rate loop I, roll and pitch"),
+    SIL_PARAM_RP("rate.rp.kd",      rateGains, kd,         "rate loop D, roll and pitch"),
+    SIL_PARAM_F("rate.yaw.kp",      rateGains[2].kp,       "rate loop P, yaw"),
+    SIL_PARAM_F("rate.yaw.ki",      rateGains[2].ki,       "rate loop I, yaw"),
+};
+
+#define SIL_PARAM_NUM            (sizeof(g_params) / sizeof(g_params[0]))
+
+/* 一次仿真的结果 */
+typedef struct {
+    double simS;                 // 仿真时长 (s)
+    double wallS;                // 实际耗时 (s)
+    double trackSq[3];           // 跟踪误差平方和：横滚/俯仰角 (deg)，偏航角速度 (deg/s)
+    double estSq[2];             // 姿态估计误差平方和：横滚/俯仰 (deg)
+    uint32_t samples;            // 参与统计的迭代数(在空中且链路正常)
+    double maxTilt;              // 最大倾角 (deg)
+    double maxAltitude;          // 最大高度 (m)
+    double pos[3];               // 结束时的位置 (m)
+    stabilizerTiming_t timing;
+    halSimI2cStats_t i2c[HAL_I2C_NUM];
+    sensorlogStats_t log;        // 原始传感器记录统计(--record)
+    blackboxStats_t blackbox;    // 黑匣子统计(--blackbox/--blackbox-flash)
+    silFlashStats_t flash;       // Flash模型统计(--blackbox-flash)
+    halSimSpiStats_t spi;        // SPI2总线统计(--blackbox-flash)
+} silResult_t;
+
+static silQuad_t g_quad;
+static FILE *g_blackboxFile;         // 文件存储端的输出文件
+
+/**
+ * @brief  查找参数
+ * @param  name: 参数名
+ * @retval 参数，不存在时为0
+ */
+static const silParam_t *silFindParam(const char *name)
+{
+    size_t i;
+    
+    for (i = 0; i < SIL_PARAM_NUM; i++)
+    {
+        if (strcmp(g_params[i].name, name) == 0)
+        {
+            return &g_params[i];
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  设置参数
+ * @param  cfg: 配置
+ * @param  param: 参数
+ * @param  value: 值
+ * @retval 无
+ */
+static void silSetParam(silConfig_t *cfg, const silParam_t *param, double value)
+{
+    uint8_t *base = (uint8_t *)cfg + param->offset;
+    uint8_t i;
+    
+    for (i = 0; i < param->count; i++, base += param->stride)
+    {
+        if (param->isFloat)
+        {
+            *(float *)base = (float)value;
+        }
+        else
+        {
+            *(double *)base = value;
+        }
+    }
+}
+
+/**
+ * @brief  读取参数(多个值时取第一个)
+ * @param  cfg: 配置
+ * @param  param: 参数
+ * @retval 值
+ */
+static double silGetParam(const silConfig_t *cfg, const silParam_t *param)
+{
+    const uint8_t *base = (const uint8_t *)cfg + param->offset;
+    
+    return param->isFloat ? (double)*(const float *)base : *(const double *)base;
+}
+
+/**
+ * @brief  发送一包遥控数据并由atkpRx处理
+ * @param  sp: 设定值
+ * @retval 无
+ */
+static void silSendRc(const setpoint_t *sp)
+{
+    atkp_t p;
+    
+    p.msgID = DOWN_RCDATA;
+    p.dataLen = ATKP_RCDATA_SIZE;
+    memcpy(&p.data[0], &sp->roll, 4);
+    memcpy(&p.data[4], &sp->pitch, 4);
+    memcpy(&p.data[8], &sp->yawRate, 4);
+    memcpy(&p.data[12], &sp->thrust, 4);
+    atkpRxPacket(&p);
+    atkpRxPoll();
+}
+
+/**
+ * @brief  把记录缓冲区中的原始传感器记录写入文件
+ * @param  record: 输出文件
+ * @retval 无
+ */
+static void silRecordDrain(FILE *record)
+{
+    uint8_t buf[SENSORLOG_BUFFER_SIZE];
+    uint32_t n;
+    
+    while ((n = sensorlogRead(buf, sizeof(buf))) > 0)
+    {
+        fwrite(buf, 1, n, record);
+    }
+}
+
+/**
+ * @brief  文件存储端：开始一次记录(多次记录依次追加在同一文件中)
+ */
+static uint8_t silBlackboxOpen(void)
+{
+    return g_blackboxFile != 0;
+}
+
+/**
+ * @brief  文件存储端：写入
+ */
+static int32_t silBlackboxWrite(const uint8_t *data, uint32_t len)
+{
+    return fwrite(data, 1, len, g_blackboxFile) == len ? (int32_t)len : -1;
+}
+
+/**
+ * @brief  文件存储端：结束一次记录
+ */
+static void silBlackboxClose(void)
+{
+    fflush(g_blackboxFile);
+}
+
+static const blackboxBackend_t g_blackboxFileBackend = {
+    silBlackboxOpen,
+    silBlackboxWrite,
+    silBlackboxClose,
+    0,
+};
+
+/**
+ * @brief  结束黑匣子记录：请求关闭后按任务周期推进虚拟时钟，直到剩余数据写完
+ * @param  无
+ * @retval 无
+ */
+static void silBlackboxFinish(void)
+{
+    blackboxStats_t stats;
+    uint32_t t;
+    
+    blackboxClose();
+    for (t = 0; t < SIL_BLACKBOX_CLOSE_MS; t += BLACKBOX_PERIOD_MS)
+    {
+        blackboxGetStats(&stats);
+        if (stats.state != BLACKBOX_STATE_LOGGING && stats.state != BLACKBOX_STATE_CLOSING)
+        {
+            break;
+        }
+        halSimAdvanceNs(BLACKBOX_PERIOD_MS * 1000000ULL);
+        blackboxProcess();
+    }
+}
+
+/**
+ * @brief  把Flash中已写入的数据经W25Q驱动读出到文件
+ * @param  out: 输出文件
+ * @retval 读出的字节数
+ */
+static uint32_t silBlackboxDumpFlash(FILE *out)
+{
+    uint8_t buf[4096];
+    uint32_t used = blackboxFlashGetUsed();
+    uint32_t addr, n;
+    
+    for (addr = 0; addr < used; addr += n)
+    {
+        n = used - addr < sizeof(buf) ? used - addr : (uint32_t)sizeof(buf);
+        if (!W25Q_Read(addr, buf, n))
+        {
+            break;
+        }
+        fwrite(buf, 1, n, out);
+    }
+    
+    return addr;
+}
+
+/**
+ * @brief  运行一次仿真
+ * @param  cfg: 配置
+ * @param  script: 遥控脚本
+ * @param  duration: 仿真时长 (s)
+ * @param  seed: 随机数种子
+ * @param  csv: 轨迹输出，可为0
+ * @param  csvDiv: 每csvDiv次迭代输出一行
+ * @param  record: 原始传感器记录输出，可为0
+ * @param  blackbox: 黑匣子存储端，可为0
+ * @param  res: 输出结果
+ * @retval 无
+ */
+static void silRun(const silConfig_t *cfg, const silRcScript_t *script, double duration, uint64_t seed,
+                   FILE *csv, uint32_t csvDiv, FILE *record, const blackboxBackend_t *blackbox, silResult_t *res)
+{
+    uint8_t header[SENSORLOG_HEADER_SIZE];
+    const silRcStep_t *rc = 0;
+    radiolinkStatus_t link;
+    attitude_t est;
+    float motor[MIXER_MOTOR_NUM];
+    double euler[3], t, tilt, err;
+    uint64_t baseNs, startNs, nextRcNs = 0, endNs = (uint64_t)(duration * 1e9);
+    uint64_t k;
+    struct timespec wall0, wall1;
+    uint8_t quality = 0xFF, i;
+    
+    memset(res, 0, sizeof(*res));
+    clock_gettime(CLOCK_MONOTONIC, &wall0);
+    
+    halSimReset();
+    silQuadInit(&g_quad, &cfg->quad);
+    silSensorsInit(&g_quad, &cfg->sensors, seed);
+    if (blackbox == &blackboxFlashBackend)
+    {
+        silFlashInit();
+    }
+    atkpRxInit();
+    stabilizerInit();
+    blackboxInit(blackbox, STABILIZER_RATE_HZ);
+    controllerSetGains(cfg->angleGains, cfg->rateGains);
+    if (record)
+    {
+        fwrite(header, 1, sensorlogGetHeader(header), record);
+    }
+    else
+    {
+        sensorlogStop();
+    }
+    
+    /* 初始化中的I2C访问已推进虚拟时钟，第一次迭代对齐到下一个周期起点 */
+    baseNs = (halSimNowNs() / SIL_PERIOD_NS + 1) * SIL_PERIOD_NS;
+    
+    for (k = 0; k * SIL_PERIOD_NS < endNs; k++)
+    {
+        /* 周期起点：上一次迭代超时时立即开始 */
+        startNs = baseNs + k * SIL_PERIOD_NS;
+        if (halSimNowNs() < startNs)
+        {
+            halSimAdvanceNs(startNs - halSimNowNs());
+        }
+        silQuadAdvance(&g_quad, (double)halSimNowNs() * 1e-9);
+        t = (double)(halSimNowNs() - baseNs) * 1e-9;
+        
+        /* 遥控：按ATKPRX_PERIOD_MS发送，链路质量变化时更新链路状态 */
+        if (halSimNowNs() - baseNs >= nextRcNs)
+        {
+            nextRcNs += SIL_RC_PERIOD_NS;
+            rc = silRcAt(script, t);
+            if (rc->quality != quality)
+            {
+                quality = rc->quality;
+                link.quality = quality;
+                link.rssi = 0;
+                communityPublish(COMMUNITY_TOPIC_LINK, &link, sizeof(link));
+            }
+            if (quality > 0)
+            {
+                silSendRc(&rc->sp);
+            }
+        }
+        
+        stabilizerStep();
+        if (record)
+        {
+            silRecordDrain(record);
+        }
+        
+        /* 迭代期间(I2C传输)电机保持上一次的输出，结束时更新 */
+        silQuadAdvance(&g_quad, (double)halSimNowNs() * 1e-9);
+        communityRead(COMMUNITY_TOPIC_MOTOR, motor, sizeof(motor));
+        silQuadSetMotors(&g_quad, motor);
+        
+        /* 黑匣子任务优先级最低，在电机输出之后运行，SPI传输不推迟本次输出 */
+        if (blackbox && k % SIL_BLACKBOX_DIV == 0)
+        {
+            blackboxProcess();
+        }
+        
+        /* 统计 */
+        communityRead(COMMUNITY_TOPIC_ATTITUDE, &est, sizeof(est));
+        silQuadGetEuler(&g_quad, euler);
+        tilt = acos(fmin(1.0, fmax(-1.0, 1.0 - 2.0 * (g_quad.q[1] * g_quad.q[1] + g_quad.q[2] * g_quad.q[2])))) * (180.0 / M_PI);
+        res->maxTilt = fmax(res->maxTilt, tilt);
+        res->maxAltitude = fmax(res->maxAltitude, g_quad.pos[2]);
+        if (!g_quad.onGround && quality > 0 && rc->sp.thrust >= CONTROLLER_MIN_THRUST)
+        {
+            err = fmax(-CONTROLLER_MAX_ANGLE, fmin(CONTROLLER_MAX_ANGLE, (double)rc->sp.roll)) - euler[0];
+            res->trackSq[0] += err * err;
+            err = fmax(-CONTROLLER_MAX_ANGLE, fmin(CONTROLLER_MAX_ANGLE, (double)rc->sp.pitch)) - euler[1];
+            res->trackSq[1] += err * err;
+            err = (double)rc->sp.yawRate - g_quad.rate[2] * (180.0 / M_PI);
+            res->trackSq[2] += err * err;
+            err = (double)est.roll - euler[0];
+            res->estSq[0] += err * err;
+            err = (double)est.pitch - euler[1];
+            res->estSq[1] += err * err;
+            res->samples++;
+        }
+        
+        if (csv && k % csvDiv == 0)
+        {
+            fprintf(csv, "%.4f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,%.2f,%.2f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                    t, (double)rc->sp.roll, (double)rc->sp.pitch, (double)rc->sp.yawRate, (double)rc->sp.thrust,
+                    euler[0], euler[1], euler[2], (double)est.roll, (double)est.pitch, (double)est.yaw,
+                    g_quad.rate[0] * (180.0 / M_PI), g_quad.rate[1] * (180.0 / M_PI), g_quad.rate[2] * (180.0 / M_PI),
+                    (double)motor[0], (double)motor[1], (double)motor[2], (double)motor[3],
+                    g_quad.pos[0], g_quad.pos[1], g_quad.pos[2]);
+        }
+    }
+    
+    if (blackbox)
+    {
+        silBlackboxFinish();
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &wall1);
+    res->wallS = (double)(wall1.tv_sec - wall0.tv_sec) + (double)(wall1.tv_nsec - wall0.tv_nsec) * 1e-9;
+    res->simS = (double)(k * SIL_PERIOD_NS) * 1e-9;
+    for (i = 0; i < 3; i++)
+    {
+        res->pos[i] = g_quad.pos[i];
+    }
+    stabilizerGetTiming(&res->timing);
+    for (i = 0; i < HAL_I2C_NUM; i++)
+    {
+        halSimI2cGetStats((halI2c_e)i, &res->i2c[i]);
+    }
+    sensorlogGetStats(&res->log);
+    blackboxGetStats(&res->blackbox);
+    silFlashGetStats(&res->flash);
+    halSimSpiGetStats(HAL_SPI_2, &res->spi);
+}
+
+/**
+ * @brief  均方根
+ */
+static double silRms(double sumSq, uint32_t n)
+{
+    return n ? sqrt(sumSq / n) : 0.0;
+}
+
+/**
+ * @brief  打印耗时统计的均值与最大值 (us)
+ */
+static void silPrintStats(const char *name, const DWT_Stats_t *stats)
+{
+    printf("%-22s mean %6.1f  max %6.1f  (us, %u samples)\n", name,
+           (double)DWT_StatsMean(stats) * 1e6 / SystemCoreClock,
+           stats->count ? (double)stats->max * 1e6 / SystemCoreClock : 0.0, (unsigned)stats->count);
+}
+
+/**
+ * @brief  打印一次仿真的完整结果
+ */
+static void silPrintResult(const silResult_t *res)
+{
+    static const char *const stageNames[STABILIZER_STAGE_NUM] = {
+        "stage.read", "stage.estimate", "stage.control", "stage.mix"
+    };
+    uint8_t i;
+    
+    printf("sim_time               %.3f s\n", res->simS);
+    printf("wall_time              %.3f s\n", res->wallS);
+    printf("realtime_factor        %.1f\n", res->wallS > 0.0 ? res->simS / res->wallS : 0.0);
+    printf("loop_rate              %d Hz\n", STABILIZER_RATE_HZ);
+    printf("iterations             %u\n", (unsigned)res->timing.iterations);
+    printf("overruns               %u\n", (unsigned)res->timing.overruns);
+    silPrintStats("loop.total", &res->timing.total);
+    for (i = 0; i < STABILIZER_STAGE_NUM; i++)
+    {
+        silPrintStats(stageNames[i], &res->timing.stage[i]);
+    }
+    silPrintStats("loop.jitter", &res->timing.jitter);
+    silPrintStats("blackbox.log", &res->timing.blackbox);
+    for (i = 0; i < HAL_I2C_NUM; i++)
+    {
+        printf("i2c%u                   %u reads, %u writes, %u bytes, bus busy %.1f%%\n", i + 1,
+               (unsigned)res->i2c[i].reads, (unsigned)res->i2c[i].writes, (unsigned)res->i2c[i].bytes,
+               res->simS > 0.0 ? (double)res->i2c[i].busyNs * 1e-9 / res->simS * 100.0 : 0.0);
+    }
+    printf("track_rms              roll %.2f  pitch %.2f deg, yaw_rate %.2f deg/s (%u samples)\n",
+           silRms(res->trackSq[0], res->samples), silRms(res->trackSq[1], res->samples),
+           silRms(res->trackSq[2], res->samples), (unsigned)res->samples);
+    printf("estimate_rms           roll %.2f  pitch %.2f deg\n",
+           silRms(res->estSq[0], res->samples), silRms(res->estSq[1], res->samples));
+    printf("max_tilt               %.1f deg\n", res->maxTilt);
+    printf("max_altitude           %.2f m\n", res->maxAltitude);
+    printf("final_position         %.2f %.2f %.2f m\n", res->pos[0], res->pos[1], res->pos[2]);
+    if (res->log.records > 0)
+    {
+        printf("sensorlog              %u records, %u bytes, %u dropped\n", (unsigned)res->log.records,
+               (unsigned)res->log.bytes, (unsigned)res->log.dropped);
+    }
+    if (res->blackbox.sessions > 0)
+    {
+        printf("blackbox               %u sessions, %u frames, %u bytes (%.1f bytes/frame, %.1f kB/s), "
+               "%u dropped, %u discarded, fifo peak %u\n", (unsigned)res->blackbox.sessions,
+               (unsigned)res->blackbox.frames, (unsigned)res->blackbox.written,
+               res->blackbox.frames ? (double)res->blackbox.bytes / res->blackbox.frames : 0.0,
+               res->simS > 0.0 ? (double)res->blackbox.written / res->simS / 1000.0 : 0.0,
+               (unsigned)res->blackbox.dropped, (unsigned)res->blackbox.discarded, (unsigned)res->blackbox.fifoPeak);
+    }
+    if (res->flash.pagePrograms > 0)
+    {
+        printf("flash                  %u pages, %u bytes programmed, %u rejected, %u bad bits, "
+               "busy %.1f%%, spi busy %.1f%%\n", (unsigned)res->flash.pagePrograms,
+               (unsigned)res->flash.bytesProgrammed, (unsigned)res->flash.rejected, (unsigned)res->flash.badBits,
+               res->simS > 0.0 ? (double)res->flash.busyNs * 1e-9 / res->simS * 100.0 : 0.0,
+               res->simS > 0.0 ? (double)res->spi.busyNs * 1e-9 / res->simS * 100.0 : 0.0);
+    }
+}
+
+/**
+ * @brief  打印用法
+ */
+static void silUsage(const char *prog)
+{
+    printf("usage: %s [options]\n"
+           "  --script FILE              RC script (default: built-in takeoff/step/yaw/failsafe script)\n"
+           "  --duration S               simulated time in seconds (default: script end + 1)\n"
+           "  --seed N                   noise seed (default 1)\n"
+           "  --set NAME=VALUE           override a parameter, may be repeated\n"
+           "  --sweep NAME=START:STOP:STEP  run once per value and print one row per run\n"
+           "  --csv FILE                 write a trace of every iteration (single run only)\n"
+           "  --csv-div N                write every Nth iteration (default 1)\n"
+           "  --record FILE              write the raw sensor log for fc_replay (single run only)\n"
+           "  --blackbox FILE            write the blackbox log directly to a file (single run only)\n"
+           "  --blackbox-flash FILE      log to the simulated SPI NOR flash, then read it back into FILE\n"
+           "  --list-params              list parameters and their defaults\n", prog);
+}
+
+/**
+ * @brief  解析NAME=VALUE中的参数名
+ * @param  arg: 参数
+ * @param  value: 输出'='之后的部分
+ * @retval 参数，格式错误或不存在时为0(已打印错误信息)
+ */
+static const silParam_t *silParseAssign(const char *arg, const char **value)
+{
+    char name[64];
+    const char *eq = strchr(arg, '=');
+    const silParam_t *param;
+    
+    if (!eq || (size_t)(eq - arg) >= sizeof(name))
+    {
+        fprintf(stderr, "expected NAME=VALUE: %s\n", arg);
+        return 0;
+    }
+    memcpy(name, arg, (size_t)(eq - arg));
+    name[eq - arg] = 0;
+    
+    param = silFindParam(name);
+    if (!param)
+    {
+        fprintf(stderr, "unknown parameter '%s' (see --list-params)\n", name);
+        return 0;
+    }
+    *value = eq + 1;
+    
+    return param;
+}
+
+int main(int argc, char **argv)
+{
+    static silRcScript_t script;
+    static silConfig_t cfg;
+    static double sweepValues[SIL_SWEEP_MAX];
+    const silParam_t *param, *sweepParam = 0;
+    const char *value, *csvPath = 0, *recordPath = 0, *blackboxPath = 0;
+    const blackboxBackend_t *blackbox = 0;
+    silResult_t res;
+    double duration = -1.0, start, stop, step;
+    unsigned long long seed = 1;
+    uint32_t csvDiv = 1, sweepNum = 0, i;
+    FILE *csv = 0, *record = 0, *dump = 0;
+    int a;
+    
+    silQuadDefaultParams(&cfg.quad);
+    silSensorsDefaultParams(&cfg.sensors);
+    controllerGetDefaultGains(cfg.angleGains, cfg.rateGains);
+    silRcDefault(&script);
+    
+    for (a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "--list-params") == 0)
+        {
+            for (i = 0; i < SIL_PARAM_NUM; i++)
+            {
+                printf("%-20s %-12g %s\n", g_params[i].name, silGetParam(&cfg, &g_params[i]), g_params[i].help);
+            }
+            return 0;
+        }
+        if (strcmp(argv[a], "--help") == 0 || strcmp(argv[a], "-h") == 0)
+        {
+            silUsage(argv[0]);
+            return 0;
+        }
+        if (a + 1 >= argc)
+        {
+            silUsage(argv[0]);
+            return 2;
+        }
+        
+        if (strcmp(argv[a], "--script") == 0)
+        {
+            if (!silRcLoad(&script, argv[++a]))
+            {
+                return 1;
+            }
+        }
+        else if (strcmp(argv[a], "--duration") == 0)
+        {
+            duration = atof(argv[++a]);
+        }
+        else if (strcmp(argv[a], "--seed") == 0)
+        {
+            seed = strtoull(argv[++a], 0, 0);
+        }
+        else if (strcmp(argv[a], "--csv") == 0)
+        {
+            csvPath = argv[++a];
+        }
+        else if (strcmp(argv[a], "--record") == 0)
+        {
+            recordPath = argv[++a];
+        }
+        else if (strcmp(argv[a], "--blackbox") == 0 || strcmp(argv[a], "--blackbox-flash") == 0)
+        {
+            blackbox = strcmp(argv[a], "--blackbox") == 0 ? &g_blackboxFileBackend : &blackboxFlashBackend;
+            blackboxPath = argv[++a];
+        }
+        else if (strcmp(argv[a], "--csv-div") == 0)
+        {
+            csvDiv = (uint32_t)atoi(argv[++a]);
+            csvDiv = csvDiv ? csvDiv : 1;
+        }
+        else if (strcmp(argv[a], "--set") == 0)
+        {
+            if (!(param = silParseAssign(argv[++a], &value)))
+            {
+                return 2;
+            }
+            silSetParam(&cfg, param, atof(value));
+        }
+        else if (strcmp(argv[a], "--sweep") == 0)
+        {
+            if (!(sweepParam = silParseAssign(argv[++a], &value)))
+            {
+                return 2;
+            }
+            if (sscanf(value, "%lf:%lf:%lf", &start, &stop, &step) != 3 || step <= 0.0 || stop < start)
+            {
+                fprintf(stderr, "expected NAME=START:STOP:STEP with STEP > 0: %s\n", argv[a]);
+                return 2;
+            }
+            for (sweepNum = 0; sweepNum < SIL_SWEEP_MAX && start + sweepNum * step <= stop + step * 1e-6; sweepNum++)
+            {
+                sweepValues[sweepNum] = start + sweepNum * step;
+            }
+        }
+        else
+        {
+            silUsage(argv[0]);
+            return 2;
+        }
+    }
+    
+    if (duration <= 0.0)
+    {
+        duration = silRcEndTime(&script) + 1.0;
+    }
+    
+    if (sweepParam)
+    {
+        printf("%-12s %9s %9s %9s %9s %9s %8s %8s %8s\n", sweepParam->name, "trk_roll", "trk_pitch",
+               "trk_yawr", "est_roll", "est_pitch", "max_tilt", "overrun", "rt_x");
+        for (i = 0; i < sweepNum; i++)
+        {
+            silSetParam(&cfg, sweepParam, sweepValues[i]);
+            silRun(&cfg, &script, duration, seed, 0, 1, 0, 0, &res);
+            printf("%-12g %9.2f %9.2f %9.2f %9.2f %9.2f %8.1f %8u %8.1f\n", sweepValues[i],
+                   silRms(res.trackSq[0], res.samples), silRms(res.trackSq[1], res.samples),
+                   silRms(res.trackSq[2], res.samples), silRms(res.estSq[0], res.samples),
+                   silRms(res.estSq[1], res.samples), res.maxTilt, (unsigned)res.timing.overruns,
+                   res.wallS > 0.0 ? res.simS / res.wallS : 0.0);
+        }
+        return 0;
+    }
+    
+    if (csvPath)
+    {
+        csv = fopen(csvPath, "w");
+        if (!csv)
+        {
+            perror(csvPath);
+            return 1;
+        }
+        fprintf(csv, "t,sp_roll,sp_pitch,sp_yaw_rate,sp_thrust,roll,pitch,yaw,est_roll,est_pitch,est_yaw,"
+                     "rate_x,rate_y,rate_z,m1,m2,m3,m4,x,y,z\n");
+    }
+    
+    if (recordPath)
+    {
+        record = fopen(recordPath, "wb");
+        if (!record)
+        {
+            perror(recordPath);
+            return 1;
+        }
+    }
+    
+    if (blackboxPath)
+    {
+        dump = fopen(blackboxPath, "wb");
+        if (!dump)
+        {
+            perror(blackboxPath);
+            return 1;
+        }
+        g_blackboxFile = blackbox == &g_blackboxFileBackend ? dump : 0;
+    }
+    
+    silRun(&cfg, &script, duration, seed, csv, csvDiv, record, blackbox, &res);
+    if (csv)
+    {
+        fclose(csv);
+    }
+    if (record)
+    {
+        fclose(record);
+    }
+    if (dump)
+    {
+        if (blackbox == &blackboxFlashBackend)
+        {
+            silBlackboxDumpFlash(dump);
+        }
+        fclose(dump);
+    }
+    silPrintResult(&res);
+    
+    return 0;
+}
+
+/*
+ * atkpRx的命令应答(遥测上传、CPU占用)不在仿真范围内，为空操作
+ */
+void atkpSendLinkStats(void)
+{
+}
+
+void atkpSendCpuLoad(void)
+{
+}
+
+void atkpSendStack(void)
+{
+}
+
+void atkpSendLatency(void)
+{
+}
+
+void cpuloadResetPeak(void)
+{
+}
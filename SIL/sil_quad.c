@@ -0,0 +1,249 @@
+﻿/*
+ * sil_quad.c
+ *
+ * SIL仿真四轴机体模型实现
+ * 半隐式欧拉积分(先更新速度再更新位置/姿态)，步长SIL_QUAD_STEP_S
+ *
+ * 2026-03-01
+ */
+
+#include "sil_quad.h"
+#include <math.h>
+#include <string.h>
+
+/* 各电机相对中心的方向(X布局，45度)与旋转方向(+1逆时针，-1顺时针) */
+static const double g_motorDir[SIL_QUAD_MOTOR_NUM][2] = {
+    { 0.70710678, -0.70710678},  // M1右前
+    {-0.70710678, -0.70710678},  // M2右后
+    {-0.70710678,  0.70710678},  // M3左后
+    { 0.70710678,  0.70710678},  // M4左前
+};
+static const double g_motorSpin[SIL_QUAD_MOTOR_NUM] = {1.0, -1.0, 1.0, -1.0};
+
+/**
+ * @brief  默认机体参数(约500g、250mm轴距、推重比2.5)
+ * @param  params: 输出参数
+ * @retval 无
+ */
+void silQuadDefaultParams(silQuadParams_t *params)
+{
+    params->mass = 0.5;
+    params->arm = 0.125;
+    params->inertia[0] = 2.5e-3;
+    params->inertia[1] = 2.5e-3;
+    params->inertia[2] = 4.5e-3;
+    params->maxThrust = 2.5 * 0.5 * SIL_QUAD_GRAVITY / SIL_QUAD_MOTOR_NUM;
+    params->torqueRatio = 0.016;
+    params->motorTau = 0.03;
+    params->thrustCurve = 0.3;
+    params->rotorHz = 600.0;
+    params->drag = 0.1;
+    params->angularDrag = 2e-4;
+}
+
+/**
+ * @brief  机体初始化：静止水平停在原点
+ * @param  quad: 机体
+ * @param  params: 参数
+ * @retval 无
+ */
+void silQuadInit(silQuad_t *quad, const silQuadParams_t *params)
+{
+    memset(quad, 0, sizeof(*quad));
+    quad->params = *params;
+    quad->q[0] = 1.0;
+    quad->specificForce[2] = SIL_QUAD_GRAVITY;
+    quad->onGround = 1;
+}
+
+/**
+ * @brief  设置电机输入
+ * @param  quad: 机体
+ * @param  motor: 各电机输入(0~1，与COMMUNITY_TOPIC_MOTOR相同)
+ * @retval 无
+ */
+void silQuadSetMotors(silQuad_t *quad, const float *motor)
+{
+    uint8_t i;
+    
+    for (i = 0; i < SIL_QUAD_MOTOR_NUM; i++)
+    {
+        quad->motorCmd[i] = motor[i] < 0.0f ? 0.0 : (motor[i] > 1.0f ? 1.0 : (double)motor[i]);
+    }
+}
+
+/**
+ * @brief  机体系到地面系的旋转矩阵
+ * @param  q: 四元数
+ * @param  r: 输出3x3矩阵
+ * @retval 无
+ */
+static void silQuadRotation(const double *q, double r[3][3])
+{
+    r[0][0] = 1.0 - 2.0 * (q[2] * q[2] + q[3] * q[3]);
+    r[0][1] = 2.0 * (q[1] * q[2] - q[0] * q[3]);
+    r[0][2] = 2.0 * (q[1] * q[3] + q[0] * q[2]);
+    r[1][0] = 2.0 * (q[1] * q[2] + q[0] * q[3]);
+    r[1][1] = 1.0 - 2.0 * (q[1] * q[1] + q[3] * q[3]);
+    r[1][2] = 2.0 * (q[2] * q[3] - q[0] * q[1]);
+    r[2][0] = 2.0 * (q[1] * q[3] - q[0] * q[2]);
+    r[2][1] = 2.0 * (q[2] * q[3] + q[0] * q[1]);
+    r[2][2] = 1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2]);
+}
+
+/**
+ * @brief  向量从地面系转到机体系
+ * @param  quad: 机体
+ * @param  earth: 地面系向量
+ * @param  body: 输出机体系向量
+ * @retval 无
+ */
+void silQuadEarthToBody(const silQuad_t *quad, const double *earth, double *body)
+{
+    double r[3][3];
+    
+    silQuadRotation(quad->q, r);
+    body[0] = r[0][0] * earth[0] + r[1][0] * earth[1] + r[2][0] * earth[2];
+    body[1] = r[0][1] * earth[0] + r[1][1] * earth[1] + r[2][1] * earth[2];
+    body[2] = r[0][2] * earth[0] + r[1][2] * earth[1] + r[2][2] * earth[2];
+}
+
+/**
+ * @brief  姿态角(ZYX欧拉角，与sensfusionGetEuler相同)
+ * @param  quad: 机体
+ * @param  euler: 输出[roll, pitch, yaw] (deg)
+ * @retval 无
+ */
+void silQuadGetEuler(const silQuad_t *quad, double *euler)
+{
+    const double *q = quad->q;
+    double sinp = 2.0 * (q[0] * q[2] - q[3] * q[1]);
+    
+    sinp = sinp > 1.0 ? 1.0 : (sinp < -1.0 ? -1.0 : sinp);
+    euler[0] = atan2(2.0 * (q[0] * q[1] + q[2] * q[3]), 1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2])) * (180.0 / M_PI);
+    euler[1] = asin(sinp) * (180.0 / M_PI);
+    euler[2] = atan2(2.0 * (q[0] * q[3] + q[1] * q[2]), 1.0 - 2.0 * (q[2] * q[2] + q[3] * q[3])) * (180.0 / M_PI);
+}
+
+/**
+ * @brief  积分一步
+ * @param  quad: 机体
+ * @param  dt: 步长 (s)
+ * @retval 无
+ */
+static void silQuadStep(silQuad_t *quad, double dt)
+{
+    const silQuadParams_t *p = &quad->params;
+    double thrust = 0.0, torque[3] = {0.0, 0.0, 0.0};
+    double r[3][3], accel[3], h[3], dq[4], norm;
+    double u, target, t;
+    uint8_t i;
+    
+    /* 电机：转速一阶惯性趋近稳态值，推力与转速平方成正比 */
+    for (i = 0; i < SIL_QUAD_MOTOR_NUM; i++)
+    {
+        u = quad->motorCmd[i];
+        target = sqrt((1.0 - p->thrustCurve) * u + p->thrustCurve * u * u);
+        quad->motorSpeed[i] += (target - quad->motorSpeed[i]) * (dt / (p->motorTau + dt));
+        quad->rotorAngle[i] = fmod(quad->rotorAngle[i] + 2.0 * M_PI * p->rotorHz * quad->motorSpeed[i] * dt, 2.0 * M_PI);
+        
+        t = p->maxThrust * quad->motorSpeed[i] * quad->motorSpeed[i];
+        thrust += t;
+        torque[0] += g_motorDir[i][1] * p->arm * t;
+        torque[1] -= g_motorDir[i][0] * p->arm * t;
+        torque[2] -= g_motorSpin[i] * p->torqueRatio * t;
+    }
+    
+    /* 平动：推力沿机体z轴(旋转矩阵第3列)，线性阻力，重力 */
+    silQuadRotation(quad->q, r);
+    for (i = 0; i < 3; i++)
+    {
+        accel[i] = (r[i][2] * thrust - p->drag * quad->vel[i]) / p->mass;
+    }
+    accel[2] -= SIL_QUAD_GRAVITY;
+    
+    /* 地面：推力不足以离地时静止，加速度计测到地面支撑力 */
+    if (quad->onGround && accel[2] <= 0.0)
+    {
+        memset(quad->vel, 0, sizeof(quad->vel));
+        memset(quad->rate, 0, sizeof(quad->rate));
+        for (i = 0; i < 3; i++)
+        {
+            quad->specificForce[i] = r[2][i] * SIL_QUAD_GRAVITY;
+        }
+        return;
+    }
+    quad->onGround = 0;
+    
+    for (i = 0; i < 3; i++)
+    {
+        quad->vel[i] += accel[i] * dt;
+        quad->pos[i] += quad->vel[i] * dt;
+    }
+    
+    /* 比力 = 加速度 - 重力，转到机体系 */
+    accel[2] += SIL_QUAD_GRAVITY;
+    silQuadEarthToBody(quad, accel, quad->specificForce);
+    
+    if (quad->pos[2] <= 0.0)
+    {
+        /* 落地：停止运动，姿态保持 */
+        quad->pos[2] = 0.0;
+        memset(quad->vel, 0, sizeof(quad->vel));
+        memset(quad->rate, 0, sizeof(quad->rate));
+        quad->onGround = 1;
+        return;
+    }
+    
+    /* 转动：欧拉方程 I*dw/dt = tau - w x (I*w) - 阻尼 */
+    for (i = 0; i < 3; i++)
+    {
+        h[i] = p->inertia[i] * quad->rate[i];
+    }
+    torque[0] -= quad->rate[1] * h[2] - quad->rate[2] * h[1] + p->angularDrag * quad->rate[0];
+    torque[1] -= quad->rate[2] * h[0] - quad->rate[0] * h[2] + p->angularDrag * quad->rate[1];
+    torque[2] -= quad->rate[0] * h[1] - quad->rate[1] * h[0] + p->angularDrag * quad->rate[2];
+    for (i = 0; i < 3; i++)
+    {
+        quad->rate[i] += torque[i] / p->inertia[i] * dt;
+    }
+    
+    /* 四元数：dq/dt = 0.5 * q x (0, w) */
+    dq[0] = -quad->q[1] * quad->rate[0] - quad->q[2] * quad->rate[1] - quad->q[3] * quad->rate[2];
+    dq[1] =  quad->q[0] * quad->rate[0] + quad->q[2] * quad->rate[2] - quad->q[3] * quad->rate[1];
+    dq[2] =  quad->q[0] * quad->rate[1] - quad->q[1] * quad->rate[2] + quad->q[3] * quad->rate[0];
+    dq[3] =  quad->q[0] * quad->rate[2] + quad->q[1] * quad->rate[1] - quad->q[2] * quad->rate[0];
+    norm = 0.0;
+    for (i = 0; i < 4; i++)
+    {
+        quad->q[i] += 0.5 * dq[i] * dt;
+        norm += quad->q[i] * quad->q[i];
+    }
+    norm = 1.0 / sqrt(norm);
+    for (i = 0; i < 4; i++)
+    {
+        quad->q[i] *= norm;
+    }
+}
+
+/**
+ * @brief  积分到指定时刻(按SIL_QUAD_STEP_S分步，最后一步取余量)
+ * @param  quad: 机体
+ * @param  timeS: 目标时刻 (s)，不大于当前时刻时不做任何事
+ * @retval 无
+ */
+void silQuadAdvance(silQuad_t *quad, double timeS)
+{
+    double dt;
+    
+    while (quad->timeS < timeS)
+    {
+        dt = timeS - quad->timeS;
+        if (dt > SIL_QUAD_STEP_S)
+        {
+            dt = SIL_QUAD_STEP_S;
+        }
+        silQuadStep(quad, dt);
+        quad->timeS += dt;
+    }
+}
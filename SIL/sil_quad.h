@@ -0,0 +1,64 @@
+﻿/*
+ * sil_quad.h
+ *
+ * SIL仿真四轴机体模型头文件
+ * 6自由度刚体 + 4个一阶惯性电机，坐标系与飞控一致：
+ * 机体系x向前、y向左、z向上，地面系z向上，四元数为机体系到地面系的旋转
+ *
+ * 电机按mixerQuadX布局：M1右前(逆时针)、M2右后(顺时针)、M3左后(逆时针)、M4左前(顺时针)，
+ * 转速归一化为0~1，推力 = maxThrust * 转速^2，反扭矩 = torqueRatio * 推力(逆时针旋转的桨使机体顺时针转)
+ * 电机输入u(混控输出0~1)对应的稳态推力比例为(1-k)*u + k*u^2(k = thrustCurve)，
+ * 与MIXER_THRUST_LINEAR相同时混控的线性化恰好抵消
+ *
+ * 地面接触：高度为0且推力不足以离地时机体静止在地面上
+ *
+ * 2026-03-01
+ */
+
+#ifndef SIL_QUAD_H
+#define SIL_QUAD_H
+
+#include <stdint.h>
+
+#define SIL_QUAD_MOTOR_NUM       4
+#define SIL_QUAD_GRAVITY         9.80665     // 重力加速度 (m/s^2)
+#define SIL_QUAD_STEP_S          0.0001      // 积分步长 (s)
+
+/* 机体参数 */
+typedef struct {
+    double mass;                 // 质量 (kg)
+    double arm;                  // 电机到中心的距离 (m)
+    double inertia[3];           // 转动惯量Ixx/Iyy/Izz (kg*m^2)
+    double maxThrust;            // 单个电机最大推力 (N)
+    double torqueRatio;          // 反扭矩/推力 (m)
+    double motorTau;             // 电机转速时间常数 (s)
+    double thrustCurve;          // 推力曲线二次项系数k
+    double rotorHz;              // 满转速时的转速基频 (Hz)
+    double drag;                 // 平动阻力系数 (N/(m/s))
+    double angularDrag;          // 转动阻力系数 (N*m/(rad/s))
+} silQuadParams_t;
+
+/* 机体状态 */
+typedef struct {
+    silQuadParams_t params;
+    double timeS;                // 已积分到的时刻 (s)
+    double pos[3];               // 位置，地面系 (m)
+    double vel[3];               // 速度，地面系 (m/s)
+    double q[4];                 // 姿态四元数[w, x, y, z]
+    double rate[3];              // 角速度，机体系 (rad/s)
+    double specificForce[3];     // 比力(加速度计测量值)，机体系 (m/s^2)
+    double motorCmd[SIL_QUAD_MOTOR_NUM];    // 电机输入 (0~1)
+    double motorSpeed[SIL_QUAD_MOTOR_NUM];  // 归一化转速 (0~1)
+    double rotorAngle[SIL_QUAD_MOTOR_NUM];  // 转子角度 (rad)，用于振动模型
+    uint8_t onGround;
+} silQuad_t;
+
+/* 函数声明 */
+void silQuadDefaultParams(silQuadParams_t *params);
+void silQuadInit(silQuad_t *quad, const silQuadParams_t *params);
+void silQuadSetMotors(silQuad_t *quad, const float *motor);
+void silQuadAdvance(silQuad_t *quad, double timeS);
+void silQuadGetEuler(const silQuad_t *quad, double *euler);
+void silQuadEarthToBody(const silQuad_t *quad, const double *earth, double *body);
+
+#endif /* SIL_QUAD_H */
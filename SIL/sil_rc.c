@@ -0,0 +1,181 @@
+﻿/*
+ * sil_rc.c
+ *
+ * SIL仿真遥控脚本实现
+ *
+ * 2026-03-01
+ */
+
+#include "sil_rc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 内置脚本：起飞(悬停油门约0.365) -> 横滚/俯仰阶跃 -> 偏航旋转 -> 下降着陆 -> 断链失控保护 */
+static const char g_defaultScript[] =
+    "# t    roll  pitch  yawRate  thrust  quality\n"
+    "0.0    0     0      0        0\n"
+    "0.5    0     0      0        0.42\n"
+    "1.5    0     0      0        0.365\n"
+    "2.0    15    0      0        0.38\n"
+    "3.0    0     0      0        0.365\n"
+    "4.0    0     -15    0        0.38\n"
+    "5.0    0     0      0        0.365\n"
+    "6.0    0     0      90       0.365\n"
+    "7.0    0     0      0        0.34\n"
+    "9.0    0     0      0        0.34    0\n"
+    "10.0   0     0      0        0\n";
+
+/**
+ * @brief  解析脚本文本
+ * @param  script: 输出脚本
+ * @param  text: 脚本文本
+ * @param  name: 脚本名(用于错误信息)
+ * @retval 1-成功，0-格式错误(已打印错误信息)
+ */
+uint8_t silRcParse(silRcScript_t *script, const char *text, const char *name)
+{
+    char line[256];
+    const char *p = text, *end;
+    unsigned lineNo = 0;
+    double v[6];
+    size_t len;
+    int n;
+    silRcStep_t *step;
+    
+    script->count = 0;
+    
+    while (*p)
+    {
+        end = strchr(p, '\n');
+        len = end ? (size_t)(end - p) : strlen(p);
+        if (len >= sizeof(line))
+        {
+            len = sizeof(line) - 1;
+        }
+        memcpy(line, p, len);
+        line[len] = 0;
+        p = end ? end + 1 : p + strlen(p);
+        lineNo++;
+        
+        if (strchr(line, '#'))
+        {
+            *strchr(line, '#') = 0;
+        }
+        
+        v[5] = 100.0;
+        n = sscanf(line, "%lf %lf %lf %lf %lf %lf", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5]);
+        if (n <= 0)
+        {
+            continue;
+        }
+        if (n < 5 || v[5] < 0.0 || v[5] > 100.0)
+        {
+            fprintf(stderr, "%s:%u: expected 'time roll pitch yawRate thrust [quality]'\n", name, lineNo);
+            return 0;
+        }
+        if (script->count >= SIL_RC_MAX_STEPS)
+        {
+            fprintf(stderr, "%s:%u: too many lines (max %d)\n", name, lineNo, SIL_RC_MAX_STEPS);
+            return 0;
+        }
+        if (script->count > 0 && v[0] <= script->steps[script->count - 1].time)
+        {
+            fprintf(stderr, "%s:%u: time must increase\n", name, lineNo);
+            return 0;
+        }
+        
+        step = &script->steps[script->count++];
+        step->time = v[0];
+        step->sp.roll = (float)v[1];
+        step->sp.pitch = (float)v[2];
+        step->sp.yawRate = (float)v[3];
+        step->sp.thrust = (float)v[4];
+        step->quality = (uint8_t)v[5];
+    }
+    
+    if (script->count == 0)
+    {
+        fprintf(stderr, "%s: empty script\n", name);
+        return 0;
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief  从文件读取脚本
+ * @param  script: 输出脚本
+ * @param  path: 文件路径
+ * @retval 1-成功，0-失败(已打印错误信息)
+ */
+uint8_t silRcLoad(silRcScript_t *script, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    char *text;
+    long size;
+    uint8_t ok;
+    
+    if (!f)
+    {
+        perror(path);
+        return 0;
+    }
+    
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    text = malloc((size_t)size + 1);
+    if (!text || fread(text, 1, (size_t)size, f) != (size_t)size)
+    {
+        fprintf(stderr, "%s: read failed\n", path);
+        free(text);
+        fclose(f);
+        return 0;
+    }
+    text[size] = 0;
+    fclose(f);
+    
+    ok = silRcParse(script, text, path);
+    free(text);
+    
+    return ok;
+}
+
+/**
+ * @brief  使用内置脚本
+ * @param  script: 输出脚本
+ * @retval 无
+ */
+void silRcDefault(silRcScript_t *script)
+{
+    silRcParse(script, g_defaultScript, "default");
+}
+
+/**
+ * @brief  查询某一时刻的设定值
+ * @param  script: 脚本
+ * @param  time: 时刻 (s)
+ * @retval 该时刻生效的行，早于第一行时为第一行
+ */
+const silRcStep_t *silRcAt(const silRcScript_t *script, double time)
+{
+    uint16_t i = 0;
+    
+    while (i + 1 < script->count && script->steps[i + 1].time <= time)
+    {
+        i++;
+    }
+    
+    return &script->steps[i];
+}
+
+/**
+ * @brief  脚本最后一行的时刻
+ * @param  script: 脚本
+ * @retval 时刻 (s)
+ */
+double silRcEndTime(const silRcScript_t *script)
+{
+    return script->steps[script->count - 1].time;
+}
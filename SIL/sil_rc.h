@@ -0,0 +1,39 @@
+﻿/*
+ * sil_rc.h
+ *
+ * SIL仿真遥控脚本头文件
+ * 脚本为文本，每行一个设定值，从该时刻起保持到下一行：
+ *   时刻(s) 横滚(deg) 俯仰(deg) 偏航角速度(deg/s) 油门(0~1) [链路质量(0~100，默认100)]
+ * '#'之后为注释，各行时刻需递增。链路质量为0时飞控进入失控保护
+ *
+ * 2026-03-01
+ */
+
+#ifndef SIL_RC_H
+#define SIL_RC_H
+
+#include <stdint.h>
+#include "controller.h"
+
+#define SIL_RC_MAX_STEPS         256
+
+/* 脚本中的一行 */
+typedef struct {
+    double time;                 // 开始时刻 (s)
+    setpoint_t sp;
+    uint8_t quality;             // 链路质量
+} silRcStep_t;
+
+typedef struct {
+    silRcStep_t steps[SIL_RC_MAX_STEPS];
+    uint16_t count;
+} silRcScript_t;
+
+/* 函数声明 */
+uint8_t silRcParse(silRcScript_t *script, const char *text, const char *name);
+uint8_t silRcLoad(silRcScript_t *script, const char *path);
+void silRcDefault(silRcScript_t *script);
+const silRcStep_t *silRcAt(const silRcScript_t *script, double time);
+double silRcEndTime(const silRcScript_t *script);
+
+#endif /* SIL_RC_H */
@@ -0,0 +1,506 @@
+﻿/*
+ * sil_replay.c
+ *
+ * 原始传感器记录(sensorlog)回放：把记录中的原始值放入hal_sim的I2C寄存器，
+ * 由未修改的驱动读取并经过与飞控相同的转换、陀螺仪滤波、姿态解算、控制与混控(stabilizerStep)，
+ * 每次迭代的输出以%.9g(float可逆)写出，并计算全部输出的FNV-1a摘要，
+ * 同一记录在不同提交上回放的输出/摘要相同即说明这些代码的数值行为未改变
+ *
+ * 迭代划分：每条IMU记录开始一次迭代，其后到下一条IMU记录之前的气压/磁力计/设定值记录属于同一迭代，
+ * 在调用stabilizerStep之前放入寄存器或发布；控制循环按迭代序号降频读取辅助传感器，
+ * 与记录时的迭代序号一致才能重现，记录有丢失时(时间戳间隔超过1.5个周期)计入gaps
+ *
+ * 用法：
+ *   fc_replay LOG [--out FILE] [--repeat N]
+ *   --out FILE    每次迭代一行：t_us gyro[3] accel[3] roll pitch yaw control[4] motor[4] [alt vz]
+ *   --repeat N    重复回放N次，吞吐量取最快的一次(输出与摘要每次都相同)
+ *
+ * 2026-03-01
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hal_sim.h"
+#include "stabilizer.h"
+#include "community.h"
+#include "radioLink.h"
+#include "mixer.h"
+#include "sensorlog.h"
+
+#define REPLAY_FNV_OFFSET        0xCBF29CE484222325ULL
+#define REPLAY_FNV_PRIME         0x100000001B3ULL
+
+/* 一次回放的结果 */
+typedef struct {
+    uint32_t records;            // 记录总数
+    uint32_t imu;                // IMU记录数(迭代数)
+    uint32_t baro;               // 气压计记录数
+    uint32_t mag;                // 磁力计记录数
+    uint32_t setpoint;           // 设定值记录数
+    uint32_t gaps;               // IMU时间戳间隔超过1.5个周期的次数
+    uint32_t truncated;          // 末尾不完整或无法识别的字节数
+    uint64_t durationUs;         // 记录时长 (us)
+    uint64_t digest;             // 输出摘要
+    double wallS;                // 回放耗时 (s)
+} replayResult_t;
+
+static halSimI2cDevice_t g_mpu;
+static halSimI2cDevice_t g_mag;
+static halSimI2cDevice_t g_baro;
+
+/**
+ * @brief  FNV-1a摘要累加
+ * @param  hash: 摘要
+ * @param  data: 数据
+ * @param  len: 字节数
+ * @retval 无
+ */
+static void replayHash(uint64_t *hash, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t h = *hash;
+    
+    while (len--)
+    {
+        h = (h ^ *p++) * REPLAY_FNV_PRIME;
+    }
+    *hash = h;
+}
+
+/**
+ * @brief  写入16位大端数(MPU9250数据寄存器)
+ */
+static void replayPutBe16(uint8_t *regs, int16_t value)
+{
+    regs[0] = (uint8_t)((uint16_t)value >> 8);
+    regs[1] = (uint8_t)value;
+}
+
+/**
+ * @brief  写入16位小端数(AK8963数据与BMP280校准寄存器)
+ */
+static void replayPutLe16(uint8_t *regs, uint16_t value)
+{
+    regs[0] = (uint8_t)value;
+    regs[1] = (uint8_t)(value >> 8);
+}
+
+/**
+ * @brief  写入BMP280的20位ADC值(MSB、LSB、XLSB[7:4])
+ */
+static void replayPutRaw20(uint8_t *regs, uint32_t value)
+{
+    regs[0] = (uint8_t)(value >> 12);
+    regs[1] = (uint8_t)(value >> 4);
+    regs[2] = (uint8_t)((value & 0x0F) << 4);
+}
+
+/**
+ * @brief  按文件头建立寄存器模型：识别寄存器与校准数据，数据寄存器在回放时写入
+ * @param  header: 文件头
+ * @retval 无
+ */
+static void replayAttachDevices(const sensorlogHeader_t *header)
+{
+    const BMP280_CalibData_t *c = &header->baroCalib;
+    uint16_t calib[12];
+    uint8_t i;
+    
+    calib[0] = c->dig_T1;
+    calib[1] = (uint16_t)c->dig_T2;
+    calib[2] = (uint16_t)c->dig_T3;
+    calib[3] = c->dig_P1;
+    calib[4] = (uint16_t)c->dig_P2;
+    calib[5] = (uint16_t)c->dig_P3;
+    calib[6] = (uint16_t)c->dig_P4;
+    calib[7] = (uint16_t)c->dig_P5;
+    calib[8] = (uint16_t)c->dig_P6;
+    calib[9] = (uint16_t)c->dig_P7;
+    calib[10] = (uint16_t)c->dig_P8;
+    calib[11] = (uint16_t)c->dig_P9;
+    
+    memset(&g_mpu, 0, sizeof(g_mpu));
+    g_mpu.addr = MPU9250_ADDR;
+    g_mpu.regs[MPU9250_WHO_AM_I_REG] = MPU9250_WHO_AM_I_VAL;
+    halSimI2cAttach(HAL_I2C_1, &g_mpu);
+    
+    memset(&g_mag, 0, sizeof(g_mag));
+    g_mag.addr = AK8963_ADDR;
+    g_mag.regs[AK8963_WIA_REG] = AK8963_WIA_VAL;
+    for (i = 0; i < 3; i++)
+    {
+        g_mag.regs[AK8963_ASAX_REG + i] = header->magAsa[i];
+    }
+    halSimI2cAttach(HAL_I2C_1, &g_mag);
+    
+    memset(&g_baro, 0, sizeof(g_baro));
+    g_baro.addr = BMP280_ADDR;
+    g_baro.regs[BMP280_WHO_AM_I_REG] = BMP280_WHO_AM_I_VAL;
+    for (i = 0; i < 12; i++)
+    {
+        replayPutLe16(&g_baro.regs[BMP280_DIG_T1_LSB_REG + 2 * i], calib[i]);
+    }
+    halSimI2cAttach(HAL_I2C_2, &g_baro);
+}
+
+/**
+ * @brief  把非IMU记录放入寄存器或发布
+ * @param  rec: 记录
+ * @param  res: 统计
+ * @retval 无
+ */
+static void replayApply(const sensorlogRecord_t *rec, replayResult_t *res)
+{
+    radiolinkStatus_t link;
+    
+    switch (rec->type)
+    {
+        case SENSORLOG_REC_BARO:
+            replayPutRaw20(&g_baro.regs[BMP280_PRESS_MSB_REG], rec->data.baro.press);
+            replayPutRaw20(&g_baro.regs[BMP280_TEMP_MSB_REG], rec->data.baro.temp);
+            res->baro++;
+            break;
+        
+        case SENSORLOG_REC_MAG:
+            g_mag.regs[AK8963_ST1_REG] = rec->data.mag.st1;
+            replayPutLe16(&g_mag.regs[AK8963_HXL_REG], (uint16_t)rec->data.mag.magX);
+            replayPutLe16(&g_mag.regs[AK8963_HXL_REG + 2], (uint16_t)rec->data.mag.magY);
+            replayPutLe16(&g_mag.regs[AK8963_HXL_REG + 4], (uint16_t)rec->data.mag.magZ);
+            g_mag.regs[AK8963_ST2_REG] = rec->data.mag.st2;
+            res->mag++;
+            break;
+        
+        case SENSORLOG_REC_SETPOINT:
+            link.quality = rec->data.setpoint.quality;
+            link.rssi = 0;
+            communityPublish(COMMUNITY_TOPIC_SETPOINT, &rec->data.setpoint.sp, sizeof(setpoint_t));
+            communityPublish(COMMUNITY_TOPIC_LINK, &link, sizeof(link));
+            res->setpoint++;
+            break;
+        
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief  执行一次迭代并输出结果
+ * @param  imu: 本次迭代的IMU记录
+ * @param  timeUs: 展开回绕后的时间戳 (us)
+ * @param  baseNs: 时间戳0对应的虚拟时间 (ns)
+ * @param  out: 文本输出，可为0
+ * @param  res: 统计
+ * @retval 无
+ */
+static void replayStep(const MPU9250_RawData_t *imu, uint64_t timeUs, uint64_t baseNs, FILE *out,
+                       replayResult_t *res)
+{
+    /* gyro[3] accel[3] attitude[3] control[4] motor[4] vertical[2] */
+    float v[19];
+    MPU9250_Data_t sensor;
+    attitude_t att;
+    control_t ctrl;
+    uint64_t nowNs = baseNs + timeUs * 1000;
+    uint8_t n = 17, i;
+    
+    replayPutBe16(&g_mpu.regs[MPU9250_ACCEL_XOUT_H_REG], imu->accelX);
+    replayPutBe16(&g_mpu.regs[MPU9250_ACCEL_YOUT_H_REG], imu->accelY);
+    replayPutBe16(&g_mpu.regs[MPU9250_ACCEL_ZOUT_H_REG], imu->accelZ);
+    replayPutBe16(&g_mpu.regs[MPU9250_TEMP_OUT_H_REG], imu->temp);
+    replayPutBe16(&g_mpu.regs[MPU9250_GYRO_XOUT_H_REG], imu->gyroX);
+    replayPutBe16(&g_mpu.regs[MPU9250_GYRO_YOUT_H_REG], imu->gyroY);
+    replayPutBe16(&g_mpu.regs[MPU9250_GYRO_ZOUT_H_REG], imu->gyroZ);
+    
+    /* 虚拟时钟只影响时序统计，不影响计算结果 */
+    if (halSimNowNs() < nowNs)
+    {
+        halSimAdvanceNs(nowNs - halSimNowNs());
+    }
+    
+    stabilizerStep();
+    
+    communityRead(COMMUNITY_TOPIC_SENSOR, &sensor, sizeof(sensor));
+    communityRead(COMMUNITY_TOPIC_ATTITUDE, &att, sizeof(att));
+    communityRead(COMMUNITY_TOPIC_CONTROL, &ctrl, sizeof(ctrl));
+    communityRead(COMMUNITY_TOPIC_MOTOR, &v[13], MIXER_MOTOR_NUM * sizeof(float));
+    v[0] = sensor.gyroX;
+    v[1] = sensor.gyroY;
+    v[2] = sensor.gyroZ;
+    v[3] = sensor.accelX;
+    v[4] = sensor.accelY;
+    v[5] = sensor.accelZ;
+    v[6] = att.roll;
+    v[7] = att.pitch;
+    v[8] = att.yaw;
+    v[9] = ctrl.roll;
+    v[10] = ctrl.pitch;
+    v[11] = ctrl.yaw;
+    v[12] = ctrl.thrust;
+#if STABILIZER_ESTIMATOR == STABILIZER_ESTIMATOR_EKF
+    communityRead(COMMUNITY_TOPIC_VERTICAL, &v[17], 2 * sizeof(float));
+    n = 19;
+#endif
+    
+    replayHash(&res->digest, v, n * sizeof(float));
+    res->imu++;
+    
+    if (out)
+    {
+        fprintf(out, "%llu", (unsigned long long)timeUs);
+        for (i = 0; i < n; i++)
+        {
+            fprintf(out, " %.9g", (double)v[i]);
+        }
+        fputc('\n', out);
+    }
+}
+
+/**
+ * @brief  回放一份记录
+ * @param  data: 记录文件内容
+ * @param  len: 字节数
+ * @param  out: 文本输出，可为0
+ * @param  res: 输出结果
+ * @retval 1-成功，0-文件头错误或配置不符(已打印错误信息)
+ */
+static uint8_t replayRun(const uint8_t *data, uint32_t len, FILE *out, replayResult_t *res)
+{
+    sensorlogHeader_t header;
+    sensorlogRecord_t rec;
+    MPU9250_RawData_t imu;
+    uint64_t baseNs, timeUs = 0;
+    uint32_t pos, lastUs = 0, periodUs = 1000000 / STABILIZER_RATE_HZ, dt;
+    uint8_t pending = 0, size;
+    struct timespec wall0, wall1;
+    
+    memset(res, 0, sizeof(*res));
+    res->digest = REPLAY_FNV_OFFSET;
+    
+    pos = sensorlogDecodeHeader(data, len, &header);
+    if (pos == 0)
+    {
+        fprintf(stderr, "not a sensor log (bad magic or version)\n");
+        return 0;
+    }
+    if (header.rateHz != STABILIZER_RATE_HZ || header.estimator != STABILIZER_ESTIMATOR)
+    {
+        fprintf(stderr, "log was recorded at %u Hz with estimator %u, this build runs %u Hz with estimator %u\n",
+                header.rateHz, header.estimator, STABILIZER_RATE_HZ, STABILIZER_ESTIMATOR);
+        return 0;
+    }
+    
+    clock_gettime(CLOCK_MONOTONIC, &wall0);
+    
+    halSimReset();
+    replayAttachDevices(&header);
+    stabilizerInit();
+    baseNs = (halSimNowNs() / 1000000 + 1) * 1000000;
+    
+    while ((size = sensorlogDecodeRecord(&data[pos], len - pos, &rec)) > 0)
+    {
+        pos += size;
+        res->records++;
+        if (rec.type != SENSORLOG_REC_IMU)
+        {
+            replayApply(&rec, res);
+            continue;
+        }
+        
+        /* 新的IMU记录：上一次迭代的全部记录已就绪 */
+        if (pending)
+        {
+            replayStep(&imu, timeUs, baseNs, out, res);
+        }
+        
+        /* 时间戳按32位回绕展开 */
+        dt = rec.timeUs - lastUs;
+        if (pending && dt > periodUs + periodUs / 2)
+        {
+            res->gaps++;
+        }
+        timeUs = pending ? timeUs + dt : rec.timeUs;
+        lastUs = rec.timeUs;
+        imu = rec.data.imu;
+        pending = 1;
+    }
+    if (pending)
+    {
+        replayStep(&imu, timeUs, baseNs, out, res);
+        res->durationUs = timeUs + periodUs;
+    }
+    res->truncated = len - pos;
+    
+    clock_gettime(CLOCK_MONOTONIC, &wall1);
+    res->wallS = (double)(wall1.tv_sec - wall0.tv_sec) + (double)(wall1.tv_nsec - wall0.tv_nsec) * 1e-9;
+    
+    return 1;
+}
+
+/**
+ * @brief  读取整个文件
+ * @param  path: 文件名
+ * @param  len: 输出字节数
+ * @retval 文件内容(malloc)，失败时为0(已打印错误信息)
+ */
+static uint8_t *replayLoad(const char *path, uint32_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *data = 0;
+    long size;
+    
+    if (!f)
+    {
+        perror(path);
+        return 0;
+    }
+    if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) >= 0 && size <= 0x7FFFFFFF &&
+        fseek(f, 0, SEEK_SET) == 0)
+    {
+        data = (uint8_t *)malloc(size ? (size_t)size : 1);
+        if (data && fread(data, 1, (size_t)size, f) == (size_t)size)
+        {
+            *len = (uint32_t)size;
+        }
+        else
+        {
+            free(data);
+            data = 0;
+        }
+    }
+    if (!data)
+    {
+        fprintf(stderr, "%s: read failed\n", path);
+    }
+    fclose(f);
+    
+    return data;
+}
+
+/**
+ * @brief  打印用法
+ */
+static void replayUsage(const char *prog)
+{
+    printf("usage: %s LOG [options]\n"
+           "  --out FILE                 write one line per iteration (%%.9g, bit-exact for float)\n"
+           "  --repeat N                 replay N times (1..1000000) and report the fastest run (default 1)\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *logPath = 0, *outPath = 0;
+    replayResult_t res, best = {0};
+    uint8_t *data;
+    char *end;
+    long n;
+    uint32_t len = 0, repeat = 1, i;
+    FILE *out = 0;
+    int a;
+    
+    for (a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "--help") == 0 || strcmp(argv[a], "-h") == 0)
+        {
+            replayUsage(argv[0]);
+            return 0;
+        }
+        if (argv[a][0] != '-')
+        {
+            logPath = argv[a];
+            continue;
+        }
+        if (a + 1 >= argc)
+        {
+            replayUsage(argv[0]);
+            return 2;
+        }
+        if (strcmp(argv[a], "--out") == 0)
+        {
+            outPath = argv[++a];
+        }
+        else if (strcmp(argv[a], "--repeat") == 0)
+        {
+            n = strtol(argv[++a], &end, 10);
+            if (end == argv[a] || *end != '\0' || n < 1 || n > 1000000)
+            {
+                replayUsage(argv[0]);
+                return 2;
+            }
+            repeat = (uint32_t)n;
+        }
+        else
+        {
+            replayUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (!logPath)
+    {
+        replayUsage(argv[0]);
+        return 2;
+    }
+    
+    data = replayLoad(logPath, &len);
+    if (!data)
+    {
+        return 1;
+    }
+    
+    for (i = 0; i < repeat; i++)
+    {
+        /* 文本输出只在第一次回放时写出，不计入之后的吞吐量 */
+        if (i == 0 && outPath)
+        {
+            out = fopen(outPath, "w");
+            if (!out)
+            {
+                perror(outPath);
+                free(data);
+                return 1;
+            }
+        }
+        if (!replayRun(data, len, out, &res))
+        {
+            free(data);
+            return 1;
+        }
+        if (out)
+        {
+            fclose(out);
+            out = 0;
+        }
+        if (i > 0 && res.digest != best.digest)
+        {
+            fprintf(stderr, "digest changed between runs: %016llx != %016llx\n",
+                    (unsigned long long)res.digest, (unsigned long long)best.digest);
+            free(data);
+            return 1;
+        }
+        if (i == 0 || res.wallS < best.wallS)
+        {
+            best = res;
+        }
+    }
+    free(data);
+    
+    printf("records                %u (imu %u, baro %u, mag %u, setpoint %u)\n", (unsigned)best.records,
+           (unsigned)best.imu, (unsigned)best.baro, (unsigned)best.mag, (unsigned)best.setpoint);
+    printf("log_duration           %.3f s\n", (double)best.durationUs * 1e-6);
+    printf("gaps                   %u\n", (unsigned)best.gaps);
+    if (best.truncated)
+    {
+        printf("truncated              %u bytes\n", (unsigned)best.truncated);
+    }
+    printf("wall_time              %.3f s%s\n", best.wallS, repeat > 1 ? " (fastest run)" : "");
+    if (best.wallS > 0.0)
+    {
+        printf("throughput             %.0f imu samples/s, %.0f records/s, %.2f MB/s, %.1fx realtime\n",
+               best.imu / best.wallS, best.records / best.wallS, len / best.wallS * 1e-6,
+               (double)best.durationUs * 1e-6 / best.wallS);
+    }
+    printf("digest                 %016llx\n", (unsigned long long)best.digest);
+    
+    return 0;
+}
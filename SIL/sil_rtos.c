@@ -0,0 +1,205 @@
+﻿/*
+ * sil_rtos.c
+ *
+ * SIL仿真用的FreeRTOS替身实现(任务节拍与静态队列)
+ *
+ * 2026-03-01
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "hal_sim.h"
+#include <string.h>
+
+#define SIL_RTOS_TICK_NS         (1000000000ULL / configTICK_RATE_HZ)
+
+/* 唯一的"当前任务"，只用于区分空句柄 */
+static struct silTask_s {
+    uint32_t notify;             // 任务通知计数
+} g_task;
+
+/**
+ * @brief  当前系统节拍(由虚拟时钟换算)
+ * @param  无
+ * @retval 节拍数
+ */
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(halSimNowNs() / SIL_RTOS_TICK_NS);
+}
+
+/**
+ * @brief  延时到上次唤醒时刻之后increment个节拍，虚拟时钟直接前进到该时刻
+ * @param  previousWakeTime: 上次唤醒时刻，更新为本次唤醒时刻
+ * @param  increment: 周期 (节拍)
+ * @retval 无
+ */
+void vTaskDelayUntil(TickType_t *previousWakeTime, TickType_t increment)
+{
+    uint64_t wakeNs;
+    
+    *previousWakeTime += increment;
+    wakeNs = (uint64_t)*previousWakeTime * SIL_RTOS_TICK_NS;
+    if (wakeNs > halSimNowNs())
+    {
+        halSimAdvanceNs(wakeNs - halSimNowNs());
+    }
+}
+
+/**
+ * @brief  当前任务句柄
+ * @param  无
+ * @retval 任务句柄
+ */
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return &g_task;
+}
+
+/**
+ * @brief  中断中给任务通知计数加1
+ * @param  task: 任务句柄
+ * @param  higherPriorityTaskWoken: 置为pdFALSE(没有调度器)
+ * @retval 无
+ */
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken)
+{
+    task->notify++;
+    if (higherPriorityTaskWoken != NULL)
+    {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+}
+
+/**
+ * @brief  取任务通知计数，不等待
+ * @param  clearCountOnExit: pdTRUE时清零，否则减1
+ * @param  ticksToWait: 忽略
+ * @retval 取之前的通知计数
+ */
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+    uint32_t count = g_task.notify;
+    
+    if (count > 0)
+    {
+        g_task.notify = clearCountOnExit ? 0 : count - 1;
+    }
+    
+    return count;
+}
+
+/**
+ * @brief  挂起调度器，单线程运行时为空操作
+ * @param  无
+ * @retval 无
+ */
+void vTaskSuspendAll(void)
+{
+}
+
+/**
+ * @brief  恢复调度器
+ * @param  无
+ * @retval pdFALSE(没有因恢复而发生的任务切换)
+ */
+BaseType_t xTaskResumeAll(void)
+{
+    return pdFALSE;
+}
+
+/**
+ * @brief  创建静态队列
+ * @param  length: 队列长度
+ * @param  itemSize: 元素大小 (字节)
+ * @param  storage: 存储区，length * itemSize字节
+ * @param  queue: 队列控制块
+ * @retval 队列句柄
+ */
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t itemSize,
+                                 uint8_t *storage, StaticQueue_t *queue)
+{
+    queue->storage = storage;
+    queue->length = length;
+    queue->itemSize = itemSize;
+    queue->head = 0;
+    queue->count = 0;
+    
+    return queue;
+}
+
+/**
+ * @brief  发送到队尾
+ * @param  queue: 队列句柄
+ * @param  item: 元素
+ * @param  ticksToWait: 忽略
+ * @retval pdPASS-成功，pdFAIL-队列已满
+ */
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait)
+{
+    UBaseType_t tail;
+    
+    if (queue->count >= queue->length)
+    {
+        return pdFAIL;
+    }
+    
+    tail = (queue->head + queue->count) % queue->length;
+    memcpy(&queue->storage[tail * queue->itemSize], item, queue->itemSize);
+    queue->count++;
+    
+    return pdPASS;
+}
+
+/**
+ * @brief  发送到队首
+ * @param  queue: 队列句柄
+ * @param  item: 元素
+ * @param  ticksToWait: 忽略
+ * @retval pdPASS-成功，pdFAIL-队列已满
+ */
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t ticksToWait)
+{
+    if (queue->count >= queue->length)
+    {
+        return pdFAIL;
+    }
+    
+    queue->head = (queue->head + queue->length - 1) % queue->length;
+    memcpy(&queue->storage[queue->head * queue->itemSize], item, queue->itemSize);
+    queue->count++;
+    
+    return pdPASS;
+}
+
+/**
+ * @brief  从队首接收
+ * @param  queue: 队列句柄
+ * @param  item: 输出元素
+ * @param  ticksToWait: 忽略
+ * @retval pdTRUE-成功，pdFALSE-队列为空
+ */
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticksToWait)
+{
+    if (queue->count == 0)
+    {
+        return pdFALSE;
+    }
+    
+    memcpy(item, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    
+    return pdTRUE;
+}
+
+/**
+ * @brief  队列中的元素数
+ * @param  queue: 队列句柄
+ * @retval 元素数
+ */
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    return queue->count;
+}
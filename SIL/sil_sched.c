@@ -0,0 +1,235 @@
+﻿/*
+ * sil_sched.c
+ *
+ * 可调度性分析：按固件的任务表(周期与截止时间见TASK/schedConfig.h)，用目标板上实测的最坏执行时间
+ * 代替估计值，重新分配优先级并做响应时间分析(TASK/sched.c，与固件启动时的分析相同)
+ *
+ * 实测值的来源：
+ *   stabilizer   stabilizerGetTiming()的total.max(DWT周期)
+ *   其他任务     在任务循环体前后用DWT_GetCycles()计时得到的最大值
+ *
+ * 用法：
+ *   fc_sched [NAME=WCET]... [--file FILE] [--cycles]
+ *   NAME=WCET     替换一个任务的最坏执行时间，NAME为任务名(stabilizer、atkpTx、radioLink、atkpRx、blackbox)
+ *   --file FILE   每行一个"NAME WCET"，#开始的行为注释；命令行上的值优先
+ *   --cycles      WCET的单位为DWT周期(按SystemCoreClock换算并向上取整到us)，默认为us
+ *
+ * 输出每个任务的周期、截止时间、WCET、优先级、最坏响应时间与余量，以及总利用率；
+ * 所有任务满足截止时间时返回0，否则返回1，参数错误返回2
+ *
+ * 2026-03-02
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sched.h"
+#include "schedConfig.h"
+#include "DWT.h"
+
+/* 与USER/main.c相同：configMAX_PRIORITIES为7，空闲任务之上、留出最高一级 */
+#define SCHEDTOOL_PRIORITY_MAX   5
+#define SCHEDTOOL_PRIORITY_MIN   1
+
+#define SCHEDTOOL_LINE_MAX       128
+
+#define SCHEDTOOL_TASK(name, period, deadline, wcet) \
+    { 0, (name), 0, 0, 0, (period), (deadline), (wcet), 0, 0, 0 }
+
+/* 固件的任务表，顺序与USER/main.c相同 */
+static schedTask_t g_tasks[] = {
+    SCHEDTOOL_TASK("stabilizer", SCHED_STABILIZER_PERIOD_US, SCHED_STABILIZER_DEADLINE_US, SCHED_STABILIZER_WCET_US),
+    SCHEDTOOL_TASK("atkpTx", SCHED_ATKPTX_PERIOD_US, SCHED_ATKPTX_DEADLINE_US, SCHED_ATKPTX_WCET_US),
+    SCHEDTOOL_TASK("radioLink", SCHED_RADIOLINK_PERIOD_US, SCHED_RADIOLINK_DEADLINE_US, SCHED_RADIOLINK_WCET_US),
+    SCHEDTOOL_TASK("atkpRx", SCHED_ATKPRX_PERIOD_US, SCHED_ATKPRX_DEADLINE_US, SCHED_ATKPRX_WCET_US),
+#if STABILIZER_BLACKBOX
+    SCHEDTOOL_TASK("blackbox", SCHED_BLACKBOX_PERIOD_US, SCHED_BLACKBOX_DEADLINE_US, SCHED_BLACKBOX_WCET_US),
+#endif
+};
+
+#define SCHEDTOOL_TASK_NUM       ((uint8_t)(sizeof(g_tasks) / sizeof(g_tasks[0])))
+
+/* 各任务的WCET是否已被实测值替换 */
+static uint8_t g_measured[SCHEDTOOL_TASK_NUM];
+
+/**
+ * @brief  替换一个任务的最坏执行时间
+ * @param  name: 任务名
+ * @param  len: 任务名长度
+ * @param  value: 最坏执行时间文本
+ * @param  cycles: 1-单位为DWT周期，0-单位为us
+ * @param  override: 1-覆盖已替换的值，0-保留已替换的值
+ * @retval 1-成功，0-任务名或数值无效(已打印错误信息)
+ */
+static uint8_t schedtoolSetWcet(const char *name, size_t len, const char *value, uint8_t cycles, uint8_t override)
+{
+    uint32_t cyclesPerUs = SystemCoreClock / 1000000;
+    unsigned long wcet;
+    char *end;
+    uint8_t i;
+    
+    wcet = strtoul(value, &end, 10);
+    if (end == value || *end != '\0' || wcet == 0 || wcet > 0xFFFFFFFFUL)
+    {
+        fprintf(stderr, "invalid WCET '%s'\n", value);
+        return 0;
+    }
+    if (cycles)
+    {
+        wcet = (wcet + cyclesPerUs - 1) / cyclesPerUs;
+    }
+    
+    for (i = 0; i < SCHEDTOOL_TASK_NUM; i++)
+    {
+        if (strlen(g_tasks[i].name) == len && strncmp(g_tasks[i].name, name, len) == 0)
+        {
+            if (override || !g_measured[i])
+            {
+                g_tasks[i].wcetUs = (uint32_t)wcet;
+                g_measured[i] = 1;
+            }
+            return 1;
+        }
+    }
+    fprintf(stderr, "unknown task '%.*s'\n", (int)len, name);
+    return 0;
+}
+
+/**
+ * @brief  读取实测值文件，每行"NAME WCET"
+ * @param  path: 文件名
+ * @param  cycles: 1-单位为DWT周期，0-单位为us
+ * @retval 1-成功，0-失败(已打印错误信息)
+ */
+static uint8_t schedtoolLoad(const char *path, uint8_t cycles)
+{
+    FILE *f = fopen(path, "r");
+    char line[SCHEDTOOL_LINE_MAX];
+    char name[SCHEDTOOL_LINE_MAX], value[SCHEDTOOL_LINE_MAX];
+    uint32_t lineNo = 0;
+    uint8_t ok = 1;
+    
+    if (!f)
+    {
+        perror(path);
+        return 0;
+    }
+    while (ok && fgets(line, sizeof(line), f))
+    {
+        lineNo++;
+        if (sscanf(line, "%127s", name) != 1 || name[0] == '#')
+        {
+            continue;
+        }
+        if (sscanf(line, "%127s %127s", name, value) != 2)
+        {
+            fprintf(stderr, "%s:%u: expected NAME WCET\n", path, (unsigned)lineNo);
+            ok = 0;
+        }
+        else if (!schedtoolSetWcet(name, strlen(name), value, cycles, 0))
+        {
+            fprintf(stderr, "%s:%u: invalid entry\n", path, (unsigned)lineNo);
+            ok = 0;
+        }
+    }
+    fclose(f);
+    
+    return ok;
+}
+
+static void schedtoolUsage(const char *prog)
+{
+    uint8_t i;
+    
+    printf("usage: %s [NAME=WCET]... [options]\n"
+           "  NAME=WCET                  measured worst-case execution time of one task\n"
+           "  --file FILE                read 'NAME WCET' lines (# starts a comment)\n"
+           "  --cycles                   WCET values are DWT cycles instead of us\n"
+           "tasks:", prog);
+    for (i = 0; i < SCHEDTOOL_TASK_NUM; i++)
+    {
+        printf(" %s", g_tasks[i].name);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *filePath = 0;
+    const char *eq;
+    uint8_t cycles = 0, schedulable;
+    uint32_t deadline;
+    int a;
+    uint8_t i;
+    
+    /* 先确定单位，再按命令行、文件的顺序替换(命令行优先) */
+    for (a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "--help") == 0 || strcmp(argv[a], "-h") == 0)
+        {
+            schedtoolUsage(argv[0]);
+            return 0;
+        }
+        if (strcmp(argv[a], "--cycles") == 0)
+        {
+            cycles = 1;
+        }
+    }
+    for (a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "--cycles") == 0)
+        {
+            continue;
+        }
+        if (strcmp(argv[a], "--file") == 0)
+        {
+            if (a + 1 >= argc)
+            {
+                schedtoolUsage(argv[0]);
+                return 2;
+            }
+            filePath = argv[++a];
+        }
+        else if (argv[a][0] != '-' && (eq = strchr(argv[a], '=')) != 0)
+        {
+            if (!schedtoolSetWcet(argv[a], (size_t)(eq - argv[a]), eq + 1, cycles, 1))
+            {
+                return 2;
+            }
+        }
+        else
+        {
+            schedtoolUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (filePath && !schedtoolLoad(filePath, cycles))
+    {
+        return 2;
+    }
+    
+    schedAssignPriorities(g_tasks, SCHEDTOOL_TASK_NUM, SCHEDTOOL_PRIORITY_MAX, SCHEDTOOL_PRIORITY_MIN);
+    schedulable = schedAnalyze(g_tasks, SCHEDTOOL_TASK_NUM);
+    
+    printf("%-12s %10s %12s %8s %9s %5s %12s %9s\n",
+           "task", "period_us", "deadline_us", "wcet_us", "source", "prio", "response_us", "slack_us");
+    for (i = 0; i < SCHEDTOOL_TASK_NUM; i++)
+    {
+        deadline = g_tasks[i].deadlineUs != 0 ? g_tasks[i].deadlineUs : g_tasks[i].periodUs;
+        printf("%-12s %10u %12u %8u %9s %5u ", g_tasks[i].name, (unsigned)g_tasks[i].periodUs, (unsigned)deadline,
+               (unsigned)g_tasks[i].wcetUs, g_measured[i] ? "measured" : "estimate", (unsigned)g_tasks[i].priority);
+        if (g_tasks[i].responseUs == 0xFFFFFFFF)
+        {
+            printf("%12s %9s\n", "miss", "-");
+        }
+        else
+        {
+            printf("%12u %9u\n", (unsigned)g_tasks[i].responseUs, (unsigned)(deadline - g_tasks[i].responseUs));
+        }
+    }
+    printf("utilization %u.%u%%, %s\n", (unsigned)(schedUtilization(g_tasks, SCHEDTOOL_TASK_NUM) / 10),
+           (unsigned)(schedUtilization(g_tasks, SCHEDTOOL_TASK_NUM) % 10),
+           schedulable ? "all deadlines met" : "DEADLINE MISS");
+    
+    return schedulable ? 0 : 1;
+}
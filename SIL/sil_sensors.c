@@ -0,0 +1,415 @@
+﻿/*
+ * sil_sensors.c
+ *
+ * SIL仿真传感器模型实现
+ *
+ * 2026-03-01
+ */
+
+#include "sil_sensors.h"
+#include "hal_sim.h"
+#include "MPU9250.h"
+#include "BMP280.h"
+#include <math.h>
+#include <string.h>
+
+#define SIL_GYRO_LSB             131.0       // LSB/(deg/s)，±250dps
+#define SIL_ACCEL_LSB            16384.0     // LSB/g，±2g
+#define SIL_MAG_UT_PER_LSB       0.15        // 16位输出
+#define SIL_MAG_PERIOD_NS        10000000ULL // 连续测量模式2，100Hz
+#define SIL_SEA_LEVEL_PA         101325.0
+
+/* BMP280数据手册中的示例校准值 */
+#define SIL_BMP_T1               27504
+#define SIL_BMP_T2               26435
+#define SIL_BMP_T3               (-1000)
+#define SIL_BMP_P1               36477
+#define SIL_BMP_P2               (-10685)
+#define SIL_BMP_P3               3024
+#define SIL_BMP_P4               2855
+#define SIL_BMP_P5               140
+#define SIL_BMP_P6               (-7)
+#define SIL_BMP_P7               15500
+#define SIL_BMP_P8               (-14600)
+#define SIL_BMP_P9               6000
+
+static const silQuad_t *g_quad;
+static silSensorsParams_t g_params;
+static uint64_t g_rng;
+static double g_gyroBias[3];
+static double g_imuFilt[6];          // DLPF状态：加速度xyz (g)，角速度xyz (deg/s)
+static double g_imuLastS;            // 上一次采样时刻
+static uint8_t g_imuPrimed;
+static uint64_t g_magNextNs;
+
+static halSimI2cDevice_t g_mpu;
+static halSimI2cDevice_t g_mag;
+static halSimI2cDevice_t g_baro;
+
+/**
+ * @brief  伪随机数(xorshift64*)
+ * @param  无
+ * @retval [0, 1)均匀分布
+ */
+static double silRandUniform(void)
+{
+    g_rng ^= g_rng >> 12;
+    g_rng ^= g_rng << 25;
+    g_rng ^= g_rng >> 27;
+    
+    return (double)((g_rng * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief  标准正态分布随机数(Box-Muller)
+ * @param  无
+ * @retval 随机数
+ */
+static double silRandGauss(void)
+{
+    double u1 = silRandUniform();
+    double u2 = silRandUniform();
+    
+    if (u1 < 1e-300)
+    {
+        u1 = 1e-300;
+    }
+    
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+/**
+ * @brief  量化为int16(饱和)
+ * @param  value: 以LSB为单位的值
+ * @retval 量化结果
+ */
+static int16_t silQuantize(double value)
+{
+    value = floor(value + 0.5);
+    if (value > 32767.0)
+    {
+        return 32767;
+    }
+    if (value < -32768.0)
+    {
+        return -32768;
+    }
+    
+    return (int16_t)value;
+}
+
+/**
+ * @brief  写入大端16位寄存器
+ */
+static void silPutBe16(uint8_t *regs, int16_t value)
+{
+    regs[0] = (uint8_t)((uint16_t)value >> 8);
+    regs[1] = (uint8_t)value;
+}
+
+/**
+ * @brief  写入小端16位寄存器
+ */
+static void silPutLe16(uint8_t *regs, int16_t value)
+{
+    regs[0] = (uint8_t)value;
+    regs[1] = (uint8_t)((uint16_t)value >> 8);
+}
+
+/**
+ * @brief  MPU9250采样：读ACCEL_XOUT_H时锁存全部数据寄存器(与突发读取一致)
+ * @param  dev: 设备
+ * @param  reg: 寄存器
+ * @retval 无
+ */
+static void silMpuOnRead(halSimI2cDevice_t *dev, uint8_t reg)
+{
+    double nowS = (double)halSimNowNs() * 1e-9;
+    double meas[6], alpha, vib, phase;
+    uint8_t i, m;
+    
+    if (reg != MPU9250_ACCEL_XOUT_H_REG)
+    {
+        return;
+    }
+    
+    for (i = 0; i < 3; i++)
+    {
+        meas[i] = g_quad->specificForce[i] / SIL_QUAD_GRAVITY + g_params.accelNoise * silRandGauss();
+        meas[3 + i] = g_quad->rate[i] * (180.0 / M_PI) + g_gyroBias[i] + g_params.gyroNoise * silRandGauss();
+    }
+    
+    /* 振动：每个电机的不平衡量随转子旋转，在机体xy平面内产生转速基频的正弦激励 */
+    for (m = 0; m < SIL_QUAD_MOTOR_NUM; m++)
+    {
+        vib = g_quad->motorSpeed[m] * g_quad->motorSpeed[m];
+        phase = g_quad->rotorAngle[m];
+        meas[0] += g_params.vibAccel * vib * cos(phase);
+        meas[1] += g_params.vibAccel * vib * sin(phase);
+        meas[3] += g_params.vibGyro * vib * sin(phase);
+        meas[4] += g_params.vibGyro * vib * cos(phase);
+    }
+    
+    /* 片内DLPF：一阶低通近似 */
+    if (!g_imuPrimed || g_params.dlpfHz <= 0.0)
+    {
+        alpha = 1.0;
+        g_imuPrimed = 1;
+    }
+    else
+    {
+        alpha = (nowS - g_imuLastS) / (1.0 / (2.0 * M_PI * g_params.dlpfHz) + (nowS - g_imuLastS));
+    }
+    g_imuLastS = nowS;
+    for (i = 0; i < 6; i++)
+    {
+        g_imuFilt[i] += alpha * (meas[i] - g_imuFilt[i]);
+    }
+    
+    for (i = 0; i < 3; i++)
+    {
+        silPutBe16(&dev->regs[MPU9250_ACCEL_XOUT_H_REG + 2 * i], silQuantize(g_imuFilt[i] * SIL_ACCEL_LSB));
+        silPutBe16(&dev->regs[MPU9250_GYRO_XOUT_H_REG + 2 * i], silQuantize(g_imuFilt[3 + i] * SIL_GYRO_LSB));
+    }
+    /* 温度寄存器：(T - 21) * 333.87 */
+    silPutBe16(&dev->regs[MPU9250_TEMP_OUT_H_REG], silQuantize((g_params.temperature - 21.0) * 333.87));
+}
+
+/**
+ * @brief  AK8963采样：连续测量模式下每10ms产生一组新数据，读ST2后清除数据就绪
+ * @param  dev: 设备
+ * @param  reg: 寄存器
+ * @retval 无
+ */
+static void silMagOnRead(halSimI2cDevice_t *dev, uint8_t reg)
+{
+    double body[3];
+    uint8_t i;
+    
+    if (reg == AK8963_ST1_REG)
+    {
+        if (dev->regs[AK8963_CNTL1_REG] != 0x16 || halSimNowNs() < g_magNextNs)
+        {
+            return;
+        }
+        g_magNextNs = halSimNowNs() + SIL_MAG_PERIOD_NS;
+        
+        silQuadEarthToBody(g_quad, g_params.magField, body);
+        for (i = 0; i < 3; i++)
+        {
+            body[i] += g_params.magNoise * silRandGauss();
+        }
+        
+        /* 驱动中：magX = my，magY = mx，magZ = -mz */
+        silPutLe16(&dev->regs[AK8963_HXL_REG], silQuantize(body[1] / SIL_MAG_UT_PER_LSB));
+        silPutLe16(&dev->regs[AK8963_HXL_REG + 2], silQuantize(body[0] / SIL_MAG_UT_PER_LSB));
+        silPutLe16(&dev->regs[AK8963_HXL_REG + 4], silQuantize(-body[2] / SIL_MAG_UT_PER_LSB));
+        dev->regs[AK8963_ST1_REG] = 0x01;
+    }
+    else if (reg == AK8963_ST2_REG)
+    {
+        /* 读取ST2的同时数据就绪清零(寄存器值本次仍读出0) */
+        dev->regs[AK8963_ST1_REG] = 0x00;
+        dev->regs[AK8963_ST2_REG] = 0x00;
+    }
+}
+
+/**
+ * @brief  BMP280温度补偿(与驱动相同的整数公式)
+ * @param  adcT: 温度原始值
+ * @param  tFine: 输出t_fine
+ * @retval 温度 (0.01degC)
+ */
+static int32_t silBmpTemperature(int32_t adcT, int32_t *tFine)
+{
+    int32_t var1, var2;
+    
+    var1 = ((((adcT >> 3) - ((int32_t)SIL_BMP_T1 << 1))) * ((int32_t)SIL_BMP_T2)) >> 11;
+    var2 = (((((adcT >> 4) - ((int32_t)SIL_BMP_T1)) * ((adcT >> 4) - ((int32_t)SIL_BMP_T1))) >> 12) * ((int32_t)SIL_BMP_T3)) >> 14;
+    *tFine = var1 + var2;
+    
+    return (*tFine * 5 + 128) >> 8;
+}
+
+/**
+ * @brief  BMP280气压补偿(与驱动相同的整数公式)
+ * @param  adcP: 气压原始值
+ * @param  tFine: 温度补偿得到的t_fine
+ * @retval 气压 (Pa * 256)
+ */
+static int64_t silBmpPressure(int32_t adcP, int32_t tFine)
+{
+    int64_t var1, var2, p;
+    
+    var1 = ((int64_t)tFine) - 128000;
+    var2 = var1 * var1 * (int64_t)SIL_BMP_P6;
+    var2 = var2 + ((var1 * (int64_t)SIL_BMP_P5) << 17);
+    var2 = var2 + (((int64_t)SIL_BMP_P4) << 35);
+    var1 = ((var1 * var1 * (int64_t)SIL_BMP_P3) >> 8) + ((var1 * (int64_t)SIL_BMP_P2) << 12);
+    var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)SIL_BMP_P1) >> 33;
+    if (var1 == 0)
+    {
+        return 0;
+    }
+    
+    p = 1048576 - adcP;
+    p = (((p << 31) - var2) * 3125) / var1;
+    var1 = (((int64_t)SIL_BMP_P9) * (p >> 13) * (p >> 13)) >> 25;
+    var2 = (((int64_t)SIL_BMP_P8) * p) >> 19;
+    
+    return ((p + var1 + var2) >> 8) + (((int64_t)SIL_BMP_P7) << 4);
+}
+
+/**
+ * @brief  写入20位原始值(msb, lsb, xlsb高4位)
+ */
+static void silPutRaw20(uint8_t *regs, int32_t value)
+{
+    regs[0] = (uint8_t)(value >> 12);
+    regs[1] = (uint8_t)(value >> 4);
+    regs[2] = (uint8_t)((value & 0x0F) << 4);
+}
+
+/**
+ * @brief  BMP280采样：读PRESS_MSB时按当前高度反解原始值
+ *         补偿结果随温度原始值单调增加、随气压原始值单调减小，二分查找
+ * @param  dev: 设备
+ * @param  reg: 寄存器
+ * @retval 无
+ */
+static void silBaroOnRead(halSimI2cDevice_t *dev, uint8_t reg)
+{
+    double altitude, pressure;
+    int32_t lo, hi, mid, tFine;
+    int32_t targetT = (int32_t)floor(g_params.temperature * 100.0 + 0.5);
+    int64_t targetP;
+    
+    if (reg != BMP280_PRESS_MSB_REG)
+    {
+        return;
+    }
+    
+    altitude = g_params.groundAltitude + g_quad->pos[2];
+    pressure = SIL_SEA_LEVEL_PA * pow(1.0 - altitude / 44330.0, 5.255) + g_params.baroNoise * silRandGauss();
+    targetP = (int64_t)floor(pressure * 256.0 + 0.5);
+    
+    lo = 0;
+    hi = 0xFFFFF;
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (silBmpTemperature(mid, &tFine) < targetT)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    silPutRaw20(&dev->regs[BMP280_TEMP_MSB_REG], lo);
+    silBmpTemperature(lo, &tFine);
+    
+    lo = 0;
+    hi = 0xFFFFF;
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (silBmpPressure(mid, tFine) > targetP)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    silPutRaw20(&dev->regs[BMP280_PRESS_MSB_REG], lo);
+}
+
+/**
+ * @brief  默认传感器参数
+ * @param  params: 输出参数
+ * @retval 无
+ */
+void silSensorsDefaultParams(silSensorsParams_t *params)
+{
+    params->gyroNoise = 0.1;
+    params->gyroBias = 1.0;
+    params->accelNoise = 0.004;
+    params->vibAccel = 0.3;
+    params->vibGyro = 5.0;
+    params->dlpfHz = 184.0;
+    params->magField[0] = 25.0;
+    params->magField[1] = 0.0;
+    params->magField[2] = -40.0;
+    params->magNoise = 0.3;
+    params->baroNoise = 3.0;
+    params->groundAltitude = 50.0;
+    params->temperature = 25.0;
+}
+
+/**
+ * @brief  挂接传感器模型，需在halSimReset之后、stabilizerInit之前调用
+ * @param  quad: 机体模型(测量值取自其当前状态)
+ * @param  params: 传感器参数
+ * @param  seed: 随机数种子
+ * @retval 无
+ */
+void silSensorsInit(const silQuad_t *quad, const silSensorsParams_t *params, uint64_t seed)
+{
+    static const int16_t calib[12] = {
+        (int16_t)SIL_BMP_T1, SIL_BMP_T2, SIL_BMP_T3,
+        (int16_t)SIL_BMP_P1, SIL_BMP_P2, SIL_BMP_P3, SIL_BMP_P4, SIL_BMP_P5,
+        SIL_BMP_P6, SIL_BMP_P7, SIL_BMP_P8, SIL_BMP_P9
+    };
+    uint8_t i;
+    
+    g_quad = quad;
+    g_params = *params;
+    g_rng = seed * 0x9E3779B97F4A7C15ULL + 1;
+    for (i = 0; i < 3; i++)
+    {
+        g_gyroBias[i] = params->gyroBias * silRandGauss();
+    }
+    memset(g_imuFilt, 0, sizeof(g_imuFilt));
+    g_imuPrimed = 0;
+    g_magNextNs = 0;
+    
+    memset(&g_mpu, 0, sizeof(g_mpu));
+    g_mpu.addr = MPU9250_ADDR;
+    g_mpu.regs[MPU9250_WHO_AM_I_REG] = MPU9250_WHO_AM_I_VAL;
+    g_mpu.onRead = silMpuOnRead;
+    halSimI2cAttach(HAL_I2C_1, &g_mpu);
+    
+    memset(&g_mag, 0, sizeof(g_mag));
+    g_mag.addr = AK8963_ADDR;
+    g_mag.regs[AK8963_WIA_REG] = AK8963_WIA_VAL;
+    g_mag.regs[AK8963_ASAX_REG] = 128;
+    g_mag.regs[AK8963_ASAX_REG + 1] = 128;
+    g_mag.regs[AK8963_ASAX_REG + 2] = 128;
+    g_mag.onRead = silMagOnRead;
+    halSimI2cAttach(HAL_I2C_1, &g_mag);
+    
+    memset(&g_baro, 0, sizeof(g_baro));
+    g_baro.addr = BMP280_ADDR;
+    g_baro.regs[BMP280_WHO_AM_I_REG] = BMP280_WHO_AM_I_VAL;
+    for (i = 0; i < 12; i++)
+    {
+        silPutLe16(&g_baro.regs[BMP280_DIG_T1_LSB_REG + 2 * i], calib[i]);
+    }
+    g_baro.onRead = silBaroOnRead;
+    halSimI2cAttach(HAL_I2C_2, &g_baro);
+}
+
+/**
+ * @brief  读取本次仿真随机得到的陀螺仪零偏
+ * @param  bias: 输出[x, y, z] (deg/s)
+ * @retval 无
+ */
+void silSensorsGetGyroBias(double *bias)
+{
+    bias[0] = g_gyroBias[0];
+    bias[1] = g_gyroBias[1];
+    bias[2] = g_gyroBias[2];
+}
@@ -0,0 +1,42 @@
+﻿/*
+ * sil_sensors.h
+ *
+ * SIL仿真传感器模型头文件
+ * 在hal_sim的I2C总线上挂接MPU9250(含旁路访问的AK8963)与BMP280寄存器模型，
+ * 驱动读取数据寄存器时按机体模型的当前状态生成测量值：
+ * 1.陀螺仪/加速度计：真值 + 零偏 + 白噪声 + 电机转速频率的振动，经一阶低通(片内DLPF)后量化
+ * 2.磁力计：地磁场转到机体系 + 白噪声，100Hz更新，读ST2后清除数据就绪
+ * 3.气压计：高度换算气压 + 白噪声，用驱动中的补偿公式反解出原始值
+ *
+ * 噪声由固定种子的伪随机数生成，同样的种子与参数得到完全相同的结果
+ *
+ * 2026-03-01
+ */
+
+#ifndef SIL_SENSORS_H
+#define SIL_SENSORS_H
+
+#include <stdint.h>
+#include "sil_quad.h"
+
+/* 传感器参数 */
+typedef struct {
+    double gyroNoise;            // 陀螺仪白噪声 (deg/s RMS)
+    double gyroBias;             // 陀螺仪零偏标准差 (deg/s，每轴按种子随机取值)
+    double accelNoise;           // 加速度计白噪声 (g RMS)
+    double vibAccel;             // 满转速时的振动加速度幅值 (g)
+    double vibGyro;              // 满转速时的振动角速度幅值 (deg/s)
+    double dlpfHz;               // 片内数字低通截止频率 (Hz)，0为不滤波
+    double magField[3];          // 地磁场，地面系 (uT)
+    double magNoise;             // 磁力计白噪声 (uT RMS)
+    double baroNoise;            // 气压计白噪声 (Pa RMS)
+    double groundAltitude;       // 起飞点海拔 (m)
+    double temperature;          // 气温 (degC)
+} silSensorsParams_t;
+
+/* 函数声明 */
+void silSensorsDefaultParams(silSensorsParams_t *params);
+void silSensorsInit(const silQuad_t *quad, const silSensorsParams_t *params, uint64_t seed);
+void silSensorsGetGyroBias(double *bias);
+
+#endif /* SIL_SENSORS_H */
@@ -0,0 +1,294 @@
+﻿/*
+ * sil_teldecode.c
+ *
+ * 遥测解码：从UART2发送方向(飞控 -> NRF51822)的原始字节抓包中按ATKP帧格式组帧、校验CRC，
+ * 把UP_COMPACT压缩遥测解码为CSV，并统计各类数据包、校验错误、丢帧与平均每样本字节数
+ *
+ * 帧格式：0xAA | type | length | data[length] | CRC高字节 | CRC低字节(见UART2.h)
+ *
+ * 用法：
+ *   fc_telemetry_decode CAPTURE [--out FILE] [--raw]
+ *   --out FILE    每个样本一行：frame,sample,roll,pitch,yaw,gyro_x,gyro_y,gyro_z,accel_x,accel_y,accel_z
+ *   --raw         输出量化后的整数(默认为物理量)
+ *
+ * 2026-03-01
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "atkpCompact.h"
+#include "UART2.h"
+
+/* 一个压缩帧最多包含的样本数(每样本每通道至少1字节) */
+#define TELDECODE_MAX_SAMPLES  (ATKP_MAX_DATA_SIZE / ATKP_COMPACT_CHANNELS + 1)
+
+/* 解码统计 */
+typedef struct {
+    uint32_t packets;            // CRC校验通过的数据包数
+    uint32_t types[256];         // 各数据包ID的数据包数
+    uint32_t crcErrors;          // CRC错误的数据包数
+    uint32_t lengthErrors;       // 长度字段超出ATKP_MAX_DATA_SIZE的数据包数
+    uint32_t discarded;          // 帧外被丢弃的字节数
+    uint32_t compactBytes;       // UP_COMPACT数据包的线路字节数(含帧头与CRC)
+    uint32_t truncated;          // 末尾不完整的字节数
+} teldecodeResult_t;
+
+static const char *g_channelNames[ATKP_COMPACT_CHANNELS] = {
+    "roll", "pitch", "yaw", "gyro_x", "gyro_y", "gyro_z", "accel_x", "accel_y", "accel_z"
+};
+
+/**
+ * @brief  读取整个文件
+ * @param  path: 文件名
+ * @param  len: 输出字节数
+ * @retval 文件内容(malloc)，失败时为0(已打印错误信息)
+ */
+static uint8_t *teldecodeLoad(const char *path, uint32_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *data = 0;
+    long size;
+    
+    if (!f)
+    {
+        perror(path);
+        return 0;
+    }
+    if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) >= 0 && size <= 0x7FFFFFFF &&
+        fseek(f, 0, SEEK_SET) == 0)
+    {
+        data = (uint8_t *)malloc(size ? (size_t)size : 1);
+        if (data && fread(data, 1, (size_t)size, f) == (size_t)size)
+        {
+            *len = (uint32_t)size;
+        }
+        else
+        {
+            free(data);
+            data = 0;
+        }
+    }
+    if (!data)
+    {
+        fprintf(stderr, "%s: read failed\n", path);
+    }
+    fclose(f);
+    
+    return data;
+}
+
+/**
+ * @brief  输出一个UP_COMPACT数据包解码出的样本
+ * @param  out: CSV输出
+ * @param  frame: 帧序号(解码成功的UP_COMPACT帧计数)
+ * @param  q: 量化样本
+ * @param  n: 样本数
+ * @param  raw: 1-输出量化值
+ * @retval 无
+ */
+static void teldecodeWriteSamples(FILE *out, uint32_t frame, int16_t (*q)[ATKP_COMPACT_CHANNELS], uint8_t n, uint8_t raw)
+{
+    atkpCompactSample_t sample;
+    const float *v = &sample.roll;
+    uint8_t s, ch;
+    
+    for (s = 0; s < n; s++)
+    {
+        atkpCompactDequantize(q[s], &sample);
+        fprintf(out, "%u,%u", (unsigned)frame, (unsigned)s);
+        for (ch = 0; ch < ATKP_COMPACT_CHANNELS; ch++)
+        {
+            if (raw)
+            {
+                fprintf(out, ",%d", (int)q[s][ch]);
+            }
+            else
+            {
+                fprintf(out, ",%.7g", (double)v[ch]);
+            }
+        }
+        fprintf(out, "\n");
+    }
+}
+
+/**
+ * @brief  组帧并解码全部数据
+ * @param  data: 抓包数据
+ * @param  len: 字节数
+ * @param  dec: 压缩遥测解码器
+ * @param  out: CSV输出，可为0
+ * @param  raw: 1-输出量化值
+ * @param  res: 输出统计
+ * @retval 无
+ */
+static void teldecodeRun(const uint8_t *data, uint32_t len, atkpCompactDecoder_t *dec, FILE *out, uint8_t raw,
+                         teldecodeResult_t *res)
+{
+    int16_t q[TELDECODE_MAX_SAMPLES][ATKP_COMPACT_CHANNELS];
+    uint32_t pos = 0, size;
+    uint16_t crc;
+    uint8_t type, length, n, ch;
+    
+    memset(res, 0, sizeof(*res));
+    atkpCompactDecoderInit(dec);
+    
+    if (out)
+    {
+        fprintf(out, "frame,sample");
+        for (ch = 0; ch < ATKP_COMPACT_CHANNELS; ch++)
+        {
+            fprintf(out, ",%s", g_channelNames[ch]);
+        }
+        fprintf(out, "\n");
+    }
+    
+    while (pos < len)
+    {
+        if (data[pos] != UART2_PACKET_START)
+        {
+            res->discarded++;
+            pos++;
+            continue;
+        }
+        if (len - pos < 3)
+        {
+            break;
+        }
+        
+        type = data[pos + 1];
+        length = data[pos + 2];
+        if (length > ATKP_MAX_DATA_SIZE)
+        {
+            /* 不是帧头(或长度损坏)，从下一字节重新查找 */
+            res->lengthErrors++;
+            res->discarded++;
+            pos++;
+            continue;
+        }
+        size = (uint32_t)length + 5;
+        if (len - pos < size)
+        {
+            break;
+        }
+        
+        crc = CRC16_Calculate(&data[pos + 1], (uint16_t)(length + 2));
+        if (crc != (uint16_t)((data[pos + length + 3] << 8) | data[pos + length + 4]))
+        {
+            res->crcErrors++;
+            res->discarded++;
+            pos++;
+            continue;
+        }
+        
+        res->packets++;
+        res->types[type]++;
+        if (type == UP_COMPACT)
+        {
+            res->compactBytes += size;
+            n = atkpCompactDecode(dec, &data[pos + 3], length, q, TELDECODE_MAX_SAMPLES);
+            if (out && n > 0)
+            {
+                teldecodeWriteSamples(out, dec->frames, q, n, raw);
+            }
+        }
+        pos += size;
+    }
+    
+    res->truncated = len - pos;
+}
+
+/**
+ * @brief  打印用法
+ */
+static void teldecodeUsage(const char *prog)
+{
+    printf("usage: %s CAPTURE [options]\n"
+           "  CAPTURE                    raw UART2 TX bytes (flight controller -> radio)\n"
+           "  --out FILE                 write one CSV line per UP_COMPACT sample\n"
+           "  --raw                      write quantized integers instead of physical values\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *capturePath = 0, *outPath = 0;
+    static teldecodeResult_t res;
+    atkpCompactDecoder_t dec;
+    uint8_t *data;
+    uint32_t len = 0;
+    uint8_t raw = 0;
+    FILE *out = 0;
+    int a;
+    
+    for (a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "--help") == 0 || strcmp(argv[a], "-h") == 0)
+        {
+            teldecodeUsage(argv[0]);
+            return 0;
+        }
+        if (argv[a][0] != '-')
+        {
+            capturePath = argv[a];
+        }
+        else if (strcmp(argv[a], "--raw") == 0)
+        {
+            raw = 1;
+        }
+        else if (strcmp(argv[a], "--out") == 0 && a + 1 < argc)
+        {
+            outPath = argv[++a];
+        }
+        else
+        {
+            teldecodeUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (!capturePath)
+    {
+        teldecodeUsage(argv[0]);
+        return 2;
+    }
+    
+    data = teldecodeLoad(capturePath, &len);
+    if (!data)
+    {
+        return 1;
+    }
+    if (outPath)
+    {
+        out = fopen(outPath, "w");
+        if (!out)
+        {
+            perror(outPath);
+            free(data);
+            return 1;
+        }
+    }
+    
+    CRC16_Init();
+    teldecodeRun(data, len, &dec, out, raw, &res);
+    if (out)
+    {
+        fclose(out);
+    }
+    free(data);
+    
+    printf("packets                %u (%u crc errors, %u length errors, %u bytes discarded)\n",
+           (unsigned)res.packets, (unsigned)res.crcErrors, (unsigned)res.lengthErrors, (unsigned)res.discarded);
+    printf("types                  status %u, senser %u, compact %u, ping %u, linkstats %u, other %u\n",
+           (unsigned)res.types[UP_STATUS], (unsigned)res.types[UP_SENSER], (unsigned)res.types[UP_COMPACT],
+           (unsigned)res.types[UP_PING], (unsigned)res.types[UP_LINKSTATS],
+           (unsigned)(res.packets - res.types[UP_STATUS] - res.types[UP_SENSER] - res.types[UP_COMPACT] -
+                      res.types[UP_PING] - res.types[UP_LINKSTATS]));
+    printf("compact                %u frames, %u samples, %u dropped, %u malformed\n", (unsigned)dec.frames,
+           (unsigned)dec.samples, (unsigned)dec.dropped, (unsigned)dec.malformed);
+    printf("bytes_per_sample       %.2f\n", dec.samples ? (double)res.compactBytes / dec.samples : 0.0);
+    if (res.truncated)
+    {
+        printf("truncated              %u bytes\n", (unsigned)res.truncated);
+    }
+    
+    return 0;
+}
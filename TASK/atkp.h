@@ -0,0 +1,67 @@
+﻿/*
+ * atkp.h
+ *
+ * ATKP通信协议定义
+ * 飞控(STM32F411CEU6)与NRF51822无线模块之间的数据包格式
+ *
+ * 2026-02-16
+ */
+
+#ifndef __ATKP_H
+#define __ATKP_H
+
+#include <stdint.h>
+
+/* 协议参数 */
+#define ATKP_MAX_DATA_SIZE     30          // 单包最大数据长度(受NRF51822无线负载32字节限制)
+
+/* 上行数据包ID(飞控 -> 遥控器) */
+#define UP_VERSION             0x00        // 版本信息
+#define UP_STATUS              0x01        // 姿态(float roll/pitch/yaw)
+#define UP_SENSER              0x02        // 传感器(float accel xyz / gyro xyz)
+#define UP_COMPACT             0x30        // 压缩遥测(量化+增量编码，见atkpCompact.h)
+#define UP_PING                0x31        // 链路延迟测量(请求/应答)
+#define UP_LINKSTATS           0x32        // 链路统计
+#define UP_CPULOAD             0x33        // CPU占用
+#define UP_STACK               0x34        // 任务栈剩余与建议深度
+#define UP_LATENCY             0x35        // 中断到任务延迟(LATENCY_ENABLE)
+
+/* 下行数据包ID(遥控器 -> 飞控) */
+#define DOWN_COMMAND           0x01        // 命令
+#define DOWN_ACK               0x02        // 应答
+#define DOWN_RCDATA            0x03        // 遥控数据
+#define DOWN_PING              0x04        // 链路延迟测量(请求/应答)
+#define DOWN_RADIO             0x05        // 无线模块状态(data[0]=RSSI)
+
+/* DOWN_COMMAND命令字(data[0]) */
+#define CMD_GET_LINKSTATS      0x01        // 立即上传一次UP_LINKSTATS
+#define CMD_GET_CPULOAD        0x02        // 立即上传一次UP_CPULOAD
+#define CMD_RESET_CPULOAD      0x03        // 清零CPU占用峰值
+#define CMD_GET_STACK          0x04        // 立即上传一次UP_STACK
+#define CMD_GET_LATENCY        0x05        // 立即上传一次UP_LATENCY
+#define CMD_RESET_LATENCY      0x06        // 清零中断到任务延迟统计
+#define CMD_BLACKBOX_ERASE     0x07        // 擦除黑匣子存储(STABILIZER_BLACKBOX)
+
+/* DOWN_RCDATA数据内容(float小端)
+ * data[0~3]: 横滚角 (deg)
+ * data[4~7]: 俯仰角 (deg)
+ * data[8~11]: 偏航角速度 (deg/s)
+ * data[12~15]: 油门 (0~1)
+ */
+#define ATKP_RCDATA_SIZE       16
+
+/* PING数据内容
+ * data[0]: ATKP_PING_REQUEST/ATKP_PING_REPLY，应答原样带回请求的其余内容
+ * 飞控发起的请求：data[1]=序号，data[2~5]=发送时刻的DWT周期计数(小端)
+ */
+#define ATKP_PING_REQUEST      0x00
+#define ATKP_PING_REPLY        0x01
+
+/* 数据包结构 */
+typedef struct {
+    uint8_t msgID;                         // 数据包ID
+    uint8_t dataLen;                       // 数据长度
+    uint8_t data[ATKP_MAX_DATA_SIZE];      // 数据内容
+} atkp_t;
+
+#endif
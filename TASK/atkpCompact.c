@@ -0,0 +1,358 @@
+﻿/*
+ * atkpCompact.c
+ *
+ * 压缩遥测编解码实现
+ * 相邻遥测样本变化很小，增量经zig-zag后绝大多数只需1字节，
+ * 一个30字节的数据包可容纳约3个样本(原float格式每个样本需要两个数据包)
+ *
+ * 2026-02-16
+ */
+
+#include <string.h>
+#include "atkpCompact.h"
+
+/* 单个样本编码后的最大长度(每通道varint最多3字节) */
+#define ATKP_COMPACT_MAX_SAMPLE_SIZE  (ATKP_COMPACT_CHANNELS * 3)
+
+/* 各通道量化系数 */
+static const float g_scale[ATKP_COMPACT_CHANNELS] = {
+    ATKP_COMPACT_ANGLE_SCALE, ATKP_COMPACT_ANGLE_SCALE, ATKP_COMPACT_ANGLE_SCALE,
+    ATKP_COMPACT_GYRO_SCALE,  ATKP_COMPACT_GYRO_SCALE,  ATKP_COMPACT_GYRO_SCALE,
+    ATKP_COMPACT_ACCEL_SCALE, ATKP_COMPACT_ACCEL_SCALE, ATKP_COMPACT_ACCEL_SCALE
+};
+
+/**
+ * @brief  将物理量量化为int16(四舍五入并限幅)
+ * @param  value: 物理量
+ * @param  scale: 量化系数
+ * @retval 量化值
+ */
+static int16_t QuantizeValue(float value, float scale)
+{
+    float v = value * scale;
+
+    if (v >= 32767.0f)
+    {
+        return 32767;
+    }
+    if (v <= -32768.0f)
+    {
+        return -32768;
+    }
+
+    return (int16_t)(v >= 0.0f ? v + 0.5f : v - 0.5f);
+}
+
+/**
+ * @brief  写入一个zig-zag varint增量
+ * @param  p: 输出位置
+ * @param  delta: 增量
+ * @retval 写入的字节数(1~3)
+ */
+static uint8_t PutDelta(uint8_t *p, int16_t delta)
+{
+    uint16_t z = (uint16_t)(((uint16_t)delta << 1) ^ (uint16_t)(delta >> 15));
+    uint8_t n = 0;
+
+    while (z >= 0x80)
+    {
+        p[n++] = (uint8_t)(z | 0x80);
+        z >>= 7;
+    }
+    p[n++] = (uint8_t)z;
+
+    return n;
+}
+
+/**
+ * @brief  读取一个zig-zag varint增量
+ * @param  p: 输入位置
+ * @param  avail: 剩余可读字节数
+ * @param  delta: 输出增量
+ * @retval 读取的字节数，0-数据不完整或格式错误
+ */
+static uint8_t GetDelta(const uint8_t *p, uint8_t avail, int16_t *delta)
+{
+    uint32_t z = 0;
+    uint8_t n = 0;
+
+    do
+    {
+        if (n >= avail || n >= 3)
+        {
+            return 0;
+        }
+        z |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+    } while (p[n++] & 0x80);
+
+    if (z > 0xFFFF)
+    {
+        return 0;
+    }
+
+    *delta = (int16_t)((z >> 1) ^ (0U - (z & 1U)));
+
+    return n;
+}
+
+/**
+ * @brief  编码一个样本
+ * @param  enc: 编码器
+ * @param  q: 量化样本
+ * @param  p: 输出位置
+ * @param  raw: 1-写入原值(关键帧首样本)，0-写入增量
+ * @retval 写入的字节数
+ */
+static uint8_t EncodeSample(const atkpCompactEncoder_t *enc, const int16_t *q, uint8_t *p, uint8_t raw)
+{
+    uint8_t n = 0;
+    uint8_t ch;
+
+    for (ch = 0; ch < ATKP_COMPACT_CHANNELS; ch++)
+    {
+        if (raw)
+        {
+            p[n++] = (uint8_t)((uint16_t)q[ch] & 0xFF);
+            p[n++] = (uint8_t)((uint16_t)q[ch] >> 8);
+        }
+        else
+        {
+            n += PutDelta(&p[n], (int16_t)(q[ch] - enc->last[ch]));
+        }
+    }
+
+    return n;
+}
+
+/**
+ * @brief  输出当前帧并推进序号
+ * @param  enc: 编码器
+ * @param  out: 输出数据包
+ * @retval 无
+ */
+static void EmitFrame(atkpCompactEncoder_t *enc, atkp_t *out)
+{
+    out->msgID = UP_COMPACT;
+    out->dataLen = enc->len;
+    memcpy(out->data, enc->buf, enc->len);
+
+    enc->seq = (enc->seq + 1) & ATKP_COMPACT_SEQ_MASK;
+    if (++enc->framesSinceKey >= ATKP_COMPACT_KEY_INTERVAL)
+    {
+        enc->framesSinceKey = 0;
+    }
+    enc->len = 0;
+}
+
+/**
+ * @brief  物理量样本量化
+ * @param  sample: 物理量样本
+ * @param  q: 输出量化样本(ATKP_COMPACT_CHANNELS个int16)
+ * @retval 无
+ */
+void atkpCompactQuantize(const atkpCompactSample_t *sample, int16_t *q)
+{
+    const float *v = &sample->roll;
+    uint8_t ch;
+
+    for (ch = 0; ch < ATKP_COMPACT_CHANNELS; ch++)
+    {
+        q[ch] = QuantizeValue(v[ch], g_scale[ch]);
+    }
+}
+
+/**
+ * @brief  量化样本还原为物理量
+ * @param  q: 量化样本
+ * @param  sample: 输出物理量样本
+ * @retval 无
+ */
+void atkpCompactDequantize(const int16_t *q, atkpCompactSample_t *sample)
+{
+    float *v = &sample->roll;
+    uint8_t ch;
+
+    for (ch = 0; ch < ATKP_COMPACT_CHANNELS; ch++)
+    {
+        v[ch] = (float)q[ch] / g_scale[ch];
+    }
+}
+
+/**
+ * @brief  编码器初始化
+ * @param  enc: 编码器
+ * @retval 无
+ */
+void atkpCompactEncoderInit(atkpCompactEncoder_t *enc)
+{
+    memset(enc, 0, sizeof(*enc));
+}
+
+/**
+ * @brief  向编码器压入一个样本
+ * @param  enc: 编码器
+ * @param  q: 量化样本
+ * @param  out: 当前帧装满时输出的数据包
+ * @retval 1-out中有一个完整数据包待发送，0-无
+ */
+uint8_t atkpCompactPush(atkpCompactEncoder_t *enc, const int16_t *q, atkp_t *out)
+{
+    uint8_t tmp[ATKP_COMPACT_MAX_SAMPLE_SIZE];
+    uint8_t n = 0;
+    uint8_t emitted = 0;
+
+    /* 当前帧放不下该样本时先输出当前帧 */
+    if (enc->len != 0)
+    {
+        n = EncodeSample(enc, q, tmp, 0);
+        if (enc->len + n > ATKP_MAX_DATA_SIZE)
+        {
+            EmitFrame(enc, out);
+            emitted = 1;
+        }
+    }
+
+    /* 开始新帧，关键帧的首样本写原值 */
+    if (enc->len == 0)
+    {
+        enc->buf[0] = enc->seq & ATKP_COMPACT_SEQ_MASK;
+        enc->buf[1] = 0;
+        enc->len = ATKP_COMPACT_HEADER_SIZE;
+
+        if (enc->framesSinceKey == 0)
+        {
+            enc->buf[0] |= ATKP_COMPACT_KEY_FLAG;
+            n = EncodeSample(enc, q, tmp, 1);
+        }
+        else if (n == 0)
+        {
+            n = EncodeSample(enc, q, tmp, 0);
+        }
+    }
+
+    memcpy(&enc->buf[enc->len], tmp, n);
+    enc->len += n;
+    enc->buf[1]++;
+    memcpy(enc->last, q, sizeof(enc->last));
+
+    return emitted;
+}
+
+/**
+ * @brief  输出未装满的当前帧
+ * @param  enc: 编码器
+ * @param  out: 输出数据包
+ * @retval 1-out中有一个数据包待发送，0-当前帧为空
+ */
+uint8_t atkpCompactFlush(atkpCompactEncoder_t *enc, atkp_t *out)
+{
+    if (enc->len <= ATKP_COMPACT_HEADER_SIZE)
+    {
+        return 0;
+    }
+
+    EmitFrame(enc, out);
+
+    return 1;
+}
+
+/**
+ * @brief  解码器初始化
+ * @param  dec: 解码器
+ * @retval 无
+ */
+void atkpCompactDecoderInit(atkpCompactDecoder_t *dec)
+{
+    memset(dec, 0, sizeof(*dec));
+}
+
+/**
+ * @brief  解码一个UP_COMPACT数据包
+ * @param  dec: 解码器
+ * @param  data: 数据内容
+ * @param  len: 数据长度
+ * @param  out: 输出量化样本数组
+ * @param  maxSamples: out可容纳的样本数
+ * @retval 输出的样本数，丢帧后到下一关键帧之前的增量帧返回0
+ */
+uint8_t atkpCompactDecode(atkpCompactDecoder_t *dec, const uint8_t *data, uint8_t len,
+                          int16_t (*out)[ATKP_COMPACT_CHANNELS], uint8_t maxSamples)
+{
+    int16_t base[ATKP_COMPACT_CHANNELS];
+    uint8_t key, seq, count;
+    uint8_t pos = ATKP_COMPACT_HEADER_SIZE;
+    uint8_t n = 0;
+    uint8_t s, ch, used;
+    int16_t delta;
+
+    if (len < ATKP_COMPACT_HEADER_SIZE || data[1] == 0)
+    {
+        dec->malformed++;
+        dec->synced = 0;
+        return 0;
+    }
+
+    key = data[0] & ATKP_COMPACT_KEY_FLAG;
+    seq = data[0] & ATKP_COMPACT_SEQ_MASK;
+    count = data[1];
+
+    /* 增量帧必须紧接在已解码的帧之后 */
+    if (!key && (!dec->synced || seq != dec->expectSeq))
+    {
+        dec->dropped++;
+        dec->synced = 0;
+        return 0;
+    }
+
+    /* 先在副本上解码，错误帧不影响解码器状态 */
+    memcpy(base, dec->last, sizeof(base));
+
+    for (s = 0; s < count; s++)
+    {
+        for (ch = 0; ch < ATKP_COMPACT_CHANNELS; ch++)
+        {
+            if (key && s == 0)
+            {
+                if (len - pos < 2)
+                {
+                    goto malformed;
+                }
+                base[ch] = (int16_t)(data[pos] | (data[pos + 1] << 8));
+                pos += 2;
+            }
+            else
+            {
+                used = GetDelta(&data[pos], len - pos, &delta);
+                if (used == 0)
+                {
+                    goto malformed;
+                }
+                base[ch] = (int16_t)(base[ch] + delta);
+                pos += used;
+            }
+        }
+
+        if (n < maxSamples)
+        {
+            memcpy(out[n++], base, sizeof(base));
+        }
+    }
+
+    if (pos != len)
+    {
+        goto malformed;
+    }
+
+    memcpy(dec->last, base, sizeof(base));
+    dec->synced = 1;
+    dec->expectSeq = (seq + 1) & ATKP_COMPACT_SEQ_MASK;
+    dec->frames++;
+    dec->samples += count;
+
+    return n;
+
+malformed:
+    dec->malformed++;
+    dec->synced = 0;
+    return 0;
+}
@@ -0,0 +1,98 @@
+﻿/*
+ * atkpCompact.h
+ *
+ * 压缩遥测编解码
+ * 姿态/传感器数据量化为int16，周期性发送关键帧，其余帧发送zig-zag varint增量
+ *
+ * 本模块只依赖<stdint.h>/<string.h>，编码端运行在atkpTxTask中，
+ * 解码端可直接与上位机程序一起编译使用
+ *
+ * 2026-02-16
+ */
+
+#ifndef __ATKPCOMPACT_H
+#define __ATKPCOMPACT_H
+
+#include <stdint.h>
+#include "atkp.h"
+
+/* 通道定义 */
+#define ATKP_COMPACT_ROLL        0
+#define ATKP_COMPACT_PITCH       1
+#define ATKP_COMPACT_YAW         2
+#define ATKP_COMPACT_GYRO_X      3
+#define ATKP_COMPACT_GYRO_Y      4
+#define ATKP_COMPACT_GYRO_Z      5
+#define ATKP_COMPACT_ACCEL_X     6
+#define ATKP_COMPACT_ACCEL_Y     7
+#define ATKP_COMPACT_ACCEL_Z     8
+#define ATKP_COMPACT_CHANNELS    9
+
+/* 量化系数(物理量 * 系数 = int16) */
+#define ATKP_COMPACT_ANGLE_SCALE 100.0f    // 0.01 deg
+#define ATKP_COMPACT_GYRO_SCALE  10.0f     // 0.1 deg/s
+#define ATKP_COMPACT_ACCEL_SCALE 1000.0f   // 1 mg
+
+/* 编码参数 */
+#define ATKP_COMPACT_KEY_INTERVAL 16       // 每16帧发送一次关键帧
+#define ATKP_COMPACT_HEADER_SIZE  2        // 帧头: [关键帧标志|序号] [样本数]
+#define ATKP_COMPACT_KEY_FLAG     0x80
+#define ATKP_COMPACT_SEQ_MASK     0x7F
+
+/*
+ * 帧格式(UP_COMPACT数据内容)：
+ * data[0]: bit7=关键帧标志，bit0~6=帧序号
+ * data[1]: 本帧样本数
+ * 关键帧：第一个样本为9个int16(小端)原值，后续样本为增量
+ * 增量帧：所有样本均为相对上一样本的增量
+ * 增量按int16回绕计算，经zig-zag后以varint(1~3字节)存放
+ */
+
+/* 遥测样本(物理量) */
+typedef struct {
+    float roll;      // 横滚角 (deg)
+    float pitch;     // 俯仰角 (deg)
+    float yaw;       // 偏航角 (deg)
+    float gyroX;     // 陀螺仪X轴 (deg/s)
+    float gyroY;     // 陀螺仪Y轴 (deg/s)
+    float gyroZ;     // 陀螺仪Z轴 (deg/s)
+    float accelX;    // 加速度X轴 (g)
+    float accelY;    // 加速度Y轴 (g)
+    float accelZ;    // 加速度Z轴 (g)
+} atkpCompactSample_t;
+
+/* 编码器状态 */
+typedef struct {
+    int16_t last[ATKP_COMPACT_CHANNELS];   // 增量基准(上一样本)
+    uint8_t buf[ATKP_MAX_DATA_SIZE];       // 正在组装的帧
+    uint8_t len;                           // 当前帧已用字节数
+    uint8_t seq;                           // 帧序号
+    uint8_t framesSinceKey;                // 距上一关键帧的帧数
+} atkpCompactEncoder_t;
+
+/* 解码器状态 */
+typedef struct {
+    int16_t last[ATKP_COMPACT_CHANNELS];   // 增量基准(上一样本)
+    uint8_t synced;                        // 1-已同步到关键帧
+    uint8_t expectSeq;                     // 期望的下一帧序号
+    uint32_t frames;                       // 成功解码的帧数
+    uint32_t samples;                      // 成功解码的样本数
+    uint32_t dropped;                      // 因丢帧/未同步而丢弃的帧数
+    uint32_t malformed;                    // 格式错误的帧数
+} atkpCompactDecoder_t;
+
+/* 量化 */
+void atkpCompactQuantize(const atkpCompactSample_t *sample, int16_t *q);
+void atkpCompactDequantize(const int16_t *q, atkpCompactSample_t *sample);
+
+/* 编码 */
+void atkpCompactEncoderInit(atkpCompactEncoder_t *enc);
+uint8_t atkpCompactPush(atkpCompactEncoder_t *enc, const int16_t *q, atkp_t *out);
+uint8_t atkpCompactFlush(atkpCompactEncoder_t *enc, atkp_t *out);
+
+/* 解码 */
+void atkpCompactDecoderInit(atkpCompactDecoder_t *dec);
+uint8_t atkpCompactDecode(atkpCompactDecoder_t *dec, const uint8_t *data, uint8_t len,
+                          int16_t (*out)[ATKP_COMPACT_CHANNELS], uint8_t maxSamples);
+
+#endif
@@ -1,4 +1,17 @@
 ﻿#include "atkpRx.h"
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "atkpTx.h"
+#include "controller.h"
+#include "community.h"
+#include "cpuload.h"
+#include "latency.h"
+#include "stabilizer.h"
+#if STABILIZER_BLACKBOX
+#include "blackbox.h"
+#endif
+#include <string.h>
+#include <math.h>
 
 /*
 	*atkpRx函数
@@ -6,9 +19,135 @@
 	*1.接收数据包解析出不同指令，随即更新系统状态
 */
 
+static QueueHandle_t g_rxQueue;
+static StaticQueue_t g_rxQueueStruct;
+static uint8_t g_rxQueueStorage[ATKPRX_QUEUE_SIZE * sizeof(atkp_t)];
+static volatile uint32_t g_rcRejects;   // 被拒绝的DOWN_RCDATA(长度不足或含NaN/Inf)
+
+/*
+	*初始化接收队列，需在启动调度器前调用
+*/
+void atkpRxInit(void){
+	g_rxQueue = xQueueCreateStatic(ATKPRX_QUEUE_SIZE, sizeof(atkp_t), g_rxQueueStorage, &g_rxQueueStruct);
+}
+
+/*
+	*radioLinkTask收到数据包后调用，放入接收队列
+	*返回：1-成功，0-队列已满
+*/
+uint8_t atkpRxPacket(const atkp_t *p){
+	return xQueueSend(g_rxQueue, p, 0) == pdPASS;
+}
+
+/*
+	*被拒绝的遥控数据包数，由radiolinkGetStats与链路的整包错误计数一起上报
+*/
+uint32_t atkpRxGetRcRejects(void){
+	return g_rcRejects;
+}
+
+/*
+	*处理DOWN_COMMAND
+*/
+static void atkpHandleCommand(const atkp_t *p){
+	if(p->dataLen == 0){
+		return;
+	}
+	
+	switch(p->data[0]){
+		case CMD_GET_LINKSTATS:
+			atkpSendLinkStats();
+			break;
+		case CMD_GET_CPULOAD:
+			atkpSendCpuLoad();
+			break;
+		case CMD_RESET_CPULOAD:
+			cpuloadResetPeak();
+			break;
+		case CMD_GET_STACK:
+			atkpSendStack();
+			break;
+#if LATENCY_ENABLE
+		case CMD_GET_LATENCY:
+			atkpSendLatency();
+			break;
+		case CMD_RESET_LATENCY:
+			latencyReset();
+			break;
+#endif
+#if STABILIZER_BLACKBOX
+		case CMD_BLACKBOX_ERASE:
+			blackboxErase();
+			break;
+#endif
+		default:
+			break;
+	}
+}
+
+/*
+	*处理DOWN_RCDATA，更新控制设定值
+	*CRC只保证传输正确，不保证内容有效：任一字段为NaN/Inf时整包丢弃，
+	*NaN能通过controllerUpdate中的限幅比较，经两级PID进入混控与占空比换算
+*/
+static void atkpHandleRcData(const atkp_t *p){
+	setpoint_t sp;
+	
+	if(p->dataLen < ATKP_RCDATA_SIZE){
+		g_rcRejects++;
+		return;
+	}
+	
+	memcpy(&sp.roll, &p->data[0], 4);
+	memcpy(&sp.pitch, &p->data[4], 4);
+	memcpy(&sp.yawRate, &p->data[8], 4);
+	memcpy(&sp.thrust, &p->data[12], 4);
+	if(!isfinite(sp.roll) || !isfinite(sp.pitch) || !isfinite(sp.yawRate) || !isfinite(sp.thrust)){
+		g_rcRejects++;
+		return;
+	}
+	communityPublish(COMMUNITY_TOPIC_SETPOINT, &sp, sizeof(sp));
+}
+
+/*
+	*按消息ID分发一个数据包
+*/
+static void atkpRxDispatch(const atkp_t *p){
+	switch(p->msgID){
+		case DOWN_COMMAND:
+			atkpHandleCommand(p);
+			break;
+		case DOWN_RCDATA:
+			atkpHandleRcData(p);
+			break;
+		default:
+			break;
+	}
+}
+
+/*
+	*处理接收队列中已有的全部数据包，不等待(SIL仿真中代替atkpRxTask)
+	*返回：处理的数据包数
+*/
+uint8_t atkpRxPoll(void){
+	atkp_t p;
+	uint8_t count = 0;
+	
+	while(xQueueReceive(g_rxQueue, &p, 0) == pdTRUE){
+		atkpRxDispatch(&p);
+		count++;
+	}
+	
+	return count;
+}
+
 void atkpRxTask(){
+	atkp_t p;
+	
 	while(1){
-		
+		if(xQueueReceive(g_rxQueue, &p, portMAX_DELAY) == pdTRUE){
+			atkpRxDispatch(&p);
+		}
 	}
 }
 
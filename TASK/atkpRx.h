@@ -1,6 +1,16 @@
 ﻿#ifndef __ATKPRX_H
 #define __ATKPRX_H
 
+#include <stdint.h>
+#include "atkp.h"
+
+#define ATKPRX_QUEUE_SIZE         10      // 接收队列长度
+#define ATKPRX_PERIOD_MS          20      // 遥控数据包最小间隔(50Hz)，用于可调度性分析
+
+void atkpRxInit(void);
+uint8_t atkpRxPacket(const atkp_t *p);
+uint8_t atkpRxPoll(void);
+uint32_t atkpRxGetRcRejects(void);
 void atkpRxTask(void);
 
 #endif
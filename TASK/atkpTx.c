@@ -1,15 +1,272 @@
 ﻿#include "atkpTx.h"
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "atkp.h"
+#include "atkpCompact.h"
+#include "radioLink.h"
+#include "stabilizer.h"
+#include "community.h"
+#include "cpuload.h"
+#include "stackmon.h"
+#include "latency.h"
 
 /*
 	*atkpTx函数
 	*用处：
-	*1.收集飞行器状态
+	*1.从community零拷贝读取飞行器状态
 	*2.发送给遥控器数据包
+	
+	*遥测格式(ATKP_TX_COMPACT选择)：
+	*1.float遥测：每个样本发送UP_STATUS(12字节)与UP_SENSER(24字节)两个数据包
+	*2.压缩遥测：样本量化为int16后增量编码，一个UP_COMPACT数据包约容纳3个样本，
+	*  相同串口带宽下样本率约为float遥测的3~4倍
+	*3.每ATKP_TX_LINKSTATS_MS上传一次链路统计UP_LINKSTATS
+	*4.每CPULOAD_SLOT_MS结束一个CPU占用统计子窗口，每CPULOAD_WINDOW_MS上传UP_CPULOAD(最近CPULOAD_WINDOW_MS的滑动窗口)，
+	*  同时采样任务栈并上传UP_STACK
+	*  LATENCY_ENABLE时同时上传UP_LATENCY
 */
 
+#if ATKP_TX_COMPACT
+
+static atkpCompactEncoder_t g_encoder;
+
+/*
+	*压入一个样本，帧装满时发送
+*/
+static void atkpSendCompact(const float *status, const float *sensor){
+	atkpCompactSample_t sample;
+	int16_t q[ATKP_COMPACT_CHANNELS];
+	atkp_t p;
+	
+	sample.roll = status[0];
+	sample.pitch = status[1];
+	sample.yaw = status[2];
+	sample.accelX = sensor[0];
+	sample.accelY = sensor[1];
+	sample.accelZ = sensor[2];
+	sample.gyroX = sensor[3];
+	sample.gyroY = sensor[4];
+	sample.gyroZ = sensor[5];
+	
+	atkpCompactQuantize(&sample, q);
+	if(atkpCompactPush(&g_encoder, q, &p)){
+		radiolinkSendTelemetry(&p);
+	}
+}
+
+#else
+
+/*
+	*发送由若干float组成的数据包
+*/
+static void atkpSendFloats(uint8_t msgID, const float *values, uint8_t count){
+	atkp_t p;
+	
+	p.msgID = msgID;
+	p.dataLen = count * sizeof(float);
+	memcpy(p.data, values, p.dataLen);
+	radiolinkSendTelemetry(&p);
+}
+
+#endif
+
+/*
+	*零拷贝读取最新姿态与传感器数据
+	*status: roll pitch yaw，sensor: accelX/Y/Z gyroX/Y/Z
+	*读取期间被stabilizerTask覆盖(或尚未发布)时返回0，本周期不发送
+*/
+static uint8_t atkpReadSample(float *status, float *sensor){
+	const attitude_t *att;
+	const MPU9250_Data_t *imu;
+	uint32_t attSeq, imuSeq;
+	
+	att = communityPeek(COMMUNITY_TOPIC_ATTITUDE, &attSeq);
+	imu = communityPeek(COMMUNITY_TOPIC_SENSOR, &imuSeq);
+	if(att == NULL || imu == NULL){
+		return 0;
+	}
+	
+	status[0] = att->roll;
+	status[1] = att->pitch;
+	status[2] = att->yaw;
+	sensor[0] = imu->accelX;
+	sensor[1] = imu->accelY;
+	sensor[2] = imu->accelZ;
+	sensor[3] = imu->gyroX;
+	sensor[4] = imu->gyroY;
+	sensor[5] = imu->gyroZ;
+	
+	return communityPeekValid(COMMUNITY_TOPIC_ATTITUDE, attSeq) && communityPeekValid(COMMUNITY_TOPIC_SENSOR, imuSeq);
+}
+
+/*
+	*上传链路统计，数据内容(小端，共30字节)：
+	*rxPackets(4) rxBytes(4) txPackets(4) txBytes(4)
+	*rxCrcErrors(2) rxOverruns(2) rxResyncs(2) txOverruns(2) (低16位)
+	*rttAvg(2) rttMax(2) (单位0.1ms，超出65535时取65535)
+	*quality(1) rssi(1)
+	*也由atkpRxTask在收到CMD_GET_LINKSTATS时调用
+*/
+void atkpSendLinkStats(void){
+	radiolinkStats_t stats;
+	atkp_t p;
+	uint16_t v16[6];
+	
+	radiolinkGetStats(&stats);
+	
+	v16[0] = (uint16_t)stats.rxCrcErrors;
+	v16[1] = (uint16_t)stats.rxOverruns;
+	v16[2] = (uint16_t)stats.rxResyncs;
+	v16[3] = (uint16_t)stats.txOverruns;
+	v16[4] = (stats.rttAvgUs / 100 > 0xFFFF) ? 0xFFFF : (uint16_t)(stats.rttAvgUs / 100);
+	v16[5] = (stats.rttMaxUs / 100 > 0xFFFF) ? 0xFFFF : (uint16_t)(stats.rttMaxUs / 100);
+	
+	p.msgID = UP_LINKSTATS;
+	p.dataLen = 30;
+	memcpy(&p.data[0], &stats.rxPackets, 4);
+	memcpy(&p.data[4], &stats.rxBytes, 4);
+	memcpy(&p.data[8], &stats.txPackets, 4);
+	memcpy(&p.data[12], &stats.txBytes, 4);
+	memcpy(&p.data[16], v16, sizeof(v16));
+	p.data[28] = stats.quality;
+	p.data[29] = stats.rssi;
+	
+	radiolinkSendPacket(&p);
+}
+
+/*
+	*上传CPU占用，数据内容(小端)：
+	*total(2) totalPeak(2) (单位0.1%)
+	*每个任务3字节：任务编号(1) 占用(1) 峰值(1) (单位0.5%，按任务编号对应任务表的创建顺序)
+	*也由atkpRxTask在收到CMD_GET_CPULOAD时调用
+*/
+void atkpSendCpuLoad(void){
+	cpuloadStats_t stats;
+	atkp_t p;
+	uint8_t i;
+	
+	cpuloadGetStats(&stats);
+	
+	p.msgID = UP_CPULOAD;
+	memcpy(&p.data[0], &stats.total, 2);
+	memcpy(&p.data[2], &stats.totalPeak, 2);
+	for(i = 0; i < stats.taskCount; i++){
+		p.data[4 + i * 3] = stats.tasks[i].number;
+		p.data[5 + i * 3] = (uint8_t)(stats.tasks[i].load / 5);
+		p.data[6 + i * 3] = (uint8_t)(stats.tasks[i].peak / 5);
+	}
+	p.dataLen = 4 + stats.taskCount * 3;
+	
+	radiolinkSendPacket(&p);
+}
+
+/*
+	*上传任务栈监测，数据内容(小端)：
+	*每个任务4字节：历史最小剩余(2) 建议栈深度(2) (单位字，按任务表顺序，其后为空闲与定时器任务)
+	*也由atkpRxTask在收到CMD_GET_STACK时调用
+*/
+void atkpSendStack(void){
+	stackmonTask_t tasks[STACKMON_MAX_TASKS];
+	atkp_t p;
+	uint8_t count, i;
+	
+	count = stackmonGetTasks(tasks);
+	
+	p.msgID = UP_STACK;
+	for(i = 0; i < count; i++){
+		memcpy(&p.data[i * 4], &tasks[i].minFree, 2);
+		memcpy(&p.data[i * 4 + 2], &tasks[i].recommended, 2);
+	}
+	p.dataLen = count * 4;
+	
+	radiolinkSendPacket(&p);
+}
+
+/*
+	*上传中断到任务延迟，每个测量源一个数据包，数据内容(小端)：
+	*测量源(1) 样本数(4) 最小(2) 平均(2) 最大(2) (单位0.1us)
+	*直方图DWT_STATS_BINS字节，每桶LATENCY_BIN_US，各桶占样本数的百分比(非零桶至少为1，最后一桶为超出范围的样本)
+	*也由atkpRxTask在收到CMD_GET_LATENCY时调用
+*/
+void atkpSendLatency(void){
+#if LATENCY_ENABLE
+	DWT_Stats_t stats;
+	atkp_t p;
+	uint32_t cyclesPer100ns = SystemCoreClock / 10000000;
+	uint32_t value[3], percent;
+	uint16_t v;
+	uint8_t src, i;
+	
+	for(src = 0; src < LATENCY_SRC_NUM; src++){
+		latencyGetStats((latencySource_e)src, &stats);
+		
+		p.msgID = UP_LATENCY;
+		p.data[0] = src;
+		memcpy(&p.data[1], &stats.count, 4);
+		value[0] = (stats.count > 0) ? stats.min : 0;
+		value[1] = DWT_StatsMean(&stats);
+		value[2] = stats.max;
+		for(i = 0; i < 3; i++){
+			value[i] /= cyclesPer100ns;
+			v = (value[i] > 0xFFFF) ? 0xFFFF : (uint16_t)value[i];
+			memcpy(&p.data[5 + i * 2], &v, 2);
+		}
+		for(i = 0; i < DWT_STATS_BINS; i++){
+			percent = (stats.count > 0) ? (uint32_t)((uint64_t)stats.bins[i] * 100 / stats.count) : 0;
+			if(percent == 0 && stats.bins[i] > 0){
+				percent = 1;
+			}
+			p.data[11 + i] = (uint8_t)percent;
+		}
+		p.dataLen = 11 + DWT_STATS_BINS;
+		
+		radiolinkSendPacket(&p);
+	}
+#endif
+}
+
 void atkpTxTask(){
+	TickType_t lastWakeTime = xTaskGetTickCount();
+	TickType_t lastStatsTime = lastWakeTime;
+	TickType_t lastLoadTime = lastWakeTime;
+	TickType_t lastLoadSlotTime = lastWakeTime;
+	float status[3];
+	float sensor[6];
+	
+#if ATKP_TX_COMPACT
+	atkpCompactEncoderInit(&g_encoder);
+#endif
+	
 	while(1){
+		vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(ATKP_TX_PERIOD_MS));
+		
+		if(atkpReadSample(status, sensor)){
+#if ATKP_TX_COMPACT
+			atkpSendCompact(status, sensor);
+#else
+			atkpSendFloats(UP_STATUS, status, 3);
+			atkpSendFloats(UP_SENSER, sensor, 6);
+#endif
+		}
 		
+		if(lastWakeTime - lastStatsTime >= pdMS_TO_TICKS(ATKP_TX_LINKSTATS_MS)){
+			lastStatsTime = lastWakeTime;
+			atkpSendLinkStats();
+		}
+		if(lastWakeTime - lastLoadSlotTime >= pdMS_TO_TICKS(CPULOAD_SLOT_MS)){
+			lastLoadSlotTime = lastWakeTime;
+			cpuloadUpdate();
+		}
+		if(lastWakeTime - lastLoadTime >= pdMS_TO_TICKS(CPULOAD_WINDOW_MS)){
+			lastLoadTime = lastWakeTime;
+			atkpSendCpuLoad();
+			stackmonUpdate();
+			atkpSendStack();
+#if LATENCY_ENABLE
+			atkpSendLatency();
+#endif
+		}
 	}
 }
 
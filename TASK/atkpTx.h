@@ -1,7 +1,22 @@
 ﻿#ifndef __ATKPTX_H
 #define __ATKPTX_H
 
+/* 遥测配置 */
+#define ATKP_TX_COMPACT           1       // 1-压缩遥测(UP_COMPACT)，0-float遥测(UP_STATUS+UP_SENSER)
+
+#if ATKP_TX_COMPACT
+#define ATKP_TX_PERIOD_MS         3       // 采样周期，约333Hz
+#else
+#define ATKP_TX_PERIOD_MS         10      // 采样周期，100Hz
+#endif
+
+#define ATKP_TX_LINKSTATS_MS      1000    // UP_LINKSTATS上传周期
+
 void atkpTxTask(void);
+void atkpSendLinkStats(void);
+void atkpSendCpuLoad(void);
+void atkpSendStack(void);
+void atkpSendLatency(void);
 
 #endif
 
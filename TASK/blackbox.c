@@ -0,0 +1,338 @@
+﻿/*
+ * blackbox.c
+ *
+ * 黑匣子实现
+ * 帧缓冲区与编码缓冲区都是单生产者/单消费者无锁环形缓冲区(ringbuf)，控制循环不需要临界区；
+ * 时间戳在任务中由DWT周期累加换算为us(同stabilizer的传感器记录)
+ *
+ * 2026-03-01
+ */
+
+#include <string.h>
+#include "blackbox.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "ringbuf.h"
+#include "ramfunc.h"
+#include "DWT.h"
+
+#if !RINGBUF_IS_POW2(BLACKBOX_FRAME_NUM) || !RINGBUF_IS_POW2(BLACKBOX_FIFO_SIZE)
+#error "BLACKBOX_FRAME_NUM与BLACKBOX_FIFO_SIZE必须为2的幂"
+#endif
+
+#if BLACKBOX_FIFO_SIZE < BLACKBOX_WRITE_CHUNK + BLACKBOX_MAX_FRAME_SIZE + BLACKBOX_END_SIZE
+#error "BLACKBOX_FIFO_SIZE过小"
+#endif
+
+static blackboxFrame_t g_frames[BLACKBOX_FRAME_NUM];
+static ringbuf_t g_frameRing;
+static uint8_t g_fifo[BLACKBOX_FIFO_SIZE];
+static ringbuf_t g_fifoRing;
+
+static const blackboxBackend_t *g_backend;
+static uint16_t g_rateHz;
+static uint8_t g_state;
+static blackboxCodec_t g_encoder;
+static blackboxStats_t g_stats;
+static volatile uint32_t g_dropped;        // 只由控制循环写
+static volatile uint8_t g_closeRequest;
+static volatile uint8_t g_eraseRequest;
+static uint16_t g_idleSteps;               // 连续没有新帧的任务周期数
+static uint32_t g_sessionDropped;          // 本次记录开始时的丢弃帧数
+
+static uint32_t g_timeUs;                  // 本次记录的时间戳 (us)
+static uint32_t g_timeCycles;              // 不足1us的DWT周期余数
+static uint32_t g_lastCycles;              // 上一帧的DWT周期
+
+/**
+ * @brief  黑匣子初始化
+ * @param  backend: 存储端
+ * @param  rateHz: 控制频率 (Hz)
+ * @retval 无
+ */
+void blackboxInit(const blackboxBackend_t *backend, uint16_t rateHz)
+{
+    g_backend = 0;
+    ringbufInit(&g_frameRing, g_frames, sizeof(blackboxFrame_t), BLACKBOX_FRAME_NUM);
+    ringbufInit(&g_fifoRing, g_fifo, 1, BLACKBOX_FIFO_SIZE);
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_rateHz = rateHz;
+    g_state = BLACKBOX_STATE_IDLE;
+    g_dropped = 0;
+    g_closeRequest = 0;
+    g_eraseRequest = 0;
+    g_idleSteps = 0;
+    g_backend = backend;
+}
+
+/**
+ * @brief  取得帧缓冲区中下一帧的位置，由调用者直接填写
+ * @param  无
+ * @retval 帧，0-缓冲区满(已计入丢弃)或未初始化
+ * @note   填写后调用blackboxCommitFrame
+ */
+RAMFUNC blackboxFrame_t *blackboxBeginFrame(void)
+{
+    void *span;
+    
+    if (g_backend == 0)
+    {
+        return 0;
+    }
+    if (ringbufWriteSpan(&g_frameRing, &span) == 0)
+    {
+        g_dropped++;
+        return 0;
+    }
+    
+    return (blackboxFrame_t *)span;
+}
+
+/**
+ * @brief  提交blackboxBeginFrame取得的帧
+ * @param  无
+ * @retval 无
+ */
+RAMFUNC void blackboxCommitFrame(void)
+{
+    ringbufCommit(&g_frameRing, 1);
+}
+
+/**
+ * @brief  请求结束本次记录(如降落后)，在下一个任务周期中写出剩余数据
+ * @param  无
+ * @retval 无
+ */
+void blackboxClose(void)
+{
+    g_closeRequest = 1;
+}
+
+/**
+ * @brief  请求擦除存储，正在记录时在本次记录结束后开始
+ * @param  无
+ * @retval 无
+ */
+void blackboxErase(void)
+{
+    g_eraseRequest = 1;
+}
+
+/**
+ * @brief  获取统计
+ * @param  stats: 输出统计
+ * @retval 无
+ */
+void blackboxGetStats(blackboxStats_t *stats)
+{
+    *stats = g_stats;
+    stats->state = g_state;
+    stats->dropped = g_dropped;
+}
+
+/**
+ * @brief  写入编码缓冲区
+ * @param  data: 数据
+ * @param  len: 字节数(调用前已确认空间足够)
+ * @retval 无
+ */
+static void BlackboxPush(const uint8_t *data, uint32_t len)
+{
+    uint32_t used;
+    
+    ringbufPushBulk(&g_fifoRing, data, len);
+    g_stats.bytes += len;
+    
+    used = BLACKBOX_FIFO_SIZE - ringbufFree(&g_fifoRing);
+    if (used > g_stats.fifoPeak)
+    {
+        g_stats.fifoPeak = used;
+    }
+}
+
+/**
+ * @brief  开始一次记录：打开存储端并写入文件头
+ * @param  frame: 第一帧(时间戳从该帧开始)
+ * @retval 1-成功，0-存储端不可用
+ */
+static uint8_t BlackboxOpen(const blackboxFrame_t *frame)
+{
+    uint8_t header[BLACKBOX_HEADER_SIZE];
+    
+    if (!g_backend->open())
+    {
+        g_state = BLACKBOX_STATE_STOPPED;
+        return 0;
+    }
+    
+    ringbufFlush(&g_fifoRing);
+    blackboxEncoderInit(&g_encoder, g_rateHz);
+    BlackboxPush(header, blackboxEncodeHeader(header, g_rateHz));
+    
+    g_timeUs = 0;
+    g_timeCycles = 0;
+    g_lastCycles = frame->cycles;
+    g_sessionDropped = g_dropped;
+    g_idleSteps = 0;
+    g_stats.sessions++;
+    g_state = BLACKBOX_STATE_LOGGING;
+    
+    return 1;
+}
+
+/**
+ * @brief  量化并编码一帧
+ * @param  frame: 帧
+ * @retval 无
+ */
+static void BlackboxEncode(const blackboxFrame_t *frame)
+{
+    uint8_t buf[BLACKBOX_MAX_FRAME_SIZE];
+    int32_t q[BLACKBOX_FIELD_NUM];
+    uint32_t cyclesPerUs = SystemCoreClock / 1000000;
+    
+    /* 一次记录中相邻帧间隔不超过BLACKBOX_IDLE_CLOSE_MS，不受32位周期计数回绕的影响 */
+    g_timeCycles += frame->cycles - g_lastCycles;
+    g_lastCycles = frame->cycles;
+    g_timeUs += g_timeCycles / cyclesPerUs;
+    g_timeCycles %= cyclesPerUs;
+    
+    blackboxQuantize(frame->values, q);
+    BlackboxPush(buf, blackboxEncodeFrame(&g_encoder, frame->iteration, g_timeUs, q, buf));
+    g_stats.frames++;
+}
+
+/**
+ * @brief  存储端已满或出错：丢弃未写出的数据并停止记录
+ * @param  无
+ * @retval 无
+ */
+static void BlackboxStop(void)
+{
+    ringbufFlush(&g_fifoRing);
+    g_backend->close();
+    g_state = BLACKBOX_STATE_STOPPED;
+}
+
+/**
+ * @brief  把编码缓冲区中的数据交给存储端，记录中凑够BLACKBOX_WRITE_CHUNK字节才写，关闭时全部写出
+ * @param  无
+ * @retval 无
+ */
+static void BlackboxWrite(void)
+{
+    const void *span;
+    uint32_t n;
+    int32_t written;
+    
+    while (g_state == BLACKBOX_STATE_LOGGING || g_state == BLACKBOX_STATE_CLOSING)
+    {
+        if (g_state == BLACKBOX_STATE_LOGGING && ringbufCount(&g_fifoRing) < BLACKBOX_WRITE_CHUNK)
+        {
+            break;
+        }
+        n = ringbufReadSpan(&g_fifoRing, &span);
+        if (n == 0)
+        {
+            break;
+        }
+        
+        written = g_backend->write((const uint8_t *)span, n > BLACKBOX_WRITE_CHUNK ? BLACKBOX_WRITE_CHUNK : n);
+        if (written < 0)
+        {
+            BlackboxStop();
+            break;
+        }
+        if (written == 0)
+        {
+            break;
+        }
+        ringbufConsume(&g_fifoRing, (uint32_t)written);
+        g_stats.written += (uint32_t)written;
+    }
+    
+    if (g_state == BLACKBOX_STATE_CLOSING && ringbufCount(&g_fifoRing) == 0)
+    {
+        g_backend->close();
+        g_state = BLACKBOX_STATE_IDLE;
+    }
+}
+
+/**
+ * @brief  黑匣子任务的一个周期：处理擦除请求 -> 编码新帧 -> 判断是否结束记录 -> 写入存储端
+ * @param  无
+ * @retval 无
+ */
+void blackboxProcess(void)
+{
+    const void *span;
+    uint8_t end[BLACKBOX_END_SIZE];
+    uint8_t received = 0;
+    
+    if (g_backend == 0)
+    {
+        return;
+    }
+    
+    /* 擦除：不在记录中时开始，期间收到的帧丢弃 */
+    if (g_eraseRequest && (g_state == BLACKBOX_STATE_IDLE || g_state == BLACKBOX_STATE_STOPPED))
+    {
+        g_state = BLACKBOX_STATE_ERASING;
+    }
+    if (g_state == BLACKBOX_STATE_ERASING && (g_backend->erase == 0 || g_backend->erase()))
+    {
+        g_eraseRequest = 0;
+        g_state = BLACKBOX_STATE_IDLE;
+    }
+    
+    /* 关闭中的新帧留在帧缓冲区，下一次记录再处理 */
+    while (g_state != BLACKBOX_STATE_CLOSING && ringbufReadSpan(&g_frameRing, &span) > 0)
+    {
+        received = 1;
+        if (g_state == BLACKBOX_STATE_IDLE && g_eraseRequest == 0)
+        {
+            BlackboxOpen((const blackboxFrame_t *)span);
+        }
+        if (g_state != BLACKBOX_STATE_LOGGING)
+        {
+            ringbufConsume(&g_frameRing, 1);
+            g_stats.discarded++;
+            continue;
+        }
+        if (ringbufFree(&g_fifoRing) < BLACKBOX_MAX_FRAME_SIZE + BLACKBOX_END_SIZE)
+        {
+            break;
+        }
+        BlackboxEncode((const blackboxFrame_t *)span);
+        ringbufConsume(&g_frameRing, 1);
+    }
+    
+    if (g_state == BLACKBOX_STATE_LOGGING)
+    {
+        g_idleSteps = received ? 0 : g_idleSteps + 1;
+        if (g_closeRequest || g_eraseRequest || g_idleSteps >= BLACKBOX_IDLE_CLOSE_MS / BLACKBOX_PERIOD_MS)
+        {
+            BlackboxPush(end, blackboxEncodeEnd(end, g_dropped - g_sessionDropped));
+            g_state = BLACKBOX_STATE_CLOSING;
+        }
+    }
+    g_closeRequest = 0;
+    
+    BlackboxWrite();
+}
+
+/**
+ * @brief  黑匣子任务，周期BLACKBOX_PERIOD_MS，优先级低于所有控制与通信任务
+ * @param  无
+ * @retval 无
+ */
+void blackboxTask(void)
+{
+    TickType_t lastWakeTime = xTaskGetTickCount();
+    
+    while (1)
+    {
+        vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(BLACKBOX_PERIOD_MS));
+        blackboxProcess();
+    }
+}
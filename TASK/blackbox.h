@@ -0,0 +1,79 @@
+﻿/*
+ * blackbox.h
+ *
+ * 黑匣子：按控制频率记录陀螺仪、设定值、角速度环PID各项与电机输出
+ *
+ * 1.控制循环(生产者)每次迭代用blackboxBeginFrame/blackboxCommitFrame把浮点原值直接写入帧环形缓冲区，
+ *   不做量化与编码，每次迭代只增加约30个字的拷贝
+ * 2.低优先级的blackboxTask(消费者)每BLACKBOX_PERIOD_MS取出所有帧，量化并预测编码(blackboxCodec)后
+ *   放入编码缓冲区，凑够BLACKBOX_WRITE_CHUNK字节再交给存储端写入
+ * 3.存储端由blackboxInit传入，目标板为SPI NOR Flash(blackboxFlash.h)，SIL中为文件
+ * 4.收到第一帧时开始一次记录(写文件头)，超过BLACKBOX_IDLE_CLOSE_MS没有新帧或调用blackboxClose时
+ *   写结束标记并关闭；帧缓冲区满时控制循环丢弃该帧并计数，迭代序号不连续可在解码时看出
+ *
+ * 2026-03-01
+ */
+
+#ifndef __BLACKBOX_H
+#define __BLACKBOX_H
+
+#include <stdint.h>
+#include "blackboxCodec.h"
+
+#define BLACKBOX_FRAME_NUM       64        // 帧缓冲区帧数(2的幂)，1kHz下可容纳64ms
+#define BLACKBOX_FIFO_SIZE       4096      // 编码缓冲区字节数(2的幂)，约100帧
+#define BLACKBOX_WRITE_CHUNK     256       // 每次交给存储端的字节数(一个Flash页)
+#define BLACKBOX_PERIOD_MS       2         // 任务周期
+#define BLACKBOX_IDLE_CLOSE_MS   500       // 超过该时间没有新帧时结束本次记录
+
+/* 状态 */
+#define BLACKBOX_STATE_IDLE      0         // 未在记录
+#define BLACKBOX_STATE_LOGGING   1         // 记录中
+#define BLACKBOX_STATE_CLOSING   2         // 写出剩余数据后关闭
+#define BLACKBOX_STATE_ERASING   3         // 擦除存储
+#define BLACKBOX_STATE_STOPPED   4         // 存储不可用或已满，擦除后恢复
+
+/* 控制循环写入的一帧(未量化) */
+typedef struct {
+    uint32_t iteration;                    // 控制迭代序号
+    uint32_t cycles;                       // 迭代开始时刻 (DWT周期)
+    float values[BLACKBOX_FIELD_NUM];      // 各字段物理量，下标见blackboxCodec.h
+} blackboxFrame_t;
+
+/* 存储端，各函数在blackboxTask中调用 */
+typedef struct {
+    uint8_t (*open)(void);                                 // 开始一次记录，返回1-成功，0-不可用或已满
+    int32_t (*write)(const uint8_t *data, uint32_t len);   // 写入，返回接受的字节数，0-忙，<0-已满或出错
+    void (*close)(void);                                   // 结束本次记录
+    uint8_t (*erase)(void);                                // 擦除全部记录，重复调用直到返回1，可为0
+} blackboxBackend_t;
+
+/* 统计 */
+typedef struct {
+    uint8_t state;                         // BLACKBOX_STATE_xxx
+    uint32_t sessions;                     // 记录次数
+    uint32_t frames;                       // 编码的帧数
+    uint32_t dropped;                      // 帧缓冲区满、控制循环丢弃的帧数
+    uint32_t discarded;                    // 存储不可用或擦除中丢弃的帧数
+    uint32_t bytes;                        // 编码后的字节数(含文件头与结束标记)
+    uint32_t written;                      // 存储端接受的字节数
+    uint32_t fifoPeak;                     // 编码缓冲区最大占用 (字节)
+} blackboxStats_t;
+
+/* 初始化，需在控制循环开始前调用 */
+void blackboxInit(const blackboxBackend_t *backend, uint16_t rateHz);
+
+/* 生产者：控制循环 */
+blackboxFrame_t *blackboxBeginFrame(void);
+void blackboxCommitFrame(void);
+
+/* 消费者：blackboxTask(SIL中由仿真主循环按BLACKBOX_PERIOD_MS调用blackboxProcess) */
+void blackboxProcess(void);
+void blackboxTask(void);
+
+/* 其他任务 */
+void blackboxClose(void);
+void blackboxErase(void);
+void blackboxGetStats(blackboxStats_t *stats);
+
+#endif
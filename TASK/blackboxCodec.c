@@ -0,0 +1,426 @@
+﻿/*
+ * blackboxCodec.c
+ *
+ * 黑匣子编解码实现
+ * 残差按uint32回绕计算，线性外推溢出时编码端与解码端得到相同的结果，解码逐位还原量化值
+ *
+ * 2026-03-01
+ */
+
+#include <string.h>
+#include "blackboxCodec.h"
+
+#define BLACKBOX_QUANT_MAX       1.0e9f    // 量化值限幅
+#define BLACKBOX_VARINT_MAX      5         // uint32的varint最多5字节
+
+/*
+ * 字段表
+ * 原始陀螺仪噪声大，用前两帧平均预测；滤波后的陀螺仪、角速度设定值、PID各项与电机输出变化平滑，
+ * 用线性外推；遥控设定值50Hz更新、其余时间不变，用上一帧预测(残差为0，每帧1字节)
+ */
+const blackboxField_t blackboxFields[BLACKBOX_FIELD_NUM] = {
+    {"gyro_raw_x",  16.0f,    BLACKBOX_PRED_AVERAGE2},    // 1/16 deg/s
+    {"gyro_raw_y",  16.0f,    BLACKBOX_PRED_AVERAGE2},
+    {"gyro_raw_z",  16.0f,    BLACKBOX_PRED_AVERAGE2},
+    {"gyro_x",      16.0f,    BLACKBOX_PRED_LINEAR},
+    {"gyro_y",      16.0f,    BLACKBOX_PRED_LINEAR},
+    {"gyro_z",      16.0f,    BLACKBOX_PRED_LINEAR},
+    {"sp_roll",     100.0f,   BLACKBOX_PRED_PREVIOUS},    // 0.01 deg
+    {"sp_pitch",    100.0f,   BLACKBOX_PRED_PREVIOUS},
+    {"sp_yaw_rate", 10.0f,    BLACKBOX_PRED_PREVIOUS},    // 0.1 deg/s
+    {"sp_thrust",   1000.0f,  BLACKBOX_PRED_PREVIOUS},    // 0.001
+    {"rate_sp_x",   16.0f,    BLACKBOX_PRED_LINEAR},
+    {"rate_sp_y",   16.0f,    BLACKBOX_PRED_LINEAR},
+    {"rate_sp_z",   16.0f,    BLACKBOX_PRED_LINEAR},
+    {"p_x",         10000.0f, BLACKBOX_PRED_LINEAR},      // 0.0001(输出限幅0.5)
+    {"p_y",         10000.0f, BLACKBOX_PRED_LINEAR},
+    {"p_z",         10000.0f, BLACKBOX_PRED_LINEAR},
+    {"i_x",         10000.0f, BLACKBOX_PRED_LINEAR},
+    {"i_y",         10000.0f, BLACKBOX_PRED_LINEAR},
+    {"i_z",         10000.0f, BLACKBOX_PRED_LINEAR},
+    {"d_x",         10000.0f, BLACKBOX_PRED_LINEAR},
+    {"d_y",         10000.0f, BLACKBOX_PRED_LINEAR},
+    {"d_z",         10000.0f, BLACKBOX_PRED_LINEAR},
+    {"motor_1",     1000.0f,  BLACKBOX_PRED_LINEAR},      // 0.001
+    {"motor_2",     1000.0f,  BLACKBOX_PRED_LINEAR},
+    {"motor_3",     1000.0f,  BLACKBOX_PRED_LINEAR},
+    {"motor_4",     1000.0f,  BLACKBOX_PRED_LINEAR},
+};
+
+/**
+ * @brief  写入一个varint
+ * @param  p: 输出位置
+ * @param  v: 数值
+ * @retval 写入的字节数(1~5)
+ */
+static uint8_t PutVarint(uint8_t *p, uint32_t v)
+{
+    uint8_t n = 0;
+    
+    while (v >= 0x80)
+    {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    
+    return n;
+}
+
+/**
+ * @brief  读取一个varint
+ * @param  p: 输入位置
+ * @param  avail: 剩余可读字节数
+ * @param  v: 输出数值
+ * @retval 读取的字节数，0-数据不完整或超过5字节
+ */
+static uint8_t GetVarint(const uint8_t *p, uint32_t avail, uint32_t *v)
+{
+    uint32_t x = 0;
+    uint8_t n = 0;
+    
+    do
+    {
+        if (n >= avail || n >= BLACKBOX_VARINT_MAX)
+        {
+            return 0;
+        }
+        x |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+    } while (p[n++] & 0x80);
+    
+    *v = x;
+    return n;
+}
+
+/**
+ * @brief  有符号数zig-zag编码(0,-1,1,-2...映射为0,1,2,3...)
+ * @param  v: 有符号数
+ * @retval 无符号数
+ */
+static uint32_t ZigZag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (0U - ((uint32_t)v >> 31));
+}
+
+/**
+ * @brief  zig-zag解码
+ * @param  z: 无符号数
+ * @retval 有符号数
+ */
+static int32_t UnZigZag(uint32_t z)
+{
+    return (int32_t)((z >> 1) ^ (0U - (z & 1U)));
+}
+
+/**
+ * @brief  按字段的预测方式计算预测值
+ * @param  c: 编码器/解码器
+ * @param  field: 字段
+ * @retval 预测值
+ */
+static int32_t Predict(const blackboxCodec_t *c, uint8_t field)
+{
+    int32_t p0 = c->prev[0][field];
+    int32_t p1 = c->prev[1][field];
+    
+    switch (blackboxFields[field].predictor)
+    {
+        case BLACKBOX_PRED_AVERAGE2:
+            return (int32_t)(((int64_t)p0 + p1) / 2);
+        case BLACKBOX_PRED_LINEAR:
+            return (int32_t)((uint32_t)p0 * 2U - (uint32_t)p1);
+        default:
+            return p0;
+    }
+}
+
+/**
+ * @brief  记录一帧的值作为之后的预测历史
+ * @param  c: 编码器/解码器
+ * @param  q: 量化值
+ * @param  key: 1-关键帧(两帧历史都设为本帧，之后的线性外推从0斜率开始)
+ * @retval 无
+ */
+static void PushHistory(blackboxCodec_t *c, const int32_t *q, uint8_t key)
+{
+    memcpy(c->prev[1], key ? q : c->prev[0], sizeof(c->prev[1]));
+    memcpy(c->prev[0], q, sizeof(c->prev[0]));
+}
+
+/**
+ * @brief  浮点字段量化(四舍五入并限幅)
+ * @param  values: BLACKBOX_FIELD_NUM个物理量
+ * @param  q: 输出量化值
+ * @retval 无
+ */
+void blackboxQuantize(const float *values, int32_t *q)
+{
+    float v;
+    uint8_t i;
+    
+    for (i = 0; i < BLACKBOX_FIELD_NUM; i++)
+    {
+        v = values[i] * blackboxFields[i].scale;
+        if (v >= BLACKBOX_QUANT_MAX)
+        {
+            q[i] = (int32_t)BLACKBOX_QUANT_MAX;
+        }
+        else if (v <= -BLACKBOX_QUANT_MAX)
+        {
+            q[i] = -(int32_t)BLACKBOX_QUANT_MAX;
+        }
+        else if (v != v)
+        {
+            q[i] = 0;    // NaN
+        }
+        else
+        {
+            q[i] = (int32_t)(v >= 0.0f ? v + 0.5f : v - 0.5f);
+        }
+    }
+}
+
+/**
+ * @brief  量化值还原为物理量
+ * @param  field: 字段
+ * @param  q: 量化值
+ * @retval 物理量
+ */
+float blackboxDequantize(uint8_t field, int32_t q)
+{
+    return (float)q / blackboxFields[field].scale;
+}
+
+/**
+ * @brief  编码文件头
+ * @param  buf: 输出缓冲区(至少BLACKBOX_HEADER_SIZE字节)
+ * @param  rateHz: 控制频率 (Hz)
+ * @retval 文件头长度
+ */
+uint8_t blackboxEncodeHeader(uint8_t *buf, uint16_t rateHz)
+{
+    memcpy(buf, BLACKBOX_MAGIC, 4);
+    buf[4] = BLACKBOX_VERSION;
+    buf[5] = BLACKBOX_HEADER_SIZE;
+    buf[6] = BLACKBOX_FIELD_NUM;
+    buf[7] = BLACKBOX_KEY_INTERVAL;
+    buf[8] = (uint8_t)rateHz;
+    buf[9] = (uint8_t)(rateHz >> 8);
+    
+    return BLACKBOX_HEADER_SIZE;
+}
+
+/**
+ * @brief  编码器初始化，下一帧为关键帧
+ * @param  enc: 编码器
+ * @param  rateHz: 控制频率 (Hz)
+ * @retval 无
+ */
+void blackboxEncoderInit(blackboxCodec_t *enc, uint16_t rateHz)
+{
+    memset(enc, 0, sizeof(*enc));
+    enc->periodUs = rateHz ? 1000000UL / rateHz : 0;
+}
+
+/**
+ * @brief  编码一帧
+ * @param  enc: 编码器
+ * @param  iteration: 迭代序号(递增，不连续表示中间有帧丢弃)
+ * @param  timeUs: 时间戳 (us)
+ * @param  q: 量化值(BLACKBOX_FIELD_NUM个)
+ * @param  buf: 输出缓冲区(至少BLACKBOX_MAX_FRAME_SIZE字节)
+ * @retval 编码长度
+ */
+uint8_t blackboxEncodeFrame(blackboxCodec_t *enc, uint32_t iteration, uint32_t timeUs, const int32_t *q, uint8_t *buf)
+{
+    uint32_t delta;
+    uint8_t key = enc->sinceKey == 0;
+    uint8_t n = 1;
+    uint8_t i;
+    
+    if (key)
+    {
+        buf[0] = BLACKBOX_FRAME_I;
+        n += PutVarint(&buf[n], iteration);
+        n += PutVarint(&buf[n], timeUs);
+        for (i = 0; i < BLACKBOX_FIELD_NUM; i++)
+        {
+            n += PutVarint(&buf[n], ZigZag(q[i]));
+        }
+    }
+    else
+    {
+        /* 时间戳按迭代数推算，只保存抖动 */
+        delta = iteration - enc->iteration;
+        buf[0] = BLACKBOX_FRAME_P;
+        n += PutVarint(&buf[n], delta - 1);
+        n += PutVarint(&buf[n], ZigZag((int32_t)(timeUs - (enc->timeUs + enc->periodUs * delta))));
+        for (i = 0; i < BLACKBOX_FIELD_NUM; i++)
+        {
+            n += PutVarint(&buf[n], ZigZag((int32_t)((uint32_t)q[i] - (uint32_t)Predict(enc, i))));
+        }
+    }
+    
+    PushHistory(enc, q, key);
+    enc->iteration = iteration;
+    enc->timeUs = timeUs;
+    if (++enc->sinceKey >= BLACKBOX_KEY_INTERVAL)
+    {
+        enc->sinceKey = 0;
+    }
+    
+    return n;
+}
+
+/**
+ * @brief  编码结束标记
+ * @param  buf: 输出缓冲区(至少BLACKBOX_END_SIZE字节)
+ * @param  dropped: 本次记录中丢弃的帧数
+ * @retval 编码长度
+ */
+uint8_t blackboxEncodeEnd(uint8_t *buf, uint32_t dropped)
+{
+    buf[0] = BLACKBOX_FRAME_END;
+    
+    return 1 + PutVarint(&buf[1], dropped);
+}
+
+/**
+ * @brief  解码器初始化
+ * @param  dec: 解码器
+ * @retval 无
+ */
+void blackboxDecoderInit(blackboxCodec_t *dec)
+{
+    memset(dec, 0, sizeof(*dec));
+}
+
+/**
+ * @brief  解码一帧的内容(类型字节之后)
+ * @param  dec: 解码器
+ * @param  p: 输入位置
+ * @param  avail: 剩余可读字节数
+ * @param  key: 1-关键帧
+ * @param  out: 输出
+ * @retval 读取的字节数，0-数据不完整或格式错误
+ */
+static uint32_t DecodeFrame(blackboxCodec_t *dec, const uint8_t *p, uint32_t avail, uint8_t key,
+                            blackboxDecoded_t *out)
+{
+    uint32_t v[2], z, pos = 0;
+    uint8_t n, i;
+    
+    for (i = 0; i < 2; i++)
+    {
+        if ((n = GetVarint(&p[pos], avail - pos, &v[i])) == 0)
+        {
+            return 0;
+        }
+        pos += n;
+    }
+    for (i = 0; i < BLACKBOX_FIELD_NUM; i++)
+    {
+        if ((n = GetVarint(&p[pos], avail - pos, &z)) == 0)
+        {
+            return 0;
+        }
+        pos += n;
+        out->values[i] = key ? UnZigZag(z) : (int32_t)((uint32_t)UnZigZag(z) + (uint32_t)Predict(dec, i));
+    }
+    
+    if (key)
+    {
+        out->iteration = v[0];
+        out->timeUs = v[1];
+    }
+    else
+    {
+        out->iteration = dec->iteration + v[0] + 1;
+        out->timeUs = dec->timeUs + dec->periodUs * (v[0] + 1) + (uint32_t)UnZigZag(v[1]);
+    }
+    out->key = key;
+    
+    PushHistory(dec, out->values, key);
+    dec->iteration = out->iteration;
+    dec->timeUs = out->timeUs;
+    dec->synced = 1;
+    
+    return pos;
+}
+
+/**
+ * @brief  从数据流中解码一项(文件头、帧、结束标记或一段无法解码的字节)
+ * @param  dec: 解码器
+ * @param  buf: 输入数据
+ * @param  len: 输入长度
+ * @param  out: 输出
+ * @retval 消耗的字节数，0-没有数据或末尾的数据不完整
+ * @note   未写入区域(0xFF)、损坏的数据以及关键帧之前的预测帧作为SKIP跳过，
+ *         直到下一个文件头(记录之外)或关键帧(记录之中)
+ */
+uint32_t blackboxDecode(blackboxCodec_t *dec, const uint8_t *buf, uint32_t len, blackboxDecoded_t *out)
+{
+    uint32_t n = 0, v;
+    uint16_t rateHz;
+    
+    if (len == 0)
+    {
+        return 0;
+    }
+    
+    if (buf[0] == BLACKBOX_MAGIC[0] && len >= 4 && memcmp(buf, BLACKBOX_MAGIC, 4) == 0)
+    {
+        if (len < BLACKBOX_HEADER_SIZE || len < buf[5])
+        {
+            return 0;
+        }
+        rateHz = (uint16_t)(buf[8] | (buf[9] << 8));
+        if (buf[4] == BLACKBOX_VERSION && buf[5] >= BLACKBOX_HEADER_SIZE && buf[6] == BLACKBOX_FIELD_NUM && rateHz > 0)
+        {
+            blackboxEncoderInit(dec, rateHz);
+            out->type = BLACKBOX_DECODED_HEADER;
+            out->rateHz = rateHz;
+            return buf[5];
+        }
+    }
+    else if (dec->periodUs != 0 && (buf[0] == BLACKBOX_FRAME_I || (buf[0] == BLACKBOX_FRAME_P && dec->synced)))
+    {
+        n = DecodeFrame(dec, &buf[1], len - 1, buf[0] == BLACKBOX_FRAME_I, out);
+        if (n > 0)
+        {
+            out->type = BLACKBOX_DECODED_FRAME;
+            return 1 + n;
+        }
+        if (len < BLACKBOX_MAX_FRAME_SIZE)
+        {
+            return 0;
+        }
+    }
+    else if (dec->periodUs != 0 && buf[0] == BLACKBOX_FRAME_END)
+    {
+        n = GetVarint(&buf[1], len - 1, &v);
+        if (n > 0)
+        {
+            blackboxDecoderInit(dec);
+            out->type = BLACKBOX_DECODED_END;
+            out->dropped = v;
+            return 1 + n;
+        }
+        if (len < BLACKBOX_END_SIZE)
+        {
+            return 0;
+        }
+    }
+    
+    /* 无法解码：失去同步，跳到下一个文件头或关键帧 */
+    dec->synced = 0;
+    for (n = 1; n < len; n++)
+    {
+        if (buf[n] == BLACKBOX_MAGIC[0] || (dec->periodUs != 0 && buf[n] == BLACKBOX_FRAME_I))
+        {
+            break;
+        }
+    }
+    out->type = BLACKBOX_DECODED_SKIP;
+    return n;
+}
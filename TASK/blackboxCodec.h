@@ -0,0 +1,115 @@
+﻿/*
+ * blackboxCodec.h
+ *
+ * 黑匣子编解码
+ * 每次控制迭代记录一帧(陀螺仪原始/滤波值、设定值、角速度环PID各项、电机输出)，
+ * 各字段按固定系数量化为整数后用预测编码：只保存与预测值之差(残差)，经zig-zag后以varint存放，
+ * 大部分残差只需1字节
+ *
+ * 本模块只依赖<stdint.h>/<string.h>，编码端运行在黑匣子任务中，
+ * 解码端可直接与上位机程序一起编译使用(见SIL/sil_bbdecode.c)
+ *
+ * 2026-03-01
+ */
+
+#ifndef __BLACKBOXCODEC_H
+#define __BLACKBOXCODEC_H
+
+#include <stdint.h>
+
+/*
+ * 数据流格式：
+ * 文件头(BLACKBOX_HEADER_SIZE字节)：
+ *   [0] "FCBB"  [4] 版本  [5] 文件头长度  [6] 字段数  [7] 关键帧间隔  [8] 控制频率 (Hz，uint16小端)
+ * 帧：类型(1字节) + 内容，整数均为varint(每字节低7位，bit7为后续标志，低位在前)，
+ * 有符号数先做zig-zag
+ *   'I' 关键帧：迭代序号、时间戳(us)、各字段量化值(zig-zag)
+ *   'P' 预测帧：迭代序号增量-1、时间戳与按迭代数推算值之差(zig-zag)、各字段残差(zig-zag)
+ *   'E' 结束：本次记录中因缓冲区满丢弃的帧数
+ * 关键帧清空预测历史，之后每BLACKBOX_KEY_INTERVAL帧重复一次，数据损坏时从下一个关键帧恢复
+ * 迭代序号不连续表示中间的帧被丢弃，预测历史只包含记录下来的帧，解码端同样处理
+ *
+ * varint的最后一个字节小于0x80，有效数据中不会出现连续5个以上的0xFF，
+ * 存储端可以用全0xFF表示未写入(NOR Flash擦除后的状态)，解码时跳过
+ */
+
+#define BLACKBOX_MAGIC           "FCBB"
+#define BLACKBOX_VERSION         1
+#define BLACKBOX_HEADER_SIZE     10
+
+#define BLACKBOX_FRAME_I         'I'
+#define BLACKBOX_FRAME_P         'P'
+#define BLACKBOX_FRAME_END       'E'
+
+#define BLACKBOX_KEY_INTERVAL    32        // 关键帧间隔(帧)
+
+/* 字段 */
+#define BLACKBOX_GYRO_RAW        0         // 原始角速度X/Y/Z (deg/s)
+#define BLACKBOX_GYRO_FILT       3         // 滤波后角速度X/Y/Z (deg/s)
+#define BLACKBOX_SETPOINT        6         // 设定值roll/pitch (deg)、yawRate (deg/s)、thrust (0~1)
+#define BLACKBOX_RATE_SP         10        // 角速度环设定值X/Y/Z (deg/s)
+#define BLACKBOX_P_TERM          13        // 角速度环P项X/Y/Z(归一化力矩)
+#define BLACKBOX_I_TERM          16        // 角速度环I项X/Y/Z
+#define BLACKBOX_D_TERM          19        // 角速度环D项X/Y/Z
+#define BLACKBOX_MOTOR           22        // 电机输出1~4 (0~1)
+#define BLACKBOX_FIELD_NUM       26
+
+/* 单帧编码后的最大长度：类型 + 2个时间字段 + 各字段(varint最多5字节) */
+#define BLACKBOX_MAX_FRAME_SIZE  (1 + 2 * 5 + BLACKBOX_FIELD_NUM * 5)
+#define BLACKBOX_END_SIZE        6
+
+/* 预测方式 */
+#define BLACKBOX_PRED_PREVIOUS   0         // 上一帧的值，适合阶跃变化的量(设定值)
+#define BLACKBOX_PRED_AVERAGE2   1         // 前两帧的平均，适合噪声大的量(原始陀螺仪)
+#define BLACKBOX_PRED_LINEAR     2         // 前两帧线性外推，适合平滑变化的量(滤波后的量)
+
+/* 字段描述 */
+typedef struct {
+    const char *name;                // 字段名(解码输出的列名)
+    float scale;                     // 量化系数(物理量 * 系数 = 整数)
+    uint8_t predictor;               // BLACKBOX_PRED_xxx
+} blackboxField_t;
+
+extern const blackboxField_t blackboxFields[BLACKBOX_FIELD_NUM];
+
+/* 编码器/解码器状态(两端对称) */
+typedef struct {
+    int32_t prev[2][BLACKBOX_FIELD_NUM];   // 预测历史：prev[0]为上一帧，prev[1]为上上帧
+    uint32_t iteration;                    // 上一帧的迭代序号
+    uint32_t timeUs;                       // 上一帧的时间戳 (us)
+    uint32_t periodUs;                     // 控制周期 (us)
+    uint8_t sinceKey;                      // 距上一关键帧的帧数
+    uint8_t synced;                        // 已有关键帧(解码端)
+} blackboxCodec_t;
+
+/* 解码结果 */
+#define BLACKBOX_DECODED_HEADER  1         // 文件头(新的一次记录开始)
+#define BLACKBOX_DECODED_FRAME   2         // 一帧数据
+#define BLACKBOX_DECODED_END     3         // 记录结束
+#define BLACKBOX_DECODED_SKIP    4         // 跳过的字节(未写入区域、损坏或未同步的数据)
+
+typedef struct {
+    uint8_t type;                          // BLACKBOX_DECODED_xxx
+    uint16_t rateHz;                       // HEADER：控制频率 (Hz)
+    uint32_t iteration;                    // FRAME：迭代序号
+    uint32_t timeUs;                       // FRAME：时间戳 (us)
+    uint8_t key;                           // FRAME：1-关键帧
+    int32_t values[BLACKBOX_FIELD_NUM];    // FRAME：量化值
+    uint32_t dropped;                      // END：丢弃的帧数
+} blackboxDecoded_t;
+
+/* 量化 */
+void blackboxQuantize(const float *values, int32_t *q);
+float blackboxDequantize(uint8_t field, int32_t q);
+
+/* 编码 */
+uint8_t blackboxEncodeHeader(uint8_t *buf, uint16_t rateHz);
+void blackboxEncoderInit(blackboxCodec_t *enc, uint16_t rateHz);
+uint8_t blackboxEncodeFrame(blackboxCodec_t *enc, uint32_t iteration, uint32_t timeUs, const int32_t *q, uint8_t *buf);
+uint8_t blackboxEncodeEnd(uint8_t *buf, uint32_t dropped);
+
+/* 解码 */
+void blackboxDecoderInit(blackboxCodec_t *dec);
+uint32_t blackboxDecode(blackboxCodec_t *dec, const uint8_t *buf, uint32_t len, blackboxDecoded_t *out);
+
+#endif
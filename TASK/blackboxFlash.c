@@ -0,0 +1,176 @@
+﻿/*
+ * blackboxFlash.c
+ *
+ * 黑匣子存储端：W25Q SPI NOR Flash实现
+ * 已写入的页从地址0开始连续排列，每次记录从新的一页开始，且有效数据中不会出现整页0xFF
+ * (见blackboxCodec.h)，因此第一个空页可以用二分查找确定，16MB芯片只需检查16页(每页读8字节，约60us)
+ * 每次写入最多编程到页尾，发出页编程命令后立即返回，芯片忙时返回0由黑匣子任务下个周期重试
+ *
+ * 2026-03-01
+ */
+
+#include "blackboxFlash.h"
+#include "W25Q.h"
+
+#define BLACKBOX_FLASH_PROBE_SIZE  8       // 判断空页时读取的字节数
+
+static uint32_t g_addr;                    // 下一个写入地址
+static uint8_t g_erasing;                  // 已发出整片擦除命令
+
+/**
+ * @brief  检查一页是否为空
+ * @param  page: 页号
+ * @retval 1-空，0-已写入或读取失败
+ * @note   有效数据中任意连续5个字节至少有一个小于0x80，写入过的页开头就是数据，
+ *         只需检查页首BLACKBOX_FLASH_PROBE_SIZE字节
+ */
+static uint8_t PageErased(uint32_t page)
+{
+    uint8_t buf[BLACKBOX_FLASH_PROBE_SIZE];
+    uint8_t i;
+    
+    if (!W25Q_Read(page * W25Q_PAGE_SIZE, buf, BLACKBOX_FLASH_PROBE_SIZE))
+    {
+        return 0;
+    }
+    for (i = 0; i < BLACKBOX_FLASH_PROBE_SIZE; i++)
+    {
+        if (buf[i] != 0xFF)
+        {
+            return 0;
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief  二分查找第一个空页
+ * @param  无
+ * @retval 第一个空页的地址，没有空页时为容量
+ */
+static uint32_t FindFree(void)
+{
+    uint32_t lo = 0, hi = W25Q_GetCapacity() / W25Q_PAGE_SIZE, mid;
+    
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (PageErased(mid))
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+    
+    return lo * W25Q_PAGE_SIZE;
+}
+
+/**
+ * @brief  开始一次记录：检测芯片并定位第一个空页
+ * @param  无
+ * @retval 1-成功，0-没有芯片、芯片忙或已写满
+ */
+static uint8_t FlashOpen(void)
+{
+    if (W25Q_GetCapacity() == 0 && !W25Q_Init())
+    {
+        return 0;
+    }
+    if (W25Q_IsBusy())
+    {
+        return 0;
+    }
+    
+    g_addr = FindFree();
+    return g_addr < W25Q_GetCapacity();
+}
+
+/**
+ * @brief  写入数据，最多写到当前页尾
+ * @param  data: 数据
+ * @param  len: 字节数
+ * @retval 接受的字节数，0-芯片忙，-1-已写满或SPI出错
+ */
+static int32_t FlashWrite(const uint8_t *data, uint32_t len)
+{
+    uint32_t n = W25Q_PAGE_SIZE - g_addr % W25Q_PAGE_SIZE;
+    
+    if (g_addr >= W25Q_GetCapacity())
+    {
+        return -1;
+    }
+    if (W25Q_IsBusy())
+    {
+        return 0;
+    }
+    
+    n = len < n ? len : n;
+    if (!W25Q_PageProgram(g_addr, data, (uint16_t)n))
+    {
+        return -1;
+    }
+    g_addr += n;
+    
+    return (int32_t)n;
+}
+
+/**
+ * @brief  结束本次记录(数据已全部发出编程命令，不需要额外操作)
+ * @param  无
+ * @retval 无
+ */
+static void FlashClose(void)
+{
+}
+
+/**
+ * @brief  整片擦除，第一次调用发出命令，之后查询是否完成
+ * @param  无
+ * @retval 1-完成(或没有芯片)，0-擦除中
+ */
+static uint8_t FlashErase(void)
+{
+    if (!g_erasing)
+    {
+        if (W25Q_GetCapacity() == 0 && !W25Q_Init())
+        {
+            return 1;
+        }
+        g_erasing = W25Q_EraseChip();
+        return 0;
+    }
+    if (W25Q_IsBusy())
+    {
+        return 0;
+    }
+    
+    g_erasing = 0;
+    g_addr = 0;
+    return 1;
+}
+
+const blackboxBackend_t blackboxFlashBackend = {
+    FlashOpen,
+    FlashWrite,
+    FlashClose,
+    FlashErase,
+};
+
+/**
+ * @brief  已使用的字节数(到最后一个写入页的页尾)，用于读出记录
+ * @param  无
+ * @retval 字节数，没有芯片或芯片忙时为0
+ */
+uint32_t blackboxFlashGetUsed(void)
+{
+    if ((W25Q_GetCapacity() == 0 && !W25Q_Init()) || W25Q_IsBusy())
+    {
+        return 0;
+    }
+    
+    return FindFree();
+}
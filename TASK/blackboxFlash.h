@@ -0,0 +1,21 @@
+﻿/*
+ * blackboxFlash.h
+ *
+ * 黑匣子存储端：W25Q SPI NOR Flash
+ * 只写入已擦除的区域：每次记录从第一个空页(全0xFF)开始顺序写入，写满后停止，
+ * 擦除(整片)由地面站命令触发(CMD_BLACKBOX_ERASE)，不在飞行中擦除
+ *
+ * 2026-03-01
+ */
+
+#ifndef __BLACKBOXFLASH_H
+#define __BLACKBOXFLASH_H
+
+#include <stdint.h>
+#include "blackbox.h"
+
+extern const blackboxBackend_t blackboxFlashBackend;
+
+uint32_t blackboxFlashGetUsed(void);
+
+#endif
@@ -0,0 +1,179 @@
+﻿#include "cpuload.h"
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "DWT.h"
+
+static cpuloadStats_t g_stats;
+static TaskStatus_t g_status[CPULOAD_MAX_TASKS];
+static uint32_t g_lastRunTime[CPULOAD_MAX_TASKS];   // 上一次更新时各任务的运行时间，按g_stats.tasks的顺序
+static uint32_t g_lastTotalRunTime;
+static uint32_t g_lastIdleCycles;
+static uint32_t g_lastWindowStart;
+
+/* 滑动窗口：最近CPULOAD_SLOTS个子窗口的增量(周期)，g_slot为下一个写入的位置 */
+static uint32_t g_slotRun[CPULOAD_MAX_TASKS][CPULOAD_SLOTS];   // 各任务运行时间，按g_stats.tasks的顺序
+static uint32_t g_slotNextRun[CPULOAD_MAX_TASKS][CPULOAD_SLOTS];
+static uint32_t g_slotTotalRun[CPULOAD_SLOTS];                 // 运行时统计的总时间
+static uint32_t g_slotBusy[CPULOAD_SLOTS];                     // 非空闲时间
+static uint32_t g_slotCycles[CPULOAD_SLOTS];                   // 子窗口长度
+static uint8_t g_slot;
+
+/* 空闲钩子 */
+static volatile uint32_t g_idleCycles;                // 累计空闲时间 (周期)
+static uint32_t g_idleLast;                           // 上一次空闲钩子调用的时刻
+static volatile uint8_t g_resetPeak;
+
+/*
+	*空闲钩子，空闲任务每次循环调用一次
+*/
+void vApplicationIdleHook(void){
+	uint32_t now = DWT_GetCycles();
+	uint32_t gap = now - g_idleLast;
+	
+	if(gap < CPULOAD_IDLE_GAP_US * (SystemCoreClock / 1000000)){
+		g_idleCycles += gap;
+	}
+	g_idleLast = now;
+}
+
+/*
+	*占用(0.1%)
+*/
+static uint16_t cpuloadPermille(uint32_t part, uint32_t whole){
+	if(whole == 0){
+		return 0;
+	}
+	if(part >= whole){
+		return 1000;
+	}
+	return (uint16_t)((uint64_t)part * 1000 / whole);
+}
+
+/*
+	*滑动窗口内的总和
+*/
+static uint32_t cpuloadSum(const uint32_t *slots){
+	uint32_t sum = 0;
+	uint8_t i;
+	
+	for(i = 0; i < CPULOAD_SLOTS; i++){
+		sum += slots[i];
+	}
+	return sum;
+}
+
+/*
+	*查找上一次更新中同一编号的任务
+	*返回：下标，未找到返回CPULOAD_MAX_TASKS
+*/
+static uint8_t cpuloadFind(uint8_t number){
+	uint8_t i;
+	
+	for(i = 0; i < g_stats.taskCount; i++){
+		if(g_stats.tasks[i].number == number){
+			return i;
+		}
+	}
+	return CPULOAD_MAX_TASKS;
+}
+
+/*
+	*结束一个子窗口，每CPULOAD_SLOT_MS调用一次(由atkpTxTask调用)
+	*第一次调用的起点在调度器启动前，只记录起点，不计入滑动窗口
+*/
+void cpuloadUpdate(void){
+	cpuloadStats_t next;
+	uint32_t runTime[CPULOAD_MAX_TASKS];
+	configRUN_TIME_COUNTER_TYPE totalRunTime;
+	uint32_t now, idle, window, idleDelta;
+	UBaseType_t count, i;
+	uint8_t prev, slot = g_slot, first = (g_stats.windows == 0);
+	
+	count = uxTaskGetSystemState(g_status, CPULOAD_MAX_TASKS, &totalRunTime);
+	now = DWT_GetCycles();
+	idle = g_idleCycles;
+	
+	if(g_resetPeak){
+		g_resetPeak = 0;
+		g_stats.totalPeak = 0;
+		for(i = 0; i < g_stats.taskCount; i++){
+			g_stats.tasks[i].peak = 0;
+		}
+	}
+	
+	next.windows = g_stats.windows + 1;
+	next.taskCount = (uint8_t)count;
+	
+	/* 总占用：本子窗口的非空闲时间写入滑动窗口，取窗口内之和 */
+	window = now - g_lastWindowStart;
+	idleDelta = idle - g_lastIdleCycles;
+	if(idleDelta > window){
+		idleDelta = window;
+	}
+	g_slotCycles[slot] = first ? 0 : window;
+	g_slotBusy[slot] = first ? 0 : window - idleDelta;
+	next.total = cpuloadPermille(cpuloadSum(g_slotBusy), cpuloadSum(g_slotCycles));
+	next.totalPeak = g_stats.totalPeak;
+	
+	/* 各任务占用，分母取运行时统计的总时间增量；任务按编号对应上一次更新的滑动窗口 */
+	g_slotTotalRun[slot] = first ? 0 : (uint32_t)totalRunTime - g_lastTotalRunTime;
+	for(i = 0; i < count; i++){
+		next.tasks[i].number = (uint8_t)g_status[i].xTaskNumber;
+		next.tasks[i].name = g_status[i].pcTaskName;
+		next.tasks[i].peak = 0;
+		runTime[i] = (uint32_t)g_status[i].ulRunTimeCounter;
+		
+		prev = cpuloadFind(next.tasks[i].number);
+		if(prev < CPULOAD_MAX_TASKS){
+			memcpy(g_slotNextRun[i], g_slotRun[prev], sizeof(g_slotNextRun[i]));
+			g_slotNextRun[i][slot] = first ? 0 : runTime[i] - g_lastRunTime[prev];
+			next.tasks[i].peak = g_stats.tasks[prev].peak;
+		}
+		else{
+			memset(g_slotNextRun[i], 0, sizeof(g_slotNextRun[i]));
+		}
+		next.tasks[i].load = cpuloadPermille(cpuloadSum(g_slotNextRun[i]), cpuloadSum(g_slotTotalRun));
+	}
+	memcpy(g_slotRun, g_slotNextRun, sizeof(g_slotRun));
+	g_slot = (uint8_t)((slot + 1) % CPULOAD_SLOTS);
+	
+	/* 第一次调用只记录起点，不计入峰值 */
+	if(!first){
+		if(next.total > next.totalPeak){
+			next.totalPeak = next.total;
+		}
+		for(i = 0; i < count; i++){
+			if(next.tasks[i].load > next.tasks[i].peak){
+				next.tasks[i].peak = next.tasks[i].load;
+			}
+		}
+	}
+	
+	for(i = 0; i < count; i++){
+		g_lastRunTime[i] = runTime[i];
+	}
+	g_lastTotalRunTime = (uint32_t)totalRunTime;
+	g_lastIdleCycles = idle;
+	g_lastWindowStart = now;
+	
+	taskENTER_CRITICAL();
+	g_stats = next;
+	taskEXIT_CRITICAL();
+}
+
+/*
+	*获取占用统计
+*/
+void cpuloadGetStats(cpuloadStats_t *stats){
+	taskENTER_CRITICAL();
+	*stats = g_stats;
+	taskEXIT_CRITICAL();
+}
+
+/*
+	*请求清零峰值，在下一次更新时生效
+*/
+void cpuloadResetPeak(void){
+	g_resetPeak = 1;
+}
@@ -0,0 +1,42 @@
+﻿#ifndef __CPULOAD_H
+#define __CPULOAD_H
+
+#include <stdint.h>
+
+/*
+	*CPU占用监测
+	*1.各任务占用：FreeRTOS运行时统计以DWT周期计数为时钟，每个子窗口取各任务运行时间的增量
+	*2.总占用：空闲钩子用DWT累计空闲循环的时间，两次调用间隔超过CPULOAD_IDLE_GAP_US视为
+	*  其间运行了任务或中断，不计入空闲，因此中断耗时也计入总占用
+	*3.滑动窗口：每CPULOAD_SLOT_MS更新一次，保存最近CPULOAD_SLOTS个子窗口的增量，
+	*  占用为这些子窗口之和(即最近CPULOAD_WINDOW_MS)的比例，每次更新记录复位以来的峰值
+*/
+
+#define CPULOAD_SLOT_MS           250     // 子窗口(更新周期)
+#define CPULOAD_SLOTS             4       // 滑动窗口包含的子窗口数
+#define CPULOAD_WINDOW_MS         (CPULOAD_SLOT_MS * CPULOAD_SLOTS)   // 统计窗口
+#define CPULOAD_MAX_TASKS         8       // 最多统计的任务数(含空闲与定时器任务)
+#define CPULOAD_IDLE_GAP_US       2       // 空闲循环相邻两次调用的最大间隔
+
+/* 单个任务 */
+typedef struct {
+	uint8_t number;           // 任务编号(按创建顺序)
+	const char *name;         // 任务名
+	uint16_t load;            // 最近窗口占用 (0.1%)
+	uint16_t peak;            // 峰值占用 (0.1%)
+} cpuloadTask_t;
+
+/* 占用统计 */
+typedef struct {
+	uint32_t windows;         // 已统计的子窗口数
+	uint16_t total;           // 最近窗口总占用 (0.1%)
+	uint16_t totalPeak;       // 峰值总占用 (0.1%)
+	uint8_t taskCount;
+	cpuloadTask_t tasks[CPULOAD_MAX_TASKS];
+} cpuloadStats_t;
+
+void cpuloadUpdate(void);
+void cpuloadGetStats(cpuloadStats_t *stats);
+void cpuloadResetPeak(void);
+
+#endif
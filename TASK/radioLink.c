@@ -1,4 +1,14 @@
 ﻿#include "radioLink.h"
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "UART2.h"
+#include "DWT.h"
+#include "atkpRx.h"
+#include "community.h"
+#include "ringbuf.h"
+#include "latency.h"
 
 /*
 	*无线通信驱动，负责与 NRF51822 无线模块的通信
@@ -22,15 +32,311 @@
 	*5. 处理完成后重置状态机
 	
 	*数据发送流程：
-	*1. 数据包被放入发送队列 txQueue
+	*1. 命令应答等数据包被放入发送队列 txQueue，可由多个任务发送
+	*2. atkpTxTask的周期遥测写入单生产者环形缓冲区 telemetryRing，不经过队列
+	*3. 本任务先发送队列中的数据包，再直接在环形缓冲区内编码发送遥测
+	*4. UART2发送缓冲区满时用任务通知阻塞到TXE中断腾出一帧的空间，不忙等，不占用低优先级任务的时间
+	*5. 收发事件都会唤醒本任务，两次运行至少间隔RADIOLINK_MIN_INTERVAL_MS，期间的事件合并处理，
+	*   使可调度性分析中的最小触发间隔有界(TASK/schedConfig.h)；115200波特率下该间隔内最多收到约35字节，远小于接收缓冲区
+	
+	*链路监测：
+	*1. DOWN_PING请求直接在本任务中应答，DOWN_PING应答用于计算往返时间
+	*2. 每RADIOLINK_QUALITY_MS统计一次有效包比例作为链路质量，发布到community供stabilizer做失控保护，
+	*   只统计整包(有效包、CRC/长度错误、缓冲区满丢包、atkpRx接收队列满丢包)，USART硬件溢出丢失的是字节，单独计数
 	
 	*涉及到:
 	*1.NRF51822与STM32F411CEU6的串口通讯
 */
 
+static QueueHandle_t g_txQueue;
+static StaticQueue_t g_txQueueStruct;
+static uint8_t g_txQueueStorage[RADIOLINK_TX_QUEUE_SIZE * sizeof(atkp_t)];
+static atkp_t g_telemetryBuffer[RADIOLINK_TELEMETRY_SIZE];
+static ringbuf_t g_telemetryRing;
+static TaskHandle_t g_taskHandle;
+static radiolinkStats_t g_stats;
+static uint32_t g_rxOversize;       // 超出ATKP_MAX_DATA_SIZE而丢弃的数据包
+static uint32_t g_rxDropped;        // atkpRx接收队列满而丢弃的数据包
+static TickType_t g_lastRxTick;     // 最近一次收到有效数据包的时刻
+static uint8_t g_pingSeq;
+static uint8_t g_notifyTaken;       // 发送等待中取走了任务通知，下一轮不阻塞
+
+/*
+	*发送丢包计数，可能由多个任务同时调用
+*/
+static void radiolinkCountTxOverrun(void){
+	taskENTER_CRITICAL();
+	g_stats.txOverruns++;
+	taskEXIT_CRITICAL();
+}
+
+/*
+	*UART2接收完成或发送缓冲区腾出空间(中断中)，唤醒radioLinkTask
+*/
+static void radiolinkWakeFromISR(void){
+	BaseType_t woken = pdFALSE;
+	
+	if(g_taskHandle != NULL){
+		vTaskNotifyGiveFromISR(g_taskHandle, &woken);
+		portYIELD_FROM_ISR(woken);
+	}
+}
+
+/*
+	*UART2发送缓冲区满时阻塞等待中断腾出空间，代替忙等
+	*通知与接收、遥测共用，取走的通知可能来自它们，主循环下一轮不阻塞以免延误处理
+*/
+static void radiolinkTxWait(void){
+	ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(RADIOLINK_POLL_MS));
+	g_notifyTaken = 1;
+}
+
+/*
+	*初始化串口与发送队列，需在启动调度器前调用
+*/
+void radiolinkInit(void){
+	DWT_Init();
+	UART2_Init();
+	g_txQueue = xQueueCreateStatic(RADIOLINK_TX_QUEUE_SIZE, sizeof(atkp_t), g_txQueueStorage, &g_txQueueStruct);
+	ringbufInit(&g_telemetryRing, g_telemetryBuffer, sizeof(atkp_t), RADIOLINK_TELEMETRY_SIZE);
+	g_stats.rttMinUs = 0xFFFFFFFF;
+}
+
+/*
+	*把数据包放入发送队列，队列满时直接丢弃
+	*返回：1-成功，0-队列已满
+*/
+uint8_t radiolinkSendPacket(const atkp_t *p){
+	if(xQueueSend(g_txQueue, p, 0) != pdPASS){
+		radiolinkCountTxOverrun();
+		return 0;
+	}
+	
+	if(g_taskHandle != NULL){
+		xTaskNotifyGive(g_taskHandle);
+	}
+	return 1;
+}
+
+/*
+	*写入一个遥测数据包，缓冲区满时直接丢弃
+	*只能由atkpTxTask调用(单生产者)
+	*返回：1-成功，0-缓冲区已满
+*/
+uint8_t radiolinkSendTelemetry(const atkp_t *p){
+	if(!ringbufPush(&g_telemetryRing, p)){
+		radiolinkCountTxOverrun();
+		return 0;
+	}
+	
+	if(g_taskHandle != NULL){
+		xTaskNotifyGive(g_taskHandle);
+	}
+	return 1;
+}
+
+/*
+	*获取链路统计
+*/
+void radiolinkGetStats(radiolinkStats_t *stats){
+	UART2_RxStats_t rx;
+	
+	UART2_GetRxStats(&rx);
+	
+	*stats = g_stats;
+	stats->rxPackets = rx.packets - g_rxOversize - g_rxDropped;
+	stats->rxBytes = rx.bytes;
+	stats->rxCrcErrors = rx.crcErrors;
+	stats->rxLengthErrors = rx.lengthErrors + g_rxOversize;
+	stats->rxRcRejects = atkpRxGetRcRejects();
+	stats->rxOverruns = rx.overruns + g_rxDropped;
+	stats->rxHwOverruns = rx.hwOverruns;
+	stats->rxResyncs = rx.resyncs;
+}
+
+/*
+	*发送PING请求，携带当前DWT周期计数
+*/
+static void radiolinkSendPing(void){
+	atkp_t p;
+	uint32_t now = DWT_GetCycles();
+	
+	p.msgID = UP_PING;
+	p.dataLen = 6;
+	p.data[0] = ATKP_PING_REQUEST;
+	p.data[1] = g_pingSeq++;
+	memcpy(&p.data[2], &now, sizeof(now));
+	
+	if(radiolinkSendPacket(&p)){
+		g_stats.pingSent++;
+	}
+}
+
+/*
+	*处理DOWN_PING：请求原样应答，应答计算往返时间
+*/
+static void radiolinkHandlePing(const atkp_t *p){
+	atkp_t reply;
+	uint32_t sent, rtt;
+	
+	if(p->dataLen == 0){
+		return;
+	}
+	
+	if(p->data[0] == ATKP_PING_REQUEST){
+		reply = *p;
+		reply.msgID = UP_PING;
+		reply.data[0] = ATKP_PING_REPLY;
+		
+		/* 插到队首，避免排队时间计入遥控器测得的延迟 */
+		if(xQueueSendToFront(g_txQueue, &reply, 0) != pdPASS){
+			radiolinkCountTxOverrun();
+		}
+	}
+	else if(p->dataLen >= 6){
+		memcpy(&sent, &p->data[2], sizeof(sent));
+		rtt = DWT_CyclesToUs(DWT_GetCycles() - sent);
+		
+		g_stats.pingReplies++;
+		g_stats.rttLastUs = rtt;
+		if(rtt < g_stats.rttMinUs){
+			g_stats.rttMinUs = rtt;
+		}
+		if(rtt > g_stats.rttMaxUs){
+			g_stats.rttMaxUs = rtt;
+		}
+		if(g_stats.pingReplies == 1){
+			g_stats.rttAvgUs = rtt;
+		}
+		else{
+			g_stats.rttAvgUs = g_stats.rttAvgUs - g_stats.rttAvgUs / 8 + rtt / 8;
+		}
+	}
+}
+
+/*
+	*处理一个校验通过的数据包
+*/
+static void radiolinkHandlePacket(const Packet_t *packet){
+	atkp_t p;
+	
+	if(packet->length > ATKP_MAX_DATA_SIZE){
+		g_rxOversize++;
+		return;
+	}
+	
+	p.msgID = packet->type;
+	p.dataLen = packet->length;
+	memcpy(p.data, packet->data, packet->length);
+	g_lastRxTick = xTaskGetTickCount();
+	
+	switch(p.msgID){
+		case DOWN_PING:
+			radiolinkHandlePing(&p);
+			break;
+		case DOWN_RADIO:
+			if(p.dataLen >= 1){
+				g_stats.rssi = p.data[0];
+			}
+			break;
+		default:
+			if(!atkpRxPacket(&p)){
+				g_rxDropped++;
+			}
+			break;
+	}
+}
+
+/*
+	*组帧并通过UART2发送一个数据包
+*/
+static void radiolinkTransmit(const atkp_t *p){
+	Packet_t packet;
+	
+	packet.start = UART2_PACKET_START;
+	packet.type = p->msgID;
+	packet.length = p->dataLen;
+	memcpy(packet.data, p->data, p->dataLen);
+	UART2_SendPacket(&packet);
+	
+	g_stats.txPackets++;
+	g_stats.txBytes += p->dataLen + 5;
+}
+
+/*
+	*统计窗口内的有效包比例，并发布到COMMUNITY_TOPIC_LINK
+	*坏包只计整包错误(含超长包与atkpRx队列满丢弃的包)，硬件溢出(字节)不计入，否则一个损坏的包会被重复计数
+*/
+static void radiolinkUpdateQuality(void){
+	static uint32_t lastGood, lastBad;
+	UART2_RxStats_t rx;
+	radiolinkStatus_t status;
+	uint32_t good, bad;
+	
+	UART2_GetRxStats(&rx);
+	good = rx.packets - g_rxOversize - g_rxDropped - lastGood;
+	bad = rx.crcErrors + rx.lengthErrors + rx.overruns + g_rxOversize + g_rxDropped - lastBad;
+	lastGood = rx.packets - g_rxOversize - g_rxDropped;
+	lastBad = rx.crcErrors + rx.lengthErrors + rx.overruns + g_rxOversize + g_rxDropped;
+	
+	if(xTaskGetTickCount() - g_lastRxTick > pdMS_TO_TICKS(RADIOLINK_TIMEOUT_MS)){
+		g_stats.quality = 0;
+	}
+	else if(good + bad > 0){
+		g_stats.quality = (uint8_t)(good * 100 / (good + bad));
+	}
+	
+	status.quality = g_stats.quality;
+	status.rssi = g_stats.rssi;
+	communityPublish(COMMUNITY_TOPIC_LINK, &status, sizeof(status));
+}
+
 void radioLinkTask(){
+	atkp_t p;
+	Packet_t packet;
+	const void *telemetry;
+	TickType_t lastQualityTick, lastPingTick, lastRunTick;
+	
+	g_taskHandle = xTaskGetCurrentTaskHandle();
+	UART2_SetRxCallback(radiolinkWakeFromISR);
+	UART2_SetTxWait(radiolinkTxWait, radiolinkWakeFromISR);
+	lastQualityTick = lastPingTick = lastRunTick = g_lastRxTick = xTaskGetTickCount();
+	
 	while(1){
+		ulTaskNotifyTake(pdTRUE, g_notifyTaken ? 0 : pdMS_TO_TICKS(RADIOLINK_POLL_MS));
+		g_notifyTaken = 0;
+		LATENCY_TASK_WAKE(LATENCY_SRC_UART2_RX);
+		
+		/* 每个接收帧、遥测与发送请求都会唤醒本任务，限制最小运行间隔使触发频率有界：
+		 * 距上次运行不足RADIOLINK_MIN_INTERVAL_MS时延时到期，期间的事件合并到本次处理 */
+		if(xTaskGetTickCount() - lastRunTick < pdMS_TO_TICKS(RADIOLINK_MIN_INTERVAL_MS)){
+			vTaskDelayUntil(&lastRunTick, pdMS_TO_TICKS(RADIOLINK_MIN_INTERVAL_MS));
+		}
+		lastRunTick = xTaskGetTickCount();
+		
+		/* 接收，UART2接收缓冲区中可能有多个数据包 */
+		while(UART2_ReceivePacket(&packet)){
+			radiolinkHandlePacket(&packet);
+		}
+		
+		/* 发送 */
+		while(xQueueReceive(g_txQueue, &p, 0) == pdTRUE){
+			radiolinkTransmit(&p);
+		}
+		while(ringbufReadSpan(&g_telemetryRing, &telemetry) > 0){
+			radiolinkTransmit((const atkp_t *)telemetry);
+			ringbufConsume(&g_telemetryRing, 1);
+		}
 		
+		/* 链路监测 */
+		if(xTaskGetTickCount() - lastQualityTick >= pdMS_TO_TICKS(RADIOLINK_QUALITY_MS)){
+			lastQualityTick += pdMS_TO_TICKS(RADIOLINK_QUALITY_MS);
+			radiolinkUpdateQuality();
+		}
+		if(xTaskGetTickCount() - lastPingTick >= pdMS_TO_TICKS(RADIOLINK_PING_MS)){
+			lastPingTick += pdMS_TO_TICKS(RADIOLINK_PING_MS);
+			radiolinkSendPing();
+		}
 	}
 }
 
@@ -1,6 +1,54 @@
 ﻿#ifndef __RADIOLINK_H
 #define __RADIOLINK_H
 
+#include <stdint.h>
+#include "atkp.h"
+
+#define RADIOLINK_TX_QUEUE_SIZE   16      // 发送队列长度
+#define RADIOLINK_TELEMETRY_SIZE  8       // 遥测缓冲区长度(数据包个数，2的幂)
+#define RADIOLINK_POLL_MS         10      // 无收发事件时的最长等待时间
+#define RADIOLINK_MIN_INTERVAL_MS 3       // 两次运行的最小间隔，期间的收发事件合并处理(可调度性分析的最小触发间隔)
+#define RADIOLINK_QUALITY_MS      250     // 链路质量统计窗口
+#define RADIOLINK_TIMEOUT_MS      500     // 超过该时间未收到有效数据包视为断链
+#define RADIOLINK_PING_MS         1000    // 飞控发起PING的周期
+
+/* 链路统计 */
+typedef struct {
+	/* 接收方向 */
+	uint32_t rxPackets;       // 有效并已交付的数据包
+	uint32_t rxBytes;         // 字节数
+	uint32_t rxCrcErrors;     // CRC错误
+	uint32_t rxLengthErrors;  // 长度错误(含超出ATKP_MAX_DATA_SIZE的数据包)
+	uint32_t rxRcRejects;     // atkpRx拒绝的遥控数据包(长度不足或含NaN/Inf，已计入rxPackets)
+	uint32_t rxOverruns;      // 接收缓冲区满或atkpRx接收队列满丢包
+	uint32_t rxHwOverruns;    // USART硬件溢出(丢失字节，不计入链路质量)
+	uint32_t rxResyncs;       // 解析器重新同步次数
+	/* 发送方向 */
+	uint32_t txPackets;       // 数据包
+	uint32_t txBytes;         // 字节数
+	uint32_t txOverruns;      // 发送队列满丢包
+	/* 延迟(飞控发起的PING往返时间) */
+	uint32_t pingSent;        // 已发送的PING请求
+	uint32_t pingReplies;     // 收到的PING应答
+	uint32_t rttLastUs;       // 最近一次往返时间 (us)
+	uint32_t rttMinUs;        // 最小往返时间 (us)
+	uint32_t rttMaxUs;        // 最大往返时间 (us)
+	uint32_t rttAvgUs;        // 平均往返时间 (us，1/8滑动平均)
+	/* 链路质量 */
+	uint8_t quality;          // 0~100，统计窗口内有效包比例，断链时为0
+	uint8_t rssi;             // 无线模块上报的RSSI，0表示未知
+} radiolinkStats_t;
+
+/* 链路状态，发布到COMMUNITY_TOPIC_LINK */
+typedef struct {
+	uint8_t quality;          // 0~100，断链时为0
+	uint8_t rssi;             // 0表示未知
+} radiolinkStatus_t;
+
+void radiolinkInit(void);
+uint8_t radiolinkSendPacket(const atkp_t *p);
+uint8_t radiolinkSendTelemetry(const atkp_t *p);
+void radiolinkGetStats(radiolinkStats_t *stats);
 void radioLinkTask(void);
 
 #endif
@@ -0,0 +1,146 @@
+﻿#include "sched.h"
+
+#define SCHED_RESPONSE_FAIL   0xFFFFFFFF
+
+/*
+	*有效截止时间，后台任务返回0
+*/
+static uint32_t schedDeadline(const schedTask_t *task){
+	if(task->periodUs == 0){
+		return 0;
+	}
+	return task->deadlineUs != 0 ? task->deadlineUs : task->periodUs;
+}
+
+/*
+	*按截止时间单调分配优先级
+	*周期任务从maxPriority开始逐级递减，级数不够时其余任务共用minPriority，后台任务为minPriority
+*/
+void schedAssignPriorities(schedTask_t *tasks, uint8_t count, uint8_t maxPriority, uint8_t minPriority){
+	uint32_t last = 0, best, d;
+	uint8_t priority = maxPriority;
+	uint8_t i;
+	
+	for(i = 0; i < count; i++){
+		tasks[i].priority = minPriority;
+	}
+	
+	/* 每轮取出剩余任务中最短的截止时间，同一截止时间的任务共用一级 */
+	while(1){
+		best = 0;
+		for(i = 0; i < count; i++){
+			d = schedDeadline(&tasks[i]);
+			if(d > last && (best == 0 || d < best)){
+				best = d;
+			}
+		}
+		if(best == 0){
+			break;
+		}
+		
+		for(i = 0; i < count; i++){
+			if(schedDeadline(&tasks[i]) == best){
+				tasks[i].priority = priority;
+			}
+		}
+		if(priority > minPriority){
+			priority--;
+		}
+		last = best;
+	}
+}
+
+/*
+	*任务i的干扰任务：优先级不低于任务i的其他周期任务
+*/
+static uint8_t schedInterferes(const schedTask_t *tasks, uint8_t i, uint8_t j){
+	return j != i && tasks[j].periodUs != 0 && tasks[j].priority >= tasks[i].priority;
+}
+
+/*
+	*响应时间分析，结果写入各任务的responseUs
+	*优先级相同的任务按时间片轮转，保守地视为互相抢占
+	*截止时间大于周期时前一次执行可能尚未结束，需检查忙区间内的第q次执行：
+	*w = (q+1)*C + sum(ceil(w/Tj) * Cj)，R = max(w - q*T)，直到w <= (q+1)*T(忙区间结束)；
+	*本级及更高优先级的利用率不小于1时忙区间不结束，直接判为不满足
+	*返回：1-所有周期任务满足截止时间，0-至少一个任务不满足
+*/
+uint8_t schedAnalyze(schedTask_t *tasks, uint8_t count){
+	uint32_t deadline, response, worst, next, busy;
+	uint64_t ppm;
+	uint8_t ok = 1;
+	uint8_t i, j;
+	uint32_t q;
+	
+	for(i = 0; i < count; i++){
+		deadline = schedDeadline(&tasks[i]);
+		if(deadline == 0){
+			tasks[i].responseUs = 0;
+			continue;
+		}
+		
+		/* 利用率按百万分比向上取整，保守 */
+		ppm = ((uint64_t)tasks[i].wcetUs * 1000000 + tasks[i].periodUs - 1) / tasks[i].periodUs;
+		for(j = 0; j < count; j++){
+			if(schedInterferes(tasks, i, j)){
+				ppm += ((uint64_t)tasks[j].wcetUs * 1000000 + tasks[j].periodUs - 1) / tasks[j].periodUs;
+			}
+		}
+		
+		/* 第q次执行的完成时刻不早于第q-1次的完成时刻加C，从该处开始迭代 */
+		worst = 0;
+		busy = 0;
+		for(q = 0; ppm < 1000000; q++){
+			response = busy + tasks[i].wcetUs;
+			while(1){
+				next = (q + 1) * tasks[i].wcetUs;
+				for(j = 0; j < count; j++){
+					if(schedInterferes(tasks, i, j)){
+						next += (response + tasks[j].periodUs - 1) / tasks[j].periodUs * tasks[j].wcetUs;
+					}
+				}
+				if(next == response || next - q * tasks[i].periodUs > deadline){
+					break;
+				}
+				response = next;
+			}
+			
+			busy = next;
+			next -= q * tasks[i].periodUs;
+			if(next > worst){
+				worst = next;
+			}
+			/* 超过截止时间，或第q次执行在下一次释放前完成(忙区间结束) */
+			if(worst > deadline || next <= tasks[i].periodUs){
+				break;
+			}
+		}
+		
+		if(ppm >= 1000000 || worst > deadline){
+			tasks[i].responseUs = SCHED_RESPONSE_FAIL;
+			ok = 0;
+		}
+		else{
+			tasks[i].responseUs = worst;
+		}
+	}
+	
+	return ok;
+}
+
+/*
+	*周期任务的总CPU利用率
+	*返回：千分比
+*/
+uint32_t schedUtilization(const schedTask_t *tasks, uint8_t count){
+	uint32_t permille = 0;
+	uint8_t i;
+	
+	for(i = 0; i < count; i++){
+		if(tasks[i].periodUs != 0){
+			permille += (uint32_t)((uint64_t)tasks[i].wcetUs * 1000 / tasks[i].periodUs);
+		}
+	}
+	
+	return permille;
+}
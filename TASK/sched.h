@@ -0,0 +1,34 @@
+﻿#ifndef __SCHED_H
+#define __SCHED_H
+
+#include <stdint.h>
+
+/*
+	*任务表与可调度性分析
+	*1.优先级按截止时间单调分配(截止时间等于周期时即速率单调)：截止时间越短优先级越高，
+	*  截止时间相同的任务共用一个优先级，不手工指定
+	*2.响应时间分析：R = C + sum(ceil(R/Tj) * Cj)，j为优先级不低于本任务的其他周期任务，
+	*  迭代至收敛，R <= D即满足截止时间；截止时间大于周期时检查忙区间内的每一次执行
+	*不依赖FreeRTOS与硬件，主机上可直接编译，fc_sched(SIL/sil_sched.c)用测得的WCET重新分析
+*/
+
+/* 任务表项 */
+typedef struct {
+	void (*func)(void);      // 任务函数
+	const char *name;        // 任务名
+	uint16_t stackDepth;     // 栈深度 (字)
+	void *stack;             // 栈，StackType_t[stackDepth]
+	void *tcb;               // 任务控制块，StaticTask_t
+	uint32_t periodUs;       // 周期或最小触发间隔 (us)，0表示后台任务
+	uint32_t deadlineUs;     // 相对截止时间 (us)，0表示等于周期
+	uint32_t wcetUs;         // 最坏执行时间 (us)
+	uint8_t priority;        // 由schedAssignPriorities填写
+	uint32_t responseUs;     // 由schedAnalyze填写，最坏响应时间，超过截止时间时为0xFFFFFFFF
+	void *handle;            // 任务句柄，创建任务后填写
+} schedTask_t;
+
+void schedAssignPriorities(schedTask_t *tasks, uint8_t count, uint8_t maxPriority, uint8_t minPriority);
+uint8_t schedAnalyze(schedTask_t *tasks, uint8_t count);
+uint32_t schedUtilization(const schedTask_t *tasks, uint8_t count);
+
+#endif
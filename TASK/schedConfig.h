@@ -0,0 +1,39 @@
+﻿#ifndef __SCHEDCONFIG_H
+#define __SCHEDCONFIG_H
+
+#include "stabilizer.h"
+#include "atkpTx.h"
+#include "radioLink.h"
+#include "atkpRx.h"
+#include "blackbox.h"
+
+/*
+	*任务表的时间参数，USER/main.c创建任务与主机工具fc_sched(SIL/sil_sched.c)共用
+	*1.周期与截止时间(us，截止时间0表示等于周期)由各任务的配置导出
+	*2.最坏执行时间为估计值：在目标板上读出DWT统计的最大值，用fc_sched按实测值重新分析，
+	*  确认可调度后再更新这里
+*/
+#define SCHED_STABILIZER_PERIOD_US    ( 1000000 / STABILIZER_RATE_HZ )
+#define SCHED_STABILIZER_DEADLINE_US  0
+#define SCHED_STABILIZER_WCET_US      400
+
+#define SCHED_ATKPTX_PERIOD_US        ( ATKP_TX_PERIOD_MS * 1000 )
+#define SCHED_ATKPTX_DEADLINE_US      0
+#define SCHED_ATKPTX_WCET_US          150
+
+/* radioLink由接收帧、遥测与发送请求触发，按任务中限制的最小运行间隔分析；
+ * 间隔按1ms节拍计，两次运行的实际间隔可能比节拍数少不到1个节拍 */
+#define SCHED_RADIOLINK_PERIOD_US     ( ( RADIOLINK_MIN_INTERVAL_MS - 1 ) * 1000 )
+#define SCHED_RADIOLINK_DEADLINE_US   0
+#define SCHED_RADIOLINK_WCET_US       300
+
+#define SCHED_ATKPRX_PERIOD_US        ( ATKPRX_PERIOD_MS * 1000 )
+#define SCHED_ATKPRX_DEADLINE_US      0
+#define SCHED_ATKPRX_WCET_US          50
+
+/* 截止时间放宽到帧缓冲区容量的一半，优先级最低；最坏情况为编码积压的帧并写一页Flash */
+#define SCHED_BLACKBOX_PERIOD_US      ( BLACKBOX_PERIOD_MS * 1000 )
+#define SCHED_BLACKBOX_DEADLINE_US    ( BLACKBOX_FRAME_NUM / 2 * 1000000 / STABILIZER_RATE_HZ )
+#define SCHED_BLACKBOX_WCET_US        250
+
+#endif
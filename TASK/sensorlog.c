@@ -0,0 +1,471 @@
+﻿/*
+ * sensorlog.c
+ *
+ * 原始传感器数据记录实现
+ * 记录按固定长度的小端格式手工打包(不依赖结构体布局与编译器对齐)，
+ * 整条记录写入字节环形缓冲区，空间不足时整条丢弃并计数，存储端读到的总是完整记录
+ *
+ * 2026-03-01
+ */
+
+#include <string.h>
+#include "sensorlog.h"
+#include "ringbuf.h"
+
+#if !RINGBUF_IS_POW2(SENSORLOG_BUFFER_SIZE)
+#error "SENSORLOG_BUFFER_SIZE必须为2的幂"
+#endif
+
+static uint8_t g_buffer[SENSORLOG_BUFFER_SIZE];
+static ringbuf_t g_ring;
+static uint8_t g_header[SENSORLOG_HEADER_SIZE];
+static volatile uint8_t g_started;
+static sensorlogStats_t g_stats;
+
+/**
+ * @brief  写入16位小端数
+ * @param  p: 输出位置
+ * @param  v: 数值
+ * @retval 无
+ */
+static void PutU16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+/**
+ * @brief  写入32位小端数
+ * @param  p: 输出位置
+ * @param  v: 数值
+ * @retval 无
+ */
+static void PutU32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * @brief  写入float(按IEEE754位模式)
+ * @param  p: 输出位置
+ * @param  v: 数值
+ * @retval 无
+ */
+static void PutFloat(uint8_t *p, float v)
+{
+    uint32_t u;
+    
+    memcpy(&u, &v, sizeof(u));
+    PutU32(p, u);
+}
+
+/**
+ * @brief  读取16位小端数
+ * @param  p: 输入位置
+ * @retval 数值
+ */
+static uint16_t GetU16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/**
+ * @brief  读取32位小端数
+ * @param  p: 输入位置
+ * @retval 数值
+ */
+static uint32_t GetU32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief  读取float
+ * @param  p: 输入位置
+ * @retval 数值
+ */
+static float GetFloat(const uint8_t *p)
+{
+    uint32_t u = GetU32(p);
+    float v;
+    
+    memcpy(&v, &u, sizeof(v));
+    return v;
+}
+
+/**
+ * @brief  编码文件头
+ * @param  buf: 输出缓冲区(至少SENSORLOG_HEADER_SIZE字节)
+ * @param  header: 文件头内容
+ * @retval 文件头长度
+ */
+uint8_t sensorlogEncodeHeader(uint8_t *buf, const sensorlogHeader_t *header)
+{
+    const BMP280_CalibData_t *c = &header->baroCalib;
+    uint16_t calib[12];
+    uint8_t i;
+    
+    calib[0] = c->dig_T1;
+    calib[1] = (uint16_t)c->dig_T2;
+    calib[2] = (uint16_t)c->dig_T3;
+    calib[3] = c->dig_P1;
+    calib[4] = (uint16_t)c->dig_P2;
+    calib[5] = (uint16_t)c->dig_P3;
+    calib[6] = (uint16_t)c->dig_P4;
+    calib[7] = (uint16_t)c->dig_P5;
+    calib[8] = (uint16_t)c->dig_P6;
+    calib[9] = (uint16_t)c->dig_P7;
+    calib[10] = (uint16_t)c->dig_P8;
+    calib[11] = (uint16_t)c->dig_P9;
+    
+    memcpy(buf, SENSORLOG_MAGIC, 4);
+    buf[4] = SENSORLOG_VERSION;
+    buf[5] = SENSORLOG_HEADER_SIZE;
+    PutU16(&buf[6], header->rateHz);
+    buf[8] = header->estimator;
+    buf[9] = header->magAsa[0];
+    buf[10] = header->magAsa[1];
+    buf[11] = header->magAsa[2];
+    for (i = 0; i < 12; i++)
+    {
+        PutU16(&buf[12 + i * 2], calib[i]);
+    }
+    
+    return SENSORLOG_HEADER_SIZE;
+}
+
+/**
+ * @brief  解码文件头
+ * @param  buf: 输入数据
+ * @param  len: 输入长度
+ * @param  header: 输出文件头内容
+ * @retval 文件头长度，0-数据不足、标识或版本不符
+ */
+uint8_t sensorlogDecodeHeader(const uint8_t *buf, uint32_t len, sensorlogHeader_t *header)
+{
+    BMP280_CalibData_t *c = &header->baroCalib;
+    const uint8_t *p = &buf[12];
+    
+    if (len < SENSORLOG_HEADER_SIZE || memcmp(buf, SENSORLOG_MAGIC, 4) != 0 ||
+        buf[4] != SENSORLOG_VERSION || buf[5] < SENSORLOG_HEADER_SIZE || buf[5] > len)
+    {
+        return 0;
+    }
+    
+    header->rateHz = GetU16(&buf[6]);
+    header->estimator = buf[8];
+    header->magAsa[0] = buf[9];
+    header->magAsa[1] = buf[10];
+    header->magAsa[2] = buf[11];
+    
+    c->dig_T1 = GetU16(&p[0]);
+    c->dig_T2 = (int16_t)GetU16(&p[2]);
+    c->dig_T3 = (int16_t)GetU16(&p[4]);
+    c->dig_P1 = GetU16(&p[6]);
+    c->dig_P2 = (int16_t)GetU16(&p[8]);
+    c->dig_P3 = (int16_t)GetU16(&p[10]);
+    c->dig_P4 = (int16_t)GetU16(&p[12]);
+    c->dig_P5 = (int16_t)GetU16(&p[14]);
+    c->dig_P6 = (int16_t)GetU16(&p[16]);
+    c->dig_P7 = (int16_t)GetU16(&p[18]);
+    c->dig_P8 = (int16_t)GetU16(&p[20]);
+    c->dig_P9 = (int16_t)GetU16(&p[22]);
+    
+    /* 新版本可在文件头末尾追加字段，按记录的长度跳过 */
+    return buf[5];
+}
+
+/**
+ * @brief  记录编码后的长度
+ * @param  type: 记录类型
+ * @retval 长度(含类型与时间戳)，0-未知类型
+ */
+uint8_t sensorlogRecordSize(uint8_t type)
+{
+    switch (type)
+    {
+        case SENSORLOG_REC_IMU:      return SENSORLOG_REC_HEADER_SIZE + 14;
+        case SENSORLOG_REC_BARO:     return SENSORLOG_REC_HEADER_SIZE + 6;
+        case SENSORLOG_REC_MAG:      return SENSORLOG_REC_HEADER_SIZE + 8;
+        case SENSORLOG_REC_SETPOINT: return SENSORLOG_REC_HEADER_SIZE + 17;
+        default:                     return 0;
+    }
+}
+
+/**
+ * @brief  编码一条记录
+ * @param  buf: 输出缓冲区(至少SENSORLOG_REC_MAX_SIZE字节)
+ * @param  rec: 记录
+ * @retval 编码长度，0-未知类型
+ */
+uint8_t sensorlogEncodeRecord(uint8_t *buf, const sensorlogRecord_t *rec)
+{
+    uint8_t *p = &buf[SENSORLOG_REC_HEADER_SIZE];
+    
+    buf[0] = rec->type;
+    PutU32(&buf[1], rec->timeUs);
+    
+    switch (rec->type)
+    {
+        case SENSORLOG_REC_IMU:
+            PutU16(&p[0], (uint16_t)rec->data.imu.accelX);
+            PutU16(&p[2], (uint16_t)rec->data.imu.accelY);
+            PutU16(&p[4], (uint16_t)rec->data.imu.accelZ);
+            PutU16(&p[6], (uint16_t)rec->data.imu.gyroX);
+            PutU16(&p[8], (uint16_t)rec->data.imu.gyroY);
+            PutU16(&p[10], (uint16_t)rec->data.imu.gyroZ);
+            PutU16(&p[12], (uint16_t)rec->data.imu.temp);
+            break;
+        
+        case SENSORLOG_REC_BARO:
+            /* 20位ADC值，各用3字节 */
+            PutU16(&p[0], (uint16_t)rec->data.baro.press);
+            p[2] = (uint8_t)(rec->data.baro.press >> 16);
+            PutU16(&p[3], (uint16_t)rec->data.baro.temp);
+            p[5] = (uint8_t)(rec->data.baro.temp >> 16);
+            break;
+        
+        case SENSORLOG_REC_MAG:
+            p[0] = rec->data.mag.st1;
+            PutU16(&p[1], (uint16_t)rec->data.mag.magX);
+            PutU16(&p[3], (uint16_t)rec->data.mag.magY);
+            PutU16(&p[5], (uint16_t)rec->data.mag.magZ);
+            p[7] = rec->data.mag.st2;
+            break;
+        
+        case SENSORLOG_REC_SETPOINT:
+            PutFloat(&p[0], rec->data.setpoint.sp.roll);
+            PutFloat(&p[4], rec->data.setpoint.sp.pitch);
+            PutFloat(&p[8], rec->data.setpoint.sp.yawRate);
+            PutFloat(&p[12], rec->data.setpoint.sp.thrust);
+            p[16] = rec->data.setpoint.quality;
+            break;
+        
+        default:
+            return 0;
+    }
+    
+    return sensorlogRecordSize(rec->type);
+}
+
+/**
+ * @brief  解码一条记录
+ * @param  buf: 输入数据
+ * @param  len: 输入长度
+ * @param  rec: 输出记录
+ * @retval 消耗的字节数，0-数据不足或未知类型
+ */
+uint8_t sensorlogDecodeRecord(const uint8_t *buf, uint32_t len, sensorlogRecord_t *rec)
+{
+    const uint8_t *p = &buf[SENSORLOG_REC_HEADER_SIZE];
+    uint8_t size;
+    
+    if (len < SENSORLOG_REC_HEADER_SIZE)
+    {
+        return 0;
+    }
+    size = sensorlogRecordSize(buf[0]);
+    if (size == 0 || len < size)
+    {
+        return 0;
+    }
+    
+    rec->type = buf[0];
+    rec->timeUs = GetU32(&buf[1]);
+    
+    switch (rec->type)
+    {
+        case SENSORLOG_REC_IMU:
+            rec->data.imu.accelX = (int16_t)GetU16(&p[0]);
+            rec->data.imu.accelY = (int16_t)GetU16(&p[2]);
+            rec->data.imu.accelZ = (int16_t)GetU16(&p[4]);
+            rec->data.imu.gyroX = (int16_t)GetU16(&p[6]);
+            rec->data.imu.gyroY = (int16_t)GetU16(&p[8]);
+            rec->data.imu.gyroZ = (int16_t)GetU16(&p[10]);
+            rec->data.imu.temp = (int16_t)GetU16(&p[12]);
+            break;
+        
+        case SENSORLOG_REC_BARO:
+            rec->data.baro.press = GetU16(&p[0]) | ((uint32_t)p[2] << 16);
+            rec->data.baro.temp = GetU16(&p[3]) | ((uint32_t)p[5] << 16);
+            break;
+        
+        case SENSORLOG_REC_MAG:
+            rec->data.mag.st1 = p[0];
+            rec->data.mag.magX = (int16_t)GetU16(&p[1]);
+            rec->data.mag.magY = (int16_t)GetU16(&p[3]);
+            rec->data.mag.magZ = (int16_t)GetU16(&p[5]);
+            rec->data.mag.st2 = p[7];
+            break;
+        
+        case SENSORLOG_REC_SETPOINT:
+            rec->data.setpoint.sp.roll = GetFloat(&p[0]);
+            rec->data.setpoint.sp.pitch = GetFloat(&p[4]);
+            rec->data.setpoint.sp.yawRate = GetFloat(&p[8]);
+            rec->data.setpoint.sp.thrust = GetFloat(&p[12]);
+            rec->data.setpoint.quality = p[16];
+            break;
+        
+        default:
+            break;
+    }
+    
+    return size;
+}
+
+/**
+ * @brief  开始记录，清空缓冲区与统计
+ * @param  header: 文件头内容(存储端用sensorlogGetHeader取出后写在数据之前)
+ * @retval 无
+ */
+void sensorlogStart(const sensorlogHeader_t *header)
+{
+    g_started = 0;
+    ringbufInit(&g_ring, g_buffer, 1, SENSORLOG_BUFFER_SIZE);
+    sensorlogEncodeHeader(g_header, header);
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_started = 1;
+}
+
+/**
+ * @brief  停止记录，缓冲区中已有的记录仍可读出
+ * @param  无
+ * @retval 无
+ */
+void sensorlogStop(void)
+{
+    g_started = 0;
+}
+
+/**
+ * @brief  编码记录并整条写入缓冲区
+ * @param  rec: 记录
+ * @retval 无
+ */
+static void sensorlogWrite(const sensorlogRecord_t *rec)
+{
+    uint8_t buf[SENSORLOG_REC_MAX_SIZE];
+    uint8_t size;
+    
+    if (!g_started)
+    {
+        return;
+    }
+    
+    size = sensorlogEncodeRecord(buf, rec);
+    if (ringbufFree(&g_ring) < size)
+    {
+        g_stats.dropped++;
+        return;
+    }
+    
+    ringbufPushBulk(&g_ring, buf, size);
+    g_stats.records++;
+    g_stats.bytes += size;
+}
+
+/**
+ * @brief  记录MPU9250原始数据
+ * @param  timeUs: 时间戳 (us)
+ * @param  raw: 原始数据
+ * @retval 无
+ */
+void sensorlogWriteImu(uint32_t timeUs, const MPU9250_RawData_t *raw)
+{
+    sensorlogRecord_t rec;
+    
+    rec.type = SENSORLOG_REC_IMU;
+    rec.timeUs = timeUs;
+    rec.data.imu = *raw;
+    sensorlogWrite(&rec);
+}
+
+/**
+ * @brief  记录BMP280原始数据
+ * @param  timeUs: 时间戳 (us)
+ * @param  raw: 原始数据
+ * @retval 无
+ */
+void sensorlogWriteBaro(uint32_t timeUs, const BMP280_RawData_t *raw)
+{
+    sensorlogRecord_t rec;
+    
+    rec.type = SENSORLOG_REC_BARO;
+    rec.timeUs = timeUs;
+    rec.data.baro = *raw;
+    sensorlogWrite(&rec);
+}
+
+/**
+ * @brief  记录AK8963原始数据(包括无新数据的读取，回放时按原样重现)
+ * @param  timeUs: 时间戳 (us)
+ * @param  raw: 原始数据
+ * @retval 无
+ */
+void sensorlogWriteMag(uint32_t timeUs, const MPU9250_MagRawData_t *raw)
+{
+    sensorlogRecord_t rec;
+    
+    rec.type = SENSORLOG_REC_MAG;
+    rec.timeUs = timeUs;
+    rec.data.mag = *raw;
+    sensorlogWrite(&rec);
+}
+
+/**
+ * @brief  记录遥控设定值与链路质量
+ * @param  timeUs: 时间戳 (us)
+ * @param  sp: 设定值
+ * @param  quality: 链路质量，0-失控
+ * @retval 无
+ */
+void sensorlogWriteSetpoint(uint32_t timeUs, const setpoint_t *sp, uint8_t quality)
+{
+    sensorlogRecord_t rec;
+    
+    rec.type = SENSORLOG_REC_SETPOINT;
+    rec.timeUs = timeUs;
+    rec.data.setpoint.sp = *sp;
+    rec.data.setpoint.quality = quality;
+    sensorlogWrite(&rec);
+}
+
+/**
+ * @brief  取出本次记录的文件头
+ * @param  buf: 输出缓冲区(至少SENSORLOG_HEADER_SIZE字节)
+ * @retval 文件头长度，0-未开始记录
+ */
+uint8_t sensorlogGetHeader(uint8_t *buf)
+{
+    if (!g_started)
+    {
+        return 0;
+    }
+    
+    memcpy(buf, g_header, SENSORLOG_HEADER_SIZE);
+    return SENSORLOG_HEADER_SIZE;
+}
+
+/**
+ * @brief  从缓冲区读出记录数据(记录按整条写入，读出的字节流可直接追加到文件)
+ * @param  buf: 输出缓冲区
+ * @param  maxLen: 最多读取的字节数
+ * @retval 读出的字节数
+ */
+uint32_t sensorlogRead(uint8_t *buf, uint32_t maxLen)
+{
+    return ringbufPopBulk(&g_ring, buf, maxLen);
+}
+
+/**
+ * @brief  获取记录统计
+ * @param  stats: 输出统计
+ * @retval 无
+ */
+void sensorlogGetStats(sensorlogStats_t *stats)
+{
+    *stats = g_stats;
+}
@@ -0,0 +1,109 @@
+﻿/*
+ * sensorlog.h
+ *
+ * 原始传感器数据记录
+ * 控制循环把每次读到的MPU9250/AK8963/BMP280原始数据与遥控设定值带时间戳写入环形缓冲区，
+ * 由存储端(SIL中为文件)调用sensorlogRead取出；主机上fc_replay按记录重放，
+ * 经过与飞控相同的转换、滤波与姿态解算代码，输出可在不同提交之间逐位比较
+ *
+ * 本模块只依赖驱动/控制器头文件中的数据结构，编解码函数可直接在主机上使用
+ *
+ * 2026-03-01
+ */
+
+#ifndef __SENSORLOG_H
+#define __SENSORLOG_H
+
+#include <stdint.h>
+#include "MPU9250.h"
+#include "BMP280.h"
+#include "controller.h"
+
+/*
+ * 文件格式(所有多字节数值均为小端)：
+ * 文件头(SENSORLOG_HEADER_SIZE字节)：
+ *   [0]  "FCSL"
+ *   [4]  版本(SENSORLOG_VERSION)
+ *   [5]  文件头长度
+ *   [6]  控制频率 (Hz，uint16)
+ *   [8]  姿态估计器(STABILIZER_ESTIMATOR)
+ *   [9]  AK8963 ASAX/ASAY/ASAZ
+ *   [12] BMP280校准数据dig_T1~dig_P9(12 x 16位)
+ * 记录：类型(1字节) + 时间戳(uint32，us，约71分钟回绕) + 内容
+ *   IMU      14字节  MPU9250_RawData_t各字段(int16)，顺序与结构体相同
+ *   BARO     6字节   BMP280_RawData_t的press、temp(各uint24，20位有效)
+ *   MAG      8字节   st1、magX、magY、magZ(int16)、st2
+ *   SETPOINT 17字节  setpoint_t各字段(float)与链路质量(0-失控)
+ * 每次控制迭代先写IMU记录，同一迭代中读到的气压/磁力计数据与变化后的设定值跟在其后
+ */
+
+#define SENSORLOG_MAGIC           "FCSL"
+#define SENSORLOG_VERSION         1
+#define SENSORLOG_HEADER_SIZE     36
+
+/* 记录类型 */
+#define SENSORLOG_REC_IMU         0x01
+#define SENSORLOG_REC_BARO        0x02
+#define SENSORLOG_REC_MAG         0x03
+#define SENSORLOG_REC_SETPOINT    0x04
+
+#define SENSORLOG_REC_HEADER_SIZE 5      // 类型 + 时间戳
+#define SENSORLOG_REC_MAX_SIZE    (SENSORLOG_REC_HEADER_SIZE + 17)
+
+/* 记录缓冲区字节数(2的幂)，1kHz下每秒约19KB，需能容纳存储端两次读取之间的数据 */
+#define SENSORLOG_BUFFER_SIZE     4096
+
+/* 文件头内容 */
+typedef struct {
+    uint16_t rateHz;                 // 控制频率 (Hz)
+    uint8_t estimator;               // 姿态估计器
+    uint8_t magAsa[3];               // AK8963出厂灵敏度调整寄存器值
+    BMP280_CalibData_t baroCalib;    // BMP280校准数据
+} sensorlogHeader_t;
+
+/* 设定值记录 */
+typedef struct {
+    setpoint_t sp;
+    uint8_t quality;                 // 链路质量，0-失控(控制器使用零设定值)
+} sensorlogSetpoint_t;
+
+/* 解码后的记录 */
+typedef struct {
+    uint8_t type;                    // SENSORLOG_REC_xxx
+    uint32_t timeUs;                 // 时间戳 (us)
+    union {
+        MPU9250_RawData_t imu;
+        BMP280_RawData_t baro;
+        MPU9250_MagRawData_t mag;
+        sensorlogSetpoint_t setpoint;
+    } data;
+} sensorlogRecord_t;
+
+/* 记录统计 */
+typedef struct {
+    uint32_t records;                // 写入的记录数
+    uint32_t bytes;                  // 写入的字节数
+    uint32_t dropped;                // 缓冲区满丢弃的记录数
+} sensorlogStats_t;
+
+/* 编解码 */
+uint8_t sensorlogEncodeHeader(uint8_t *buf, const sensorlogHeader_t *header);
+uint8_t sensorlogDecodeHeader(const uint8_t *buf, uint32_t len, sensorlogHeader_t *header);
+uint8_t sensorlogRecordSize(uint8_t type);
+uint8_t sensorlogEncodeRecord(uint8_t *buf, const sensorlogRecord_t *rec);
+uint8_t sensorlogDecodeRecord(const uint8_t *buf, uint32_t len, sensorlogRecord_t *rec);
+
+/* 记录(生产者：控制循环) */
+void sensorlogStart(const sensorlogHeader_t *header);
+void sensorlogStop(void);
+void sensorlogWriteImu(uint32_t timeUs, const MPU9250_RawData_t *raw);
+void sensorlogWriteBaro(uint32_t timeUs, const BMP280_RawData_t *raw);
+void sensorlogWriteMag(uint32_t timeUs, const MPU9250_MagRawData_t *raw);
+void sensorlogWriteSetpoint(uint32_t timeUs, const setpoint_t *sp, uint8_t quality);
+
+/* 读取(消费者：存储端) */
+uint8_t sensorlogGetHeader(uint8_t *buf);
+uint32_t sensorlogRead(uint8_t *buf, uint32_t maxLen);
+void sensorlogGetStats(sensorlogStats_t *stats);
+
+#endif
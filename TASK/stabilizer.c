@@ -1,4 +1,26 @@
 ﻿#include "stabilizer.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "I2C.h"
+#include "sensfusion.h"
+#include "ekf.h"
+#include "filter.h"
+#include "dynnotch.h"
+#include "rpmfilter.h"
+#include "BMP280.h"
+#include "mixer.h"
+#include "PWM.h"
+#include "community.h"
+#include "radioLink.h"
+#include "latency.h"
+#include "ramfunc.h"
+#if STABILIZER_SENSOR_LOG
+#include <string.h>
+#include "sensorlog.h"
+#endif
+#if STABILIZER_BLACKBOX
+#include "blackbox.h"
+#endif
 
 /*
  * stabilizerTask函数，是处理分析任务的核心函数，
@@ -6,11 +28,500 @@
  * 1.使用I2C接收来自MPU9250（地址为0xD2），BMP280（地址为0xEC）的传感器数据
  * 2.使用来自传感器的数据来进行姿态解算
  * 3.接受atkpRx的对系统状态的调整，进行对应的控制
- * 4.返回对应数据包给atkpTxTask
+ * 4.把姿态、传感器数据与控制输出发布到community，供atkpTxTask等读取
+ * 5.把陀螺仪、设定值、角速度环PID各项与电机输出写入黑匣子帧缓冲区，由blackboxTask编码保存
+ *
+ * 循环以STABILIZER_RATE_HZ固定频率运行，由vTaskDelayUntil或MPU9250数据就绪中断驱动，
+ * 每次迭代用DWT周期计数记录各阶段耗时、间隔抖动与超时，供性能分析使用
  */
 
+#if STABILIZER_RATE_HZ < 500 || STABILIZER_RATE_HZ > 1000
+#error "STABILIZER_RATE_HZ应在500~1000Hz之间"
+#endif
+
+/* vTaskDelayUntil按1kHz系统节拍定时，MPU9250采样率为1kHz的整数分频 */
+#if 1000 % STABILIZER_RATE_HZ != 0
+#error "STABILIZER_RATE_HZ需能整除1kHz"
+#endif
+
+#if STABILIZER_BLACKBOX && BLACKBOX_MOTOR + MIXER_MOTOR_NUM != BLACKBOX_FIELD_NUM
+#error "黑匣子电机字段数与MIXER_MOTOR_NUM不一致"
+#endif
+
+#if STABILIZER_ESTIMATOR == STABILIZER_ESTIMATOR_EKF
+#define STABILIZER_ACC_DIV   (STABILIZER_RATE_HZ / STABILIZER_ACC_UPDATE_HZ)
+#define STABILIZER_MAG_DIV   (STABILIZER_RATE_HZ / STABILIZER_MAG_RATE_HZ)
+#define STABILIZER_BARO_DIV  (STABILIZER_RATE_HZ / STABILIZER_BARO_RATE_HZ)
+#endif
+
+static attitude_t g_attitude;        // 最新姿态
+static MPU9250_Data_t g_sensorData;  // 最新传感器数据
+static float g_gyroFilt[3];          // 滤波后的角速度 (deg/s)，供控制器使用
+static filterBank_t g_gyroFilter;
+static setpoint_t g_setpoint;         // 本次迭代使用的设定值(失控保护时为零)
+static control_t g_control;           // 控制输出
+static uint8_t g_armed;               // 解锁状态(油门大于0)
+static float g_motor[MIXER_MOTOR_NUM];  // 混控后各电机输出 (0~1)
+
+static stabilizerTiming_t g_timing;     // 循环时序统计
+static volatile uint8_t g_timingReset;  // 其他任务请求清零统计
+static uint32_t g_lastStart;            // 上一次迭代开始时刻 (DWT周期)
+static uint32_t g_tick;                 // 迭代序号，用于降频读取辅助传感器
+static TaskHandle_t g_taskHandle;
+
+#if STABILIZER_BLACKBOX
+static uint32_t g_blackboxTail;         // 上锁后剩余的记录迭代数
+#endif
+
+#if STABILIZER_SENSOR_LOG
+static uint32_t g_logUs;                // 记录时间戳 (us)
+static uint32_t g_logCycles;            // 不足1us的DWT周期余数
+static uint32_t g_logLast;              // 上一次取时间戳的DWT周期
+static sensorlogSetpoint_t g_logSetpoint;  // 上一次记录的设定值
+#endif
+
+#if STABILIZER_SYNC == STABILIZER_SYNC_IMU_DRDY
+/*
+ * MPU9250数据就绪回调(中断中)，唤醒stabilizerTask
+ */
+static void stabilizerDataReady(void){
+    BaseType_t woken = pdFALSE;
+    
+    if(g_taskHandle != NULL){
+        vTaskNotifyGiveFromISR(g_taskHandle, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+#endif
+
+/*
+ * 清零时序统计
+ */
+static void stabilizerClearTiming(void){
+    uint32_t periodCycles = SystemCoreClock / STABILIZER_RATE_HZ;
+    uint8_t i;
+    
+    g_timing.iterations = 0;
+    g_timing.overruns = 0;
+    g_timing.missedSamples = 0;
+    DWT_StatsInit(&g_timing.jitter, SystemCoreClock / 1000000);
+    DWT_StatsInit(&g_timing.dynNotch, SystemCoreClock / 1000000);
+    DWT_StatsInit(&g_timing.rpmFilter, SystemCoreClock / 1000000);
+    DWT_StatsInit(&g_timing.blackbox, SystemCoreClock / 1000000);
+    DWT_StatsInit(&g_timing.total, periodCycles / DWT_STATS_BINS);
+    for(i = 0; i < STABILIZER_STAGE_NUM; i++){
+        DWT_StatsInit(&g_timing.stage[i], periodCycles / DWT_STATS_BINS);
+    }
+}
+
+#if STABILIZER_SENSOR_LOG
+/*
+ * 记录时间戳：DWT周期累加换算为us，不受32位周期计数约43s回绕的影响
+ */
+static uint32_t stabilizerLogTime(void){
+    uint32_t cyclesPerUs = SystemCoreClock / 1000000;
+    uint32_t now = DWT_GetCycles();
+    
+    g_logCycles += now - g_logLast;
+    g_logLast = now;
+    g_logUs += g_logCycles / cyclesPerUs;
+    g_logCycles %= cyclesPerUs;
+    
+    return g_logUs;
+}
+
+/*
+ * 开始记录，文件头保存回放所需的配置与传感器校准数据
+ */
+static void stabilizerLogStart(void){
+    sensorlogHeader_t header;
+    
+    header.rateHz = STABILIZER_RATE_HZ;
+    header.estimator = STABILIZER_ESTIMATOR;
+    MPU9250_GetMagAsa(header.magAsa);
+    BMP280_GetCalibData(&header.baroCalib);
+    
+    g_logUs = 0;
+    g_logCycles = 0;
+    g_logLast = DWT_GetCycles();
+    g_logSetpoint.quality = 0xFF;   // 保证第一次迭代记录设定值
+    sensorlogStart(&header);
+}
+
+/*
+ * 设定值或链路质量变化时记录
+ */
+static void stabilizerLogSetpoint(const setpoint_t *sp, uint8_t quality){
+    if(quality == g_logSetpoint.quality && memcmp(sp, &g_logSetpoint.sp, sizeof(*sp)) == 0){
+        return;
+    }
+    g_logSetpoint.sp = *sp;
+    g_logSetpoint.quality = quality;
+    sensorlogWriteSetpoint(stabilizerLogTime(), sp, quality);
+}
+#endif
+
+/*
+ * 初始化传感器，需在启动调度器前调用
+ */
+void stabilizerInit(void){
+    DWT_Init();
+    I2C1_Init();
+    MPU9250_Init();
+    
+    /* 采样率与控制频率一致，每次迭代都能读到新数据 */
+    MPU9250_SetSampleRate(STABILIZER_RATE_HZ);
+    
+#if STABILIZER_ESTIMATOR == STABILIZER_ESTIMATOR_EKF
+    I2C2_Init();
+    MPU9250_MagInit();
+    BMP280_Init();
+    ekfInit();
+#else
+    sensfusionInit();
+#endif
+    
+    filterBankInit(&g_gyroFilter);
+    if(STABILIZER_GYRO_LPF_HZ > 0.0f){
+        filterBankAddLowpass(&g_gyroFilter, STABILIZER_GYRO_LPF_HZ, FILTER_BUTTERWORTH_Q, STABILIZER_RATE_HZ);
+    }
+    if(STABILIZER_GYRO_NOTCH_HZ > 0.0f){
+        filterBankAddNotch(&g_gyroFilter, STABILIZER_GYRO_NOTCH_HZ,
+                           filterNotchQ(STABILIZER_GYRO_NOTCH_HZ, STABILIZER_GYRO_NOTCH_CUTOFF_HZ), STABILIZER_RATE_HZ);
+    }
+    
+#if STABILIZER_RPM_FILTER
+    rpmFilterInit(STABILIZER_RATE_HZ);
+#endif
+#if STABILIZER_DYN_NOTCH
+    dynNotchInit(STABILIZER_RATE_HZ);
+#endif
+    
+    controllerInit(1.0f / STABILIZER_RATE_HZ);
+    mixerInit(mixerQuadX);
+#if STABILIZER_MOTOR_OUTPUT
+    PWM_Init();
+#endif
+    
+    g_lastStart = 0;
+    g_tick = 0;
+#if STABILIZER_BLACKBOX
+    g_blackboxTail = 0;
+#endif
+    stabilizerClearTiming();
+#if STABILIZER_SENSOR_LOG
+    stabilizerLogStart();
+#endif
+    
+#if STABILIZER_SYNC == STABILIZER_SYNC_IMU_DRDY
+    MPU9250_EnableDataReady(stabilizerDataReady);
+#endif
+}
+
+/*
+ * 根据本次迭代的时间戳更新时序统计
+ * stamp[0]为迭代开始时刻，stamp[i+1]为第i阶段结束时刻
+ */
+static void stabilizerUpdateTiming(const uint32_t *stamp, uint32_t lastStart){
+    uint32_t periodCycles = SystemCoreClock / STABILIZER_RATE_HZ;
+    uint32_t interval, busy;
+    uint8_t i;
+    
+    if(g_timingReset){
+        g_timingReset = 0;
+        stabilizerClearTiming();
+    }
+    
+    busy = stamp[STABILIZER_STAGE_NUM] - stamp[0];
+    DWT_StatsAdd(&g_timing.total, busy);
+    for(i = 0; i < STABILIZER_STAGE_NUM; i++){
+        DWT_StatsAdd(&g_timing.stage[i], stamp[i + 1] - stamp[i]);
+    }
+    
+    if(g_timing.iterations > 0){
+        interval = stamp[0] - lastStart;
+        DWT_StatsAdd(&g_timing.jitter, interval > periodCycles ? interval - periodCycles : periodCycles - interval);
+        
+        if(busy > periodCycles || interval > periodCycles + periodCycles / 2){
+            g_timing.overruns++;
+        }
+    }
+    else if(busy > periodCycles){
+        g_timing.overruns++;
+    }
+    
+    g_timing.iterations++;
+}
+
+#if STABILIZER_ESTIMATOR == STABILIZER_ESTIMATOR_EKF
+/*
+ * EKF姿态与高度估计，重力方向/磁航向/气压高度按各自频率降频观测
+ * 磁力计与气压计在此读取，其I2C耗时计入估计阶段
+ */
+static void stabilizerEstimateEkf(uint32_t tick){
+    MPU9250_MagRawData_t magRaw;
+    MPU9250_MagData_t mag;
+    BMP280_RawData_t baroRaw;
+    BMP280_Data_t baro;
+    float vertical[2];
+    
+    ekfPredict(g_sensorData.gyroX, g_sensorData.gyroY, g_sensorData.gyroZ,
+               g_sensorData.accelX, g_sensorData.accelY, g_sensorData.accelZ,
+               1.0f / STABILIZER_RATE_HZ);
+    
+    if(tick % STABILIZER_ACC_DIV == 0){
+        ekfUpdateAccel(g_sensorData.accelX, g_sensorData.accelY, g_sensorData.accelZ);
+    }
+    /* 错开相位，避免同一次迭代中同时读取多个传感器 */
+    if(tick % STABILIZER_MAG_DIV == 1){
+        MPU9250_ReadMagRaw(&magRaw);
+#if STABILIZER_SENSOR_LOG
+        sensorlogWriteMag(stabilizerLogTime(), &magRaw);
+#endif
+        if(MPU9250_ConvertMag(&magRaw, &mag)){
+            ekfUpdateMag(mag.magX, mag.magY, mag.magZ);
+        }
+    }
+    if(tick % STABILIZER_BARO_DIV == 2){
+        BMP280_ReadRawData(&baroRaw);
+#if STABILIZER_SENSOR_LOG
+        sensorlogWriteBaro(stabilizerLogTime(), &baroRaw);
+#endif
+        BMP280_ConvertData(&baroRaw, &baro);
+        ekfUpdateBaro(baro.altitude);
+    }
+    
+    ekfGetEuler(&g_attitude.roll, &g_attitude.pitch, &g_attitude.yaw);
+    ekfGetVertical(&vertical[0], &vertical[1]);
+    communityPublish(COMMUNITY_TOPIC_VERTICAL, vertical, sizeof(vertical));
+}
+#endif
+
+/*
+ * 控制：取遥控设定值，链路中断(或尚未建立)时油门归零(失控保护)
+ */
+RAMFUNC static void stabilizerControl(void){
+    setpoint_t *sp = &g_setpoint;
+    radiolinkStatus_t link;
+    float angle[3];
+    
+    if(communityRead(COMMUNITY_TOPIC_SETPOINT, sp, sizeof(*sp)) == 0 ||
+       communityRead(COMMUNITY_TOPIC_LINK, &link, sizeof(link)) == 0 || link.quality == 0){
+        sp->roll = 0.0f;
+        sp->pitch = 0.0f;
+        sp->yawRate = 0.0f;
+        sp->thrust = 0.0f;
+        link.quality = 0;
+    }
+#if STABILIZER_SENSOR_LOG
+    stabilizerLogSetpoint(sp, link.quality);
+#endif
+    
+    g_armed = sp->thrust > 0.0f;
+    
+    angle[0] = g_attitude.roll;
+    angle[1] = g_attitude.pitch;
+    angle[2] = g_attitude.yaw;
+    
+    controllerUpdate(sp, angle, g_gyroFilt, &g_control);
+    communityPublish(COMMUNITY_TOPIC_CONTROL, &g_control, sizeof(g_control));
+}
+
+/*
+ * 混控并输出到电机，油门0~1映射到PWM_MIN_DUTY~PWM_MAX_DUTY
+ */
+RAMFUNC static void stabilizerMix(void){
+    uint16_t duty[MIXER_MOTOR_NUM];
+    uint8_t i;
+    
+    mixerUpdate(&g_control, g_armed, g_motor);
+    communityPublish(COMMUNITY_TOPIC_MOTOR, g_motor, sizeof(g_motor));
+    
+    for(i = 0; i < MIXER_MOTOR_NUM; i++){
+        duty[i] = PWM_MIN_DUTY + (uint16_t)(g_motor[i] * (PWM_MAX_DUTY - PWM_MIN_DUTY) + 0.5f);
+    }
+#if STABILIZER_MOTOR_OUTPUT
+    PWM_SetAllDuty(duty);
+#else
+    (void)duty;
+#endif
+}
+
+/*
+ * 陀螺仪滤波：转速陷波(可选) -> 动态陷波(可选) -> 静态滤波器组，结果供控制器使用
+ */
+RAMFUNC static void stabilizerFilterGyro(void){
+#if STABILIZER_DYN_NOTCH || STABILIZER_RPM_FILTER
+    uint32_t start;
+#endif
+#if STABILIZER_RPM_FILTER
+    uint8_t i;
+#endif
+    
+    g_gyroFilt[0] = g_sensorData.gyroX;
+    g_gyroFilt[1] = g_sensorData.gyroY;
+    g_gyroFilt[2] = g_sensorData.gyroZ;
+    
+#if STABILIZER_RPM_FILTER
+    /* 上一次迭代的电机输出估计各电机转速 */
+    start = DWT_GetCycles();
+    for(i = 0; i < RPM_FILTER_MOTOR_NUM; i++){
+        rpmFilterSetMotorHz(i, g_motor[i] * STABILIZER_MOTOR_MAX_HZ);
+    }
+    rpmFilterUpdate();
+    rpmFilterApply(g_gyroFilt);
+    DWT_StatsAdd(&g_timing.rpmFilter, DWT_GetCycles() - start);
+#endif
+    
+#if STABILIZER_DYN_NOTCH
+    /* 分析使用低通之前、RPM陷波(若启用)之后的数据：电机谐波已由RPM陷波去除，动态陷波跟踪剩下的机架共振 */
+    start = DWT_GetCycles();
+    dynNotchUpdate(g_gyroFilt);
+    DWT_StatsAdd(&g_timing.dynNotch, DWT_GetCycles() - start);
+    dynNotchApply(g_gyroFilt);
+#endif
+    
+    filterBankApply(&g_gyroFilter, g_gyroFilt);
+}
+
+#if STABILIZER_BLACKBOX
+/*
+ * 黑匣子记录：解锁期间及上锁后STABILIZER_BLACKBOX_TAIL_MS内每次迭代写一帧，
+ * 只把浮点原值拷贝到帧缓冲区，量化与编码在blackboxTask中完成
+ */
+RAMFUNC static void stabilizerBlackbox(uint32_t start){
+    blackboxFrame_t *frame;
+    controllerRateTerms_t terms;
+    float *v;
+    uint8_t i;
+    
+    if(g_armed){
+        g_blackboxTail = STABILIZER_RATE_HZ * STABILIZER_BLACKBOX_TAIL_MS / 1000;
+    }
+    else if(g_blackboxTail > 0){
+        g_blackboxTail--;
+    }
+    else{
+        return;
+    }
+    
+    frame = blackboxBeginFrame();
+    if(frame == NULL){
+        return;
+    }
+    frame->iteration = g_tick;
+    frame->cycles = start;
+    v = frame->values;
+    
+    v[BLACKBOX_GYRO_RAW + 0] = g_sensorData.gyroX;
+    v[BLACKBOX_GYRO_RAW + 1] = g_sensorData.gyroY;
+    v[BLACKBOX_GYRO_RAW + 2] = g_sensorData.gyroZ;
+    v[BLACKBOX_SETPOINT + 0] = g_setpoint.roll;
+    v[BLACKBOX_SETPOINT + 1] = g_setpoint.pitch;
+    v[BLACKBOX_SETPOINT + 2] = g_setpoint.yawRate;
+    v[BLACKBOX_SETPOINT + 3] = g_setpoint.thrust;
+    
+    controllerGetRateTerms(&terms);
+    for(i = 0; i < 3; i++){
+        v[BLACKBOX_GYRO_FILT + i] = g_gyroFilt[i];
+        v[BLACKBOX_RATE_SP + i] = terms.rateSp[i];
+        v[BLACKBOX_P_TERM + i] = terms.p[i];
+        v[BLACKBOX_I_TERM + i] = terms.i[i];
+        v[BLACKBOX_D_TERM + i] = terms.d[i];
+    }
+    for(i = 0; i < MIXER_MOTOR_NUM; i++){
+        v[BLACKBOX_MOTOR + i] = g_motor[i];
+    }
+    
+    blackboxCommitFrame();
+}
+#endif
+
+/*
+ * 一次控制迭代：读取传感器 -> 姿态解算 -> 控制 -> 电机混控输出，并记录各阶段耗时
+ * 由stabilizerTask按STABILIZER_RATE_HZ调用，SIL仿真中由仿真主循环直接调用
+ */
+void stabilizerStep(void){
+    uint32_t stamp[STABILIZER_STAGE_NUM + 1];
+    MPU9250_RawData_t raw;
+    
+    stamp[0] = DWT_GetCycles();
+    
+    /* 1.读取传感器并滤波 */
+    MPU9250_ReadRawData(&raw);
+#if STABILIZER_SENSOR_LOG
+    sensorlogWriteImu(stabilizerLogTime(), &raw);
+#endif
+    MPU9250_ConvertData(&raw, &g_sensorData);
+    communityPublish(COMMUNITY_TOPIC_SENSOR, &g_sensorData, sizeof(g_sensorData));
+    stabilizerFilterGyro();
+    stamp[1] = DWT_GetCycles();
+    
+    /* 2.姿态解算 */
+#if STABILIZER_ESTIMATOR == STABILIZER_ESTIMATOR_EKF
+    stabilizerEstimateEkf(g_tick);
+#else
+    sensfusionUpdate(g_sensorData.gyroX, g_sensorData.gyroY, g_sensorData.gyroZ,
+                     g_sensorData.accelX, g_sensorData.accelY, g_sensorData.accelZ,
+                     1.0f / STABILIZER_RATE_HZ);
+    sensfusionGetEuler(&g_attitude.roll, &g_attitude.pitch, &g_attitude.yaw);
+#endif
+    communityPublish(COMMUNITY_TOPIC_ATTITUDE, &g_attitude, sizeof(g_attitude));
+    stamp[2] = DWT_GetCycles();
+    
+    /* 3.控制 */
+    stabilizerControl();
+    stamp[3] = DWT_GetCycles();
+    
+    /* 4.电机混控输出 */
+    stabilizerMix();
+    stamp[4] = DWT_GetCycles();
+    
+#if STABILIZER_BLACKBOX
+    /* 不计入各阶段，单独统计 */
+    stabilizerBlackbox(stamp[0]);
+    DWT_StatsAdd(&g_timing.blackbox, DWT_GetCycles() - stamp[STABILIZER_STAGE_NUM]);
+#endif
+    
+    stabilizerUpdateTiming(stamp, g_lastStart);
+    g_lastStart = stamp[0];
+    g_tick++;
+}
+
 void stabilizerTask(){
+#if STABILIZER_SYNC == STABILIZER_SYNC_DELAY_UNTIL
+    TickType_t lastWakeTime = xTaskGetTickCount();
+#endif
+    
+    g_taskHandle = xTaskGetCurrentTaskHandle();
+    
     while(1){
-        
+#if STABILIZER_SYNC == STABILIZER_SYNC_DELAY_UNTIL
+        vTaskDelayUntil(&lastWakeTime, configTICK_RATE_HZ / STABILIZER_RATE_HZ);
+#else
+        /* 等待数据就绪，超过两个周期未到视为丢失一次采样 */
+        if(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(2000 / STABILIZER_RATE_HZ + 1)) == 0){
+            g_timing.missedSamples++;
+            continue;
+        }
+        LATENCY_TASK_WAKE(LATENCY_SRC_MPU_DRDY);
+#endif
+        stabilizerStep();
     }
 }
+
+/*
+ * 获取循环时序统计
+ */
+void stabilizerGetTiming(stabilizerTiming_t *timing){
+    taskENTER_CRITICAL();
+    *timing = g_timing;
+    taskEXIT_CRITICAL();
+}
+
+/*
+ * 请求清零循环时序统计，在下一次迭代中生效
+ */
+void stabilizerResetTiming(void){
+    g_timingReset = 1;
+}
@@ -1,7 +1,88 @@
 ﻿#ifndef __STABILIZER_H
 #define __STABILIZER_H
 
+#include "MPU9250.h"
+#include "DWT.h"
+#include "controller.h"
+
+/* 控制循环配置 */
+/* 控制频率(500~1000Hz，两种同步方式都需能整除1kHz)：MPU9250数字低通滤波器开启时内部采样率为1kHz，
+ * 且I2C1(400kHz)读取一次加速度计+温度+陀螺仪约需390us，2kHz(周期500us)无法实现 */
+#define STABILIZER_RATE_HZ          1000
+#define STABILIZER_SYNC_DELAY_UNTIL 0       // 由vTaskDelayUntil定时(1kHz系统节拍)
+#define STABILIZER_SYNC_IMU_DRDY    1       // 由MPU9250数据就绪中断通知(采样率 = 1kHz / (SMPLRT_DIV + 1))
+#define STABILIZER_SYNC             STABILIZER_SYNC_DELAY_UNTIL
+
+/* 陀螺仪滤波(控制器使用滤波后的角速度)，频率为0时不添加该级 */
+#define STABILIZER_GYRO_LPF_HZ      100.0f  // 二阶巴特沃斯低通
+#define STABILIZER_GYRO_NOTCH_HZ    0.0f    // 固定陷波中心频率(机架共振)
+#define STABILIZER_GYRO_NOTCH_CUTOFF_HZ 0.0f // 固定陷波-3dB下边沿
+
+/* 动态陷波：陀螺仪FFT跟踪机架共振，计算分摊到每次迭代 */
+#define STABILIZER_DYN_NOTCH        1
+
+/* 电机转速谐波陷波：无转速反馈，按电机输出线性估计转速 */
+#define STABILIZER_RPM_FILTER       1
+#define STABILIZER_MOTOR_MAX_HZ     600.0f  // 满占空比时电机转速基频估计 (Hz，约36000RPM)
+
+/* 电机输出：PWM.c当前使用PB6/PB7/PB10，与I2C1(PB6/PB7)、I2C2(PB10)引脚冲突，
+ * 核对电机引脚后再开启，关闭时只计算混控结果不输出 */
+#define STABILIZER_MOTOR_OUTPUT     0
+
+/* 姿态估计器 */
+#define STABILIZER_ESTIMATOR_COMPLEMENTARY  0   // sensfusion(Mahony/Madgwick)，仅陀螺仪+加速度计
+#define STABILIZER_ESTIMATOR_EKF            1   // ekf(MEKF)，融合磁力计航向与气压高度
+#define STABILIZER_ESTIMATOR        STABILIZER_ESTIMATOR_COMPLEMENTARY
+
+/* EKF模式下辅助传感器的读取频率 */
+#define STABILIZER_ACC_UPDATE_HZ    100     // 重力方向观测(降频以减弱振动噪声的相关性)
+#define STABILIZER_MAG_RATE_HZ      100     // AK8963连续测量模式2
+#define STABILIZER_BARO_RATE_HZ     25      // BMP280约35Hz输出
+
+/* 原始传感器数据记录(sensorlog)：IMU/磁力计/气压计原始值与设定值写入记录缓冲区，主机上用fc_replay回放 */
+#ifndef STABILIZER_SENSOR_LOG
+#define STABILIZER_SENSOR_LOG       0
+#endif
+
+/* 黑匣子：解锁期间(及上锁后STABILIZER_BLACKBOX_TAIL_MS内)每次迭代记录一帧，由blackboxTask编码写入存储端
+ * 默认不编译(与STABILIZER_SENSOR_LOG相同)，需要记录的版本在编译选项中指定STABILIZER_BLACKBOX=1 */
+#ifndef STABILIZER_BLACKBOX
+#define STABILIZER_BLACKBOX         0
+#endif
+#define STABILIZER_BLACKBOX_TAIL_MS 1000    // 上锁(含失控保护)后继续记录的时间
+
+/* 循环阶段 */
+#define STABILIZER_STAGE_READ       0       // 读取传感器
+#define STABILIZER_STAGE_ESTIMATE   1       // 姿态解算
+#define STABILIZER_STAGE_CONTROL    2       // 控制
+#define STABILIZER_STAGE_MIX        3       // 电机混控输出
+#define STABILIZER_STAGE_NUM        4
+
+/* 姿态角 */
+typedef struct {
+    float roll;      // 横滚角 (deg)
+    float pitch;     // 俯仰角 (deg)
+    float yaw;       // 偏航角 (deg)
+} attitude_t;
+
+/* 循环时序统计(单位均为DWT周期) */
+typedef struct {
+    uint32_t iterations;                         // 迭代次数
+    uint32_t overruns;                           // 执行时间超过周期或间隔超过1.5个周期的次数
+    uint32_t missedSamples;                      // 等待数据就绪超时的次数(仅DRDY模式)
+    DWT_Stats_t jitter;                          // |实际间隔 - 标称周期|，1us一个桶
+    DWT_Stats_t total;                           // 单次迭代执行时间，周期/16一个桶
+    DWT_Stats_t stage[STABILIZER_STAGE_NUM];     // 各阶段执行时间，周期/16一个桶
+    DWT_Stats_t dynNotch;                        // 动态陷波每次迭代的分析耗时，1us一个桶
+    DWT_Stats_t rpmFilter;                       // 转速陷波每次迭代的系数更新+滤波耗时，1us一个桶
+    DWT_Stats_t blackbox;                        // 黑匣子每次迭代的记录耗时，1us一个桶
+} stabilizerTiming_t;
+
+void stabilizerInit(void);
+void stabilizerStep(void);
 void stabilizerTask(void);
+void stabilizerGetTiming(stabilizerTiming_t *timing);
+void stabilizerResetTiming(void);
 
 #endif
 
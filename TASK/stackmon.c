@@ -0,0 +1,115 @@
+﻿#include "stackmon.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "stabilizer.h"
+#include "PWM.h"
+
+static stackmonTask_t g_tasks[STACKMON_MAX_TASKS];
+static uint8_t g_taskCount;
+static uint8_t g_kernelTasksAdded;
+
+/* 栈溢出记录，停机后用调试器查看 */
+volatile stackmonOverflow_t g_stackOverflow;
+
+/*
+	*添加一个监测对象
+*/
+static void stackmonAdd(const char *name, void *handle, uint16_t depth){
+	if(g_taskCount >= STACKMON_MAX_TASKS || handle == NULL){
+		return;
+	}
+	
+	g_tasks[g_taskCount].name = name;
+	g_tasks[g_taskCount].handle = handle;
+	g_tasks[g_taskCount].depth = depth;
+	g_tasks[g_taskCount].minFree = depth;
+	g_tasks[g_taskCount].recommended = depth;
+	g_taskCount++;
+}
+
+/*
+	*初始化，在main创建任务后、启动调度器前调用
+	*tasks: main.c的任务表，handle已填写
+*/
+void stackmonInit(const schedTask_t *tasks, uint8_t count){
+	uint8_t i;
+	
+	g_taskCount = 0;
+	g_kernelTasksAdded = 0;
+	for(i = 0; i < count; i++){
+		stackmonAdd(tasks[i].name, tasks[i].handle, tasks[i].stackDepth);
+	}
+}
+
+/*
+	*采样各任务栈剩余量并更新建议值，周期调用(由atkpTxTask调用)
+*/
+void stackmonUpdate(void){
+	uint16_t used, margin;
+	uint8_t i;
+	
+	if(!g_kernelTasksAdded){
+		g_kernelTasksAdded = 1;
+		stackmonAdd("IDLE", xTaskGetIdleTaskHandle(), configMINIMAL_STACK_SIZE);
+#if configUSE_TIMERS
+		stackmonAdd("Tmr Svc", xTimerGetTimerDaemonTaskHandle(), configTIMER_TASK_STACK_DEPTH);
+#endif
+	}
+	
+	for(i = 0; i < g_taskCount; i++){
+		g_tasks[i].minFree = (uint16_t)uxTaskGetStackHighWaterMark((TaskHandle_t)g_tasks[i].handle);
+		
+		used = g_tasks[i].depth - g_tasks[i].minFree;
+		margin = used * STACKMON_MARGIN_PERCENT / 100;
+		if(margin < STACKMON_MARGIN_MIN){
+			margin = STACKMON_MARGIN_MIN;
+		}
+		g_tasks[i].recommended = (used + margin + 7) & ~7;
+	}
+}
+
+/*
+	*获取监测结果
+	*tasks: 输出，长度STACKMON_MAX_TASKS
+	*返回：任务数
+*/
+uint8_t stackmonGetTasks(stackmonTask_t *tasks){
+	uint8_t i;
+	
+	taskENTER_CRITICAL();
+	for(i = 0; i < g_taskCount; i++){
+		tasks[i] = g_tasks[i];
+	}
+	taskEXIT_CRITICAL();
+	
+	return g_taskCount;
+}
+
+/*
+	*栈溢出钩子(configCHECK_FOR_STACK_OVERFLOW)，在任务切换中调用
+	*溢出后内存已被破坏，记录任务名、停止电机后停机等待调试器或看门狗
+*/
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName){
+	uint8_t i;
+	
+	(void)xTask;
+	taskDISABLE_INTERRUPTS();
+	
+	g_stackOverflow.count++;
+	for(i = 0; i < sizeof(g_stackOverflow.name) - 1 && pcTaskName[i] != '\0'; i++){
+		g_stackOverflow.name[i] = pcTaskName[i];
+	}
+	g_stackOverflow.name[i] = '\0';
+	
+#if STABILIZER_MOTOR_OUTPUT
+	{
+		uint16_t duty[4] = {PWM_MIN_DUTY, PWM_MIN_DUTY, PWM_MIN_DUTY, PWM_MIN_DUTY};
+		
+		PWM_SetAllDuty(duty);
+	}
+#endif
+	
+	while(1){
+	}
+}
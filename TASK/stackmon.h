@@ -0,0 +1,39 @@
+﻿#ifndef __STACKMON_H
+#define __STACKMON_H
+
+#include <stdint.h>
+#include "sched.h"
+
+/*
+	*任务栈监测
+	*1.周期读取各任务栈的历史最小剩余量(uxTaskGetStackHighWaterMark)，据此给出建议栈深度：
+	*  已用量 + max(已用量*STACKMON_MARGIN_PERCENT%, STACKMON_MARGIN_MIN)，按8字向上取整
+	*  空闲与定时器任务在调度器启动后才创建，第一次stackmonUpdate时加入
+	*2.configCHECK_FOR_STACK_OVERFLOW为2，任务切换时检查栈顶标记，溢出时调用钩子记录任务名后停机
+	*建议值需在覆盖各种飞行状态(含EKF、遥控命令、遥测)运行一段时间后再采用
+*/
+
+#define STACKMON_MAX_TASKS        7       // 最多监测的任务数(含空闲与定时器任务，UP_STACK每任务4字节)
+#define STACKMON_MARGIN_PERCENT   25      // 建议栈深度的余量比例
+#define STACKMON_MARGIN_MIN       32      // 最小余量 (字)，覆盖FPU上下文等偶发用量
+
+/* 单个任务 */
+typedef struct {
+	const char *name;
+	void *handle;
+	uint16_t depth;           // 栈深度 (字)
+	uint16_t minFree;         // 历史最小剩余 (字)
+	uint16_t recommended;     // 建议栈深度 (字)
+} stackmonTask_t;
+
+/* 栈溢出记录 */
+typedef struct {
+	uint32_t count;           // 溢出次数(停机前只会记录一次)
+	char name[16];            // 溢出的任务名
+} stackmonOverflow_t;
+
+void stackmonInit(const schedTask_t *tasks, uint8_t count);
+void stackmonUpdate(void);
+uint8_t stackmonGetTasks(stackmonTask_t *tasks);
+
+#endif
@@ -0,0 +1,93 @@
+﻿/*
+ * test.h
+ *
+ * 主机测试公用的检查宏与计时
+ * 每个测试是一个可执行文件，检查失败时打印位置并继续执行，main返回testResult()的结果，由ctest判定
+ *
+ * 2026-03-02
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <stdint.h>
+
+static int g_testFailures;
+
+/* 条件检查 */
+#define TEST_CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            g_testFailures++; \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        } \
+    } while (0)
+
+/* 数值检查：|actual - expected| <= tol */
+#define TEST_CHECK_NEAR(actual, expected, tol) \
+    do \
+    { \
+        double actual_ = (double)(actual); \
+        double expected_ = (double)(expected); \
+        if (!(fabs(actual_ - expected_) <= (double)(tol))) \
+        { \
+            g_testFailures++; \
+            printf("%s:%d: %s = %g, expected %g +- %g\n", __FILE__, __LINE__, #actual, \
+                   actual_, expected_, (double)(tol)); \
+        } \
+    } while (0)
+
+/**
+ * @brief  单调时钟
+ * @param  无
+ * @retval 当前时刻 (ns)
+ */
+static __inline double testNowNs(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/**
+ * @brief  伪随机高斯噪声(LCG + Box-Muller)，结果只取决于种子，各平台一致
+ * @param  state: 随机数状态(种子)
+ * @retval 标准正态分布随机数
+ */
+static __inline double testGauss(uint32_t *state)
+{
+    double u1, u2;
+    
+    *state = *state * 1664525u + 1013904223u;
+    u1 = ((*state >> 8) + 1.0) / 16777217.0;
+    *state = *state * 1664525u + 1013904223u;
+    u2 = (*state >> 8) / 16777216.0;
+    
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * 3.14159265358979323846 * u2);
+}
+
+/**
+ * @brief  打印测试结果
+ * @param  name: 测试名
+ * @retval main的返回值：0-全部通过，1-有检查失败
+ */
+static __inline int testResult(const char *name)
+{
+    if (g_testFailures)
+    {
+        printf("%s: %d checks FAILED\n", name, g_testFailures);
+        return 1;
+    }
+    printf("%s: passed\n", name);
+    
+    return 0;
+}
+
+#endif /* TEST_H */
@@ -0,0 +1,387 @@
+﻿/*
+ * test_controller.c
+ *
+ * 串级PID控制器测试，被控对象为简化的单轴刚体模型(解耦、小角度)：
+ * 力矩指令经一阶电机惯性后产生角加速度，参数由SIL默认机体(silQuadDefaultParams)在悬停附近线性化得到
+ * 1.阶跃响应：横滚/俯仰角度阶跃、偏航角速度阶跃的超调、上升时间、调节时间与稳态误差
+ * 2.常值扰动力矩下积分消除稳态误差
+ * 3.积分限幅与退饱和、微分作用于测量值(设定值突变无微分冲击)、油门PID衰减
+ * 4.pidBankUpdate与controllerUpdate的主机耗时
+ *
+ * 2026-03-02
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "controller.h"
+#include "test.h"
+
+#define TEST_RATE_HZ               1000
+#define TEST_DT                    (1.0 / TEST_RATE_HZ)
+#define TEST_SUBSTEPS              10
+#define TEST_MOTOR_TAU             0.03      // 电机时间常数 (s)
+#define TEST_GAIN_RP               23600.0   // 横滚/俯仰：单位力矩指令的角加速度 (deg/s^2)
+#define TEST_GAIN_YAW              2370.0    // 偏航
+#define TEST_DRAG_RP               0.08      // 转动阻力/转动惯量 (1/s)
+#define TEST_DRAG_YAW              0.044
+#define TEST_THRUST                0.4f      // 低于TPA拐点
+
+/* 单轴被控对象 */
+typedef struct {
+    double gain;
+    double drag;
+    double torque;     // 电机惯性后的力矩指令
+    double rate;       // deg/s
+    double angle;      // deg
+} testPlant_t;
+
+/* 阶跃响应指标 */
+typedef struct {
+    double overshoot;  // 超调 (%)
+    double rise;       // 10%~90%上升时间 (s)
+    double settle;     // 进入并保持在±2%内的时刻 (s)
+    double error;      // 结束时的稳态误差
+} testStep_t;
+
+static testPlant_t g_plant[PID_AXIS_NUM];
+
+/**
+ * @brief  被控对象初始化
+ * @param  无
+ * @retval 无
+ */
+static void TestPlantInit(void)
+{
+    uint8_t i;
+    
+    for (i = 0; i < PID_AXIS_NUM; i++)
+    {
+        g_plant[i].gain = (i == PID_YAW) ? TEST_GAIN_YAW : TEST_GAIN_RP;
+        g_plant[i].drag = (i == PID_YAW) ? TEST_DRAG_YAW : TEST_DRAG_RP;
+        g_plant[i].torque = 0.0;
+        g_plant[i].rate = 0.0;
+        g_plant[i].angle = 0.0;
+    }
+}
+
+/**
+ * @brief  被控对象前进一个控制周期
+ * @param  cmd: 力矩指令
+ * @param  disturbance: 扰动力矩(与指令同单位)，可为0
+ * @retval 无
+ */
+static void TestPlantStep(const control_t *cmd, const double *disturbance)
+{
+    double u[PID_AXIS_NUM], h = TEST_DT / TEST_SUBSTEPS, acc;
+    uint8_t i, k;
+    
+    u[PID_ROLL] = cmd->roll;
+    u[PID_PITCH] = cmd->pitch;
+    u[PID_YAW] = cmd->yaw;
+    
+    for (i = 0; i < PID_AXIS_NUM; i++)
+    {
+        testPlant_t *p = &g_plant[i];
+        
+        for (k = 0; k < TEST_SUBSTEPS; k++)
+        {
+            p->torque += (u[i] - p->torque) * h / TEST_MOTOR_TAU;
+            acc = p->gain * (p->torque + (disturbance ? disturbance[i] : 0.0)) - p->drag * p->rate;
+            p->rate += acc * h;
+            p->angle += p->rate * h;
+        }
+    }
+}
+
+/**
+ * @brief  闭环运行一个控制周期
+ * @param  sp: 设定值
+ * @param  disturbance: 扰动力矩，可为0
+ * @retval 无
+ */
+static void TestLoop(const setpoint_t *sp, const double *disturbance)
+{
+    float angle[PID_AXIS_NUM], gyro[PID_AXIS_NUM];
+    control_t out;
+    uint8_t i;
+    
+    for (i = 0; i < PID_AXIS_NUM; i++)
+    {
+        angle[i] = (float)g_plant[i].angle;
+        gyro[i] = (float)g_plant[i].rate;
+    }
+    controllerUpdate(sp, angle, gyro, &out);
+    TestPlantStep(&out, disturbance);
+}
+
+/**
+ * @brief  阶跃响应
+ * @param  sp: 设定值(阶跃)
+ * @param  axis: 考察的轴
+ * @param  useRate: 1-考察角速度，0-考察角度
+ * @param  seconds: 仿真时长 (s)
+ * @param  step: 输出指标
+ * @retval 无
+ */
+static void TestStepResponse(const setpoint_t *sp, uint8_t axis, uint8_t useRate, double seconds, testStep_t *step)
+{
+    double target, y, peak = 0.0, t10 = -1.0, t90 = -1.0, t;
+    uint32_t k, n = (uint32_t)(seconds * TEST_RATE_HZ);
+    
+    target = useRate ? sp->yawRate : (axis == PID_ROLL ? sp->roll : sp->pitch);
+    
+    TestPlantInit();
+    controllerInit((float)TEST_DT);
+    step->settle = 0.0;
+    for (k = 0; k < n; k++)
+    {
+        TestLoop(sp, 0);
+        
+        t = (k + 1) * TEST_DT;
+        y = useRate ? g_plant[axis].rate : g_plant[axis].angle;
+        peak = fmax(peak, y);
+        if (t10 < 0.0 && y >= 0.1 * target)
+        {
+            t10 = t;
+        }
+        if (t90 < 0.0 && y >= 0.9 * target)
+        {
+            t90 = t;
+        }
+        if (fabs(y - target) > 0.02 * fabs(target))
+        {
+            step->settle = t;
+        }
+    }
+    
+    step->overshoot = 100.0 * (peak - target) / target;
+    step->rise = (t10 >= 0.0 && t90 >= 0.0) ? t90 - t10 : HUGE_VAL;
+    step->error = (useRate ? g_plant[axis].rate : g_plant[axis].angle) - target;
+}
+
+/**
+ * @brief  横滚、俯仰角度阶跃与偏航角速度阶跃
+ * @param  无
+ * @retval 无
+ */
+static void TestSteps(void)
+{
+    setpoint_t roll = {10.0f, 0.0f, 0.0f, TEST_THRUST};
+    setpoint_t pitch = {0.0f, -10.0f, 0.0f, TEST_THRUST};
+    setpoint_t yaw = {0.0f, 0.0f, 100.0f, TEST_THRUST};
+    testStep_t step;
+    
+    TestStepResponse(&roll, PID_ROLL, 0, 2.0, &step);
+    printf("roll 10deg   overshoot %5.1f%% rise %.3f s settle %.3f s error %+.4f deg\n",
+           step.overshoot, step.rise, step.settle, step.error);
+    TEST_CHECK(step.overshoot < 10.0);
+    /* 角度环为纯P，上升时间约2.2/CONTROLLER_ANGLE_KP */
+    TEST_CHECK(step.rise < 0.4);
+    TEST_CHECK(step.settle < 1.0);
+    TEST_CHECK(fabs(step.error) < 0.05);
+    
+    /* 俯仰与横滚参数相同，负方向阶跃取反比较 */
+    pitch.pitch = -pitch.pitch;
+    TestStepResponse(&pitch, PID_PITCH, 0, 2.0, &step);
+    printf("pitch 10deg  overshoot %5.1f%% rise %.3f s settle %.3f s error %+.4f deg\n",
+           step.overshoot, step.rise, step.settle, step.error);
+    TEST_CHECK(step.overshoot < 10.0);
+    TEST_CHECK(step.settle < 1.0);
+    
+    TestStepResponse(&yaw, PID_YAW, 1, 2.0, &step);
+    printf("yaw 100deg/s overshoot %5.1f%% rise %.3f s settle %.3f s error %+.4f deg/s\n",
+           step.overshoot, step.rise, step.settle, step.error);
+    /* 偏航只有PI，积分零点(ki/kp = 5rad/s)靠近穿越频率，超调较大 */
+    TEST_CHECK(step.overshoot < 35.0);
+    TEST_CHECK(step.settle < 1.5);
+    TEST_CHECK(fabs(step.error) < 1.0);
+}
+
+/**
+ * @brief  常值扰动力矩(如重心偏移)由角速度环积分消除
+ * @param  无
+ * @retval 无
+ */
+static void TestDisturbance(void)
+{
+    setpoint_t sp = {0.0f, 0.0f, 0.0f, TEST_THRUST};
+    double disturbance[PID_AXIS_NUM] = {0.05, -0.03, 0.02};
+    controllerRateTerms_t terms;
+    double peak = 0.0;
+    uint32_t k;
+    
+    TestPlantInit();
+    controllerInit((float)TEST_DT);
+    for (k = 0; k < 5 * TEST_RATE_HZ; k++)
+    {
+        TestLoop(&sp, disturbance);
+        peak = fmax(peak, fabs(g_plant[PID_ROLL].angle));
+    }
+    controllerGetRateTerms(&terms);
+    
+    printf("disturbance  roll peak %.3f deg final %+.4f deg, pitch final %+.4f deg, I %+.4f %+.4f %+.4f\n",
+           peak, g_plant[PID_ROLL].angle, g_plant[PID_PITCH].angle,
+           (double)terms.i[PID_ROLL], (double)terms.i[PID_PITCH], (double)terms.i[PID_YAW]);
+    TEST_CHECK(fabs(g_plant[PID_ROLL].angle) < 0.02);
+    TEST_CHECK(fabs(g_plant[PID_PITCH].angle) < 0.02);
+    TEST_CHECK(fabs(g_plant[PID_YAW].rate) < 0.1);
+    TEST_CHECK_NEAR(terms.i[PID_ROLL], -disturbance[PID_ROLL], 0.002);
+    TEST_CHECK_NEAR(terms.i[PID_PITCH], -disturbance[PID_PITCH], 0.002);
+    TEST_CHECK_NEAR(terms.i[PID_YAW], -disturbance[PID_YAW], 0.002);
+}
+
+/**
+ * @brief  pidBank：积分限幅与退饱和、设定值突变无微分冲击、P/D缩放
+ * @param  无
+ * @retval 无
+ */
+static void TestPidBank(void)
+{
+    pidGains_t gains[PID_AXIS_NUM];
+    pidBank_t pid;
+    float sp[PID_AXIS_NUM] = {0.0f, 0.0f, 0.0f};
+    float meas[PID_AXIS_NUM] = {0.0f, 0.0f, 0.0f};
+    float out[PID_AXIS_NUM], full;
+    uint32_t k, recover;
+    uint8_t i;
+    
+    controllerGetDefaultGains(0, gains);
+    pidBankInit(&pid, gains, CONTROLLER_RATE_D_CUTOFF_HZ, (float)TEST_DT);
+    
+    /* 设定值阶跃、测量值不变：D项保持为0，P项立即响应 */
+    pidBankUpdate(&pid, sp, meas, 1.0f, 1, out);
+    for (i = 0; i < PID_AXIS_NUM; i++)
+    {
+        sp[i] = 200.0f;
+    }
+    pidBankUpdate(&pid, sp, meas, 1.0f, 1, out);
+    for (i = 0; i < PID_AXIS_NUM; i++)
+    {
+        TEST_CHECK(pid.dTerm[i] == 0.0f);
+        TEST_CHECK_NEAR(pid.pTerm[i], gains[i].kp * 200.0f, 1e-6);
+    }
+    
+    /* 误差持续10s：积分停在限幅，输出不超过输出限幅 */
+    for (k = 0; k < 10 * TEST_RATE_HZ; k++)
+    {
+        pidBankUpdate(&pid, sp, meas, 1.0f, 1, out);
+    }
+    for (i = 0; i < PID_AXIS_NUM; i++)
+    {
+        TEST_CHECK(pid.integ[i] == gains[i].iLimit);
+        TEST_CHECK(out[i] <= gains[i].outLimit);
+    }
+    
+    /* 误差反向：积分从限幅退出的时间由ki决定，而不是10s内累积的误差 */
+    for (i = 0; i < PID_AXIS_NUM; i++)
+    {
+        sp[i] = -20.0f;
+    }
+    recover = 0;
+    for (k = 0; k < TEST_RATE_HZ; k++)
+    {
+        pidBankUpdate(&pid, sp, meas, 1.0f, 1, out);
+        if (recover == 0 && pid.integ[PID_ROLL] <= 0.0f)
+        {
+            recover = k + 1;
+        }
+    }
+    printf("anti-windup  roll integrator back to 0 after %u ms\n", (unsigned)recover);
+    TEST_CHECK(recover > 0 && recover <= (uint32_t)(gains[PID_ROLL].iLimit / (gains[PID_ROLL].ki * 20.0f) * TEST_RATE_HZ) + 1);
+    
+    /* integrate = 0时积分保持 */
+    full = pid.integ[PID_ROLL];
+    pidBankUpdate(&pid, sp, meas, 1.0f, 0, out);
+    TEST_CHECK(pid.integ[PID_ROLL] == full);
+    
+    /* P/D缩放(油门PID衰减)不作用于积分项 */
+    pidBankReset(&pid);
+    meas[PID_ROLL] = 0.0f;
+    pidBankUpdate(&pid, sp, meas, 1.0f, 0, out);
+    full = pid.pTerm[PID_ROLL];
+    pidBankUpdate(&pid, sp, meas, 1.0f - CONTROLLER_TPA_RATE, 0, out);
+    TEST_CHECK_NEAR(pid.pTerm[PID_ROLL], full * (1.0f - CONTROLLER_TPA_RATE), 1e-6);
+}
+
+/**
+ * @brief  满油门时角速度环P项按CONTROLLER_TPA_RATE衰减
+ * @param  无
+ * @retval 无
+ */
+static void TestTpa(void)
+{
+    setpoint_t sp = {0.0f, 0.0f, 100.0f, TEST_THRUST};
+    float angle[PID_AXIS_NUM] = {0.0f, 0.0f, 0.0f};
+    float gyro[PID_AXIS_NUM] = {0.0f, 0.0f, 0.0f};
+    controllerRateTerms_t terms;
+    control_t out;
+    float p;
+    
+    controllerInit((float)TEST_DT);
+    controllerUpdate(&sp, angle, gyro, &out);
+    controllerGetRateTerms(&terms);
+    p = terms.p[PID_YAW];
+    
+    sp.thrust = 1.0f;
+    controllerUpdate(&sp, angle, gyro, &out);
+    controllerGetRateTerms(&terms);
+    TEST_CHECK_NEAR(terms.p[PID_YAW], p * (1.0f - CONTROLLER_TPA_RATE), 1e-6);
+}
+
+/**
+ * @brief  主机耗时
+ * @param  无
+ * @retval 无
+ */
+static void TestBenchmark(void)
+{
+    static float gyro[1024][PID_AXIS_NUM];
+    setpoint_t sp = {5.0f, -5.0f, 30.0f, TEST_THRUST};
+    float angle[PID_AXIS_NUM] = {1.0f, -1.0f, 0.0f};
+    float zero[PID_AXIS_NUM] = {0.0f, 0.0f, 0.0f};
+    pidGains_t gains[PID_AXIS_NUM];
+    pidBank_t pid;
+    float out[PID_AXIS_NUM];
+    control_t control;
+    double start, pidNs, controllerNs;
+    uint32_t k;
+    uint8_t i;
+    
+    for (k = 0; k < 1024; k++)
+    {
+        for (i = 0; i < PID_AXIS_NUM; i++)
+        {
+            gyro[k][i] = (float)(50.0 * sin(0.01 * k + i));
+        }
+    }
+    
+    controllerGetDefaultGains(0, gains);
+    pidBankInit(&pid, gains, CONTROLLER_RATE_D_CUTOFF_HZ, (float)TEST_DT);
+    start = testNowNs();
+    for (k = 0; k < 1000000; k++)
+    {
+        pidBankUpdate(&pid, zero, gyro[k & 1023], 1.0f, 1, out);
+    }
+    pidNs = (testNowNs() - start) / 1000000.0;
+    
+    controllerInit((float)TEST_DT);
+    start = testNowNs();
+    for (k = 0; k < 1000000; k++)
+    {
+        controllerUpdate(&sp, angle, gyro[k & 1023], &control);
+    }
+    controllerNs = (testNowNs() - start) / 1000000.0;
+    
+    printf("benchmark    pidBankUpdate %.1f ns, controllerUpdate %.1f ns (host)\n", pidNs, controllerNs);
+}
+
+int main(void)
+{
+    TestSteps();
+    TestDisturbance();
+    TestPidBank();
+    TestTpa();
+    TestBenchmark();
+    
+    return testResult("test_controller");
+}
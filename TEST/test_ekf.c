@@ -0,0 +1,218 @@
+﻿/*
+ * test_ekf.c
+ *
+ * MEKF测试：三轴转动轨迹(陀螺仪零偏+噪声)，按stabilizer的降频配置依次做重力方向、磁航向与气压高度观测
+ * 1.协方差：每次观测后展开的9x9矩阵对称，Cholesky分解成功(正定)，对角元在合理范围内
+ * 2.收敛：倾斜误差、偏航误差、零偏与高度
+ * 3.一次1kHz迭代(预测 + 分摊的观测)的主机耗时
+ *
+ * 2026-03-02
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "ekf.h"
+#include "test.h"
+#include "test_imu.h"
+
+#define TEST_RATE_HZ               1000
+#define TEST_DT                    (1.0 / TEST_RATE_HZ)
+#define TEST_ACC_DIV               10        // 与stabilizer的STABILIZER_ACC_DIV相同(100Hz)
+#define TEST_MAG_DIV               10        // 100Hz
+#define TEST_BARO_DIV              40        // 25Hz
+#define TEST_BARO_ALTITUDE         100.0     // 起飞点气压高度 (m)
+#define TEST_BARO_NOISE            0.3       // 气压高度噪声 (m)
+
+/**
+ * @brief  检查协方差对称正定
+ * @param  minPivot: 输出Cholesky分解的最小主元
+ * @retval 1-对称且正定
+ */
+static uint8_t TestCovariance(double *minPivot)
+{
+    float P[EKF_STATE_NUM * EKF_STATE_NUM];
+    double L[EKF_STATE_NUM][EKF_STATE_NUM];
+    double sum;
+    uint8_t i, j, k;
+    
+    ekfGetCovariance(P);
+    *minPivot = INFINITY;
+    
+    for (i = 0; i < EKF_STATE_NUM; i++)
+    {
+        for (j = 0; j < i; j++)
+        {
+            if (P[i * EKF_STATE_NUM + j] != P[j * EKF_STATE_NUM + i])
+            {
+                return 0;
+            }
+        }
+    }
+    
+    /* Cholesky：P = L*L'，主元全为正即正定 */
+    for (j = 0; j < EKF_STATE_NUM; j++)
+    {
+        sum = P[j * EKF_STATE_NUM + j];
+        for (k = 0; k < j; k++)
+        {
+            sum -= L[j][k] * L[j][k];
+        }
+        *minPivot = fmin(*minPivot, sum);
+        if (!(sum > 0.0))
+        {
+            return 0;
+        }
+        L[j][j] = sqrt(sum);
+        
+        for (i = j + 1; i < EKF_STATE_NUM; i++)
+        {
+            sum = P[i * EKF_STATE_NUM + j];
+            for (k = 0; k < j; k++)
+            {
+                sum -= L[i][k] * L[j][k];
+            }
+            L[i][j] = sum / L[j][j];
+        }
+    }
+    
+    return 1;
+}
+
+/**
+ * @brief  执行一次1kHz迭代
+ * @param  k: 迭代序号
+ * @param  s: IMU采样
+ * @param  rng: 气压噪声随机数状态
+ * @retval 无
+ */
+static void TestStep(uint32_t k, const testImuSample_t *s, uint32_t *rng)
+{
+    ekfPredict(s->gyro[0], s->gyro[1], s->gyro[2], s->acc[0], s->acc[1], s->acc[2], (float)TEST_DT);
+    
+    if (k % TEST_ACC_DIV == 0)
+    {
+        ekfUpdateAccel(s->acc[0], s->acc[1], s->acc[2]);
+    }
+    if (k % TEST_MAG_DIV == 1)
+    {
+        ekfUpdateMag(s->mag[0], s->mag[1], s->mag[2]);
+    }
+    if (k % TEST_BARO_DIV == 2)
+    {
+        ekfUpdateBaro((float)(TEST_BARO_ALTITUDE + TEST_BARO_NOISE * testGauss(rng)));
+    }
+}
+
+/**
+ * @brief  转动轨迹上的协方差与收敛检查
+ * @param  无
+ * @retval 无
+ */
+static void TestRotation(void)
+{
+    testImuConfig_t cfg = {10.0, -5.0, 40.0, {0.5, -0.5, 0.3}, 0.3, 0.02, 4};
+    testImu_t imu;
+    testImuSample_t s;
+    ekfStats_t stats;
+    float roll, pitch, yaw, bias[3], height, velocity;
+    float P[EKF_STATE_NUM * EKF_STATE_NUM];
+    double pivot, minPivot = INFINITY, maxVar = 0.0, err;
+    double tiltSq = 0.0, yawSq = 0.0, heightMax = 0.0;
+    uint32_t k, n = 0, notPd = 0, rng = 5;
+    uint8_t i;
+    
+    testImuInit(&imu, &cfg);
+    ekfInit();
+    for (k = 0; k < 120 * TEST_RATE_HZ; k++)
+    {
+        testImuStep(&imu, TEST_DT, &s);
+        TestStep(k, &s, &rng);
+        
+        if (!TestCovariance(&pivot))
+        {
+            notPd++;
+        }
+        minPivot = fmin(minPivot, pivot);
+        ekfGetCovariance(P);
+        for (i = 0; i < EKF_STATE_NUM; i++)
+        {
+            maxVar = fmax(maxVar, P[i * EKF_STATE_NUM + i]);
+        }
+        
+        /* 前20s为收敛 */
+        if (k >= 20 * TEST_RATE_HZ)
+        {
+            ekfGetEuler(&roll, &pitch, &yaw);
+            ekfGetVertical(&height, &velocity);
+            err = testAngleDiff(roll, s.roll);
+            tiltSq += err * err;
+            err = testAngleDiff(pitch, s.pitch);
+            tiltSq += err * err;
+            err = testAngleDiff(yaw, s.yaw);
+            yawSq += err * err;
+            heightMax = fmax(heightMax, fabs(height));
+            n++;
+        }
+    }
+    ekfGetGyroBias(bias);
+    ekfGetStats(&stats);
+    
+    printf("covariance %u of %u steps not symmetric positive definite, min pivot %.3g, max variance %.3g\n",
+           (unsigned)notPd, (unsigned)k, minPivot, maxVar);
+    printf("error      roll/pitch rms %.3f yaw rms %.3f deg, |height| max %.3f m\n",
+           sqrt(tiltSq / (2 * n)), sqrt(yawSq / n), heightMax);
+    printf("bias       %.3f %.3f %.3f (true %.1f %.1f %.1f) deg/s\n", (double)bias[0], (double)bias[1],
+           (double)bias[2], cfg.gyroBias[0], cfg.gyroBias[1], cfg.gyroBias[2]);
+    printf("updates    acc %u mag %u baro %u rejected %u\n", (unsigned)stats.accUpdates,
+           (unsigned)stats.magUpdates, (unsigned)stats.baroUpdates, (unsigned)stats.rejected);
+    
+    TEST_CHECK(notPd == 0);
+    /* 最大的初始方差为高度EKF_INIT_POS_STD^2，两次气压观测之间仅有少量过程噪声增长 */
+    TEST_CHECK(maxVar < 1.1 * (double)(EKF_INIT_POS_STD * EKF_INIT_POS_STD));
+    TEST_CHECK(sqrt(tiltSq / (2 * n)) < 0.5);
+    TEST_CHECK(sqrt(yawSq / n) < 1.0);
+    TEST_CHECK(heightMax < 1.0);
+    for (i = 0; i < 3; i++)
+    {
+        TEST_CHECK_NEAR(bias[i], cfg.gyroBias[i], 0.1);
+    }
+    TEST_CHECK(stats.rejected == 0);
+}
+
+/**
+ * @brief  每次1kHz迭代的平均耗时
+ * @param  无
+ * @retval 无
+ */
+static void TestBenchmark(void)
+{
+    testImuConfig_t cfg = {0.0, 0.0, 40.0, {0.0, 0.0, 0.0}, 0.3, 0.02, 6};
+    static testImuSample_t s[1000];
+    testImu_t imu;
+    double start, ns;
+    uint32_t k, rng = 7;
+    
+    testImuInit(&imu, &cfg);
+    for (k = 0; k < 1000; k++)
+    {
+        testImuStep(&imu, TEST_DT, &s[k]);
+    }
+    
+    ekfInit();
+    start = testNowNs();
+    for (k = 0; k < 200000; k++)
+    {
+        TestStep(k, &s[k % 1000], &rng);
+    }
+    ns = (testNowNs() - start) / 200000.0;
+    
+    printf("iteration  %.1f ns (host, predict + amortized updates)\n", ns);
+}
+
+int main(void)
+{
+    TestRotation();
+    TestBenchmark();
+    
+    return testResult("test_ekf");
+}
@@ -0,0 +1,366 @@
+﻿/*
+ * test_filter.c
+ *
+ * 滤波器组频率响应测试
+ * 1.系数：PT1、二阶低通、陷波与双精度参考设计(RBJ cookbook)一致
+ * 2.幅频：三轴分别输入正弦，稳态幅值与参考系数的|H(e^jw)|一致，且三轴结果相同
+ * 3.设计点：低通截止频率处-3dB、陷波中心深衰减、陷波-3dB下边沿(含双线性变换的频率畸变)
+ * 4.filterBankApply的主机耗时
+ *
+ * 2026-03-02
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "filter.h"
+#include "test.h"
+
+#define TEST_SAMPLE_HZ             1000.0
+#define TEST_SETTLE                2000      // 进入稳态的样本数
+#define TEST_WINDOW                1000      // 测量窗口(1s，整数Hz的正弦恰为整周期)
+#define TEST_PI                    3.14159265358979323846
+
+static const double g_testFreqs[] = {1, 5, 10, 20, 50, 80, 100, 120, 150, 160, 200, 250, 300, 400, 450};
+#define TEST_FREQ_NUM              (sizeof(g_testFreqs) / sizeof(g_testFreqs[0]))
+
+/**
+ * @brief  按filter.h的布局归一化双精度系数
+ * @param  c: 输出{b0, b1, b2, -a1, -a2}/a0
+ * @retval 无
+ */
+static void TestSetCoeffs(double *c, double b0, double b1, double b2, double a0, double a1, double a2)
+{
+    c[0] = b0 / a0;
+    c[1] = b1 / a0;
+    c[2] = b2 / a0;
+    c[3] = -a1 / a0;
+    c[4] = -a2 / a0;
+}
+
+/**
+ * @brief  参考设计：PT1(RC低通的后向差分)
+ * @param  c: 输出系数
+ * @param  cutoffHz: 截止频率 (Hz)
+ * @retval 无
+ */
+static void TestRefPt1(double *c, double cutoffHz)
+{
+    double dt = 1.0 / TEST_SAMPLE_HZ;
+    double k = dt / (1.0 / (2.0 * TEST_PI * cutoffHz) + dt);
+    
+    TestSetCoeffs(c, k, 0.0, 0.0, 1.0, k - 1.0, 0.0);
+}
+
+/**
+ * @brief  参考设计：二阶低通(RBJ)
+ * @param  c: 输出系数
+ * @param  cutoffHz: 截止频率 (Hz)
+ * @param  q: 品质因数
+ * @retval 无
+ */
+static void TestRefLowpass(double *c, double cutoffHz, double q)
+{
+    double w = 2.0 * TEST_PI * cutoffHz / TEST_SAMPLE_HZ;
+    double alpha = sin(w) / (2.0 * q);
+    
+    TestSetCoeffs(c, (1.0 - cos(w)) / 2.0, 1.0 - cos(w), (1.0 - cos(w)) / 2.0, 1.0 + alpha, -2.0 * cos(w), 1.0 - alpha);
+}
+
+/**
+ * @brief  参考设计：陷波(RBJ)
+ * @param  c: 输出系数
+ * @param  centerHz: 中心频率 (Hz)
+ * @param  q: 品质因数
+ * @retval 无
+ */
+static void TestRefNotch(double *c, double centerHz, double q)
+{
+    double w = 2.0 * TEST_PI * centerHz / TEST_SAMPLE_HZ;
+    double alpha = sin(w) / (2.0 * q);
+    
+    TestSetCoeffs(c, 1.0, -2.0 * cos(w), 1.0, 1.0 + alpha, -2.0 * cos(w), 1.0 - alpha);
+}
+
+/**
+ * @brief  级联系数在频率f处的增益
+ * @param  c: 各级系数
+ * @param  numStages: 级数
+ * @param  f: 频率 (Hz)
+ * @retval 增益 (dB)
+ */
+static double TestGainDb(const double *c, uint8_t numStages, double f)
+{
+    double w = 2.0 * TEST_PI * f / TEST_SAMPLE_HZ;
+    double gain = 1.0, nr, ni, dr, di;
+    uint8_t s;
+    
+    /* H(z) = (b0 + b1*z^-1 + b2*z^-2) / (1 - a1'*z^-1 - a2'*z^-2)，a1'/a2'为已取反的系数 */
+    for (s = 0; s < numStages; s++, c += FILTER_COEFFS_PER_STAGE)
+    {
+        nr = c[0] + c[1] * cos(w) + c[2] * cos(2.0 * w);
+        ni = -c[1] * sin(w) - c[2] * sin(2.0 * w);
+        dr = 1.0 - c[3] * cos(w) - c[4] * cos(2.0 * w);
+        di = c[3] * sin(w) + c[4] * sin(2.0 * w);
+        gain *= sqrt((nr * nr + ni * ni) / (dr * dr + di * di));
+    }
+    
+    return 20.0 * log10(gain);
+}
+
+/**
+ * @brief  实测增益：三轴输入相位不同的正弦，取稳态窗口内的幅值
+ * @param  bank: 滤波器组
+ * @param  f: 频率 (Hz)
+ * @param  gainDb: 输出各轴增益 (dB)
+ * @retval 无
+ */
+static void TestMeasureDb(filterBank_t *bank, double f, double *gainDb)
+{
+    double w = 2.0 * TEST_PI * f / TEST_SAMPLE_HZ, phase;
+    double sumS[FILTER_AXIS_NUM] = {0.0, 0.0, 0.0};
+    double sumC[FILTER_AXIS_NUM] = {0.0, 0.0, 0.0};
+    float xyz[FILTER_AXIS_NUM];
+    uint32_t n;
+    uint8_t axis;
+    
+    filterBankReset(bank);
+    for (n = 0; n < TEST_SETTLE + TEST_WINDOW; n++)
+    {
+        for (axis = 0; axis < FILTER_AXIS_NUM; axis++)
+        {
+            xyz[axis] = (float)sin(w * n + 2.0 * TEST_PI * axis / FILTER_AXIS_NUM);
+        }
+        filterBankApply(bank, xyz);
+        
+        /* 整周期窗口内与sin/cos做相关，得到该频率分量的幅值 */
+        if (n >= TEST_SETTLE)
+        {
+            for (axis = 0; axis < FILTER_AXIS_NUM; axis++)
+            {
+                phase = w * n + 2.0 * TEST_PI * axis / FILTER_AXIS_NUM;
+                sumS[axis] += (double)xyz[axis] * sin(phase);
+                sumC[axis] += (double)xyz[axis] * cos(phase);
+            }
+        }
+    }
+    
+    for (axis = 0; axis < FILTER_AXIS_NUM; axis++)
+    {
+        gainDb[axis] = 20.0 * log10(2.0 * hypot(sumS[axis], sumC[axis]) / TEST_WINDOW);
+    }
+}
+
+/**
+ * @brief  比较滤波器组与参考系数：系数、各测试频率的实测幅频
+ * @param  name: 名称
+ * @param  bank: 滤波器组
+ * @param  ref: 参考系数(与bank级数相同)
+ * @retval 无
+ */
+static void TestResponse(const char *name, filterBank_t *bank, const double *ref)
+{
+    double expected, gain[FILTER_AXIS_NUM], maxErr = 0.0;
+    uint32_t i;
+    uint8_t axis;
+    
+    for (i = 0; i < (uint32_t)bank->numStages * FILTER_COEFFS_PER_STAGE; i++)
+    {
+        TEST_CHECK_NEAR(bank->coeffs[i], ref[i], 1e-5);
+    }
+    
+    for (i = 0; i < TEST_FREQ_NUM; i++)
+    {
+        expected = TestGainDb(ref, bank->numStages, g_testFreqs[i]);
+        TestMeasureDb(bank, g_testFreqs[i], gain);
+        for (axis = 0; axis < FILTER_AXIS_NUM; axis++)
+        {
+            /* 深衰减处只要求足够深，其余频率要求与参考一致 */
+            if (expected < -40.0)
+            {
+                TEST_CHECK(gain[axis] < -40.0);
+            }
+            else
+            {
+                TEST_CHECK_NEAR(gain[axis], expected, 0.01);
+                maxErr = fmax(maxErr, fabs(gain[axis] - expected));
+            }
+        }
+    }
+    printf("%-22s %u stages, max |measured - reference| %.5f dB\n", name, (unsigned)bank->numStages, maxErr);
+}
+
+/**
+ * @brief  PT1
+ * @param  无
+ * @retval 无
+ */
+static void TestPt1(void)
+{
+    filterBank_t bank;
+    double ref[FILTER_COEFFS_PER_STAGE];
+    
+    filterBankInit(&bank);
+    filterBankAddPt1(&bank, 80.0f, (float)TEST_SAMPLE_HZ);
+    TestRefPt1(ref, 80.0);
+    TestResponse("pt1 80Hz", &bank, ref);
+    TEST_CHECK_NEAR(TestGainDb(ref, 1, 0.0), 0.0, 1e-9);
+}
+
+/**
+ * @brief  二阶巴特沃斯低通：截止频率处-3dB
+ * @param  无
+ * @retval 无
+ */
+static void TestLowpass(void)
+{
+    filterBank_t bank;
+    double ref[FILTER_COEFFS_PER_STAGE];
+    double gain[FILTER_AXIS_NUM];
+    
+    filterBankInit(&bank);
+    filterBankAddLowpass(&bank, 100.0f, FILTER_BUTTERWORTH_Q, (float)TEST_SAMPLE_HZ);
+    TestRefLowpass(ref, 100.0, sqrt(0.5));
+    TestResponse("lowpass 100Hz", &bank, ref);
+    
+    TestMeasureDb(&bank, 100.0, gain);
+    TEST_CHECK_NEAR(gain[0], -3.0103, 0.01);
+    TEST_CHECK_NEAR(TestGainDb(ref, 1, 0.0), 0.0, 1e-9);
+}
+
+/**
+ * @brief  陷波-3dB下边沿
+ * @param  centerHz: 中心频率 (Hz)
+ * @param  q: 品质因数
+ * @retval 下边沿频率 (Hz)
+ * @note   模拟原型的两个-3dB边沿满足Wh - Wl = 1/Q、Wh*Wl = 1(以中心频率归一化)，
+ *         RBJ设计在中心频率处预畸变，数字频率w与模拟频率W的关系为tan(w/2) = W*tan(w0/2)
+ */
+static double TestNotchLowerEdge(double centerHz, double q)
+{
+    double wl = (sqrt(1.0 + 4.0 * q * q) - 1.0) / (2.0 * q);
+    double w0 = 2.0 * TEST_PI * centerHz / TEST_SAMPLE_HZ;
+    
+    return 2.0 * atan(wl * tan(w0 / 2.0)) * TEST_SAMPLE_HZ / (2.0 * TEST_PI);
+}
+
+/**
+ * @brief  陷波：中心深衰减，-3dB下边沿
+ * @param  无
+ * @retval 无
+ */
+static void TestNotch(void)
+{
+    filterBank_t bank;
+    double ref[FILTER_COEFFS_PER_STAGE], coeffs[FILTER_COEFFS_PER_STAGE];
+    double gain[FILTER_AXIS_NUM], edge;
+    float xyz[FILTER_AXIS_NUM] = {0.123f, -4.5f, 678.0f};
+    float q = filterNotchQ(200.0f, 160.0f);
+    uint8_t i;
+    
+    filterBankInit(&bank);
+    filterBankAddNotch(&bank, 200.0f, q, (float)TEST_SAMPLE_HZ);
+    TestRefNotch(ref, 200.0, q);
+    TestResponse("notch 200Hz", &bank, ref);
+    for (i = 0; i < FILTER_COEFFS_PER_STAGE; i++)
+    {
+        coeffs[i] = bank.coeffs[i];
+    }
+    
+    /* filterNotchQ按模拟带宽计算，频率畸变使数字陷波略窄：-3dB边沿在160Hz与中心之间 */
+    TestMeasureDb(&bank, 200.0, gain);
+    edge = TestNotchLowerEdge(200.0, q);
+    printf("%-22s center %.1f dB, -3dB edge %.2f Hz (160 Hz requested, %.2f dB there)\n", "", gain[0], edge,
+           TestGainDb(coeffs, 1, 160.0));
+    TEST_CHECK(gain[0] < -60.0);
+    TEST_CHECK(edge > 160.0 && edge < 200.0);
+    TEST_CHECK_NEAR(TestGainDb(coeffs, 1, edge), -3.0103, 0.001);
+    TEST_CHECK_NEAR(TestGainDb(coeffs, 1, 0.0), 0.0, 1e-6);
+    
+    /* 中心频率远低于奈奎斯特频率时畸变可忽略，边沿与filterNotchQ给定的一致 */
+    q = filterNotchQ(50.0f, 40.0f);
+    filterBankInit(&bank);
+    filterBankAddNotch(&bank, 50.0f, q, (float)TEST_SAMPLE_HZ);
+    for (i = 0; i < FILTER_COEFFS_PER_STAGE; i++)
+    {
+        coeffs[i] = bank.coeffs[i];
+    }
+    TEST_CHECK_NEAR(TestGainDb(coeffs, 1, 40.0), -3.0103, 0.1);
+    
+    /* 设为直通后输出与输入完全相同 */
+    filterBankSetBypass(&bank, 0);
+    filterBankReset(&bank);
+    filterBankApply(&bank, xyz);
+    TEST_CHECK(xyz[0] == 0.123f && xyz[1] == -4.5f && xyz[2] == 678.0f);
+}
+
+/**
+ * @brief  级联：微分项(PT1 + 低通)与陀螺仪(低通 + 陷波 + 陷波)的配置
+ * @param  无
+ * @retval 无
+ */
+static void TestCascade(void)
+{
+    filterBank_t bank;
+    double ref[FILTER_MAX_STAGES * FILTER_COEFFS_PER_STAGE];
+    
+    filterBankInit(&bank);
+    filterBankAddPt1(&bank, 80.0f, (float)TEST_SAMPLE_HZ);
+    filterBankAddLowpass(&bank, 120.0f, FILTER_BUTTERWORTH_Q, (float)TEST_SAMPLE_HZ);
+    TestRefPt1(&ref[0], 80.0);
+    TestRefLowpass(&ref[FILTER_COEFFS_PER_STAGE], 120.0, sqrt(0.5));
+    TestResponse("dterm pt1 + lowpass", &bank, ref);
+    
+    filterBankInit(&bank);
+    filterBankAddLowpass(&bank, 100.0f, FILTER_BUTTERWORTH_Q, (float)TEST_SAMPLE_HZ);
+    filterBankAddNotch(&bank, 250.0f, 3.0f, (float)TEST_SAMPLE_HZ);
+    filterBankAddNotch(&bank, 150.0f, 5.0f, (float)TEST_SAMPLE_HZ);
+    TestRefLowpass(&ref[0], 100.0, sqrt(0.5));
+    TestRefNotch(&ref[FILTER_COEFFS_PER_STAGE], 250.0, 3.0);
+    TestRefNotch(&ref[2 * FILTER_COEFFS_PER_STAGE], 150.0, 5.0);
+    TestResponse("gyro lowpass + 2 notch", &bank, ref);
+    
+    /* 已满时返回FILTER_NO_STAGE */
+    TEST_CHECK(filterBankAddPt1(&bank, 50.0f, (float)TEST_SAMPLE_HZ) == 3);
+    TEST_CHECK(filterBankAddPt1(&bank, 50.0f, (float)TEST_SAMPLE_HZ) == FILTER_NO_STAGE);
+    TEST_CHECK(bank.numStages == FILTER_MAX_STAGES);
+}
+
+/**
+ * @brief  三轴filterBankApply的主机耗时
+ * @param  无
+ * @retval 无
+ */
+static void TestBenchmark(void)
+{
+    filterBank_t bank;
+    float xyz[FILTER_AXIS_NUM] = {1.0f, 2.0f, 3.0f};
+    double start, ns;
+    uint32_t k;
+    uint8_t stages;
+    
+    filterBankInit(&bank);
+    for (stages = 1; stages <= FILTER_MAX_STAGES; stages++)
+    {
+        filterBankAddNotch(&bank, 100.0f + 50.0f * stages, 3.0f, (float)TEST_SAMPLE_HZ);
+        
+        start = testNowNs();
+        for (k = 0; k < 1000000; k++)
+        {
+            xyz[k % FILTER_AXIS_NUM] += 1.0f;
+            filterBankApply(&bank, xyz);
+        }
+        ns = (testNowNs() - start) / 1000000.0;
+        printf("benchmark              %u stages x 3 axes %.1f ns (host)\n", (unsigned)stages, ns);
+    }
+}
+
+int main(void)
+{
+    TestPt1();
+    TestLowpass();
+    TestNotch();
+    TestCascade();
+    TestBenchmark();
+    
+    return testResult("test_filter");
+}
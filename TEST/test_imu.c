@@ -0,0 +1,154 @@
+﻿/*
+ * test_imu.c
+ *
+ * 测试用IMU轨迹实现
+ * 每个采样间隔内角速度取区间中点的值并按四元数指数精确积分，
+ * 因此无噪声、无零偏时陀螺仪读数与真实姿态变化完全一致
+ *
+ * 2026-03-02
+ */
+
+#include <math.h>
+#include <string.h>
+#include "test.h"
+#include "test_imu.h"
+
+#define TEST_IMU_DEG2RAD           (3.14159265358979323846 / 180.0)
+
+/**
+ * @brief  地理系向量转到机体系：v_b = R' * v_e
+ * @param  q: 姿态
+ * @param  e: 地理系向量
+ * @param  b: 输出机体系向量
+ * @retval 无
+ */
+static void TestImuToBody(const double *q, const double *e, double *b)
+{
+    double r[3][3];
+    
+    r[0][0] = 1.0 - 2.0 * (q[2] * q[2] + q[3] * q[3]);
+    r[0][1] = 2.0 * (q[1] * q[2] - q[0] * q[3]);
+    r[0][2] = 2.0 * (q[1] * q[3] + q[0] * q[2]);
+    r[1][0] = 2.0 * (q[1] * q[2] + q[0] * q[3]);
+    r[1][1] = 1.0 - 2.0 * (q[1] * q[1] + q[3] * q[3]);
+    r[1][2] = 2.0 * (q[2] * q[3] - q[0] * q[1]);
+    r[2][0] = 2.0 * (q[1] * q[3] - q[0] * q[2]);
+    r[2][1] = 2.0 * (q[2] * q[3] + q[0] * q[1]);
+    r[2][2] = 1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2]);
+    
+    b[0] = r[0][0] * e[0] + r[1][0] * e[1] + r[2][0] * e[2];
+    b[1] = r[0][1] * e[0] + r[1][1] * e[1] + r[2][1] * e[2];
+    b[2] = r[0][2] * e[0] + r[1][2] * e[1] + r[2][2] * e[2];
+}
+
+/**
+ * @brief  轨迹初始化
+ * @param  imu: 轨迹状态
+ * @param  cfg: 配置
+ * @retval 无
+ */
+void testImuInit(testImu_t *imu, const testImuConfig_t *cfg)
+{
+    double hr = 0.5 * cfg->roll * TEST_IMU_DEG2RAD;
+    double hp = 0.5 * cfg->pitch * TEST_IMU_DEG2RAD;
+    
+    memset(imu, 0, sizeof(*imu));
+    imu->cfg = *cfg;
+    imu->rng = cfg->seed;
+    
+    /* 偏航为0的ZYX欧拉角 */
+    imu->q[0] = cos(hr) * cos(hp);
+    imu->q[1] = sin(hr) * cos(hp);
+    imu->q[2] = cos(hr) * sin(hp);
+    imu->q[3] = -sin(hr) * sin(hp);
+}
+
+/**
+ * @brief  前进一个采样间隔并生成传感器读数
+ * @param  imu: 轨迹状态
+ * @param  dt: 采样间隔 (s)
+ * @param  s: 输出采样
+ * @retval 无
+ */
+void testImuStep(testImu_t *imu, double dt, testImuSample_t *s)
+{
+    static const double gravity[3] = {0.0, 0.0, 1.0};
+    double mag[3];
+    double tm = imu->t + 0.5 * dt;
+    double w[3], b[3], q[4];
+    double norm, half, k;
+    uint8_t i;
+    
+    mag[0] = cos(TEST_IMU_MAG_INCLINATION * TEST_IMU_DEG2RAD);
+    mag[1] = 0.0;
+    mag[2] = -sin(TEST_IMU_MAG_INCLINATION * TEST_IMU_DEG2RAD);
+    
+    /* 三轴不同频率的正弦角速度(机体系)，横滚/俯仰幅值约为rateAmp/(2*pi*f) */
+    w[0] = imu->cfg.rateAmp * sin(2.0 * 3.14159265358979323846 * 0.13 * tm);
+    w[1] = imu->cfg.rateAmp * sin(2.0 * 3.14159265358979323846 * 0.17 * tm + 1.0);
+    w[2] = 0.5 * imu->cfg.rateAmp * sin(2.0 * 3.14159265358979323846 * 0.05 * tm);
+    
+    /* q = q * exp(w*dt/2) */
+    norm = sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]) * TEST_IMU_DEG2RAD;
+    if (norm > 0.0)
+    {
+        half = 0.5 * norm * dt;
+        k = sin(half) / norm * TEST_IMU_DEG2RAD;
+        q[0] = imu->q[0];
+        q[1] = imu->q[1];
+        q[2] = imu->q[2];
+        q[3] = imu->q[3];
+        b[0] = w[0] * k;
+        b[1] = w[1] * k;
+        b[2] = w[2] * k;
+        imu->q[0] = q[0] * cos(half) - q[1] * b[0] - q[2] * b[1] - q[3] * b[2];
+        imu->q[1] = q[0] * b[0] + q[1] * cos(half) + q[2] * b[2] - q[3] * b[1];
+        imu->q[2] = q[0] * b[1] - q[1] * b[2] + q[2] * cos(half) + q[3] * b[0];
+        imu->q[3] = q[0] * b[2] + q[1] * b[1] - q[2] * b[0] + q[3] * cos(half);
+    }
+    imu->t += dt;
+    
+    for (i = 0; i < 3; i++)
+    {
+        s->gyro[i] = (float)(w[i] + imu->cfg.gyroBias[i] + imu->cfg.gyroNoise * testGauss(&imu->rng));
+    }
+    TestImuToBody(imu->q, gravity, b);
+    for (i = 0; i < 3; i++)
+    {
+        s->acc[i] = (float)(b[i] + imu->cfg.accNoise * testGauss(&imu->rng));
+    }
+    TestImuToBody(imu->q, mag, b);
+    for (i = 0; i < 3; i++)
+    {
+        s->mag[i] = (float)b[i];
+    }
+    
+    q[0] = imu->q[0];
+    q[1] = imu->q[1];
+    q[2] = imu->q[2];
+    q[3] = imu->q[3];
+    s->roll = atan2(2.0 * (q[0] * q[1] + q[2] * q[3]), 1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2])) / TEST_IMU_DEG2RAD;
+    s->pitch = asin(fmax(-1.0, fmin(1.0, 2.0 * (q[0] * q[2] - q[3] * q[1])))) / TEST_IMU_DEG2RAD;
+    s->yaw = atan2(2.0 * (q[0] * q[3] + q[1] * q[2]), 1.0 - 2.0 * (q[2] * q[2] + q[3] * q[3])) / TEST_IMU_DEG2RAD;
+}
+
+/**
+ * @brief  角度差，折算到-180~180
+ * @param  a,b: 角度 (deg)
+ * @retval a - b (deg)
+ */
+double testAngleDiff(double a, double b)
+{
+    double d = fmod(a - b, 360.0);
+    
+    if (d > 180.0)
+    {
+        d -= 360.0;
+    }
+    else if (d < -180.0)
+    {
+        d += 360.0;
+    }
+    
+    return d;
+}
@@ -0,0 +1,53 @@
+﻿/*
+ * test_imu.h
+ *
+ * 测试用IMU轨迹：按给定角速度曲线积分真实姿态(double)，生成带零偏与噪声的陀螺仪、
+ * 重力方向加速度(纯转动，无线加速度)与机体系磁场
+ *
+ * 坐标系与滤波器一致：四元数为机体系到地理系，地理系z向上、x为磁北，欧拉角为ZYX顺序
+ *
+ * 2026-03-02
+ */
+
+#ifndef TEST_IMU_H
+#define TEST_IMU_H
+
+#include <stdint.h>
+
+#define TEST_IMU_MAG_INCLINATION   50.0     // 磁倾角 (deg)
+
+/* 轨迹配置 */
+typedef struct {
+    double roll;             // 初始横滚角 (deg)
+    double pitch;            // 初始俯仰角 (deg)
+    double rateAmp;          // 角速度幅值 (deg/s)，0为静止
+    double gyroBias[3];      // 陀螺仪零偏 (deg/s)
+    double gyroNoise;        // 陀螺仪噪声标准差 (deg/s)
+    double accNoise;         // 加速度噪声标准差 (g)
+    uint32_t seed;           // 噪声种子
+} testImuConfig_t;
+
+/* 轨迹状态 */
+typedef struct {
+    testImuConfig_t cfg;
+    double t;                // 时间 (s)
+    double q[4];             // 真实姿态[w, x, y, z]
+    uint32_t rng;
+} testImu_t;
+
+/* 一个采样 */
+typedef struct {
+    float gyro[3];           // 陀螺仪 (deg/s)，本采样间隔内的平均角速度
+    float acc[3];            // 加速度 (g)
+    float mag[3];            // 磁场(机体系，单位长度)
+    double roll;             // 采样间隔结束时的真实欧拉角 (deg)
+    double pitch;
+    double yaw;
+} testImuSample_t;
+
+/* 函数声明 */
+void testImuInit(testImu_t *imu, const testImuConfig_t *cfg);
+void testImuStep(testImu_t *imu, double dt, testImuSample_t *s);
+double testAngleDiff(double a, double b);
+
+#endif /* TEST_IMU_H */
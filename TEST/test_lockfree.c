@@ -0,0 +1,376 @@
+﻿/*
+ * test_lockfree.c
+ *
+ * 无锁数据结构的多线程压力测试(pthread)
+ * 1.community：一个发布者线程不断发布，多个订阅者线程用communityRead与communityPeek/communityPeekValid读取，
+ *   检查读到的数据没有撕裂(各字都属于同一代)、代数与内容一致且单调不减
+ * 2.ringbuf：生产者/消费者线程混用单个、批量与Span/Commit接口传递连续序号，检查元素完整且按序、不丢不重
+ *
+ * 单核主机上线程靠抢占交错，测试同时统计读取期间被覆盖的次数，确认确实发生了并发
+ *
+ * 2026-03-02
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <threads.h>
+#include "community.h"
+#include "ringbuf.h"
+#include "test.h"
+
+#define TEST_PUBLISHES             2000000
+#define TEST_READERS               3
+#define TEST_WORDS                 (COMMUNITY_SLOT_SIZE / 4)
+#define TEST_RB_COUNT              64        // 小缓冲区，频繁回绕与满/空
+#define TEST_RB_ITEMS              5000000
+#define TEST_RB_MAGIC              0x5A5A5A5Au
+
+/* 订阅者统计 */
+typedef struct {
+    uint32_t reads;
+    uint32_t torn;         // 撕裂的数据
+    uint32_t mismatch;     // 代数与内容不一致
+    uint32_t backwards;    // 代数倒退
+    uint32_t peekDiscard;  // communityPeek期间被覆盖而丢弃的次数
+} testReader_t;
+
+/* 环形缓冲区元素：序号及其两个变换，用于检查元素完整 */
+typedef struct {
+    uint32_t seq;
+    uint32_t check;
+    uint32_t inv;
+} testItem_t;
+
+static volatile uint32_t g_writerDone;
+static ringbuf_t g_rb;
+static testItem_t g_rbBuf[TEST_RB_COUNT];
+static uint32_t g_rbOutOfOrder;
+static uint32_t g_rbCorrupt;
+static uint32_t g_rbReceived;
+
+/**
+ * @brief  让出处理器(缓冲区满/空时)
+ * @param  无
+ * @retval 无
+ * @note   TASK/sched.h在包含路径中会遮住系统的<sched.h>，用C11的thrd_yield代替sched_yield
+ */
+static void TestYield(void)
+{
+    thrd_yield();
+}
+
+/**
+ * @brief  发布者线程：第g代的各字都为g
+ * @param  arg: 未使用
+ * @retval NULL
+ */
+static void *TestWriter(void *arg)
+{
+    uint32_t data[TEST_WORDS];
+    uint32_t g, i;
+    
+    for (g = 1; g <= TEST_PUBLISHES; g++)
+    {
+        for (i = 0; i < TEST_WORDS; i++)
+        {
+            data[i] = g;
+        }
+        communityPublish(COMMUNITY_TOPIC_ATTITUDE, data, sizeof(data));
+    }
+    g_writerDone = 1;
+    
+    return NULL;
+}
+
+/**
+ * @brief  检查一次读到的数据
+ * @param  r: 统计
+ * @param  data: 数据
+ * @param  gen: 读取返回的代数
+ * @param  last: 上一次的代数
+ * @retval 无
+ */
+static void TestCheckRead(testReader_t *r, const uint32_t *data, uint32_t gen, uint32_t *last)
+{
+    uint32_t i;
+    
+    for (i = 1; i < TEST_WORDS; i++)
+    {
+        if (data[i] != data[0])
+        {
+            r->torn++;
+            break;
+        }
+    }
+    if (data[0] != gen)
+    {
+        r->mismatch++;
+    }
+    if (gen < *last)
+    {
+        r->backwards++;
+    }
+    *last = gen;
+    r->reads++;
+}
+
+/**
+ * @brief  订阅者线程：交替使用拷贝读取与零拷贝读取
+ * @param  arg: testReader_t
+ * @retval NULL
+ */
+static void *TestReader(void *arg)
+{
+    testReader_t *r = (testReader_t *)arg;
+    uint32_t data[TEST_WORDS];
+    const uint32_t *peek;
+    uint32_t gen, seq, last = 0, i, n = 0;
+    
+    while (!g_writerDone)
+    {
+        if (n++ & 1)
+        {
+            gen = communityRead(COMMUNITY_TOPIC_ATTITUDE, data, sizeof(data));
+            if (gen)
+            {
+                TestCheckRead(r, data, gen, &last);
+            }
+            continue;
+        }
+        
+        peek = (const uint32_t *)communityPeek(COMMUNITY_TOPIC_ATTITUDE, &seq);
+        if (!peek)
+        {
+            continue;
+        }
+        for (i = 0; i < TEST_WORDS; i++)
+        {
+            data[i] = peek[i];
+        }
+        if (communityPeekValid(COMMUNITY_TOPIC_ATTITUDE, seq))
+        {
+            TestCheckRead(r, data, seq >> 1, &last);
+        }
+        else
+        {
+            r->peekDiscard++;
+        }
+    }
+    
+    return NULL;
+}
+
+/**
+ * @brief  community：一个发布者与多个订阅者
+ * @param  无
+ * @retval 无
+ */
+static void TestCommunity(void)
+{
+    pthread_t writer, readers[TEST_READERS];
+    testReader_t stats[TEST_READERS] = {{0}};
+    uint32_t data[TEST_WORDS];
+    double start;
+    uint8_t i;
+    
+    start = testNowNs();
+    g_writerDone = 0;
+    for (i = 0; i < TEST_READERS; i++)
+    {
+        pthread_create(&readers[i], NULL, TestReader, &stats[i]);
+    }
+    pthread_create(&writer, NULL, TestWriter, NULL);
+    pthread_join(writer, NULL);
+    for (i = 0; i < TEST_READERS; i++)
+    {
+        pthread_join(readers[i], NULL);
+    }
+    
+    for (i = 0; i < TEST_READERS; i++)
+    {
+        printf("reader %u    %u reads, %u torn, %u gen/data mismatch, %u backwards, %u peeks overwritten\n",
+               (unsigned)i, (unsigned)stats[i].reads, (unsigned)stats[i].torn, (unsigned)stats[i].mismatch,
+               (unsigned)stats[i].backwards, (unsigned)stats[i].peekDiscard);
+        TEST_CHECK(stats[i].reads > 0);
+        TEST_CHECK(stats[i].torn == 0);
+        TEST_CHECK(stats[i].mismatch == 0);
+        TEST_CHECK(stats[i].backwards == 0);
+    }
+    printf("community   %u publishes in %.0f ms\n", (unsigned)TEST_PUBLISHES, (testNowNs() - start) / 1e6);
+    
+    /* 全部结束后读到最后一代 */
+    TEST_CHECK(communityRead(COMMUNITY_TOPIC_ATTITUDE, data, sizeof(data)) == TEST_PUBLISHES);
+    TEST_CHECK(data[0] == TEST_PUBLISHES && data[TEST_WORDS - 1] == TEST_PUBLISHES);
+}
+
+/**
+ * @brief  生成序号为seq的元素
+ * @param  item: 输出
+ * @param  seq: 序号
+ * @retval 无
+ */
+static void TestMakeItem(testItem_t *item, uint32_t seq)
+{
+    item->seq = seq;
+    item->check = seq * 2654435761u ^ TEST_RB_MAGIC;
+    item->inv = ~seq;
+}
+
+/**
+ * @brief  生产者线程：按序号轮流使用ringbufPush、ringbufPushBulk与ringbufWriteSpan/ringbufCommit
+ * @param  arg: 未使用
+ * @retval NULL
+ */
+static void *TestProducer(void *arg)
+{
+    testItem_t items[16];
+    testItem_t *span;
+    uint32_t seq = 0, n, i, want, mode = 0;
+    
+    while (seq < TEST_RB_ITEMS)
+    {
+        want = 1 + (seq * 7 + mode) % 16;
+        if (want > TEST_RB_ITEMS - seq)
+        {
+            want = TEST_RB_ITEMS - seq;
+        }
+        
+        switch (mode++ % 3)
+        {
+            case 0:
+                TestMakeItem(&items[0], seq);
+                n = ringbufPush(&g_rb, &items[0]);
+                break;
+            case 1:
+                for (i = 0; i < want; i++)
+                {
+                    TestMakeItem(&items[i], seq + i);
+                }
+                n = ringbufPushBulk(&g_rb, items, want);
+                break;
+            default:
+                n = ringbufWriteSpan(&g_rb, (void **)&span);
+                if (n > want)
+                {
+                    n = want;
+                }
+                for (i = 0; i < n; i++)
+                {
+                    TestMakeItem(&span[i], seq + i);
+                }
+                ringbufCommit(&g_rb, n);
+                break;
+        }
+        
+        seq += n;
+        if (n == 0)
+        {
+            TestYield();
+        }
+    }
+    
+    return NULL;
+}
+
+/**
+ * @brief  检查收到的元素
+ * @param  item: 元素
+ * @param  expect: 期望的序号，检查后加1
+ * @retval 无
+ */
+static void TestCheckItem(const testItem_t *item, uint32_t *expect)
+{
+    if (item->check != (item->seq * 2654435761u ^ TEST_RB_MAGIC) || item->inv != ~item->seq)
+    {
+        g_rbCorrupt++;
+    }
+    if (item->seq != *expect)
+    {
+        g_rbOutOfOrder++;
+        *expect = item->seq;
+    }
+    (*expect)++;
+    g_rbReceived++;
+}
+
+/**
+ * @brief  消费者线程：轮流使用ringbufPop、ringbufPopBulk与ringbufReadSpan/ringbufConsume
+ * @param  arg: 未使用
+ * @retval NULL
+ */
+static void *TestConsumer(void *arg)
+{
+    testItem_t items[16];
+    const testItem_t *span;
+    uint32_t expect = 0, n, i, mode = 0;
+    
+    while (g_rbReceived < TEST_RB_ITEMS)
+    {
+        switch (mode++ % 3)
+        {
+            case 0:
+                n = ringbufPop(&g_rb, &items[0]);
+                break;
+            case 1:
+                n = ringbufPopBulk(&g_rb, items, 1 + mode % 16);
+                break;
+            default:
+                n = ringbufReadSpan(&g_rb, (const void **)&span);
+                for (i = 0; i < n; i++)
+                {
+                    TestCheckItem(&span[i], &expect);
+                }
+                ringbufConsume(&g_rb, n);
+                if (n == 0)
+                {
+                    TestYield();
+                }
+                continue;
+        }
+        
+        for (i = 0; i < n; i++)
+        {
+            TestCheckItem(&items[i], &expect);
+        }
+        if (n == 0)
+        {
+            TestYield();
+        }
+    }
+    
+    return NULL;
+}
+
+/**
+ * @brief  ringbuf：单生产者/单消费者
+ * @param  无
+ * @retval 无
+ */
+static void TestRingbuf(void)
+{
+    pthread_t producer, consumer;
+    double start;
+    
+    TEST_CHECK(ringbufInit(&g_rb, g_rbBuf, sizeof(testItem_t), TEST_RB_COUNT));
+    
+    start = testNowNs();
+    pthread_create(&consumer, NULL, TestConsumer, NULL);
+    pthread_create(&producer, NULL, TestProducer, NULL);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    
+    printf("ringbuf     %u items in %.0f ms, %u out of order, %u corrupt\n", (unsigned)g_rbReceived,
+           (testNowNs() - start) / 1e6, (unsigned)g_rbOutOfOrder, (unsigned)g_rbCorrupt);
+    TEST_CHECK(g_rbReceived == TEST_RB_ITEMS);
+    TEST_CHECK(g_rbOutOfOrder == 0);
+    TEST_CHECK(g_rbCorrupt == 0);
+    TEST_CHECK(ringbufCount(&g_rb) == 0);
+}
+
+int main(void)
+{
+    TestCommunity();
+    TestRingbuf();
+    
+    return testResult("test_lockfree");
+}
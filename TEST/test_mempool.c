@@ -0,0 +1,281 @@
+﻿/*
+ * test_mempool.c
+ *
+ * 固定块内存池测试与最坏延迟对比(heap_4.c使用FreeRTOS/port中的源码，由SIL的FreeRTOS替身编译)
+ * 1.选池：按大小选择最小的池，超过最大块失败，块地址8字节对齐
+ * 2.用完：池用完时向更大的池借用并计入failCount，全部用完时失败；统计used/peak与mempoolResetPeak
+ * 3.释放检查：块中间、池外与空指针返回0且不改变统计
+ * 4.延迟：先制造K个放不下请求的小空闲碎片，再反复分配/释放200字节，统计每次操作耗时的中位数与最大值；
+ *   heap_4首次适配要遍历全部碎片、释放时按地址插入，内存池与碎片和已分配块数无关
+ *
+ * 2026-03-02
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "mempool.h"
+#include "test.h"
+
+#define TEST_REQUEST               200       // 被计时的请求大小(256字节池)
+#define TEST_FRAGMENT              8         // heap_4碎片的请求大小
+#define TEST_FRAGMENTS_MAX         120
+#define TEST_REPEATS               20000
+
+static double g_allocNs[TEST_REPEATS];
+static double g_freeNs[TEST_REPEATS];
+
+/* 计时结果 */
+typedef struct {
+    double allocMedian;
+    double allocMax;
+    double freeMedian;
+    double freeMax;
+} testLatency_t;
+
+static int TestCompare(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief  对耗时数组排序，取中位数与最大值
+ * @param  ns: 耗时数组，长度TEST_REPEATS
+ * @param  median: 输出中位数
+ * @param  max: 输出最大值
+ * @retval 无
+ */
+static void TestSummarize(double *ns, double *median, double *max)
+{
+    qsort(ns, TEST_REPEATS, sizeof(double), TestCompare);
+    *median = ns[TEST_REPEATS / 2];
+    *max = ns[TEST_REPEATS - 1];
+}
+
+/**
+ * @brief  选池与对齐
+ * @param  无
+ * @retval 无
+ */
+static void TestSelect(void)
+{
+    mempoolStats_t stats[MEMPOOL_NUM];
+    void *p;
+    
+    mempoolInit();
+    
+    p = mempoolAlloc(1);
+    TEST_CHECK(p != NULL && ((uintptr_t)p & 7) == 0);
+    mempoolGetStats(stats);
+    TEST_CHECK(stats[MEMPOOL_32].used == 1 && stats[MEMPOOL_64].used == 0);
+    TEST_CHECK(mempoolFree(p));
+    
+    p = mempoolAlloc(32);
+    mempoolGetStats(stats);
+    TEST_CHECK(stats[MEMPOOL_32].used == 1);
+    TEST_CHECK(mempoolFree(p));
+    
+    p = mempoolAlloc(33);
+    mempoolGetStats(stats);
+    TEST_CHECK(stats[MEMPOOL_32].used == 0 && stats[MEMPOOL_64].used == 1);
+    TEST_CHECK(mempoolFree(p));
+    
+    p = mempoolAllocFromISR(TEST_REQUEST);
+    mempoolGetStats(stats);
+    TEST_CHECK(p != NULL && stats[MEMPOOL_256].used == 1);
+    TEST_CHECK(mempoolFreeFromISR(p));
+    
+    TEST_CHECK(mempoolAlloc(257) == NULL);
+    mempoolGetStats(stats);
+    TEST_CHECK(stats[MEMPOOL_32].used == 0 && stats[MEMPOOL_64].used == 0 && stats[MEMPOOL_256].used == 0);
+    TEST_CHECK(stats[MEMPOOL_32].failCount == 0 && stats[MEMPOOL_256].failCount == 0);
+}
+
+/**
+ * @brief  用完、借用、统计与释放检查
+ * @param  无
+ * @retval 无
+ */
+static void TestExhaust(void)
+{
+    static void *blocks[MEMPOOL_32_COUNT + MEMPOOL_64_COUNT + MEMPOOL_256_COUNT];
+    mempoolStats_t stats[MEMPOOL_NUM];
+    uint32_t i, n = 0;
+    
+    mempoolInit();
+    
+    /* 32字节池用完后依次借用64、256字节池 */
+    for (i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++)
+    {
+        blocks[n] = mempoolAlloc(16);
+        TEST_CHECK(blocks[n] != NULL);
+        n += (blocks[n] != NULL);
+    }
+    TEST_CHECK(mempoolAlloc(16) == NULL);
+    TEST_CHECK(mempoolAlloc(TEST_REQUEST) == NULL);
+    
+    mempoolGetStats(stats);
+    TEST_CHECK(stats[MEMPOOL_32].used == MEMPOOL_32_COUNT && stats[MEMPOOL_32].peak == MEMPOOL_32_COUNT);
+    TEST_CHECK(stats[MEMPOOL_64].used == MEMPOOL_64_COUNT && stats[MEMPOOL_256].used == MEMPOOL_256_COUNT);
+    /* 每次在32字节池用完后的请求都计一次，包括借用成功的 */
+    TEST_CHECK(stats[MEMPOOL_32].failCount == MEMPOOL_64_COUNT + MEMPOOL_256_COUNT + 1);
+    TEST_CHECK(stats[MEMPOOL_256].failCount == 1);
+    
+    /* 块中间、池外与空指针 */
+    TEST_CHECK(!mempoolFree((uint8_t *)blocks[0] + 8));
+    TEST_CHECK(!mempoolFree(&stats));
+    TEST_CHECK(!mempoolFree(NULL));
+    mempoolGetStats(stats);
+    TEST_CHECK(stats[MEMPOOL_32].used == MEMPOOL_32_COUNT);
+    
+    /* 释放一半后峰值保持，复位后等于当前值 */
+    for (i = 0; i < n / 2; i++)
+    {
+        TEST_CHECK(mempoolFree(blocks[i]));
+    }
+    mempoolGetStats(stats);
+    TEST_CHECK(stats[MEMPOOL_32].used == MEMPOOL_32_COUNT - n / 2 && stats[MEMPOOL_32].peak == MEMPOOL_32_COUNT);
+    mempoolResetPeak();
+    mempoolGetStats(stats);
+    TEST_CHECK(stats[MEMPOOL_32].peak == stats[MEMPOOL_32].used && stats[MEMPOOL_32].failCount == 0);
+    
+    for (i = n / 2; i < n; i++)
+    {
+        TEST_CHECK(mempoolFree(blocks[i]));
+    }
+    mempoolGetStats(stats);
+    for (i = 0; i < MEMPOOL_NUM; i++)
+    {
+        TEST_CHECK(stats[i].used == 0);
+    }
+}
+
+/**
+ * @brief  heap_4：制造fragments个碎片后计时分配/释放
+ * @param  fragments: 碎片个数
+ * @param  lat: 输出耗时
+ * @retval 无
+ */
+static void TestHeap4(uint32_t fragments, testLatency_t *lat)
+{
+    static void *small[TEST_FRAGMENTS_MAX], *pins[TEST_FRAGMENTS_MAX];
+    HeapStats_t hs;
+    double t0, t1, t2;
+    void *p;
+    uint32_t i;
+    
+    /* heap_4在第一次分配时初始化 */
+    vPortFree(pvPortMalloc(TEST_FRAGMENT));
+    
+    /* 小块与隔离块交替分配，释放小块后留下互不相邻的碎片 */
+    for (i = 0; i < fragments; i++)
+    {
+        small[i] = pvPortMalloc(TEST_FRAGMENT);
+        pins[i] = pvPortMalloc(TEST_FRAGMENT);
+        TEST_CHECK(small[i] != NULL && pins[i] != NULL);
+    }
+    for (i = 0; i < fragments; i++)
+    {
+        vPortFree(small[i]);
+    }
+    vPortGetHeapStats(&hs);
+    TEST_CHECK(hs.xNumberOfFreeBlocks == fragments + 1);
+    
+    for (i = 0; i < TEST_REPEATS; i++)
+    {
+        t0 = testNowNs();
+        p = pvPortMalloc(TEST_REQUEST);
+        t1 = testNowNs();
+        vPortFree(p);
+        t2 = testNowNs();
+        g_allocNs[i] = t1 - t0;
+        g_freeNs[i] = t2 - t1;
+    }
+    vPortGetHeapStats(&hs);
+    TEST_CHECK(hs.xNumberOfFreeBlocks == fragments + 1);
+    
+    for (i = 0; i < fragments; i++)
+    {
+        vPortFree(pins[i]);
+    }
+    vPortGetHeapStats(&hs);
+    TEST_CHECK(hs.xNumberOfFreeBlocks == 1);
+    
+    TestSummarize(g_allocNs, &lat->allocMedian, &lat->allocMax);
+    TestSummarize(g_freeNs, &lat->freeMedian, &lat->freeMax);
+}
+
+/**
+ * @brief  内存池：先占用fragments个小块(最多为32字节池的容量)后计时分配/释放
+ * @param  fragments: 已分配的小块数
+ * @param  lat: 输出耗时
+ * @retval 无
+ */
+static void TestMempool(uint32_t fragments, testLatency_t *lat)
+{
+    static void *small[MEMPOOL_32_COUNT];
+    uint32_t i, n = fragments < MEMPOOL_32_COUNT ? fragments : MEMPOOL_32_COUNT;
+    double t0, t1, t2;
+    void *p;
+    
+    mempoolInit();
+    for (i = 0; i < n; i++)
+    {
+        small[i] = mempoolAlloc(TEST_FRAGMENT);
+    }
+    
+    for (i = 0; i < TEST_REPEATS; i++)
+    {
+        t0 = testNowNs();
+        p = mempoolAlloc(TEST_REQUEST);
+        t1 = testNowNs();
+        TEST_CHECK(mempoolFree(p));
+        t2 = testNowNs();
+        g_allocNs[i] = t1 - t0;
+        g_freeNs[i] = t2 - t1;
+    }
+    
+    for (i = 0; i < n; i++)
+    {
+        TEST_CHECK(mempoolFree(small[i]));
+    }
+    
+    TestSummarize(g_allocNs, &lat->allocMedian, &lat->allocMax);
+    TestSummarize(g_freeNs, &lat->freeMedian, &lat->freeMax);
+}
+
+int main(void)
+{
+    static const uint32_t fragments[] = { 0, 40, TEST_FRAGMENTS_MAX };
+    testLatency_t heap, pool;
+    double overhead, unused;
+    uint32_t i;
+    
+    TestSelect();
+    TestExhaust();
+    
+    /* 计时开销：两次连续取时间的间隔 */
+    for (i = 0; i < TEST_REPEATS; i++)
+    {
+        g_allocNs[i] = -testNowNs();
+        g_allocNs[i] += testNowNs();
+    }
+    TestSummarize(g_allocNs, &overhead, &unused);
+    
+    printf("alloc/free %u bytes, ns per operation (median / max of %u, timer overhead %.0f)\n",
+           (unsigned)TEST_REQUEST, (unsigned)TEST_REPEATS, overhead);
+    for (i = 0; i < sizeof(fragments) / sizeof(fragments[0]); i++)
+    {
+        TestHeap4(fragments[i], &heap);
+        TestMempool(fragments[i], &pool);
+        printf("  K=%-4u heap_4  alloc %5.0f / %7.0f  free %5.0f / %7.0f\n", (unsigned)fragments[i],
+               heap.allocMedian, heap.allocMax, heap.freeMedian, heap.freeMax);
+        printf("         mempool alloc %5.0f / %7.0f  free %5.0f / %7.0f\n",
+               pool.allocMedian, pool.allocMax, pool.freeMedian, pool.freeMax);
+    }
+    
+    return testResult("test_mempool");
+}
@@ -0,0 +1,310 @@
+﻿/*
+ * test_mixer.c
+ *
+ * 电机混控测试，分别以MIXER_AIRMODE = 1/0编译为fc_test_mixer/fc_test_mixer_noair
+ * 电机输出按怠速与推力线性化反算回推力(0~1)后检查：
+ * 1.未解锁输出0，悬停附近未饱和时推力 = 油门 + 混控表 x 姿态力矩
+ * 2.满油门、零油门时的饱和处理：airmode下移动油门保留全部姿态力矩，非airmode下零油门损失负方向力矩
+ * 3.姿态跨度超过输出范围时按比例缩小并返回饱和
+ * 4.随机输入下输出范围与力矩保持
+ * 5.mixerUpdate的主机耗时
+ *
+ * 2026-03-02
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "mixer.h"
+#include "test.h"
+
+#define TEST_TOL                   1e-5
+
+/**
+ * @brief  由电机输出反算推力：去掉怠速，再按(1-k)*u + k*u^2
+ * @param  motor: 电机输出
+ * @param  thrust: 输出各电机推力
+ * @retval 无
+ */
+static void TestThrust(const float *motor, double *thrust)
+{
+    const double k = MIXER_THRUST_LINEAR;
+    double u;
+    uint8_t i;
+    
+    for (i = 0; i < MIXER_MOTOR_NUM; i++)
+    {
+        u = ((double)motor[i] - (double)MIXER_IDLE) / (1.0 - (double)MIXER_IDLE);
+        thrust[i] = (1.0 - k) * u + k * u * u;
+    }
+}
+
+/**
+ * @brief  混控并反算推力
+ * @param  roll/pitch/yaw/thrust: 控制输出
+ * @param  t: 输出各电机推力
+ * @retval mixerUpdate的返回值
+ */
+static uint8_t TestMix(float roll, float pitch, float yaw, float thrust, double *t)
+{
+    control_t control;
+    float motor[MIXER_MOTOR_NUM];
+    uint8_t i, saturated;
+    
+    control.roll = roll;
+    control.pitch = pitch;
+    control.yaw = yaw;
+    control.thrust = thrust;
+    saturated = mixerUpdate(&control, 1, motor);
+    
+    for (i = 0; i < MIXER_MOTOR_NUM; i++)
+    {
+        TEST_CHECK(motor[i] >= MIXER_IDLE - 1e-6f && motor[i] <= 1.0f + 1e-6f);
+    }
+    TestThrust(motor, t);
+    
+    return saturated;
+}
+
+/**
+ * @brief  混控表一行的姿态部分
+ * @param  i: 电机序号
+ * @param  roll/pitch/yaw: 姿态力矩
+ * @retval 该电机的姿态推力
+ */
+static double TestAttitude(uint8_t i, double roll, double pitch, double yaw)
+{
+    return (double)mixerQuadX[i].roll * roll + (double)mixerQuadX[i].pitch * pitch + (double)mixerQuadX[i].yaw * yaw;
+}
+
+/**
+ * @brief  检查推力 = 油门 + 混控表 x 姿态力矩
+ * @param  t: 各电机推力
+ * @param  thrust: 期望的公共油门
+ * @param  roll/pitch/yaw: 期望的姿态力矩
+ * @retval 无
+ */
+static void TestExpect(const double *t, double thrust, double roll, double pitch, double yaw)
+{
+    uint8_t i;
+    
+    for (i = 0; i < MIXER_MOTOR_NUM; i++)
+    {
+        TEST_CHECK_NEAR(t[i], thrust + TestAttitude(i, roll, pitch, yaw), TEST_TOL);
+    }
+}
+
+/**
+ * @brief  未解锁与悬停附近
+ * @param  无
+ * @retval 无
+ */
+static void TestBasic(void)
+{
+    control_t control = {0.1f, 0.1f, 0.1f, 0.5f};
+    float motor[MIXER_MOTOR_NUM];
+    double t[MIXER_MOTOR_NUM];
+    uint8_t i;
+    
+    TEST_CHECK(mixerUpdate(&control, 0, motor) == 0);
+    for (i = 0; i < MIXER_MOTOR_NUM; i++)
+    {
+        TEST_CHECK(motor[i] == 0.0f);
+    }
+    
+    /* 解锁后零输入为怠速 */
+    TEST_CHECK(TestMix(0.0f, 0.0f, 0.0f, 0.0f, t) == 0);
+    TestExpect(t, 0.0, 0.0, 0.0, 0.0);
+    
+    TEST_CHECK(TestMix(0.1f, -0.05f, 0.02f, 0.5f, t) == 0);
+    TestExpect(t, 0.5, 0.1, -0.05, 0.02);
+    
+    /* 推力线性化：输出的平方项补偿后推力与油门成正比 */
+    TEST_CHECK(TestMix(0.0f, 0.0f, 0.0f, 1.0f, t) == 0);
+    TestExpect(t, 1.0, 0.0, 0.0, 0.0);
+}
+
+/**
+ * @brief  满油门饱和：两种模式都降低油门保留姿态力矩，最大的电机正好满输出
+ * @param  无
+ * @retval 无
+ */
+static void TestFullThrottle(void)
+{
+    double t[MIXER_MOTOR_NUM];
+    
+    TEST_CHECK(TestMix(0.2f, 0.0f, 0.0f, 1.0f, t) == 0);
+    printf("full throttle  roll 0.2: thrust %.3f %.3f %.3f %.3f\n", t[0], t[1], t[2], t[3]);
+    TestExpect(t, 0.8, 0.2, 0.0, 0.0);
+    
+    /* 各电机姿态部分为0/0.2/0.1/-0.3，油门降到1 - 0.2 */
+    TEST_CHECK(TestMix(-0.1f, 0.15f, -0.05f, 0.95f, t) == 0);
+    TestExpect(t, 0.8, -0.1, 0.15, -0.05);
+}
+
+/**
+ * @brief  零油门饱和
+ * @param  无
+ * @retval 无
+ */
+static void TestZeroThrottle(void)
+{
+    double t[MIXER_MOTOR_NUM];
+#if !MIXER_AIRMODE
+    uint8_t i;
+#endif
+    
+    TEST_CHECK(TestMix(0.2f, 0.0f, 0.0f, 0.0f, t) == 0);
+    printf("zero throttle  roll 0.2: thrust %.3f %.3f %.3f %.3f\n", t[0], t[1], t[2], t[3]);
+#if MIXER_AIRMODE
+    /* 抬高油门，最小的电机正好在怠速，力矩完整 */
+    TestExpect(t, 0.2, 0.2, 0.0, 0.0);
+#else
+    /* 油门保持0，负方向的一侧在怠速，只剩一半的横滚力矩 */
+    for (i = 0; i < MIXER_MOTOR_NUM; i++)
+    {
+        TEST_CHECK_NEAR(t[i], fmax(TestAttitude(i, 0.2, 0.0, 0.0), 0.0), TEST_TOL);
+    }
+#endif
+    
+    TEST_CHECK(TestMix(0.0f, 0.0f, -0.1f, 0.05f, t) == 0);
+#if MIXER_AIRMODE
+    TestExpect(t, 0.1, 0.0, 0.0, -0.1);
+#else
+    for (i = 0; i < MIXER_MOTOR_NUM; i++)
+    {
+        TEST_CHECK_NEAR(t[i], fmax(0.05 + TestAttitude(i, 0.0, 0.0, -0.1), 0.0), TEST_TOL);
+    }
+#endif
+}
+
+/**
+ * @brief  姿态跨度超过1：按比例缩小并返回饱和
+ * @param  无
+ * @retval 无
+ */
+static void TestOversaturation(void)
+{
+    double t[MIXER_MOTOR_NUM];
+#if !MIXER_AIRMODE
+    uint8_t i;
+#endif
+    
+    /* 横滚0.5 + 偏航0.5：跨度2，缩小一半 */
+    TEST_CHECK(TestMix(0.5f, 0.0f, 0.5f, 0.8f, t) == 1);
+    printf("oversaturated  roll 0.5 yaw 0.5 thrust 0.8: thrust %.3f %.3f %.3f %.3f\n", t[0], t[1], t[2], t[3]);
+    TestExpect(t, 0.5, 0.25, 0.0, 0.25);
+    
+    TEST_CHECK(TestMix(0.5f, 0.0f, 0.5f, 0.2f, t) == 1);
+#if MIXER_AIRMODE
+    /* 油门只能是0.5 */
+    TestExpect(t, 0.5, 0.25, 0.0, 0.25);
+#else
+    for (i = 0; i < MIXER_MOTOR_NUM; i++)
+    {
+        TEST_CHECK_NEAR(t[i], fmax(0.2 + TestAttitude(i, 0.25, 0.0, 0.25), 0.0), TEST_TOL);
+    }
+#endif
+}
+
+/**
+ * @brief  随机输入：输出在[怠速, 1]内；姿态跨度不超过1且油门有余量时力矩保持
+ * @param  无
+ * @retval 无
+ */
+static void TestRandom(void)
+{
+    double t[MIXER_MOTOR_NUM], att[3], sum, lo, hi;
+    float c[4];
+    uint32_t k, rng = 3, kept = 0, lost = 0;
+    uint8_t i, j, saturated;
+    
+    for (k = 0; k < 100000; k++)
+    {
+        for (j = 0; j < 4; j++)
+        {
+            rng = rng * 1664525u + 1013904223u;
+            c[j] = (float)((rng >> 8) / 16777216.0);
+        }
+        c[0] = 1.2f * c[0] - 0.6f;
+        c[1] = 1.2f * c[1] - 0.6f;
+        c[2] = 0.6f * c[2] - 0.3f;
+        saturated = TestMix(c[0], c[1], c[2], c[3], t);
+        
+        /* 对X型混控表，力矩 = 各电机推力按表中系数加权平均 */
+        for (j = 0; j < 3; j++)
+        {
+            sum = 0.0;
+            for (i = 0; i < MIXER_MOTOR_NUM; i++)
+            {
+                sum += t[i] * TestAttitude(i, j == 0, j == 1, j == 2);
+            }
+            att[j] = sum / MIXER_MOTOR_NUM;
+        }
+        /* 姿态跨度超过1时返回饱和(恰为1附近不检查) */
+        lo = hi = TestAttitude(0, c[0], c[1], c[2]);
+        for (i = 1; i < MIXER_MOTOR_NUM; i++)
+        {
+            lo = fmin(lo, TestAttitude(i, c[0], c[1], c[2]));
+            hi = fmax(hi, TestAttitude(i, c[0], c[1], c[2]));
+        }
+        TEST_CHECK(saturated == (hi - lo > 1.0) || fabs(hi - lo - 1.0) < 1e-5);
+        
+        if (!saturated)
+        {
+            if (fabs(att[0] - (double)c[0]) < TEST_TOL && fabs(att[1] - (double)c[1]) < TEST_TOL
+                && fabs(att[2] - (double)c[2]) < TEST_TOL)
+            {
+                kept++;
+            }
+            else
+            {
+                lost++;
+            }
+        }
+    }
+    
+    printf("random         unsaturated: torque kept %u, lost %u\n", (unsigned)kept, (unsigned)lost);
+#if MIXER_AIRMODE
+    TEST_CHECK(lost == 0);
+#else
+    /* 低油门时负方向力矩被截掉 */
+    TEST_CHECK(lost > 0);
+#endif
+}
+
+/**
+ * @brief  主机耗时
+ * @param  无
+ * @retval 无
+ */
+static void TestBenchmark(void)
+{
+    control_t control = {0.1f, -0.2f, 0.05f, 0.5f};
+    float motor[MIXER_MOTOR_NUM];
+    double start, ns;
+    uint32_t k;
+    
+    start = testNowNs();
+    for (k = 0; k < 1000000; k++)
+    {
+        control.thrust = (float)(k & 1023) / 1023.0f;
+        mixerUpdate(&control, 1, motor);
+    }
+    ns = (testNowNs() - start) / 1000000.0;
+    printf("benchmark      mixerUpdate %.1f ns (host)\n", ns);
+}
+
+int main(void)
+{
+    mixerInit(mixerQuadX);
+    printf("MIXER_AIRMODE %d\n", MIXER_AIRMODE);
+    
+    TestBasic();
+    TestFullThrottle();
+    TestZeroThrottle();
+    TestOversaturation();
+    TestRandom();
+    TestBenchmark();
+    
+    return testResult(MIXER_AIRMODE ? "test_mixer" : "test_mixer_noair");
+}
@@ -0,0 +1,174 @@
+﻿/*
+ * test_ringbuf.c
+ *
+ * 环形缓冲区单线程测试与吞吐量基准(多线程见test_lockfree.c)
+ * 1.边界：初始化参数检查、可用满全部空间、满/空、回绕处的批量与Span读写、下标溢出回绕、清空
+ * 2.吞吐量：按树中的实际用法(UART2/sensorlog的字节流、遥测的atkp_t数据包)，
+ *   统计单个、批量与Span/Commit接口每次操作和每个元素的主机耗时
+ *
+ * 2026-03-02
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ringbuf.h"
+#include "atkp.h"
+#include "test.h"
+
+#define TEST_BYTES                 256       // 与UART2_TX_BUFFER_SIZE/UART2_RX_BUFFER_SIZE相同
+#define TEST_PACKETS               8         // 与RADIOLINK_TELEMETRY_SIZE相同
+#define TEST_ROUNDS                2000000
+
+static uint8_t g_bytes[TEST_BYTES];
+static atkp_t g_packets[TEST_PACKETS];
+
+/**
+ * @brief  边界情况
+ * @param  无
+ * @retval 无
+ */
+static void TestEdges(void)
+{
+    ringbuf_t rb;
+    uint8_t in[TEST_BYTES + 16], out[TEST_BYTES + 16];
+    const void *rspan;
+    void *wspan;
+    uint32_t i, n;
+    
+    TEST_CHECK(!ringbufInit(&rb, g_bytes, 1, 0));
+    TEST_CHECK(!ringbufInit(&rb, g_bytes, 1, 96));
+    TEST_CHECK(!ringbufInit(&rb, g_bytes, 0, TEST_BYTES));
+    TEST_CHECK(ringbufInit(&rb, g_bytes, 1, TEST_BYTES));
+    
+    for (i = 0; i < sizeof(in); i++)
+    {
+        in[i] = (uint8_t)(i * 7 + 3);
+    }
+    
+    /* 可用满全部空间，满后写入失败 */
+    TEST_CHECK(ringbufFree(&rb) == TEST_BYTES);
+    TEST_CHECK(ringbufPushBulk(&rb, in, TEST_BYTES + 16) == TEST_BYTES);
+    TEST_CHECK(ringbufFree(&rb) == 0 && ringbufCount(&rb) == TEST_BYTES);
+    TEST_CHECK(!ringbufPush(&rb, in));
+    TEST_CHECK(ringbufPopBulk(&rb, out, TEST_BYTES + 16) == TEST_BYTES);
+    TEST_CHECK(memcmp(in, out, TEST_BYTES) == 0);
+    TEST_CHECK(!ringbufPop(&rb, out));
+    
+    /* 下标停在末尾前10个元素处：批量读写分两段 */
+    ringbufInit(&rb, g_bytes, 1, TEST_BYTES);
+    for (i = 0; i < TEST_BYTES - 10; i++)
+    {
+        ringbufPush(&rb, &in[i]);
+        ringbufPop(&rb, out);
+    }
+    TEST_CHECK(ringbufPushBulk(&rb, in, 100) == 100);
+    TEST_CHECK(ringbufPopBulk(&rb, out, 100) == 100);
+    TEST_CHECK(memcmp(in, out, 100) == 0);
+    
+    /* Span只到缓冲区末尾 */
+    ringbufInit(&rb, g_bytes, 1, TEST_BYTES);
+    for (i = 0; i < TEST_BYTES - 10; i++)
+    {
+        ringbufPush(&rb, &in[i]);
+        ringbufPop(&rb, out);
+    }
+    n = ringbufWriteSpan(&rb, &wspan);
+    TEST_CHECK(n == 10);
+    memcpy(wspan, in, n);
+    ringbufCommit(&rb, n);
+    n = ringbufWriteSpan(&rb, &wspan);
+    TEST_CHECK(n == TEST_BYTES - 10 && wspan == g_bytes);
+    memcpy(wspan, in + 10, 20);
+    ringbufCommit(&rb, 20);
+    TEST_CHECK(ringbufCount(&rb) == 30);
+    n = ringbufReadSpan(&rb, &rspan);
+    TEST_CHECK(n == 10 && memcmp(rspan, in, 10) == 0);
+    ringbufConsume(&rb, n);
+    n = ringbufReadSpan(&rb, &rspan);
+    TEST_CHECK(n == 20 && memcmp(rspan, in + 10, 20) == 0);
+    ringbufConsume(&rb, n);
+    TEST_CHECK(ringbufCount(&rb) == 0);
+    
+    /* 自由递增的下标越过2^32 */
+    ringbufInit(&rb, g_bytes, 1, TEST_BYTES);
+    rb.head = rb.tail = rb.tailCache = rb.headCache = 0xFFFFFFF0u;
+    TEST_CHECK(ringbufPushBulk(&rb, in, TEST_BYTES) == TEST_BYTES);
+    TEST_CHECK(rb.head == 0xF0u && ringbufFree(&rb) == 0);
+    TEST_CHECK(ringbufPopBulk(&rb, out, 40) == 40 && memcmp(in, out, 40) == 0);
+    TEST_CHECK(ringbufFree(&rb) == 40);
+    
+    /* 清空 */
+    ringbufFlush(&rb);
+    TEST_CHECK(ringbufCount(&rb) == 0 && ringbufFree(&rb) == TEST_BYTES);
+}
+
+/**
+ * @brief  一种用法的吞吐量：每轮写入batch个元素再读出，统计每个元素的耗时
+ * @param  name: 名称
+ * @param  rb: 缓冲区
+ * @param  elemSize: 元素字节数
+ * @param  batch: 每次操作的元素数
+ * @param  useSpan: 1-ringbufWriteSpan/ringbufReadSpan(到缓冲区末尾时少于batch)
+ * @retval 无
+ */
+static void TestThroughput(const char *name, ringbuf_t *rb, uint16_t elemSize, uint32_t batch, uint8_t useSpan)
+{
+    static uint8_t data[64 * sizeof(atkp_t)];
+    const void *rspan;
+    void *wspan;
+    double start, ns;
+    uint32_t k, n, elems = 0;
+    
+    start = testNowNs();
+    for (k = 0; k < TEST_ROUNDS / batch; k++)
+    {
+        if (useSpan)
+        {
+            n = ringbufWriteSpan(rb, &wspan);
+            n = n < batch ? n : batch;
+            memcpy(wspan, data, n * elemSize);
+            ringbufCommit(rb, n);
+            n = ringbufReadSpan(rb, &rspan);
+            memcpy(data, rspan, n * elemSize);
+            ringbufConsume(rb, n);
+        }
+        else if (batch == 1)
+        {
+            ringbufPush(rb, data);
+            n = ringbufPop(rb, data);
+        }
+        else
+        {
+            ringbufPushBulk(rb, data, batch);
+            n = ringbufPopBulk(rb, data, batch);
+        }
+        elems += n;
+    }
+    ns = testNowNs() - start;
+    
+    printf("%-28s %7.1f ns per push+pop, %6.2f ns per element, %7.1f MB/s\n", name, ns / (TEST_ROUNDS / batch),
+           ns / elems, (double)elems * elemSize / (ns * 1e-9) / 1e6);
+    TEST_CHECK(elems > 0);
+}
+
+int main(void)
+{
+    ringbuf_t rb;
+    
+    TestEdges();
+    
+    /* UART2/sensorlog：字节流 */
+    ringbufInit(&rb, g_bytes, 1, TEST_BYTES);
+    TestThroughput("bytes  push/pop", &rb, 1, 1, 0);
+    TestThroughput("bytes  bulk 16", &rb, 1, 16, 0);
+    TestThroughput("bytes  bulk 64", &rb, 1, 64, 0);
+    TestThroughput("bytes  span 64", &rb, 1, 64, 1);
+    
+    /* 遥测：atkp_t数据包 */
+    ringbufInit(&rb, g_packets, sizeof(atkp_t), TEST_PACKETS);
+    TestThroughput("atkp_t push/pop", &rb, sizeof(atkp_t), 1, 0);
+    TestThroughput("atkp_t bulk 4", &rb, sizeof(atkp_t), 4, 0);
+    TestThroughput("atkp_t span 4", &rb, sizeof(atkp_t), 4, 1);
+    
+    return testResult("test_ringbuf");
+}
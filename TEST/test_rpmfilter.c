@@ -0,0 +1,298 @@
+﻿/*
+ * test_rpmfilter.c
+ *
+ * 转速谐波陷波测试，采样频率2kHz
+ * 1.四个电机的基频与2、3次谐波均被衰减，低频的机体运动不受影响
+ * 2.转速变化后RPM_FILTER_MOTOR_NUM次迭代内所有陷波跟上
+ * 3.RPM_FILTER_MIN_HZ以上RPM_FILTER_FADE_HZ范围内陷波深度线性过渡，超过RPM_FILTER_MAX_RATIO的谐波直通
+ * 4.计算量：每次迭代(设置转速 + 更新系数 + 三轴滤波)的主机耗时，及其占2kHz周期(500us)的比例
+ *
+ * 2026-03-02
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "rpmfilter.h"
+#include "test.h"
+
+#define TEST_SAMPLE_HZ             2000.0
+#define TEST_PERIOD_NS             (1e9 / TEST_SAMPLE_HZ)
+#define TEST_PI                    3.14159265358979323846
+#define TEST_TONE_AMP              10.0      // 每个谐波的幅值 (deg/s)
+#define TEST_MOTION_HZ             5.0       // 机体运动
+#define TEST_MOTION_AMP            50.0
+
+static double g_motorHz[RPM_FILTER_MOTOR_NUM];
+static uint32_t g_n;
+
+/**
+ * @brief  生成一个样本：机体运动 + 各电机各次谐波，三轴相位不同
+ * @param  xyz: 输出三轴
+ * @retval 无
+ */
+static void TestSample(float *xyz)
+{
+    double t = g_n / TEST_SAMPLE_HZ, sum;
+    uint8_t axis, m, h;
+    
+    for (axis = 0; axis < RPM_FILTER_AXIS_NUM; axis++)
+    {
+        sum = TEST_MOTION_AMP * sin(2.0 * TEST_PI * TEST_MOTION_HZ * t + axis);
+        for (m = 0; m < RPM_FILTER_MOTOR_NUM; m++)
+        {
+            /* 停转的电机不产生振动 */
+            if (g_motorHz[m] <= 0.0)
+            {
+                continue;
+            }
+            for (h = 1; h <= RPM_FILTER_HARMONICS; h++)
+            {
+                sum += TEST_TONE_AMP * sin(2.0 * TEST_PI * g_motorHz[m] * h * t + axis + m);
+            }
+        }
+        xyz[axis] = (float)sum;
+    }
+    g_n++;
+}
+
+/**
+ * @brief  运行一个控制周期：设置转速、更新一个电机的系数、滤波
+ * @param  xyz: 输出三轴滤波结果
+ * @retval 无
+ */
+static void TestIteration(float *xyz)
+{
+    uint8_t m;
+    
+    TestSample(xyz);
+    for (m = 0; m < RPM_FILTER_MOTOR_NUM; m++)
+    {
+        rpmFilterSetMotorHz(m, (float)g_motorHz[m]);
+    }
+    rpmFilterUpdate();
+    rpmFilterApply(xyz);
+}
+
+/**
+ * @brief  运行一段时间，取x轴输出中若干频率分量的幅值
+ * @param  samples: 样本数，须使各频率恰为整周期(整数Hz时取TEST_SAMPLE_HZ的整数倍)
+ * @param  hz: 频率 (Hz)
+ * @param  num: 频率个数
+ * @param  amp: 输出各频率的幅值
+ * @retval 无
+ */
+static void TestMeasure(uint32_t samples, const double *hz, uint8_t num, double *amp)
+{
+    double sumS[16] = {0.0}, sumC[16] = {0.0}, t;
+    float xyz[RPM_FILTER_AXIS_NUM];
+    uint32_t k;
+    uint8_t i;
+    
+    for (k = 0; k < samples; k++)
+    {
+        t = g_n / TEST_SAMPLE_HZ;
+        TestIteration(xyz);
+        for (i = 0; i < num; i++)
+        {
+            sumS[i] += (double)xyz[0] * sin(2.0 * TEST_PI * hz[i] * t);
+            sumC[i] += (double)xyz[0] * cos(2.0 * TEST_PI * hz[i] * t);
+        }
+    }
+    for (i = 0; i < num; i++)
+    {
+        amp[i] = 2.0 * hypot(sumS[i], sumC[i]) / samples;
+    }
+}
+
+/**
+ * @brief  设置各电机转速
+ * @param  base: 电机1转速 (Hz)，其余电机依次加10Hz；0为全部停转
+ * @retval 无
+ */
+static void TestSetMotors(double base)
+{
+    uint8_t m;
+    
+    for (m = 0; m < RPM_FILTER_MOTOR_NUM; m++)
+    {
+        g_motorHz[m] = base > 0.0 ? base + 10.0 * m : 0.0;
+    }
+}
+
+/**
+ * @brief  衰减各次谐波并保留机体运动；转速变化后的跟踪
+ * @param  base: 电机1转速 (Hz)
+ * @param  settle: 测量前运行的迭代数
+ * @retval 无
+ */
+static void TestHarmonics(double base, uint32_t settle)
+{
+    double hz[RPM_FILTER_NOTCH_NUM + 1], amp[RPM_FILTER_NOTCH_NUM + 1], worst = 0.0;
+    float xyz[RPM_FILTER_AXIS_NUM];
+    uint32_t k;
+    uint8_t m, h;
+    
+    TestSetMotors(base);
+    for (k = 0; k < settle; k++)
+    {
+        TestIteration(xyz);
+    }
+    
+    hz[0] = TEST_MOTION_HZ;
+    for (m = 0; m < RPM_FILTER_MOTOR_NUM; m++)
+    {
+        for (h = 0; h < RPM_FILTER_HARMONICS; h++)
+        {
+            hz[1 + m * RPM_FILTER_HARMONICS + h] = g_motorHz[m] * (h + 1);
+        }
+    }
+    TestMeasure((uint32_t)TEST_SAMPLE_HZ, hz, RPM_FILTER_NOTCH_NUM + 1, amp);
+    
+    for (k = 1; k <= RPM_FILTER_NOTCH_NUM; k++)
+    {
+        worst = fmax(worst, amp[k]);
+    }
+    printf("motors %3.0f..%3.0f Hz  (settle %4u)  motion %.3f of %.0f, worst harmonic %.4f of %.0f (%.1f dB)\n",
+           base, base + 30.0, (unsigned)settle, amp[0], TEST_MOTION_AMP, worst, TEST_TONE_AMP,
+           20.0 * log10(worst / TEST_TONE_AMP));
+    TEST_CHECK_NEAR(amp[0], TEST_MOTION_AMP, 0.01 * TEST_MOTION_AMP);
+    TEST_CHECK(worst < 0.03 * TEST_TONE_AMP);
+}
+
+/**
+ * @brief  单个电机基频处的增益(其余电机停转)
+ * @param  hz: 转速 (Hz)
+ * @retval 增益
+ */
+static double TestFundamentalGain(double hz)
+{
+    float xyz[RPM_FILTER_AXIS_NUM];
+    double amp[2], f[2];
+    uint32_t k;
+    
+    rpmFilterInit((float)TEST_SAMPLE_HZ);
+    TestSetMotors(0.0);
+    g_motorHz[0] = hz;
+    for (k = 0; k < 1000; k++)
+    {
+        TestIteration(xyz);
+    }
+    
+    /* 整数Hz以外的频率取2s窗口(半整数Hz恰为整周期) */
+    f[0] = hz;
+    f[1] = 3.0 * hz;
+    TestMeasure(2 * (uint32_t)TEST_SAMPLE_HZ, f, 2, amp);
+    
+    return amp[0] / TEST_TONE_AMP;
+}
+
+/**
+ * @brief  低频端的陷波深度过渡与奈奎斯特频率附近的直通
+ * @param  无
+ * @retval 无
+ */
+static void TestFade(void)
+{
+    static const double hz[] = {60.0, 80.0, 87.5, 95.0, 102.5, 110.0, 130.0};
+    double gain, expected;
+    uint8_t i;
+    
+    printf("fade      ");
+    for (i = 0; i < sizeof(hz) / sizeof(hz[0]); i++)
+    {
+        /* 陷波中心增益为0，按权重w与直通混合后为1 - w；2次谐波陷波的边沿另有约1%的衰减 */
+        gain = TestFundamentalGain(hz[i]);
+        expected = 1.0 - fmin(fmax((hz[i] - (double)RPM_FILTER_MIN_HZ) / (double)RPM_FILTER_FADE_HZ, 0.0), 1.0);
+        printf(" %.1fHz:%.3f", hz[i], gain);
+        TEST_CHECK_NEAR(gain, expected, 0.02);
+    }
+    printf("\n");
+}
+
+/**
+ * @brief  超过RPM_FILTER_MAX_RATIO * 采样频率的谐波直通，其余照常衰减且输出有界
+ * @param  无
+ * @retval 无
+ */
+static void TestNyquist(void)
+{
+    double hz[3], amp[3];
+    float xyz[RPM_FILTER_AXIS_NUM];
+    uint32_t k;
+    
+    /* 2次谐波760Hz低于900Hz，3次谐波1140Hz超出(混叠到860Hz) */
+    rpmFilterInit((float)TEST_SAMPLE_HZ);
+    TestSetMotors(0.0);
+    g_motorHz[0] = 380.0;
+    for (k = 0; k < 1000; k++)
+    {
+        TestIteration(xyz);
+    }
+    hz[0] = 380.0;
+    hz[1] = 760.0;
+    hz[2] = TEST_SAMPLE_HZ - 1140.0;
+    TestMeasure((uint32_t)TEST_SAMPLE_HZ, hz, 3, amp);
+    
+    printf("nyquist    380Hz %.4f  760Hz %.4f  1140Hz (aliased to 860Hz) %.3f\n", amp[0] / TEST_TONE_AMP,
+           amp[1] / TEST_TONE_AMP, amp[2] / TEST_TONE_AMP);
+    TEST_CHECK(amp[0] < 0.03 * TEST_TONE_AMP);
+    TEST_CHECK(amp[1] < 0.03 * TEST_TONE_AMP);
+    /* 直通，只受760Hz陷波边沿的影响 */
+    TEST_CHECK(amp[2] > 0.7 * TEST_TONE_AMP && amp[2] < 1.01 * TEST_TONE_AMP);
+}
+
+/**
+ * @brief  2kHz下每次迭代的计算量
+ * @param  无
+ * @retval 无
+ */
+static void TestBudget(void)
+{
+    float xyz[RPM_FILTER_AXIS_NUM] = {1.0f, 2.0f, 3.0f};
+    double start, updateNs, applyNs, totalNs;
+    uint32_t k;
+    uint8_t m;
+    
+    rpmFilterInit((float)TEST_SAMPLE_HZ);
+    
+    /* 电机转速每次都变化，避免测到不变的系数 */
+    start = testNowNs();
+    for (k = 0; k < 1000000; k++)
+    {
+        for (m = 0; m < RPM_FILTER_MOTOR_NUM; m++)
+        {
+            rpmFilterSetMotorHz(m, 150.0f + (float)((k + 37 * m) & 255));
+        }
+        rpmFilterUpdate();
+    }
+    updateNs = (testNowNs() - start) / 1000000.0;
+    
+    start = testNowNs();
+    for (k = 0; k < 1000000; k++)
+    {
+        xyz[k % RPM_FILTER_AXIS_NUM] += 1.0f;
+        rpmFilterApply(xyz);
+    }
+    applyNs = (testNowNs() - start) / 1000000.0;
+    totalNs = updateNs + applyNs;
+    
+    printf("budget     set+update %.1f ns, apply (3 axes x %u notches) %.1f ns, total %.1f ns = %.3f%% of %.0f us (host)\n",
+           updateNs, (unsigned)RPM_FILTER_NOTCH_NUM, applyNs, totalNs, 100.0 * totalNs / TEST_PERIOD_NS,
+           TEST_PERIOD_NS / 1000.0);
+    /* 主机上的宽松上限：目标上约为1.3%，主机应远低于此 */
+    TEST_CHECK(totalNs < 0.013 * TEST_PERIOD_NS);
+}
+
+int main(void)
+{
+    rpmFilterInit((float)TEST_SAMPLE_HZ);
+    TestHarmonics(150.0, 1000);
+    
+    /* 转速阶跃：RPM_FILTER_MOTOR_NUM次迭代后所有陷波都已重新计算，余下为滤波器暂态 */
+    TestHarmonics(260.0, 100);
+    TestFade();
+    TestNyquist();
+    TestBudget();
+    
+    return testResult("test_rpmfilter");
+}
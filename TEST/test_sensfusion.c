@@ -0,0 +1,156 @@
+﻿/*
+ * test_sensfusion.c
+ *
+ * 四元数姿态解算测试(按SENSFUSION_ALGORITHM分别编译为Mahony与Madgwick两个测试)：
+ * 1.静止倾斜+陀螺仪零偏：横滚/俯仰收敛到真实值，零偏估计收敛
+ * 2.三轴正弦转动+零偏+噪声：收敛后倾斜误差的均方根与最大值
+ * 3.每次更新的耗时(主机)
+ * 实际飞行记录的回放与误差统计见fc_replay
+ *
+ * 2026-03-02
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "sensfusion.h"
+#include "test.h"
+#include "test_imu.h"
+
+#define TEST_RATE_HZ               1000
+#define TEST_DT                    (1.0 / TEST_RATE_HZ)
+
+#if SENSFUSION_ALGORITHM == SENSFUSION_MAHONY
+#define TEST_NAME                  "test_sensfusion_mahony"
+#else
+#define TEST_NAME                  "test_sensfusion_madgwick"
+#endif
+
+/**
+ * @brief  静止倾斜，从水平姿态开始收敛
+ * @param  无
+ * @retval 无
+ */
+static void TestStaticTilt(void)
+{
+    testImuConfig_t cfg = {20.0, -10.0, 0.0, {1.0, -0.5, 0.0}, 0.0, 0.0, 1};
+    testImu_t imu;
+    testImuSample_t s;
+    float roll, pitch, yaw, bias[3];
+    uint32_t k;
+    
+    testImuInit(&imu, &cfg);
+    sensfusionInit();
+    for (k = 0; k < 300 * TEST_RATE_HZ; k++)
+    {
+        testImuStep(&imu, TEST_DT, &s);
+        sensfusionUpdate(s.gyro[0], s.gyro[1], s.gyro[2], s.acc[0], s.acc[1], s.acc[2], (float)TEST_DT);
+    }
+    sensfusionGetEuler(&roll, &pitch, &yaw);
+    sensfusionGetGyroBias(bias);
+    
+    printf("static   roll %.3f pitch %.3f (true %.1f %.1f), bias %.3f %.3f (true %.1f %.1f) deg/s\n",
+           (double)roll, (double)pitch, s.roll, s.pitch, (double)bias[0], (double)bias[1],
+           cfg.gyroBias[0], cfg.gyroBias[1]);
+    TEST_CHECK_NEAR(roll, s.roll, 0.1);
+    TEST_CHECK_NEAR(pitch, s.pitch, 0.1);
+    /* 垂直于重力的零偏分量可由重力观测，偏航零偏设为0使其不耦合到横滚/俯仰 */
+    TEST_CHECK_NEAR(bias[0], cfg.gyroBias[0], 0.05);
+    TEST_CHECK_NEAR(bias[1], cfg.gyroBias[1], 0.05);
+}
+
+/**
+ * @brief  倾斜误差：估计与真实重力方向(机体系)的夹角，不受欧拉角在俯仰±90度附近奇异的影响
+ * @param  q: 估计的姿态四元数
+ * @param  roll,pitch: 真实欧拉角 (deg)
+ * @retval 夹角 (deg)
+ */
+static double TestTiltError(const float *q, double roll, double pitch)
+{
+    double r = roll * (3.14159265358979323846 / 180.0);
+    double p = pitch * (3.14159265358979323846 / 180.0);
+    double w = q[0], x = q[1], y = q[2], z = q[3];
+    double dot;
+    
+    /* invSqrt归一化有约0.2%的误差，按实际模长计算 */
+    dot = (2.0 * (x * z - w * y) * -sin(p) + 2.0 * (w * x + y * z) * sin(r) * cos(p)
+        + (w * w - x * x - y * y + z * z) * cos(r) * cos(p)) / (w * w + x * x + y * y + z * z);
+    
+    return acos(fmax(-1.0, fmin(1.0, dot))) * (180.0 / 3.14159265358979323846);
+}
+
+/**
+ * @brief  三轴转动，带零偏与噪声
+ * @param  无
+ * @retval 无
+ */
+static void TestRotation(void)
+{
+    testImuConfig_t cfg = {0.0, 0.0, 40.0, {0.5, -0.5, 0.2}, 0.3, 0.02, 2};
+    testImu_t imu;
+    testImuSample_t s;
+    float q[4];
+    double err, sq = 0.0, maxErr = 0.0;
+    uint32_t k, n = 0;
+    
+    testImuInit(&imu, &cfg);
+    sensfusionInit();
+    for (k = 0; k < 120 * TEST_RATE_HZ; k++)
+    {
+        testImuStep(&imu, TEST_DT, &s);
+        sensfusionUpdate(s.gyro[0], s.gyro[1], s.gyro[2], s.acc[0], s.acc[1], s.acc[2], (float)TEST_DT);
+        
+        /* 前20s为收敛 */
+        if (k >= 20 * TEST_RATE_HZ)
+        {
+            sensfusionGetQuaternion(q);
+            err = TestTiltError(q, s.roll, s.pitch);
+            sq += err * err;
+            maxErr = fmax(maxErr, err);
+            n++;
+        }
+    }
+    
+    printf("rotation tilt error rms %.3f max %.3f deg (%u samples)\n", sqrt(sq / n), maxErr, (unsigned)n);
+    TEST_CHECK(sqrt(sq / n) < 1.0);
+    TEST_CHECK(maxErr < 3.0);
+}
+
+/**
+ * @brief  每次更新的耗时
+ * @param  无
+ * @retval 无
+ */
+static void TestBenchmark(void)
+{
+    testImuConfig_t cfg = {0.0, 0.0, 40.0, {0.0, 0.0, 0.0}, 0.3, 0.02, 3};
+    static testImuSample_t s[1024];
+    testImu_t imu;
+    double start, ns;
+    uint32_t k;
+    
+    testImuInit(&imu, &cfg);
+    for (k = 0; k < 1024; k++)
+    {
+        testImuStep(&imu, TEST_DT, &s[k]);
+    }
+    
+    sensfusionInit();
+    start = testNowNs();
+    for (k = 0; k < 1000000; k++)
+    {
+        sensfusionUpdate(s[k & 1023].gyro[0], s[k & 1023].gyro[1], s[k & 1023].gyro[2],
+                         s[k & 1023].acc[0], s[k & 1023].acc[1], s[k & 1023].acc[2], (float)TEST_DT);
+    }
+    ns = (testNowNs() - start) / 1000000.0;
+    
+    printf("update   %.1f ns (host)\n", ns);
+}
+
+int main(void)
+{
+    TestStaticTilt();
+    TestRotation();
+    TestBenchmark();
+    
+    return testResult(TEST_NAME);
+}
@@ -26,6 +26,16 @@
 #include "atkpRx.h"
 #include "stabilizer.h"
 #include "atkpTx.h"
+#include "sched.h"
+#include "schedConfig.h"
+#include "stackmon.h"
+#include "mempool.h"
+#include "latency.h"
+#include "ART.h"
+#if STABILIZER_BLACKBOX
+#include "blackbox.h"
+#include "blackboxFlash.h"
+#endif
 
 /** @addtogroup Template_Project
   * @{
@@ -33,10 +43,55 @@
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+/* 周期任务可用的优先级范围，最高一级留给定时器任务 */
+#define TASK_PRIORITY_MAX         ( configMAX_PRIORITIES - 2 )
+#define TASK_PRIORITY_MIN         ( tskIDLE_PRIORITY + 1 )
+
+/* 任务表项：函数、名称、栈、控制块、周期(us)、截止时间(us，0为等于周期)、最坏执行时间(us) */
+#define TASK_ENTRY(func, name, stack, tcb, period, deadline, wcet) \
+  { (func), (name), sizeof(stack) / sizeof(StackType_t), (stack), &(tcb), (period), (deadline), (wcet), 0, 0, NULL }
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 static __IO uint32_t uwTimingDelay;
 RCC_ClocksTypeDef RCC_Clocks;
+#if ART_BENCHMARK
+ART_Bench_t g_artBench;     /* 启动时基准测试结果，用调试器查看 */
+#endif
+
+/* 任务控制块与栈，全部静态分配，大小见链接生成的FlightControl.map */
+static StaticTask_t g_radiolinkTcb;
+static StaticTask_t g_atkpRxTcb;
+static StaticTask_t g_stabilizerTcb;
+static StaticTask_t g_atkpTxTcb;
+#if STABILIZER_BLACKBOX
+static StaticTask_t g_blackboxTcb;
+static StackType_t g_blackboxStack[384];
+#endif
+static StackType_t g_radiolinkStack[256];
+static StackType_t g_atkpRxStack[256];
+static StackType_t g_stabilizerStack[512];
+static StackType_t g_atkpTxStack[256];
+
+/* 任务表，优先级由周期/截止时间导出，时间参数见schedConfig.h */
+static schedTask_t g_tasks[] = {
+  TASK_ENTRY(stabilizerTask, "stabilizer", g_stabilizerStack, g_stabilizerTcb,
+             SCHED_STABILIZER_PERIOD_US, SCHED_STABILIZER_DEADLINE_US, SCHED_STABILIZER_WCET_US),
+  TASK_ENTRY(atkpTxTask, "atkpTx", g_atkpTxStack, g_atkpTxTcb,
+             SCHED_ATKPTX_PERIOD_US, SCHED_ATKPTX_DEADLINE_US, SCHED_ATKPTX_WCET_US),
+  TASK_ENTRY(radioLinkTask, "radioLink", g_radiolinkStack, g_radiolinkTcb,
+             SCHED_RADIOLINK_PERIOD_US, SCHED_RADIOLINK_DEADLINE_US, SCHED_RADIOLINK_WCET_US),
+  TASK_ENTRY(atkpRxTask, "atkpRx", g_atkpRxStack, g_atkpRxTcb,
+             SCHED_ATKPRX_PERIOD_US, SCHED_ATKPRX_DEADLINE_US, SCHED_ATKPRX_WCET_US),
+#if STABILIZER_BLACKBOX
+  TASK_ENTRY(blackboxTask, "blackbox", g_blackboxStack, g_blackboxTcb,
+             SCHED_BLACKBOX_PERIOD_US, SCHED_BLACKBOX_DEADLINE_US, SCHED_BLACKBOX_WCET_US),
+#endif
+};
+
+#define TASK_NUM                  ( sizeof(g_tasks) / sizeof(g_tasks[0]) )
+
+/* 可调度性分析结果，1表示所有任务满足截止时间，调试时查看g_tasks[].responseUs */
+static uint8_t g_schedulable;
 
 /* Private function prototypes -----------------------------------------------*/
 static void Delay(__IO uint32_t nTime);
@@ -50,29 +105,45 @@ static void Delay(__IO uint32_t nTime);
   */
 int main(void)
 {
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
-	
+  uint8_t i;
+    
+  /* 检查Flash等待周期、预取与缓存配置，需最先执行 */
+  ART_Init();
+#if ART_BENCHMARK
+  ART_Benchmark(&g_artBench);
+#endif
+    
+  /* FreeRTOS要求全部优先级位用于抢占优先级 */
+  NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
+    
+  /* 外设与IPC对象初始化，需在启动调度器前完成 */
+#if MEMPOOL_ENABLE
+  mempoolInit();
+#endif
+#if LATENCY_ENABLE
+  latencyInit();
+#endif
+  radiolinkInit();
+  atkpRxInit();
+  stabilizerInit();
+#if STABILIZER_BLACKBOX
+  blackboxInit(&blackboxFlashBackend, STABILIZER_RATE_HZ);
+#endif
+    
+  /* 按截止时间分配优先级并做响应时间分析，再按任务表创建任务 */
+  schedAssignPriorities(g_tasks, TASK_NUM, TASK_PRIORITY_MAX, TASK_PRIORITY_MIN);
+  g_schedulable = schedAnalyze(g_tasks, TASK_NUM);
+    
+  for (i = 0; i < TASK_NUM; i++)
+  {
+    g_tasks[i].handle = xTaskCreateStatic((TaskFunction_t)g_tasks[i].func, g_tasks[i].name, g_tasks[i].stackDepth, NULL,
+                                          g_tasks[i].priority, (StackType_t *)g_tasks[i].stack, (StaticTask_t *)g_tasks[i].tcb);
+  }
+  stackmonInit(g_tasks, TASK_NUM);
+    
+  vTaskStartScheduler();
+    
+  /* 静态创建不会因内存不足失败，正常不会运行到这里 */
   while (1)
   {
   }
@@ -0,0 +1,28 @@
+# arm-none-eabi-gcc交叉编译工具链
+# 用法: cmake -S . -B build-arm -DCMAKE_TOOLCHAIN_FILE=cmake/arm-none-eabi.cmake
+# 工具链不在PATH中时用-DARM_TOOLCHAIN_DIR=<安装目录>/bin指定
+
+set(CMAKE_SYSTEM_NAME Generic)
+set(CMAKE_SYSTEM_PROCESSOR arm)
+
+set(ARM_TOOLCHAIN_DIR "" CACHE PATH "arm-none-eabi工具链bin目录(为空时在PATH中查找)")
+if(ARM_TOOLCHAIN_DIR)
+    set(ARM_TOOLCHAIN_PREFIX "${ARM_TOOLCHAIN_DIR}/arm-none-eabi-")
+else()
+    set(ARM_TOOLCHAIN_PREFIX "arm-none-eabi-")
+endif()
+
+set(CMAKE_C_COMPILER "${ARM_TOOLCHAIN_PREFIX}gcc")
+set(CMAKE_ASM_COMPILER "${ARM_TOOLCHAIN_PREFIX}gcc")
+set(CMAKE_AR "${ARM_TOOLCHAIN_PREFIX}gcc-ar")
+set(CMAKE_RANLIB "${ARM_TOOLCHAIN_PREFIX}gcc-ranlib")
+set(CMAKE_OBJCOPY "${ARM_TOOLCHAIN_PREFIX}objcopy" CACHE FILEPATH "")
+set(CMAKE_SIZE "${ARM_TOOLCHAIN_PREFIX}size" CACHE FILEPATH "")
+set(CMAKE_NM "${ARM_TOOLCHAIN_PREFIX}nm" CACHE FILEPATH "")
+
+# 裸机无法链接测试程序
+set(CMAKE_TRY_COMPILE_TARGET_TYPE STATIC_LIBRARY)
+
+set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
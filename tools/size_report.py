@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""
+固件大小报告
+
+1.从GNU ld的.map文件读取各输出段大小，汇总Flash与SRAM占用
+2.用nm读取每个函数的大小
+3.指定--baseline时与基线比较，列出各段与变化最大的函数；--write-baseline保存当前结果为基线
+
+用法(由CMake的size-report/size-baseline目标调用)：
+  size_report.py --nm arm-none-eabi-nm --elf X.elf --map X.map --baseline X.json [--top 30] [--fail-above 0]
+  size_report.py --nm arm-none-eabi-nm --elf X.elf --map X.map --write-baseline X.json
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+# 占用Flash的输出段(加载地址在Flash)与占用SRAM的输出段
+FLASH_SECTIONS = ('.isr_vector', '.text', '.rodata', '.ARM.extab', '.ARM',
+                  '.preinit_array', '.init_array', '.fini_array', '.ramfunc', '.data')
+RAM_SECTIONS = ('.ramfunc', '.data', '.bss', '._user_heap_stack')
+# 调试信息等不占用目标存储的段
+IGNORED_SECTIONS = ('.debug', '.comment', '.ARM.attributes', '.stab')
+
+SECTION_RE = re.compile(r'^(\.[\w.$]+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+))?\s*$')
+ADDR_SIZE_RE = re.compile(r'^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)')
+
+
+def read_map_sections(path):
+    """读取.map中"Linker script and memory map"之后的输出段(顶格的段名)，段名过长时地址与大小在下一行"""
+    sections = {}
+    pending = None
+    started = False
+
+    with open(path, encoding='utf-8', errors='replace') as f:
+        for line in f:
+            line = line.rstrip('\n')
+            if not started:
+                started = line.startswith('Linker script and memory map')
+                continue
+
+            if pending is not None:
+                m = ADDR_SIZE_RE.match(line)
+                if m:
+                    sections[pending] = int(m.group(2), 16)
+                pending = None
+                continue
+
+            m = SECTION_RE.match(line)
+            if m:
+                if m.group(3) is not None:
+                    sections[m.group(1)] = int(m.group(3), 16)
+                else:
+                    pending = m.group(1)
+
+    return {name: size for name, size in sections.items()
+            if size > 0 and not name.startswith(IGNORED_SECTIONS)}
+
+
+def read_functions(nm, elf):
+    """用nm读取函数(代码段符号)大小，同名静态函数按名称累加"""
+    out = subprocess.run([nm, '--print-size', '--size-sort', '--radix=d', elf],
+                         check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+    functions = {}
+
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) != 4 or fields[2] not in 'tTwW':
+            continue
+        functions[fields[3]] = functions.get(fields[3], 0) + int(fields[1])
+
+    return functions
+
+
+def totals(sections):
+    flash = sum(size for name, size in sections.items() if name in FLASH_SECTIONS)
+    ram = sum(size for name, size in sections.items() if name in RAM_SECTIONS)
+    return flash, ram
+
+
+def delta_str(now, before):
+    if before is None:
+        return '     (new)'
+    return '%+10d' % (now - before)
+
+
+def report(name, current, baseline, top):
+    sections = current['sections']
+    base_sections = baseline['sections'] if baseline else {}
+
+    print('== %s' % name)
+    print('%-20s %10s %10s' % ('section', 'size', 'delta' if baseline else ''))
+    for sec in sorted(set(sections) | set(base_sections)):
+        now = sections.get(sec, 0)
+        print('%-20s %10d %s' % (sec, now, delta_str(now, base_sections.get(sec)) if baseline else ''))
+
+    flash, ram = totals(sections)
+    if baseline:
+        base_flash, base_ram = totals(base_sections)
+        print('%-20s %10d %+10d' % ('FLASH total', flash, flash - base_flash))
+        print('%-20s %10d %+10d' % ('RAM total', ram, ram - base_ram))
+    else:
+        print('%-20s %10d' % ('FLASH total', flash))
+        print('%-20s %10d' % ('RAM total', ram))
+        print('no baseline, run the size-baseline target to create one')
+        return 0
+
+    functions = current['functions']
+    base_functions = baseline['functions']
+    changes = []
+    for func in set(functions) | set(base_functions):
+        now = functions.get(func, 0)
+        before = base_functions.get(func, 0)
+        if now != before:
+            changes.append((now - before, func, now, before))
+    changes.sort(key=lambda c: (-abs(c[0]), c[1]))
+
+    print('%d functions changed, total %+d bytes' % (len(changes), sum(c[0] for c in changes)))
+    for delta, func, now, before in changes[:top]:
+        tag = ' (new)' if before == 0 else (' (removed)' if now == 0 else '')
+        print('  %+8d %8d  %s%s' % (delta, now, func, tag))
+
+    return flash - base_flash
+
+
+def main():
+    parser = argparse.ArgumentParser(description='firmware size report')
+    parser.add_argument('--nm', default='arm-none-eabi-nm')
+    parser.add_argument('--elf', required=True)
+    parser.add_argument('--map', required=True)
+    parser.add_argument('--baseline', help='baseline json to compare against')
+    parser.add_argument('--write-baseline', help='write current sizes to this json')
+    parser.add_argument('--top', type=int, default=30, help='number of function changes to list')
+    parser.add_argument('--fail-above', type=int, default=None,
+                        help='exit with error if FLASH grows by more than this many bytes')
+    args = parser.parse_args()
+
+    current = {
+        'sections': read_map_sections(args.map),
+        'functions': read_functions(args.nm, args.elf),
+    }
+    name = os.path.splitext(os.path.basename(args.elf))[0]
+
+    if args.write_baseline:
+        os.makedirs(os.path.dirname(os.path.abspath(args.write_baseline)), exist_ok=True)
+        with open(args.write_baseline, 'w') as f:
+            json.dump(current, f, indent=1, sort_keys=True)
+        flash, ram = totals(current['sections'])
+        print('%s: baseline written (FLASH %d, RAM %d)' % (name, flash, ram))
+        return 0
+
+    baseline = None
+    if args.baseline and os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+
+    growth = report(name, current, baseline, args.top)
+    if args.fail_above is not None and growth > args.fail_above:
+        print('FLASH grew by %d bytes (limit %d)' % (growth, args.fail_above))
+        return 1
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())